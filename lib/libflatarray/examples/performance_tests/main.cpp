@@ -5,6 +5,7 @@
  * file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <libflatarray/aligned_allocator.hpp>
 #include <libflatarray/flat_array.hpp>
 #include <libflatarray/short_vec.hpp>
 #include <libflatarray/testbed/cpu_benchmark.hpp>
@@ -25,6 +26,8 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <list>
 #ifdef __SSE__
@@ -2424,6 +2427,197 @@ public:
     }
 };
 
+/**
+ * Throughput of the short_vec math functions: dim[0] is the number
+ * of elements (kept small enough to stay in cache), dim[1] the
+ * number of repetitions and dim[2] selects the kernel (see
+ * kernel_name()). Results are given in billion elements per second.
+ */
+class ShortVecMath : public cpu_benchmark
+{
+public:
+    std::string family()
+    {
+        return "ShortVecMath";
+    }
+
+    std::string unit()
+    {
+        return "GElements/s";
+    }
+
+protected:
+    static std::string kernel_name(int kernel)
+    {
+        switch (kernel) {
+        case 0:
+            return "fma";
+        case 1:
+            return "minmax";
+        case 2:
+            return "horizontal_sum";
+        case 3:
+            return "exp";
+        case 4:
+            return "log";
+        default:
+            return "pow";
+        }
+    }
+
+    static void init(std::vector<double, aligned_allocator<double, 64> > *a, std::vector<double, aligned_allocator<double, 64> > *b)
+    {
+        for (std::size_t i = 0; i < a->size(); ++i) {
+            (*a)[i] = 0.5 + 2.0 * i / a->size();
+            (*b)[i] = -3.0 + 6.0 * i / a->size();
+        }
+    }
+
+    static double gelements(std::vector<int> dim, double seconds)
+    {
+        return 1e-9 * dim[0] * dim[1] / seconds;
+    }
+};
+
+class ShortVecMathVanilla : public ShortVecMath
+{
+public:
+    std::string species()
+    {
+        return "vanilla_" + kernel_name(kernel);
+    }
+
+    explicit ShortVecMathVanilla(int kernel = 0) :
+        kernel(kernel)
+    {}
+
+    double performance(std::vector<int> dim)
+    {
+        int n = dim[0];
+        int repeats = dim[1];
+
+        std::vector<double, aligned_allocator<double, 64> > a(n);
+        std::vector<double, aligned_allocator<double, 64> > b(n);
+        std::vector<double, aligned_allocator<double, 64> > c(n);
+        init(&a, &b);
+        double acc = 0;
+
+        double tStart = time();
+
+        for (int t = 0; t < repeats; ++t) {
+            switch (kernel) {
+            case 0:
+                for (int i = 0; i < n; ++i) {
+                    c[i] = a[i] * b[i] + c[i];
+                }
+                break;
+            case 1:
+                for (int i = 0; i < n; ++i) {
+                    c[i] = (std::max)(c[i], (std::min)(a[i], b[i]));
+                }
+                break;
+            case 2:
+                for (int i = 0; i < n; ++i) {
+                    acc += a[i];
+                }
+                break;
+            case 3:
+                for (int i = 0; i < n; ++i) {
+                    c[i] = std::exp(b[i]);
+                }
+                break;
+            case 4:
+                for (int i = 0; i < n; ++i) {
+                    c[i] = std::log(a[i]);
+                }
+                break;
+            default:
+                for (int i = 0; i < n; ++i) {
+                    c[i] = std::pow(a[i], b[i]);
+                }
+            }
+        }
+
+        double tEnd = time();
+
+        if ((c[0] == 4711) || (acc == 4711)) {
+            std::cout << "this is really only here to prevent the compiler from optimizing away any code\n";
+        }
+
+        return gelements(dim, tEnd - tStart);
+    }
+
+private:
+    int kernel;
+};
+
+class ShortVecMathGold : public ShortVecMath
+{
+public:
+    std::string species()
+    {
+        return "gold_" + kernel_name(kernel);
+    }
+
+    explicit ShortVecMathGold(int kernel = 0) :
+        kernel(kernel)
+    {}
+
+    double performance(std::vector<int> dim)
+    {
+        typedef short_vec<double, 8> Double;
+
+        int n = dim[0];
+        int repeats = dim[1];
+
+        std::vector<double, aligned_allocator<double, 64> > a(n);
+        std::vector<double, aligned_allocator<double, 64> > b(n);
+        std::vector<double, aligned_allocator<double, 64> > c(n);
+        init(&a, &b);
+        double acc = 0;
+
+        double tStart = time();
+
+        for (int t = 0; t < repeats; ++t) {
+            for (int i = 0; i < n; i += Double::ARITY) {
+                Double va(&a[i]);
+                Double vb(&b[i]);
+
+                switch (kernel) {
+                case 0:
+                    &c[i] << fma(va, vb, Double(&c[i]));
+                    break;
+                case 1:
+                    &c[i] << max(Double(&c[i]), min(va, vb));
+                    break;
+                case 2:
+                    acc += horizontal_sum(va);
+                    break;
+                case 3:
+                    &c[i] << exp(vb);
+                    break;
+                case 4:
+                    &c[i] << log(va);
+                    break;
+                default:
+                    &c[i] << pow(va, vb);
+                }
+            }
+        }
+
+        double tEnd = time();
+
+        if ((c[0] == 4711) || (acc == 4711)) {
+            std::cout << "this is really only here to prevent the compiler from optimizing away any code\n";
+        }
+
+        return gelements(dim, tEnd - tStart);
+    }
+
+private:
+    int kernel;
+};
+
 int main(int argc, char **argv)
 {
     if ((argc < 3) || (argc == 4) || (argc > 5)) {
@@ -2578,5 +2772,19 @@ int main(int argc, char **argv)
         eval(ConditionalAnyGold(), *i);
     }
 
+    sizes.clear();
+    for (int kernel = 0; kernel < 6; ++kernel) {
+        std::vector<int> dim(3);
+        dim[0] = 4096;
+        dim[1] = (kernel < 3) ? 200000 : 20000;
+        dim[2] = kernel;
+        sizes.push_back(dim);
+    }
+
+    for (std::vector<std::vector<int> >::iterator i = sizes.begin(); i != sizes.end(); ++i) {
+        eval(ShortVecMathVanilla((*i)[2]), *i);
+        eval(ShortVecMathGold((*i)[2]), *i);
+    }
+
     return 0;
 }
@@ -21,6 +21,11 @@ namespace flat_array {
 /**
  * Will initialize all grid cells, relies on the SoA (Struct of
  * Arrays) accessor to initialize a cell's members individually.
+ *
+ * If parallel is set, rows are constructed by all OpenMP threads,
+ * split statically along the outermost dimension (z for 3D grids, y
+ * otherwise). Memory placed by first touch then ends up on the NUMA
+ * node of the thread which will update it.
  */
 template<typename CELL, bool USE_CUDA_FUNCTORS = false>
 class construct_functor
@@ -29,23 +34,41 @@ public:
     construct_functor(
         std::size_t dim_x,
         std::size_t dim_y,
-        std::size_t dim_z) :
+        std::size_t dim_z,
+        bool parallel = false) :
         dim_x(dim_x),
         dim_y(dim_y),
-        dim_z(dim_z)
+        dim_z(dim_z),
+        parallel(parallel)
     {}
 
     template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
     void operator()(soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>& accessor) const
     {
+#ifdef _OPENMP
+        if (parallel) {
+            const bool split_z = (dim_z > 1);
+            const long num_planes = long(split_z ? dim_z : dim_y);
+            soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX> plane_accessor = accessor;
+
+#pragma omp parallel for schedule(static) firstprivate(plane_accessor)
+            for (long plane = 0; plane < num_planes; ++plane) {
+                if (split_z) {
+                    for (std::size_t y = 0; y < dim_y; ++y) {
+                        construct_row(plane_accessor, y, std::size_t(plane));
+                    }
+                } else {
+                    construct_row(plane_accessor, std::size_t(plane), 0);
+                }
+            }
+
+            return;
+        }
+#endif
+
         for (std::size_t z = 0; z < dim_z; ++z) {
             for (std::size_t y = 0; y < dim_y; ++y) {
-                accessor.index() = soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>::gen_index(0, y, z);
-
-                for (std::size_t x = 0; x < dim_x; ++x) {
-                    accessor.construct_members();
-                    ++accessor;
-                }
+                construct_row(accessor, y, z);
             }
         }
     }
@@ -54,6 +77,18 @@ private:
     std::size_t dim_x;
     std::size_t dim_y;
     std::size_t dim_z;
+    bool parallel;
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void construct_row(soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>& accessor, std::size_t y, std::size_t z) const
+    {
+        accessor.index() = soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>::gen_index(0, y, z);
+
+        for (std::size_t x = 0; x < dim_x; ++x) {
+            accessor.construct_members();
+            ++accessor;
+        }
+    }
 };
 
 #ifdef LIBFLATARRAY_WITH_CUDA
@@ -87,7 +122,8 @@ void construct_kernel(char *data, long dim_x, long dim_y, long dim_z)
 }
 
 /**
- * Specialization for CUDA
+ * Specialization for CUDA. Construction always runs in parallel on
+ * the device, so the parallel flag is ignored.
  */
 template<typename CELL>
 class construct_functor<CELL, true>
@@ -96,7 +132,8 @@ public:
     construct_functor(
         std::size_t dim_x,
         std::size_t dim_y,
-        std::size_t dim_z) :
+        std::size_t dim_z,
+        bool /* parallel */ = false) :
         dim_x(dim_x),
         dim_y(dim_y),
         dim_z(dim_z)
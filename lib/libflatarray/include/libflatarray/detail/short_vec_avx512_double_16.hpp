@@ -233,6 +233,62 @@ public:
             _mm512_sqrt_pd(val[ 1]));
     }
 
+    inline
+    short_vec<double, 16> fma(const short_vec<double, 16>& factor, const short_vec<double, 16>& summand) const
+    {
+        return short_vec<double, 16>(
+            _mm512_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm512_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 16> min(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            _mm512_min_pd(val[ 0], other.val[ 0]),
+            _mm512_min_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 16> max(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            _mm512_max_pd(val[ 0], other.val[ 0]),
+            _mm512_max_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 16> abs() const
+    {
+        return short_vec<double, 16>(
+            _mm512_abs_pd(val[ 0]),
+            _mm512_abs_pd(val[ 1]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_add_pd(buf, val[ 1]);
+        return _mm512_reduce_add_pd(buf);
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_min_pd(buf, val[ 1]);
+        return _mm512_reduce_min_pd(buf);
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_max_pd(buf, val[ 1]);
+        return _mm512_reduce_max_pd(buf);
+    }
+
     inline
     void load(const double *data)
     {
@@ -266,6 +266,76 @@ public:
             _mm512_sqrt_pd(val[ 3]));
     }
 
+    inline
+    short_vec<double, 32> fma(const short_vec<double, 32>& factor, const short_vec<double, 32>& summand) const
+    {
+        return short_vec<double, 32>(
+            _mm512_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm512_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            _mm512_fmadd_pd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            _mm512_fmadd_pd(val[ 3], factor.val[ 3], summand.val[ 3]));
+    }
+
+    inline
+    short_vec<double, 32> min(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm512_min_pd(val[ 0], other.val[ 0]),
+            _mm512_min_pd(val[ 1], other.val[ 1]),
+            _mm512_min_pd(val[ 2], other.val[ 2]),
+            _mm512_min_pd(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<double, 32> max(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm512_max_pd(val[ 0], other.val[ 0]),
+            _mm512_max_pd(val[ 1], other.val[ 1]),
+            _mm512_max_pd(val[ 2], other.val[ 2]),
+            _mm512_max_pd(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<double, 32> abs() const
+    {
+        return short_vec<double, 32>(
+            _mm512_abs_pd(val[ 0]),
+            _mm512_abs_pd(val[ 1]),
+            _mm512_abs_pd(val[ 2]),
+            _mm512_abs_pd(val[ 3]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_add_pd(buf, val[ 1]);
+        buf = _mm512_add_pd(buf, val[ 2]);
+        buf = _mm512_add_pd(buf, val[ 3]);
+        return _mm512_reduce_add_pd(buf);
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_min_pd(buf, val[ 1]);
+        buf = _mm512_min_pd(buf, val[ 2]);
+        buf = _mm512_min_pd(buf, val[ 3]);
+        return _mm512_reduce_min_pd(buf);
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m512d buf = val[ 0];
+        buf = _mm512_max_pd(buf, val[ 1]);
+        buf = _mm512_max_pd(buf, val[ 2]);
+        buf = _mm512_max_pd(buf, val[ 3]);
+        return _mm512_reduce_max_pd(buf);
+    }
+
     inline
     void load(const double *data)
     {
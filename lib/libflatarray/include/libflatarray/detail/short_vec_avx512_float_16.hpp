@@ -228,6 +228,52 @@ public:
             _mm512_sqrt_ps(val));
     }
 
+    inline
+    short_vec<float, 16> fma(const short_vec<float, 16>& factor, const short_vec<float, 16>& summand) const
+    {
+        return short_vec<float, 16>(
+            _mm512_fmadd_ps(val, factor.val, summand.val));
+    }
+
+    inline
+    short_vec<float, 16> min(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            _mm512_min_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 16> max(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            _mm512_max_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 16> abs() const
+    {
+        return short_vec<float, 16>(
+            _mm512_abs_ps(val));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        return _mm512_reduce_add_ps(val);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        return _mm512_reduce_min_ps(val);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        return _mm512_reduce_max_ps(val);
+    }
+
     inline
     void load(const float *data)
     {
@@ -333,6 +333,119 @@ public:
             _mm256_sqrt_pd(val[ 7]));
     }
 
+    inline
+    short_vec<double, 32> fma(const short_vec<double, 32>& factor, const short_vec<double, 32>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 32>(
+            _mm256_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm256_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            _mm256_fmadd_pd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            _mm256_fmadd_pd(val[ 3], factor.val[ 3], summand.val[ 3]),
+            _mm256_fmadd_pd(val[ 4], factor.val[ 4], summand.val[ 4]),
+            _mm256_fmadd_pd(val[ 5], factor.val[ 5], summand.val[ 5]),
+            _mm256_fmadd_pd(val[ 6], factor.val[ 6], summand.val[ 6]),
+            _mm256_fmadd_pd(val[ 7], factor.val[ 7], summand.val[ 7]));
+#else
+        return short_vec<double, 32>(
+            _mm256_add_pd(_mm256_mul_pd(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 1], factor.val[ 1]), summand.val[ 1]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 2], factor.val[ 2]), summand.val[ 2]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 3], factor.val[ 3]), summand.val[ 3]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 4], factor.val[ 4]), summand.val[ 4]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 5], factor.val[ 5]), summand.val[ 5]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 6], factor.val[ 6]), summand.val[ 6]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 7], factor.val[ 7]), summand.val[ 7]));
+#endif
+    }
+
+    inline
+    short_vec<double, 32> min(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm256_min_pd(val[ 0], other.val[ 0]),
+            _mm256_min_pd(val[ 1], other.val[ 1]),
+            _mm256_min_pd(val[ 2], other.val[ 2]),
+            _mm256_min_pd(val[ 3], other.val[ 3]),
+            _mm256_min_pd(val[ 4], other.val[ 4]),
+            _mm256_min_pd(val[ 5], other.val[ 5]),
+            _mm256_min_pd(val[ 6], other.val[ 6]),
+            _mm256_min_pd(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<double, 32> max(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm256_max_pd(val[ 0], other.val[ 0]),
+            _mm256_max_pd(val[ 1], other.val[ 1]),
+            _mm256_max_pd(val[ 2], other.val[ 2]),
+            _mm256_max_pd(val[ 3], other.val[ 3]),
+            _mm256_max_pd(val[ 4], other.val[ 4]),
+            _mm256_max_pd(val[ 5], other.val[ 5]),
+            _mm256_max_pd(val[ 6], other.val[ 6]),
+            _mm256_max_pd(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<double, 32> abs() const
+    {
+        return short_vec<double, 32>(
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 0]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 1]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 2]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 3]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 4]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 5]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 6]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 7]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_add_pd(buf, val[ 1]);
+        buf = _mm256_add_pd(buf, val[ 2]);
+        buf = _mm256_add_pd(buf, val[ 3]);
+        buf = _mm256_add_pd(buf, val[ 4]);
+        buf = _mm256_add_pd(buf, val[ 5]);
+        buf = _mm256_add_pd(buf, val[ 6]);
+        buf = _mm256_add_pd(buf, val[ 7]);
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_min_pd(buf, val[ 1]);
+        buf = _mm256_min_pd(buf, val[ 2]);
+        buf = _mm256_min_pd(buf, val[ 3]);
+        buf = _mm256_min_pd(buf, val[ 4]);
+        buf = _mm256_min_pd(buf, val[ 5]);
+        buf = _mm256_min_pd(buf, val[ 6]);
+        buf = _mm256_min_pd(buf, val[ 7]);
+        __m128d half = _mm_min_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_max_pd(buf, val[ 1]);
+        buf = _mm256_max_pd(buf, val[ 2]);
+        buf = _mm256_max_pd(buf, val[ 3]);
+        buf = _mm256_max_pd(buf, val[ 4]);
+        buf = _mm256_max_pd(buf, val[ 5]);
+        buf = _mm256_max_pd(buf, val[ 6]);
+        buf = _mm256_max_pd(buf, val[ 7]);
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -204,6 +204,60 @@ public:
             _mm256_sqrt_pd(val));
     }
 
+    inline
+    short_vec<double, 4> fma(const short_vec<double, 4>& factor, const short_vec<double, 4>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 4>(
+            _mm256_fmadd_pd(val, factor.val, summand.val));
+#else
+        return short_vec<double, 4>(
+            _mm256_add_pd(_mm256_mul_pd(val, factor.val), summand.val));
+#endif
+    }
+
+    inline
+    short_vec<double, 4> min(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            _mm256_min_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 4> max(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            _mm256_max_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 4> abs() const
+    {
+        return short_vec<double, 4>(
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(val), _mm256_extractf128_pd(val, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m128d half = _mm_min_pd(_mm256_castpd256_pd128(val), _mm256_extractf128_pd(val, 1));
+        return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(val), _mm256_extractf128_pd(val, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -225,6 +225,71 @@ public:
             _mm256_sqrt_pd(val[ 1]));
     }
 
+    inline
+    short_vec<double, 8> fma(const short_vec<double, 8>& factor, const short_vec<double, 8>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 8>(
+            _mm256_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm256_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]));
+#else
+        return short_vec<double, 8>(
+            _mm256_add_pd(_mm256_mul_pd(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm256_add_pd(_mm256_mul_pd(val[ 1], factor.val[ 1]), summand.val[ 1]));
+#endif
+    }
+
+    inline
+    short_vec<double, 8> min(const short_vec<double, 8>& other) const
+    {
+        return short_vec<double, 8>(
+            _mm256_min_pd(val[ 0], other.val[ 0]),
+            _mm256_min_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 8> max(const short_vec<double, 8>& other) const
+    {
+        return short_vec<double, 8>(
+            _mm256_max_pd(val[ 0], other.val[ 0]),
+            _mm256_max_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 8> abs() const
+    {
+        return short_vec<double, 8>(
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 0]),
+            _mm256_andnot_pd(_mm256_set1_pd(-0.0), val[ 1]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_add_pd(buf, val[ 1]);
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_min_pd(buf, val[ 1]);
+        __m128d half = _mm_min_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m256d buf = val[ 0];
+        buf = _mm256_max_pd(buf, val[ 1]);
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(buf), _mm256_extractf128_pd(buf, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
     inline
     void load(const double *data)
     {
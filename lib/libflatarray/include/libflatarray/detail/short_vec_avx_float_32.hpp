@@ -278,6 +278,93 @@ public:
             _mm256_sqrt_ps(val[ 3]));
     }
 
+    inline
+    short_vec<float, 32> fma(const short_vec<float, 32>& factor, const short_vec<float, 32>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<float, 32>(
+            _mm256_fmadd_ps(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm256_fmadd_ps(val[ 1], factor.val[ 1], summand.val[ 1]),
+            _mm256_fmadd_ps(val[ 2], factor.val[ 2], summand.val[ 2]),
+            _mm256_fmadd_ps(val[ 3], factor.val[ 3], summand.val[ 3]));
+#else
+        return short_vec<float, 32>(
+            _mm256_add_ps(_mm256_mul_ps(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm256_add_ps(_mm256_mul_ps(val[ 1], factor.val[ 1]), summand.val[ 1]),
+            _mm256_add_ps(_mm256_mul_ps(val[ 2], factor.val[ 2]), summand.val[ 2]),
+            _mm256_add_ps(_mm256_mul_ps(val[ 3], factor.val[ 3]), summand.val[ 3]));
+#endif
+    }
+
+    inline
+    short_vec<float, 32> min(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            _mm256_min_ps(val[ 0], other.val[ 0]),
+            _mm256_min_ps(val[ 1], other.val[ 1]),
+            _mm256_min_ps(val[ 2], other.val[ 2]),
+            _mm256_min_ps(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<float, 32> max(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            _mm256_max_ps(val[ 0], other.val[ 0]),
+            _mm256_max_ps(val[ 1], other.val[ 1]),
+            _mm256_max_ps(val[ 2], other.val[ 2]),
+            _mm256_max_ps(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<float, 32> abs() const
+    {
+        return short_vec<float, 32>(
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), val[ 0]),
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), val[ 1]),
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), val[ 2]),
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), val[ 3]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        __m256 buf = val[ 0];
+        buf = _mm256_add_ps(buf, val[ 1]);
+        buf = _mm256_add_ps(buf, val[ 2]);
+        buf = _mm256_add_ps(buf, val[ 3]);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(buf), _mm256_extractf128_ps(buf, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        __m256 buf = val[ 0];
+        buf = _mm256_min_ps(buf, val[ 1]);
+        buf = _mm256_min_ps(buf, val[ 2]);
+        buf = _mm256_min_ps(buf, val[ 3]);
+        __m128 half = _mm_min_ps(_mm256_castps256_ps128(buf), _mm256_extractf128_ps(buf, 1));
+        half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        __m256 buf = val[ 0];
+        buf = _mm256_max_ps(buf, val[ 1]);
+        buf = _mm256_max_ps(buf, val[ 2]);
+        buf = _mm256_max_ps(buf, val[ 3]);
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(buf), _mm256_extractf128_ps(buf, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
     inline
     void load(const float *data)
     {
@@ -217,6 +217,66 @@ public:
         return _mm256_sqrt_ps(val);
     }
 
+    inline
+    short_vec<float, 8> fma(const short_vec<float, 8>& factor, const short_vec<float, 8>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<float, 8>(
+            _mm256_fmadd_ps(val, factor.val, summand.val));
+#else
+        return short_vec<float, 8>(
+            _mm256_add_ps(_mm256_mul_ps(val, factor.val), summand.val));
+#endif
+    }
+
+    inline
+    short_vec<float, 8> min(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            _mm256_min_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 8> max(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            _mm256_max_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 8> abs() const
+    {
+        return short_vec<float, 8>(
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), val));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(val), _mm256_extractf128_ps(val, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        __m128 half = _mm_min_ps(_mm256_castps256_ps128(val), _mm256_extractf128_ps(val, 1));
+        half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(val), _mm256_extractf128_ps(val, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
     inline
     void load(const float *data)
     {
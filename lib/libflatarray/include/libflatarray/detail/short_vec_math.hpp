@@ -0,0 +1,449 @@
+/**
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef FLAT_ARRAY_DETAIL_SHORT_VEC_MATH_HPP
+#define FLAT_ARRAY_DETAIL_SHORT_VEC_MATH_HPP
+
+// disable certain warnings from system headers when compiling with
+// Microsoft Visual Studio:
+#ifdef _MSC_BUILD
+#pragma warning( push )
+#pragma warning( disable : 4514 )
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#ifdef _MSC_BUILD
+#pragma warning( pop )
+#endif
+
+/**
+ * exp(), log() and pow() for all floating point short_vec
+ * implementations. Implementations which support comparisons and
+ * blend() (i.e. which define a mask_type) get vectorized versions,
+ * built solely from short_vec arithmetic (polynomial evaluation via
+ * fma(), exponent handling via compares and blends), so they don't
+ * depend on the ISA. The MIC, QPX and multi-register NEON
+ * implementations lack masks; for them the functions store the
+ * vector, apply the C library function to each lane and load the
+ * result back. That's slow, but exact, and keeps code portable
+ * across all backends.
+ *
+ * Accuracy of the vectorized versions (relative error, measured
+ * against the C library for normal inputs):
+ *
+ * - exp(): below 2 ulp for double and float. Results which would be
+ *   subnormal are flushed to 0, exp(x) for x > log(max) is +inf.
+ *
+ * - log(): below 2 ulp for double and float, including subnormal
+ *   arguments. log(0) is -inf, log(x < 0) is NaN.
+ *
+ * - pow(base, exponent) = exp(exponent * log(base)): the error grows
+ *   with |exponent * log(base)|, roughly by that many ulp, so it's
+ *   only a few ulp for moderate arguments. Negative bases yield NaN
+ *   (even for integral exponents), pow(x, 0) is 1.
+ *
+ * Rounding to the nearest integer relies on IEEE semantics, so these
+ * functions must not be compiled with -ffast-math or similar flags
+ * which allow reassociation.
+ */
+namespace LibFlatArray {
+
+namespace detail {
+
+namespace short_vec_math {
+
+/**
+ * Precision dependent constants. Exponents are adjusted in steps of
+ * 2^(2^i) with i < EXPONENT_STEPS, which covers the full exponent
+ * range of the respective type.
+ */
+template<typename CARGO>
+class traits;
+
+template<>
+class traits<double>
+{
+public:
+    static const int EXPONENT_STEPS = 10;
+    // degree 13 Taylor polynomial, truncation error below 5e-18 for |r| <= log(2) / 2:
+    static const int EXP_TERMS = 14;
+    // truncation error of the atanh series is below 3e-17 for |s| <= 0.172:
+    static const int LOG_TERMS = 10;
+    static const int SUBNORMAL_EXPONENT = 54;
+
+    static double exp_coefficient(int i)
+    {
+        static const double coefficients[EXP_TERMS] = {
+            1.0,
+            1.0,
+            1.0 / 2.0,
+            1.0 / 6.0,
+            1.0 / 24.0,
+            1.0 / 120.0,
+            1.0 / 720.0,
+            1.0 / 5040.0,
+            1.0 / 40320.0,
+            1.0 / 362880.0,
+            1.0 / 3628800.0,
+            1.0 / 39916800.0,
+            1.0 / 479001600.0,
+            1.0 / 6227020800.0
+        };
+        return coefficients[i];
+    }
+
+    static double exp_max()
+    {
+        return 709.782712893384;
+    }
+
+    static double exp_min()
+    {
+        return -708.3964185322641;
+    }
+
+    // Cody-Waite split of log(2): ln2_hi has only few significant
+    // bits, so n * ln2_hi is exact for all relevant exponents n.
+    static double ln2_hi()
+    {
+        return 0.693145751953125;
+    }
+
+    static double ln2_lo()
+    {
+        return 1.42860682030941723212e-6;
+    }
+
+    // 1.5 * 2^52: adding and subtracting this rounds to the nearest integer
+    static double round_magic()
+    {
+        return 6755399441055744.0;
+    }
+
+    // 2^SUBNORMAL_EXPONENT
+    static double subnormal_scale()
+    {
+        return 18014398509481984.0;
+    }
+};
+
+template<>
+class traits<float>
+{
+public:
+    static const int EXPONENT_STEPS = 7;
+    // degree 7 Taylor polynomial, truncation error below 6e-9 for |r| <= log(2) / 2:
+    static const int EXP_TERMS = 8;
+    // truncation error of the atanh series is below 3e-9 for |s| <= 0.172:
+    static const int LOG_TERMS = 5;
+    static const int SUBNORMAL_EXPONENT = 24;
+
+    static float exp_coefficient(int i)
+    {
+        static const float coefficients[EXP_TERMS] = {
+            1.0f,
+            1.0f,
+            1.0f / 2.0f,
+            1.0f / 6.0f,
+            1.0f / 24.0f,
+            1.0f / 120.0f,
+            1.0f / 720.0f,
+            1.0f / 5040.0f
+        };
+        return coefficients[i];
+    }
+
+    static float exp_max()
+    {
+        return 88.72283f;
+    }
+
+    static float exp_min()
+    {
+        return -87.33654f;
+    }
+
+    static float ln2_hi()
+    {
+        return 0.693359375f;
+    }
+
+    static float ln2_lo()
+    {
+        return -2.12194440e-4f;
+    }
+
+    // 1.5 * 2^23
+    static float round_magic()
+    {
+        return 12582912.0f;
+    }
+
+    static float subnormal_scale()
+    {
+        return 16777216.0f;
+    }
+};
+
+/**
+ * Checks whether SHORT_VEC defines a mask_type, which implies
+ * support for comparisons and blend(), and thus selects the
+ * implementation below.
+ */
+template<typename SHORT_VEC>
+class has_mask_type
+{
+private:
+    template<typename T>
+    static char check(typename T::mask_type *);
+
+    template<typename T>
+    static long check(...);
+
+public:
+    static const bool value = (sizeof(check<SHORT_VEC>(0)) == sizeof(char));
+};
+
+/**
+ * Returns 2^(2^i).
+ */
+template<typename CARGO>
+inline CARGO exponent_step(int i)
+{
+    CARGO ret = 2;
+    for (int j = 0; j < i; ++j) {
+        ret *= ret;
+    }
+
+    return ret;
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> round_to_integer(const short_vec<CARGO, ARITY>& x)
+{
+    short_vec<CARGO, ARITY> magic(traits<CARGO>::round_magic());
+    return (x + magic) - magic;
+}
+
+/**
+ * Multiplies x by 2^n for integral n. The largest step is taken
+ * twice so that results close to the maximum (where n exceeds the
+ * maximum exponent while x < 1) can still be reached.
+ */
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> scale_by_power_of_two(
+    short_vec<CARGO, ARITY> x,
+    const short_vec<CARGO, ARITY>& n)
+{
+    typedef short_vec<CARGO, ARITY> ShortVec;
+    typedef typename ShortVec::mask_type Mask;
+    const int steps = traits<CARGO>::EXPONENT_STEPS;
+
+    ShortVec zero(CARGO(0));
+    Mask negative = n < zero;
+    ShortVec magnitude = n;
+    magnitude.blend(negative, zero - n);
+
+    for (int i = steps; i >= 0; --i) {
+        int step = (i < steps) ? i : (steps - 1);
+        CARGO up = exponent_step<CARGO>(step);
+        ShortVec factor(up);
+        factor.blend(negative, ShortVec(CARGO(1) / up));
+
+        ShortVec delta(CARGO(1 << step));
+        Mask mask = magnitude >= delta;
+        x.blend(mask, x * factor);
+        magnitude.blend(mask, magnitude - delta);
+    }
+
+    return x;
+}
+
+template<typename SHORT_VEC, bool HAS_MASK = has_mask_type<SHORT_VEC>::value>
+class implementation;
+
+/**
+ * Vectorized version, see above.
+ */
+template<typename CARGO, std::size_t ARITY>
+class implementation<short_vec<CARGO, ARITY>, true>
+{
+public:
+    typedef short_vec<CARGO, ARITY> ShortVec;
+
+    static inline ShortVec exp(const ShortVec& x)
+    {
+        typedef traits<CARGO> Traits;
+
+        // reduce the argument to x = n * log(2) + r with |r| <= log(2) / 2:
+        ShortVec n = round_to_integer(
+            x * ShortVec(CARGO(1.44269504088896340736)));
+        ShortVec r = x - n * ShortVec(Traits::ln2_hi());
+        r = r - n * ShortVec(Traits::ln2_lo());
+
+        ShortVec ret(Traits::exp_coefficient(Traits::EXP_TERMS - 1));
+        for (int i = Traits::EXP_TERMS - 2; i >= 0; --i) {
+            ret = fma(ret, r, ShortVec(Traits::exp_coefficient(i)));
+        }
+
+        ret = scale_by_power_of_two(ret, n);
+        ret.blend(x > ShortVec(Traits::exp_max()), ShortVec(std::numeric_limits<CARGO>::infinity()));
+        ret.blend(x < ShortVec(Traits::exp_min()), ShortVec(CARGO(0)));
+
+        return ret;
+    }
+
+    static inline ShortVec log(const ShortVec& x)
+    {
+        typedef typename ShortVec::mask_type Mask;
+        typedef traits<CARGO> Traits;
+
+        ShortVec zero(CARGO(0));
+        ShortVec one(CARGO(1));
+
+        // decompose x = m * 2^e, starting with subnormals which are
+        // beyond the range of the binary search below:
+        ShortVec m = x;
+        ShortVec e = zero;
+        Mask mask = m < ShortVec(std::numeric_limits<CARGO>::min());
+        m.blend(mask, m * ShortVec(Traits::subnormal_scale()));
+        e.blend(mask, ShortVec(CARGO(-Traits::SUBNORMAL_EXPONENT)));
+
+        for (int i = Traits::EXPONENT_STEPS - 1; i >= 0; --i) {
+            CARGO up = exponent_step<CARGO>(i);
+            CARGO down = CARGO(1) / up;
+            ShortVec delta(CARGO(1 << i));
+
+            mask = m >= ShortVec(up);
+            m.blend(mask, m * ShortVec(down));
+            e.blend(mask, e + delta);
+
+            mask = m < ShortVec(down);
+            m.blend(mask, m * ShortVec(up));
+            e.blend(mask, e - delta);
+        }
+
+        // m is now in [0.5, 2), centering it around 1 minimizes s below:
+        mask = m < ShortVec(CARGO(0.70710678118654752440));
+        m.blend(mask, m * ShortVec(CARGO(2)));
+        e.blend(mask, e - one);
+        mask = m >= ShortVec(CARGO(1.41421356237309504880));
+        m.blend(mask, m * ShortVec(CARGO(0.5)));
+        e.blend(mask, e + one);
+
+        // log(m) = 2 * atanh(s) = 2 * (s + s^3 / 3 + s^5 / 5 + ...).
+        // Some backends implement float division via an approximate
+        // reciprocal, hence the correction step for s:
+        ShortVec numerator = m - one;
+        ShortVec denominator = m + one;
+        ShortVec s = numerator / denominator;
+        s = s + (numerator - s * denominator) / denominator;
+        ShortVec s2 = s * s;
+        ShortVec sum(CARGO(1.0 / (2 * Traits::LOG_TERMS - 1)));
+        for (int i = Traits::LOG_TERMS - 2; i >= 0; --i) {
+            sum = fma(sum, s2, ShortVec(CARGO(1.0 / (2 * i + 1))));
+        }
+
+        ShortVec ret = ShortVec(CARGO(2)) * s * sum;
+        ret = e * ShortVec(Traits::ln2_hi()) + (ret + e * ShortVec(Traits::ln2_lo()));
+
+        ShortVec infinity(std::numeric_limits<CARGO>::infinity());
+        ret.blend(x == infinity, infinity);
+        ret.blend(x == zero, zero - infinity);
+        ret.blend(x < zero, ShortVec(std::numeric_limits<CARGO>::quiet_NaN()));
+
+        return ret;
+    }
+
+    static inline ShortVec pow(const ShortVec& base, const ShortVec& exponent)
+    {
+
+        ShortVec ret = exp(exponent * log(base));
+        ret.blend(exponent == ShortVec(CARGO(0)), ShortVec(CARGO(1)));
+
+        return ret;
+    }
+};
+
+/**
+ * Fallback for implementations without masks: applies the C
+ * library functions lane by lane.
+ */
+template<typename CARGO, std::size_t ARITY>
+class implementation<short_vec<CARGO, ARITY>, false>
+{
+public:
+    typedef short_vec<CARGO, ARITY> ShortVec;
+
+    static inline ShortVec exp(const ShortVec& x)
+    {
+        CARGO buf[ARITY];
+        x.store(buf);
+        for (std::size_t i = 0; i < ARITY; ++i) {
+            buf[i] = std::exp(buf[i]);
+        }
+
+        ShortVec ret;
+        ret.load(buf);
+        return ret;
+    }
+
+    static inline ShortVec log(const ShortVec& x)
+    {
+        CARGO buf[ARITY];
+        x.store(buf);
+        for (std::size_t i = 0; i < ARITY; ++i) {
+            buf[i] = std::log(buf[i]);
+        }
+
+        ShortVec ret;
+        ret.load(buf);
+        return ret;
+    }
+
+    static inline ShortVec pow(const ShortVec& base, const ShortVec& exponent)
+    {
+        CARGO buf1[ARITY];
+        CARGO buf2[ARITY];
+        base.store(buf1);
+        exponent.store(buf2);
+        for (std::size_t i = 0; i < ARITY; ++i) {
+            buf1[i] = std::pow(buf1[i], buf2[i]);
+        }
+
+        ShortVec ret;
+        ret.load(buf1);
+        return ret;
+    }
+};
+
+}
+
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> exp(const short_vec<CARGO, ARITY>& x)
+{
+    return detail::short_vec_math::implementation<short_vec<CARGO, ARITY> >::exp(x);
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> log(const short_vec<CARGO, ARITY>& x)
+{
+    return detail::short_vec_math::implementation<short_vec<CARGO, ARITY> >::log(x);
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> pow(const short_vec<CARGO, ARITY>& base, const short_vec<CARGO, ARITY>& exponent)
+{
+    return detail::short_vec_math::implementation<short_vec<CARGO, ARITY> >::pow(base, exponent);
+}
+
+}
+
+#endif
@@ -139,6 +139,52 @@ public:
             _mm512_sqrt_pd(val));
     }
 
+    inline
+    short_vec<double, 8> fma(const short_vec<double, 8>& factor, const short_vec<double, 8>& summand) const
+    {
+        return short_vec<double, 8>(
+            _mm512_fmadd_pd(val, factor.val, summand.val));
+    }
+
+    inline
+    short_vec<double, 8> min(const short_vec<double, 8>& other) const
+    {
+        return short_vec<double, 8>(
+            _mm512_gmin_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 8> max(const short_vec<double, 8>& other) const
+    {
+        return short_vec<double, 8>(
+            _mm512_gmax_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 8> abs() const
+    {
+        return short_vec<double, 8>(
+            _mm512_gmax_pd(val, _mm512_sub_pd(_mm512_setzero_pd(), val)));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        return _mm512_reduce_add_pd(val);
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        return _mm512_reduce_gmin_pd(val);
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        return _mm512_reduce_gmax_pd(val);
+    }
+
     inline
     void load(const double *data)
     {
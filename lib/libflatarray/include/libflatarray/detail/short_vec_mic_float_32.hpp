@@ -162,6 +162,62 @@ public:
             _mm512_sqrt_ps(val[ 1]));
     }
 
+    inline
+    short_vec<float, 32> fma(const short_vec<float, 32>& factor, const short_vec<float, 32>& summand) const
+    {
+        return short_vec<float, 32>(
+            _mm512_fmadd_ps(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm512_fmadd_ps(val[ 1], factor.val[ 1], summand.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 32> min(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            _mm512_gmin_ps(val[ 0], other.val[ 0]),
+            _mm512_gmin_ps(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 32> max(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            _mm512_gmax_ps(val[ 0], other.val[ 0]),
+            _mm512_gmax_ps(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 32> abs() const
+    {
+        return short_vec<float, 32>(
+            _mm512_gmax_ps(val[ 0], _mm512_sub_ps(_mm512_setzero_ps(), val[ 0])),
+            _mm512_gmax_ps(val[ 1], _mm512_sub_ps(_mm512_setzero_ps(), val[ 1])));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        __m512 buf = val[ 0];
+        buf = _mm512_add_ps(buf, val[ 1]);
+        return _mm512_reduce_add_ps(buf);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        __m512 buf = val[ 0];
+        buf = _mm512_gmin_ps(buf, val[ 1]);
+        return _mm512_reduce_gmin_ps(buf);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        __m512 buf = val[ 0];
+        buf = _mm512_gmax_ps(buf, val[ 1]);
+        return _mm512_reduce_gmax_ps(buf);
+    }
+
     inline
     void load(const float *data)
     {
@@ -268,6 +268,90 @@ public:
         return ret;
     }
 
+    inline
+    short_vec<float, 16> fma(const short_vec<float, 16>& factor, const short_vec<float, 16>& summand) const
+    {
+#ifdef __ARM_FEATURE_FMA
+        return short_vec<float, 16>(
+            vfmaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vfmaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]),
+            vfmaq_f32(summand.val[ 2], val[ 2], factor.val[ 2]),
+            vfmaq_f32(summand.val[ 3], val[ 3], factor.val[ 3]));
+#else
+        return short_vec<float, 16>(
+            vmlaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vmlaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]),
+            vmlaq_f32(summand.val[ 2], val[ 2], factor.val[ 2]),
+            vmlaq_f32(summand.val[ 3], val[ 3], factor.val[ 3]));
+#endif
+    }
+
+    inline
+    short_vec<float, 16> min(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            vminq_f32(val[ 0], other.val[ 0]),
+            vminq_f32(val[ 1], other.val[ 1]),
+            vminq_f32(val[ 2], other.val[ 2]),
+            vminq_f32(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<float, 16> max(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            vmaxq_f32(val[ 0], other.val[ 0]),
+            vmaxq_f32(val[ 1], other.val[ 1]),
+            vmaxq_f32(val[ 2], other.val[ 2]),
+            vmaxq_f32(val[ 3], other.val[ 3]));
+    }
+
+    inline
+    short_vec<float, 16> abs() const
+    {
+        return short_vec<float, 16>(
+            vabsq_f32(val[ 0]),
+            vabsq_f32(val[ 1]),
+            vabsq_f32(val[ 2]),
+            vabsq_f32(val[ 3]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vaddq_f32(buf, val[ 1]);
+        buf = vaddq_f32(buf, val[ 2]);
+        buf = vaddq_f32(buf, val[ 3]);
+        float32x2_t half = vadd_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpadd_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vminq_f32(buf, val[ 1]);
+        buf = vminq_f32(buf, val[ 2]);
+        buf = vminq_f32(buf, val[ 3]);
+        float32x2_t half = vmin_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmin_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vmaxq_f32(buf, val[ 1]);
+        buf = vmaxq_f32(buf, val[ 2]);
+        buf = vmaxq_f32(buf, val[ 3]);
+        float32x2_t half = vmax_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmax_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
     inline
     void load(const float *data)
     {
@@ -356,6 +356,122 @@ public:
         return ret;
     }
 
+    inline
+    short_vec<float, 32> fma(const short_vec<float, 32>& factor, const short_vec<float, 32>& summand) const
+    {
+#ifdef __ARM_FEATURE_FMA
+        return short_vec<float, 32>(
+            vfmaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vfmaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]),
+            vfmaq_f32(summand.val[ 2], val[ 2], factor.val[ 2]),
+            vfmaq_f32(summand.val[ 3], val[ 3], factor.val[ 3]),
+            vfmaq_f32(summand.val[ 4], val[ 4], factor.val[ 4]),
+            vfmaq_f32(summand.val[ 5], val[ 5], factor.val[ 5]),
+            vfmaq_f32(summand.val[ 6], val[ 6], factor.val[ 6]),
+            vfmaq_f32(summand.val[ 7], val[ 7], factor.val[ 7]));
+#else
+        return short_vec<float, 32>(
+            vmlaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vmlaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]),
+            vmlaq_f32(summand.val[ 2], val[ 2], factor.val[ 2]),
+            vmlaq_f32(summand.val[ 3], val[ 3], factor.val[ 3]),
+            vmlaq_f32(summand.val[ 4], val[ 4], factor.val[ 4]),
+            vmlaq_f32(summand.val[ 5], val[ 5], factor.val[ 5]),
+            vmlaq_f32(summand.val[ 6], val[ 6], factor.val[ 6]),
+            vmlaq_f32(summand.val[ 7], val[ 7], factor.val[ 7]));
+#endif
+    }
+
+    inline
+    short_vec<float, 32> min(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            vminq_f32(val[ 0], other.val[ 0]),
+            vminq_f32(val[ 1], other.val[ 1]),
+            vminq_f32(val[ 2], other.val[ 2]),
+            vminq_f32(val[ 3], other.val[ 3]),
+            vminq_f32(val[ 4], other.val[ 4]),
+            vminq_f32(val[ 5], other.val[ 5]),
+            vminq_f32(val[ 6], other.val[ 6]),
+            vminq_f32(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<float, 32> max(const short_vec<float, 32>& other) const
+    {
+        return short_vec<float, 32>(
+            vmaxq_f32(val[ 0], other.val[ 0]),
+            vmaxq_f32(val[ 1], other.val[ 1]),
+            vmaxq_f32(val[ 2], other.val[ 2]),
+            vmaxq_f32(val[ 3], other.val[ 3]),
+            vmaxq_f32(val[ 4], other.val[ 4]),
+            vmaxq_f32(val[ 5], other.val[ 5]),
+            vmaxq_f32(val[ 6], other.val[ 6]),
+            vmaxq_f32(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<float, 32> abs() const
+    {
+        return short_vec<float, 32>(
+            vabsq_f32(val[ 0]),
+            vabsq_f32(val[ 1]),
+            vabsq_f32(val[ 2]),
+            vabsq_f32(val[ 3]),
+            vabsq_f32(val[ 4]),
+            vabsq_f32(val[ 5]),
+            vabsq_f32(val[ 6]),
+            vabsq_f32(val[ 7]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vaddq_f32(buf, val[ 1]);
+        buf = vaddq_f32(buf, val[ 2]);
+        buf = vaddq_f32(buf, val[ 3]);
+        buf = vaddq_f32(buf, val[ 4]);
+        buf = vaddq_f32(buf, val[ 5]);
+        buf = vaddq_f32(buf, val[ 6]);
+        buf = vaddq_f32(buf, val[ 7]);
+        float32x2_t half = vadd_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpadd_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vminq_f32(buf, val[ 1]);
+        buf = vminq_f32(buf, val[ 2]);
+        buf = vminq_f32(buf, val[ 3]);
+        buf = vminq_f32(buf, val[ 4]);
+        buf = vminq_f32(buf, val[ 5]);
+        buf = vminq_f32(buf, val[ 6]);
+        buf = vminq_f32(buf, val[ 7]);
+        float32x2_t half = vmin_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmin_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vmaxq_f32(buf, val[ 1]);
+        buf = vmaxq_f32(buf, val[ 2]);
+        buf = vmaxq_f32(buf, val[ 3]);
+        buf = vmaxq_f32(buf, val[ 4]);
+        buf = vmaxq_f32(buf, val[ 5]);
+        buf = vmaxq_f32(buf, val[ 6]);
+        buf = vmaxq_f32(buf, val[ 7]);
+        float32x2_t half = vmax_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmax_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
     inline
     void load(const float *data)
     {
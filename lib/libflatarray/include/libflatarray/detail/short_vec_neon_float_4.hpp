@@ -220,6 +220,63 @@ public:
         return vmulq_f32(val, x1);
     }
 
+    inline
+    short_vec<float, 4> fma(const short_vec<float, 4>& factor, const short_vec<float, 4>& summand) const
+    {
+#ifdef __ARM_FEATURE_FMA
+        return short_vec<float, 4>(
+            vfmaq_f32(summand.val, val, factor.val));
+#else
+        return short_vec<float, 4>(
+            vmlaq_f32(summand.val, val, factor.val));
+#endif
+    }
+
+    inline
+    short_vec<float, 4> min(const short_vec<float, 4>& other) const
+    {
+        return short_vec<float, 4>(
+            vminq_f32(val, other.val));
+    }
+
+    inline
+    short_vec<float, 4> max(const short_vec<float, 4>& other) const
+    {
+        return short_vec<float, 4>(
+            vmaxq_f32(val, other.val));
+    }
+
+    inline
+    short_vec<float, 4> abs() const
+    {
+        return short_vec<float, 4>(
+            vabsq_f32(val));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        float32x2_t half = vadd_f32(vget_low_f32(val), vget_high_f32(val));
+        half = vpadd_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        float32x2_t half = vmin_f32(vget_low_f32(val), vget_high_f32(val));
+        half = vpmin_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        float32x2_t half = vmax_f32(vget_low_f32(val), vget_high_f32(val));
+        half = vpmax_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
     inline
     void load(const float *data)
     {
@@ -219,6 +219,74 @@ public:
         return ret;
     }
 
+    inline
+    short_vec<float, 8> fma(const short_vec<float, 8>& factor, const short_vec<float, 8>& summand) const
+    {
+#ifdef __ARM_FEATURE_FMA
+        return short_vec<float, 8>(
+            vfmaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vfmaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]));
+#else
+        return short_vec<float, 8>(
+            vmlaq_f32(summand.val[ 0], val[ 0], factor.val[ 0]),
+            vmlaq_f32(summand.val[ 1], val[ 1], factor.val[ 1]));
+#endif
+    }
+
+    inline
+    short_vec<float, 8> min(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            vminq_f32(val[ 0], other.val[ 0]),
+            vminq_f32(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 8> max(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            vmaxq_f32(val[ 0], other.val[ 0]),
+            vmaxq_f32(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 8> abs() const
+    {
+        return short_vec<float, 8>(
+            vabsq_f32(val[ 0]),
+            vabsq_f32(val[ 1]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vaddq_f32(buf, val[ 1]);
+        float32x2_t half = vadd_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpadd_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vminq_f32(buf, val[ 1]);
+        float32x2_t half = vmin_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmin_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        float32x4_t buf = val[ 0];
+        buf = vmaxq_f32(buf, val[ 1]);
+        float32x2_t half = vmax_f32(vget_low_f32(buf), vget_high_f32(buf));
+        half = vpmax_f32(half, half);
+        return vget_lane_f32(half, 0);
+    }
+
     inline
     void load(const float *data)
     {
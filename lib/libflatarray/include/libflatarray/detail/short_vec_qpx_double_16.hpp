@@ -21,6 +21,7 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -179,6 +180,76 @@ public:
             vec_swsqrt(val[ 3]));
     }
 
+    inline
+    short_vec<double, 16> fma(const short_vec<double, 16>& factor, const short_vec<double, 16>& summand) const
+    {
+        return short_vec<double, 16>(
+            vec_madd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            vec_madd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            vec_madd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            vec_madd(val[ 3], factor.val[ 3], summand.val[ 3]));
+    }
+
+    inline
+    short_vec<double, 16> min(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            vec_sel(val[ 0], other.val[ 0], vec_cmpgt(val[ 0], other.val[ 0])),
+            vec_sel(val[ 1], other.val[ 1], vec_cmpgt(val[ 1], other.val[ 1])),
+            vec_sel(val[ 2], other.val[ 2], vec_cmpgt(val[ 2], other.val[ 2])),
+            vec_sel(val[ 3], other.val[ 3], vec_cmpgt(val[ 3], other.val[ 3])));
+    }
+
+    inline
+    short_vec<double, 16> max(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            vec_sel(other.val[ 0], val[ 0], vec_cmpgt(val[ 0], other.val[ 0])),
+            vec_sel(other.val[ 1], val[ 1], vec_cmpgt(val[ 1], other.val[ 1])),
+            vec_sel(other.val[ 2], val[ 2], vec_cmpgt(val[ 2], other.val[ 2])),
+            vec_sel(other.val[ 3], val[ 3], vec_cmpgt(val[ 3], other.val[ 3])));
+    }
+
+    inline
+    short_vec<double, 16> abs() const
+    {
+        return short_vec<double, 16>(
+            vec_abs(val[ 0]),
+            vec_abs(val[ 1]),
+            vec_abs(val[ 2]),
+            vec_abs(val[ 3]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_add(buf, val[ 1]);
+        buf = vec_add(buf, val[ 2]);
+        buf = vec_add(buf, val[ 3]);
+        return (vec_extract(buf, 0) + vec_extract(buf, 1)) + (vec_extract(buf, 2) + vec_extract(buf, 3));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_sel(buf, val[ 1], vec_cmpgt(buf, val[ 1]));
+        buf = vec_sel(buf, val[ 2], vec_cmpgt(buf, val[ 2]));
+        buf = vec_sel(buf, val[ 3], vec_cmpgt(buf, val[ 3]));
+        return (std::min)((std::min)(vec_extract(buf, 0), vec_extract(buf, 1)), (std::min)(vec_extract(buf, 2), vec_extract(buf, 3)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_sel(val[ 1], buf, vec_cmpgt(buf, val[ 1]));
+        buf = vec_sel(val[ 2], buf, vec_cmpgt(buf, val[ 2]));
+        buf = vec_sel(val[ 3], buf, vec_cmpgt(buf, val[ 3]));
+        return (std::max)((std::max)(vec_extract(buf, 0), vec_extract(buf, 1)), (std::max)(vec_extract(buf, 2), vec_extract(buf, 3)));
+    }
+
     inline
     void load(const double *data)
     {
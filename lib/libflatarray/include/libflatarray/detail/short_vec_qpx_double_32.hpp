@@ -21,6 +21,7 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -227,6 +228,104 @@ public:
             vec_swsqrt(val[ 7]));
     }
 
+    inline
+    short_vec<double, 32> fma(const short_vec<double, 32>& factor, const short_vec<double, 32>& summand) const
+    {
+        return short_vec<double, 32>(
+            vec_madd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            vec_madd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            vec_madd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            vec_madd(val[ 3], factor.val[ 3], summand.val[ 3]),
+            vec_madd(val[ 4], factor.val[ 4], summand.val[ 4]),
+            vec_madd(val[ 5], factor.val[ 5], summand.val[ 5]),
+            vec_madd(val[ 6], factor.val[ 6], summand.val[ 6]),
+            vec_madd(val[ 7], factor.val[ 7], summand.val[ 7]));
+    }
+
+    inline
+    short_vec<double, 32> min(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            vec_sel(val[ 0], other.val[ 0], vec_cmpgt(val[ 0], other.val[ 0])),
+            vec_sel(val[ 1], other.val[ 1], vec_cmpgt(val[ 1], other.val[ 1])),
+            vec_sel(val[ 2], other.val[ 2], vec_cmpgt(val[ 2], other.val[ 2])),
+            vec_sel(val[ 3], other.val[ 3], vec_cmpgt(val[ 3], other.val[ 3])),
+            vec_sel(val[ 4], other.val[ 4], vec_cmpgt(val[ 4], other.val[ 4])),
+            vec_sel(val[ 5], other.val[ 5], vec_cmpgt(val[ 5], other.val[ 5])),
+            vec_sel(val[ 6], other.val[ 6], vec_cmpgt(val[ 6], other.val[ 6])),
+            vec_sel(val[ 7], other.val[ 7], vec_cmpgt(val[ 7], other.val[ 7])));
+    }
+
+    inline
+    short_vec<double, 32> max(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            vec_sel(other.val[ 0], val[ 0], vec_cmpgt(val[ 0], other.val[ 0])),
+            vec_sel(other.val[ 1], val[ 1], vec_cmpgt(val[ 1], other.val[ 1])),
+            vec_sel(other.val[ 2], val[ 2], vec_cmpgt(val[ 2], other.val[ 2])),
+            vec_sel(other.val[ 3], val[ 3], vec_cmpgt(val[ 3], other.val[ 3])),
+            vec_sel(other.val[ 4], val[ 4], vec_cmpgt(val[ 4], other.val[ 4])),
+            vec_sel(other.val[ 5], val[ 5], vec_cmpgt(val[ 5], other.val[ 5])),
+            vec_sel(other.val[ 6], val[ 6], vec_cmpgt(val[ 6], other.val[ 6])),
+            vec_sel(other.val[ 7], val[ 7], vec_cmpgt(val[ 7], other.val[ 7])));
+    }
+
+    inline
+    short_vec<double, 32> abs() const
+    {
+        return short_vec<double, 32>(
+            vec_abs(val[ 0]),
+            vec_abs(val[ 1]),
+            vec_abs(val[ 2]),
+            vec_abs(val[ 3]),
+            vec_abs(val[ 4]),
+            vec_abs(val[ 5]),
+            vec_abs(val[ 6]),
+            vec_abs(val[ 7]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_add(buf, val[ 1]);
+        buf = vec_add(buf, val[ 2]);
+        buf = vec_add(buf, val[ 3]);
+        buf = vec_add(buf, val[ 4]);
+        buf = vec_add(buf, val[ 5]);
+        buf = vec_add(buf, val[ 6]);
+        buf = vec_add(buf, val[ 7]);
+        return (vec_extract(buf, 0) + vec_extract(buf, 1)) + (vec_extract(buf, 2) + vec_extract(buf, 3));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_sel(buf, val[ 1], vec_cmpgt(buf, val[ 1]));
+        buf = vec_sel(buf, val[ 2], vec_cmpgt(buf, val[ 2]));
+        buf = vec_sel(buf, val[ 3], vec_cmpgt(buf, val[ 3]));
+        buf = vec_sel(buf, val[ 4], vec_cmpgt(buf, val[ 4]));
+        buf = vec_sel(buf, val[ 5], vec_cmpgt(buf, val[ 5]));
+        buf = vec_sel(buf, val[ 6], vec_cmpgt(buf, val[ 6]));
+        buf = vec_sel(buf, val[ 7], vec_cmpgt(buf, val[ 7]));
+        return (std::min)((std::min)(vec_extract(buf, 0), vec_extract(buf, 1)), (std::min)(vec_extract(buf, 2), vec_extract(buf, 3)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        vector4double buf = val[ 0];
+        buf = vec_sel(val[ 1], buf, vec_cmpgt(buf, val[ 1]));
+        buf = vec_sel(val[ 2], buf, vec_cmpgt(buf, val[ 2]));
+        buf = vec_sel(val[ 3], buf, vec_cmpgt(buf, val[ 3]));
+        buf = vec_sel(val[ 4], buf, vec_cmpgt(buf, val[ 4]));
+        buf = vec_sel(val[ 5], buf, vec_cmpgt(buf, val[ 5]));
+        buf = vec_sel(val[ 6], buf, vec_cmpgt(buf, val[ 6]));
+        buf = vec_sel(val[ 7], buf, vec_cmpgt(buf, val[ 7]));
+        return (std::max)((std::max)(vec_extract(buf, 0), vec_extract(buf, 1)), (std::max)(vec_extract(buf, 2), vec_extract(buf, 3)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -21,6 +21,7 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -141,6 +142,52 @@ public:
             vec_swsqrt(val));
     }
 
+    inline
+    short_vec<double, 4> fma(const short_vec<double, 4>& factor, const short_vec<double, 4>& summand) const
+    {
+        return short_vec<double, 4>(
+            vec_madd(val, factor.val, summand.val));
+    }
+
+    inline
+    short_vec<double, 4> min(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            vec_sel(val, other.val, vec_cmpgt(val, other.val)));
+    }
+
+    inline
+    short_vec<double, 4> max(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            vec_sel(other.val, val, vec_cmpgt(val, other.val)));
+    }
+
+    inline
+    short_vec<double, 4> abs() const
+    {
+        return short_vec<double, 4>(
+            vec_abs(val));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        return (vec_extract(val, 0) + vec_extract(val, 1)) + (vec_extract(val, 2) + vec_extract(val, 3));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        return (std::min)((std::min)(vec_extract(val, 0), vec_extract(val, 1)), (std::min)(vec_extract(val, 2), vec_extract(val, 3)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        return (std::max)((std::max)(vec_extract(val, 0), vec_extract(val, 1)), (std::max)(vec_extract(val, 2), vec_extract(val, 3)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -24,6 +24,8 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
+#include <cmath>
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -216,6 +218,68 @@ public:
             std::sqrt(val[ 1]));
     }
 
+    inline
+    short_vec<double, 2> fma(const short_vec<double, 2>& factor, const short_vec<double, 2>& summand) const
+    {
+        return short_vec<double, 2>(
+            val[ 0] * factor.val[ 0] + summand.val[ 0],
+            val[ 1] * factor.val[ 1] + summand.val[ 1]);
+    }
+
+    inline
+    short_vec<double, 2> min(const short_vec<double, 2>& other) const
+    {
+        return short_vec<double, 2>(
+            (std::min)(val[ 0], other.val[ 0]),
+            (std::min)(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 2> max(const short_vec<double, 2>& other) const
+    {
+        return short_vec<double, 2>(
+            (std::max)(val[ 0], other.val[ 0]),
+            (std::max)(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 2> abs() const
+    {
+        return short_vec<double, 2>(
+            std::abs(val[ 0]),
+            std::abs(val[ 1]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        double ret = val[ 0];
+        for (int i = 1; i < 2; ++i) {
+            ret += val[i];
+        }
+        return ret;
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        double ret = val[ 0];
+        for (int i = 1; i < 2; ++i) {
+            ret = (std::min)(ret, val[i]);
+        }
+        return ret;
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        double ret = val[ 0];
+        for (int i = 1; i < 2; ++i) {
+            ret = (std::max)(ret, val[i]);
+        }
+        return ret;
+    }
+
     inline
     void load(const double *data)
     {
@@ -16,6 +16,7 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
 #include <cmath>
 
 #ifdef _MSC_BUILD
@@ -182,6 +183,52 @@ public:
         return short_vec<float, 1>(std::sqrt(val));
     }
 
+    inline
+    short_vec<float, 1> fma(const short_vec<float, 1>& factor, const short_vec<float, 1>& summand) const
+    {
+        return short_vec<float, 1>(
+            val * factor.val + summand.val);
+    }
+
+    inline
+    short_vec<float, 1> min(const short_vec<float, 1>& other) const
+    {
+        return short_vec<float, 1>(
+            (std::min)(val, other.val));
+    }
+
+    inline
+    short_vec<float, 1> max(const short_vec<float, 1>& other) const
+    {
+        return short_vec<float, 1>(
+            (std::max)(val, other.val));
+    }
+
+    inline
+    short_vec<float, 1> abs() const
+    {
+        return short_vec<float, 1>(
+            std::abs(val));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        return val;
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        return val;
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        return val;
+    }
+
     inline
     void load(const float *data)
     {
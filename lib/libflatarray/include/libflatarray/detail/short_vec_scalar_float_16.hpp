@@ -21,6 +21,8 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
+#include <cmath>
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -465,6 +467,124 @@ public:
             std::sqrt(val[15]));
     }
 
+    inline
+    short_vec<float, 16> fma(const short_vec<float, 16>& factor, const short_vec<float, 16>& summand) const
+    {
+        return short_vec<float, 16>(
+            val[ 0] * factor.val[ 0] + summand.val[ 0],
+            val[ 1] * factor.val[ 1] + summand.val[ 1],
+            val[ 2] * factor.val[ 2] + summand.val[ 2],
+            val[ 3] * factor.val[ 3] + summand.val[ 3],
+            val[ 4] * factor.val[ 4] + summand.val[ 4],
+            val[ 5] * factor.val[ 5] + summand.val[ 5],
+            val[ 6] * factor.val[ 6] + summand.val[ 6],
+            val[ 7] * factor.val[ 7] + summand.val[ 7],
+            val[ 8] * factor.val[ 8] + summand.val[ 8],
+            val[ 9] * factor.val[ 9] + summand.val[ 9],
+            val[10] * factor.val[10] + summand.val[10],
+            val[11] * factor.val[11] + summand.val[11],
+            val[12] * factor.val[12] + summand.val[12],
+            val[13] * factor.val[13] + summand.val[13],
+            val[14] * factor.val[14] + summand.val[14],
+            val[15] * factor.val[15] + summand.val[15]);
+    }
+
+    inline
+    short_vec<float, 16> min(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            (std::min)(val[ 0], other.val[ 0]),
+            (std::min)(val[ 1], other.val[ 1]),
+            (std::min)(val[ 2], other.val[ 2]),
+            (std::min)(val[ 3], other.val[ 3]),
+            (std::min)(val[ 4], other.val[ 4]),
+            (std::min)(val[ 5], other.val[ 5]),
+            (std::min)(val[ 6], other.val[ 6]),
+            (std::min)(val[ 7], other.val[ 7]),
+            (std::min)(val[ 8], other.val[ 8]),
+            (std::min)(val[ 9], other.val[ 9]),
+            (std::min)(val[10], other.val[10]),
+            (std::min)(val[11], other.val[11]),
+            (std::min)(val[12], other.val[12]),
+            (std::min)(val[13], other.val[13]),
+            (std::min)(val[14], other.val[14]),
+            (std::min)(val[15], other.val[15]));
+    }
+
+    inline
+    short_vec<float, 16> max(const short_vec<float, 16>& other) const
+    {
+        return short_vec<float, 16>(
+            (std::max)(val[ 0], other.val[ 0]),
+            (std::max)(val[ 1], other.val[ 1]),
+            (std::max)(val[ 2], other.val[ 2]),
+            (std::max)(val[ 3], other.val[ 3]),
+            (std::max)(val[ 4], other.val[ 4]),
+            (std::max)(val[ 5], other.val[ 5]),
+            (std::max)(val[ 6], other.val[ 6]),
+            (std::max)(val[ 7], other.val[ 7]),
+            (std::max)(val[ 8], other.val[ 8]),
+            (std::max)(val[ 9], other.val[ 9]),
+            (std::max)(val[10], other.val[10]),
+            (std::max)(val[11], other.val[11]),
+            (std::max)(val[12], other.val[12]),
+            (std::max)(val[13], other.val[13]),
+            (std::max)(val[14], other.val[14]),
+            (std::max)(val[15], other.val[15]));
+    }
+
+    inline
+    short_vec<float, 16> abs() const
+    {
+        return short_vec<float, 16>(
+            std::abs(val[ 0]),
+            std::abs(val[ 1]),
+            std::abs(val[ 2]),
+            std::abs(val[ 3]),
+            std::abs(val[ 4]),
+            std::abs(val[ 5]),
+            std::abs(val[ 6]),
+            std::abs(val[ 7]),
+            std::abs(val[ 8]),
+            std::abs(val[ 9]),
+            std::abs(val[10]),
+            std::abs(val[11]),
+            std::abs(val[12]),
+            std::abs(val[13]),
+            std::abs(val[14]),
+            std::abs(val[15]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        float ret = val[ 0];
+        for (int i = 1; i < 16; ++i) {
+            ret += val[i];
+        }
+        return ret;
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        float ret = val[ 0];
+        for (int i = 1; i < 16; ++i) {
+            ret = (std::min)(ret, val[i]);
+        }
+        return ret;
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        float ret = val[ 0];
+        for (int i = 1; i < 16; ++i) {
+            ret = (std::max)(ret, val[i]);
+        }
+        return ret;
+    }
+
     inline
     void load(const float *data)
     {
@@ -21,6 +21,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -334,6 +337,116 @@ public:
             _mm_sqrt_pd(val[ 7]));
     }
 
+    inline
+    short_vec<double, 16> fma(const short_vec<double, 16>& factor, const short_vec<double, 16>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 16>(
+            _mm_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            _mm_fmadd_pd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            _mm_fmadd_pd(val[ 3], factor.val[ 3], summand.val[ 3]),
+            _mm_fmadd_pd(val[ 4], factor.val[ 4], summand.val[ 4]),
+            _mm_fmadd_pd(val[ 5], factor.val[ 5], summand.val[ 5]),
+            _mm_fmadd_pd(val[ 6], factor.val[ 6], summand.val[ 6]),
+            _mm_fmadd_pd(val[ 7], factor.val[ 7], summand.val[ 7]));
+#else
+        return short_vec<double, 16>(
+            _mm_add_pd(_mm_mul_pd(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm_add_pd(_mm_mul_pd(val[ 1], factor.val[ 1]), summand.val[ 1]),
+            _mm_add_pd(_mm_mul_pd(val[ 2], factor.val[ 2]), summand.val[ 2]),
+            _mm_add_pd(_mm_mul_pd(val[ 3], factor.val[ 3]), summand.val[ 3]),
+            _mm_add_pd(_mm_mul_pd(val[ 4], factor.val[ 4]), summand.val[ 4]),
+            _mm_add_pd(_mm_mul_pd(val[ 5], factor.val[ 5]), summand.val[ 5]),
+            _mm_add_pd(_mm_mul_pd(val[ 6], factor.val[ 6]), summand.val[ 6]),
+            _mm_add_pd(_mm_mul_pd(val[ 7], factor.val[ 7]), summand.val[ 7]));
+#endif
+    }
+
+    inline
+    short_vec<double, 16> min(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            _mm_min_pd(val[ 0], other.val[ 0]),
+            _mm_min_pd(val[ 1], other.val[ 1]),
+            _mm_min_pd(val[ 2], other.val[ 2]),
+            _mm_min_pd(val[ 3], other.val[ 3]),
+            _mm_min_pd(val[ 4], other.val[ 4]),
+            _mm_min_pd(val[ 5], other.val[ 5]),
+            _mm_min_pd(val[ 6], other.val[ 6]),
+            _mm_min_pd(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<double, 16> max(const short_vec<double, 16>& other) const
+    {
+        return short_vec<double, 16>(
+            _mm_max_pd(val[ 0], other.val[ 0]),
+            _mm_max_pd(val[ 1], other.val[ 1]),
+            _mm_max_pd(val[ 2], other.val[ 2]),
+            _mm_max_pd(val[ 3], other.val[ 3]),
+            _mm_max_pd(val[ 4], other.val[ 4]),
+            _mm_max_pd(val[ 5], other.val[ 5]),
+            _mm_max_pd(val[ 6], other.val[ 6]),
+            _mm_max_pd(val[ 7], other.val[ 7]));
+    }
+
+    inline
+    short_vec<double, 16> abs() const
+    {
+        return short_vec<double, 16>(
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 0]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 1]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 2]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 3]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 4]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 5]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 6]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 7]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_add_pd(buf, val[ 1]);
+        buf = _mm_add_pd(buf, val[ 2]);
+        buf = _mm_add_pd(buf, val[ 3]);
+        buf = _mm_add_pd(buf, val[ 4]);
+        buf = _mm_add_pd(buf, val[ 5]);
+        buf = _mm_add_pd(buf, val[ 6]);
+        buf = _mm_add_pd(buf, val[ 7]);
+        return _mm_cvtsd_f64(_mm_add_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_min_pd(buf, val[ 1]);
+        buf = _mm_min_pd(buf, val[ 2]);
+        buf = _mm_min_pd(buf, val[ 3]);
+        buf = _mm_min_pd(buf, val[ 4]);
+        buf = _mm_min_pd(buf, val[ 5]);
+        buf = _mm_min_pd(buf, val[ 6]);
+        buf = _mm_min_pd(buf, val[ 7]);
+        return _mm_cvtsd_f64(_mm_min_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_max_pd(buf, val[ 1]);
+        buf = _mm_max_pd(buf, val[ 2]);
+        buf = _mm_max_pd(buf, val[ 3]);
+        buf = _mm_max_pd(buf, val[ 4]);
+        buf = _mm_max_pd(buf, val[ 5]);
+        buf = _mm_max_pd(buf, val[ 6]);
+        buf = _mm_max_pd(buf, val[ 7]);
+        return _mm_cvtsd_f64(_mm_max_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -28,6 +28,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -203,6 +206,57 @@ public:
             _mm_sqrt_pd(val));
     }
 
+    inline
+    short_vec<double, 2> fma(const short_vec<double, 2>& factor, const short_vec<double, 2>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 2>(
+            _mm_fmadd_pd(val, factor.val, summand.val));
+#else
+        return short_vec<double, 2>(
+            _mm_add_pd(_mm_mul_pd(val, factor.val), summand.val));
+#endif
+    }
+
+    inline
+    short_vec<double, 2> min(const short_vec<double, 2>& other) const
+    {
+        return short_vec<double, 2>(
+            _mm_min_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 2> max(const short_vec<double, 2>& other) const
+    {
+        return short_vec<double, 2>(
+            _mm_max_pd(val, other.val));
+    }
+
+    inline
+    short_vec<double, 2> abs() const
+    {
+        return short_vec<double, 2>(
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        return _mm_cvtsd_f64(_mm_add_sd(val, _mm_unpackhi_pd(val, val)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        return _mm_cvtsd_f64(_mm_min_sd(val, _mm_unpackhi_pd(val, val)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        return _mm_cvtsd_f64(_mm_max_sd(val, _mm_unpackhi_pd(val, val)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -21,6 +21,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
@@ -479,6 +482,180 @@ public:
             _mm_sqrt_pd(val[15]));
     }
 
+    inline
+    short_vec<double, 32> fma(const short_vec<double, 32>& factor, const short_vec<double, 32>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 32>(
+            _mm_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]),
+            _mm_fmadd_pd(val[ 2], factor.val[ 2], summand.val[ 2]),
+            _mm_fmadd_pd(val[ 3], factor.val[ 3], summand.val[ 3]),
+            _mm_fmadd_pd(val[ 4], factor.val[ 4], summand.val[ 4]),
+            _mm_fmadd_pd(val[ 5], factor.val[ 5], summand.val[ 5]),
+            _mm_fmadd_pd(val[ 6], factor.val[ 6], summand.val[ 6]),
+            _mm_fmadd_pd(val[ 7], factor.val[ 7], summand.val[ 7]),
+            _mm_fmadd_pd(val[ 8], factor.val[ 8], summand.val[ 8]),
+            _mm_fmadd_pd(val[ 9], factor.val[ 9], summand.val[ 9]),
+            _mm_fmadd_pd(val[10], factor.val[10], summand.val[10]),
+            _mm_fmadd_pd(val[11], factor.val[11], summand.val[11]),
+            _mm_fmadd_pd(val[12], factor.val[12], summand.val[12]),
+            _mm_fmadd_pd(val[13], factor.val[13], summand.val[13]),
+            _mm_fmadd_pd(val[14], factor.val[14], summand.val[14]),
+            _mm_fmadd_pd(val[15], factor.val[15], summand.val[15]));
+#else
+        return short_vec<double, 32>(
+            _mm_add_pd(_mm_mul_pd(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm_add_pd(_mm_mul_pd(val[ 1], factor.val[ 1]), summand.val[ 1]),
+            _mm_add_pd(_mm_mul_pd(val[ 2], factor.val[ 2]), summand.val[ 2]),
+            _mm_add_pd(_mm_mul_pd(val[ 3], factor.val[ 3]), summand.val[ 3]),
+            _mm_add_pd(_mm_mul_pd(val[ 4], factor.val[ 4]), summand.val[ 4]),
+            _mm_add_pd(_mm_mul_pd(val[ 5], factor.val[ 5]), summand.val[ 5]),
+            _mm_add_pd(_mm_mul_pd(val[ 6], factor.val[ 6]), summand.val[ 6]),
+            _mm_add_pd(_mm_mul_pd(val[ 7], factor.val[ 7]), summand.val[ 7]),
+            _mm_add_pd(_mm_mul_pd(val[ 8], factor.val[ 8]), summand.val[ 8]),
+            _mm_add_pd(_mm_mul_pd(val[ 9], factor.val[ 9]), summand.val[ 9]),
+            _mm_add_pd(_mm_mul_pd(val[10], factor.val[10]), summand.val[10]),
+            _mm_add_pd(_mm_mul_pd(val[11], factor.val[11]), summand.val[11]),
+            _mm_add_pd(_mm_mul_pd(val[12], factor.val[12]), summand.val[12]),
+            _mm_add_pd(_mm_mul_pd(val[13], factor.val[13]), summand.val[13]),
+            _mm_add_pd(_mm_mul_pd(val[14], factor.val[14]), summand.val[14]),
+            _mm_add_pd(_mm_mul_pd(val[15], factor.val[15]), summand.val[15]));
+#endif
+    }
+
+    inline
+    short_vec<double, 32> min(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm_min_pd(val[ 0], other.val[ 0]),
+            _mm_min_pd(val[ 1], other.val[ 1]),
+            _mm_min_pd(val[ 2], other.val[ 2]),
+            _mm_min_pd(val[ 3], other.val[ 3]),
+            _mm_min_pd(val[ 4], other.val[ 4]),
+            _mm_min_pd(val[ 5], other.val[ 5]),
+            _mm_min_pd(val[ 6], other.val[ 6]),
+            _mm_min_pd(val[ 7], other.val[ 7]),
+            _mm_min_pd(val[ 8], other.val[ 8]),
+            _mm_min_pd(val[ 9], other.val[ 9]),
+            _mm_min_pd(val[10], other.val[10]),
+            _mm_min_pd(val[11], other.val[11]),
+            _mm_min_pd(val[12], other.val[12]),
+            _mm_min_pd(val[13], other.val[13]),
+            _mm_min_pd(val[14], other.val[14]),
+            _mm_min_pd(val[15], other.val[15]));
+    }
+
+    inline
+    short_vec<double, 32> max(const short_vec<double, 32>& other) const
+    {
+        return short_vec<double, 32>(
+            _mm_max_pd(val[ 0], other.val[ 0]),
+            _mm_max_pd(val[ 1], other.val[ 1]),
+            _mm_max_pd(val[ 2], other.val[ 2]),
+            _mm_max_pd(val[ 3], other.val[ 3]),
+            _mm_max_pd(val[ 4], other.val[ 4]),
+            _mm_max_pd(val[ 5], other.val[ 5]),
+            _mm_max_pd(val[ 6], other.val[ 6]),
+            _mm_max_pd(val[ 7], other.val[ 7]),
+            _mm_max_pd(val[ 8], other.val[ 8]),
+            _mm_max_pd(val[ 9], other.val[ 9]),
+            _mm_max_pd(val[10], other.val[10]),
+            _mm_max_pd(val[11], other.val[11]),
+            _mm_max_pd(val[12], other.val[12]),
+            _mm_max_pd(val[13], other.val[13]),
+            _mm_max_pd(val[14], other.val[14]),
+            _mm_max_pd(val[15], other.val[15]));
+    }
+
+    inline
+    short_vec<double, 32> abs() const
+    {
+        return short_vec<double, 32>(
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 0]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 1]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 2]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 3]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 4]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 5]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 6]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 7]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 8]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 9]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[10]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[11]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[12]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[13]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[14]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[15]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_add_pd(buf, val[ 1]);
+        buf = _mm_add_pd(buf, val[ 2]);
+        buf = _mm_add_pd(buf, val[ 3]);
+        buf = _mm_add_pd(buf, val[ 4]);
+        buf = _mm_add_pd(buf, val[ 5]);
+        buf = _mm_add_pd(buf, val[ 6]);
+        buf = _mm_add_pd(buf, val[ 7]);
+        buf = _mm_add_pd(buf, val[ 8]);
+        buf = _mm_add_pd(buf, val[ 9]);
+        buf = _mm_add_pd(buf, val[10]);
+        buf = _mm_add_pd(buf, val[11]);
+        buf = _mm_add_pd(buf, val[12]);
+        buf = _mm_add_pd(buf, val[13]);
+        buf = _mm_add_pd(buf, val[14]);
+        buf = _mm_add_pd(buf, val[15]);
+        return _mm_cvtsd_f64(_mm_add_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_min_pd(buf, val[ 1]);
+        buf = _mm_min_pd(buf, val[ 2]);
+        buf = _mm_min_pd(buf, val[ 3]);
+        buf = _mm_min_pd(buf, val[ 4]);
+        buf = _mm_min_pd(buf, val[ 5]);
+        buf = _mm_min_pd(buf, val[ 6]);
+        buf = _mm_min_pd(buf, val[ 7]);
+        buf = _mm_min_pd(buf, val[ 8]);
+        buf = _mm_min_pd(buf, val[ 9]);
+        buf = _mm_min_pd(buf, val[10]);
+        buf = _mm_min_pd(buf, val[11]);
+        buf = _mm_min_pd(buf, val[12]);
+        buf = _mm_min_pd(buf, val[13]);
+        buf = _mm_min_pd(buf, val[14]);
+        buf = _mm_min_pd(buf, val[15]);
+        return _mm_cvtsd_f64(_mm_min_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_max_pd(buf, val[ 1]);
+        buf = _mm_max_pd(buf, val[ 2]);
+        buf = _mm_max_pd(buf, val[ 3]);
+        buf = _mm_max_pd(buf, val[ 4]);
+        buf = _mm_max_pd(buf, val[ 5]);
+        buf = _mm_max_pd(buf, val[ 6]);
+        buf = _mm_max_pd(buf, val[ 7]);
+        buf = _mm_max_pd(buf, val[ 8]);
+        buf = _mm_max_pd(buf, val[ 9]);
+        buf = _mm_max_pd(buf, val[10]);
+        buf = _mm_max_pd(buf, val[11]);
+        buf = _mm_max_pd(buf, val[12]);
+        buf = _mm_max_pd(buf, val[13]);
+        buf = _mm_max_pd(buf, val[14]);
+        buf = _mm_max_pd(buf, val[15]);
+        return _mm_cvtsd_f64(_mm_max_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
     inline
     void load(const double *data)
     {
@@ -26,6 +26,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 #ifdef LIBFLATARRAY_WITH_CPP14
 #include <initializer_list>
 #endif
@@ -222,6 +225,68 @@ public:
             _mm_sqrt_pd(val[ 1]));
     }
 
+    inline
+    short_vec<double, 4> fma(const short_vec<double, 4>& factor, const short_vec<double, 4>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<double, 4>(
+            _mm_fmadd_pd(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm_fmadd_pd(val[ 1], factor.val[ 1], summand.val[ 1]));
+#else
+        return short_vec<double, 4>(
+            _mm_add_pd(_mm_mul_pd(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm_add_pd(_mm_mul_pd(val[ 1], factor.val[ 1]), summand.val[ 1]));
+#endif
+    }
+
+    inline
+    short_vec<double, 4> min(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            _mm_min_pd(val[ 0], other.val[ 0]),
+            _mm_min_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 4> max(const short_vec<double, 4>& other) const
+    {
+        return short_vec<double, 4>(
+            _mm_max_pd(val[ 0], other.val[ 0]),
+            _mm_max_pd(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<double, 4> abs() const
+    {
+        return short_vec<double, 4>(
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 0]),
+            _mm_andnot_pd(_mm_set1_pd(-0.0), val[ 1]));
+    }
+
+    inline
+    double horizontal_sum() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_add_pd(buf, val[ 1]);
+        return _mm_cvtsd_f64(_mm_add_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_min() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_min_pd(buf, val[ 1]);
+        return _mm_cvtsd_f64(_mm_min_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
+    inline
+    double horizontal_max() const
+    {
+        __m128d buf = val[ 0];
+        buf = _mm_max_pd(buf, val[ 1]);
+        return _mm_cvtsd_f64(_mm_max_sd(buf, _mm_unpackhi_pd(buf, buf)));
+    }
+
     inline
     void load(const double *data)
     {
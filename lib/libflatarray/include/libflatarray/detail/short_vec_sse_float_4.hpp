@@ -29,6 +29,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 #ifdef __SSE4_1__
 #include <smmintrin.h>
 #endif
@@ -227,6 +230,63 @@ public:
             _mm_sqrt_ps(val));
     }
 
+    inline
+    short_vec<float, 4> fma(const short_vec<float, 4>& factor, const short_vec<float, 4>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<float, 4>(
+            _mm_fmadd_ps(val, factor.val, summand.val));
+#else
+        return short_vec<float, 4>(
+            _mm_add_ps(_mm_mul_ps(val, factor.val), summand.val));
+#endif
+    }
+
+    inline
+    short_vec<float, 4> min(const short_vec<float, 4>& other) const
+    {
+        return short_vec<float, 4>(
+            _mm_min_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 4> max(const short_vec<float, 4>& other) const
+    {
+        return short_vec<float, 4>(
+            _mm_max_ps(val, other.val));
+    }
+
+    inline
+    short_vec<float, 4> abs() const
+    {
+        return short_vec<float, 4>(
+            _mm_andnot_ps(_mm_set1_ps(-0.0f), val));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        __m128 half = _mm_add_ps(val, _mm_movehl_ps(val, val));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        __m128 half = _mm_min_ps(val, _mm_movehl_ps(val, val));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        __m128 half = _mm_max_ps(val, _mm_movehl_ps(val, val));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
     inline
     void load(const float *data)
     {
@@ -26,6 +26,9 @@
 #endif
 
 #include <emmintrin.h>
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
 #ifdef __SSE4_1__
 #include <smmintrin.h>
 #endif
@@ -245,6 +248,74 @@ public:
             _mm_sqrt_ps(val[ 1]));
     }
 
+    inline
+    short_vec<float, 8> fma(const short_vec<float, 8>& factor, const short_vec<float, 8>& summand) const
+    {
+#ifdef __FMA__
+        return short_vec<float, 8>(
+            _mm_fmadd_ps(val[ 0], factor.val[ 0], summand.val[ 0]),
+            _mm_fmadd_ps(val[ 1], factor.val[ 1], summand.val[ 1]));
+#else
+        return short_vec<float, 8>(
+            _mm_add_ps(_mm_mul_ps(val[ 0], factor.val[ 0]), summand.val[ 0]),
+            _mm_add_ps(_mm_mul_ps(val[ 1], factor.val[ 1]), summand.val[ 1]));
+#endif
+    }
+
+    inline
+    short_vec<float, 8> min(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            _mm_min_ps(val[ 0], other.val[ 0]),
+            _mm_min_ps(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 8> max(const short_vec<float, 8>& other) const
+    {
+        return short_vec<float, 8>(
+            _mm_max_ps(val[ 0], other.val[ 0]),
+            _mm_max_ps(val[ 1], other.val[ 1]));
+    }
+
+    inline
+    short_vec<float, 8> abs() const
+    {
+        return short_vec<float, 8>(
+            _mm_andnot_ps(_mm_set1_ps(-0.0f), val[ 0]),
+            _mm_andnot_ps(_mm_set1_ps(-0.0f), val[ 1]));
+    }
+
+    inline
+    float horizontal_sum() const
+    {
+        __m128 buf = val[ 0];
+        buf = _mm_add_ps(buf, val[ 1]);
+        __m128 half = _mm_add_ps(buf, _mm_movehl_ps(buf, buf));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_min() const
+    {
+        __m128 buf = val[ 0];
+        buf = _mm_min_ps(buf, val[ 1]);
+        __m128 half = _mm_min_ps(buf, _mm_movehl_ps(buf, buf));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    inline
+    float horizontal_max() const
+    {
+        __m128 buf = val[ 0];
+        buf = _mm_max_ps(buf, val[ 1]);
+        __m128 half = _mm_max_ps(buf, _mm_movehl_ps(buf, buf));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
     inline
     void load(const float *data)
     {
@@ -112,8 +112,59 @@ SHORT_VEC1 blend(const SHORT_VEC1& v1, const SHORT_VEC2& v2, const typename SHOR
     return ret;
 }
 
-// fixme: this is slow
-// fixme: replace by horizontal sum, get rid of get() alltoggether
+/**
+ * Returns a * b + c. Whether this is fused (i.e. rounded just once)
+ * depends on the implementation: AVX512, MIC and QPX always use
+ * fused multiply-add instructions, SSE and AVX do so if FMA3 is
+ * available (__FMA__), NEON if __ARM_FEATURE_FMA is set. All others,
+ * including the scalar implementations, multiply and add separately,
+ * so don't rely on the extra precision of a fused operation.
+ */
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> fma(
+    const short_vec<CARGO, ARITY>& a,
+    const short_vec<CARGO, ARITY>& b,
+    const short_vec<CARGO, ARITY>& c)
+{
+    return a.fma(b, c);
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> min(const short_vec<CARGO, ARITY>& a, const short_vec<CARGO, ARITY>& b)
+{
+    return a.min(b);
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> max(const short_vec<CARGO, ARITY>& a, const short_vec<CARGO, ARITY>& b)
+{
+    return a.max(b);
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline short_vec<CARGO, ARITY> abs(const short_vec<CARGO, ARITY>& vec)
+{
+    return vec.abs();
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline CARGO horizontal_sum(const short_vec<CARGO, ARITY>& vec)
+{
+    return vec.horizontal_sum();
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline CARGO horizontal_min(const short_vec<CARGO, ARITY>& vec)
+{
+    return vec.horizontal_min();
+}
+
+template<typename CARGO, std::size_t ARITY>
+inline CARGO horizontal_max(const short_vec<CARGO, ARITY>& vec)
+{
+    return vec.horizontal_max();
+}
+
 template<typename T, std::size_t ARITY>
 inline std::size_t count_mask(const typename short_vec<T, ARITY>::mask_type& mask)
 {
@@ -123,13 +174,8 @@ inline std::size_t count_mask(const typename short_vec<T, ARITY>::mask_type& mas
 
     short_vec<T, ARITY> v(T(0));
     v.blend(mask, short_vec<T, ARITY>(T(1)));
-    std::size_t sum = 0;
-
-    for (int i = 0; i < static_cast<int>(ARITY); ++i) {
-        sum += static_cast<std::size_t>(get(v, i));
-    }
 
-    return sum;
+    return static_cast<std::size_t>(horizontal_sum(v));
 }
 
 class short_vec_strategy
@@ -438,4 +484,6 @@ public:
 #include <libflatarray/detail/short_vec_mic_float_16.hpp>
 #include <libflatarray/detail/short_vec_mic_float_32.hpp>
 
+#include <libflatarray/detail/short_vec_math.hpp>
+
 #endif
@@ -39,6 +39,22 @@
 
 namespace LibFlatArray {
 
+/**
+ * Allocators which leave page placement to the first write (e.g. to
+ * place memory on NUMA systems by first touch) can specialize this
+ * trait to have soa_grid construct its cells in parallel, see
+ * detail::flat_array::construct_functor.
+ */
+template<typename ALLOCATOR>
+class parallel_construction
+{
+public:
+    inline bool operator()() const
+    {
+        return false;
+    }
+};
+
 /**
  * soa_grid is a 1D - 3D container with "Struct of Arrays"-style
  * memory layout but "Array of Structs"-style user interface. Another
@@ -163,14 +179,14 @@ public:
     }
 
     template<typename FUNCTOR>
-    void callback(soa_grid<value_type> *other_grid, const FUNCTOR& functor)
+    void callback(soa_grid *other_grid, const FUNCTOR& functor)
     {
         typedef typename api_traits::select_asymmetric_dual_callback<value_type>::value value;
         dual_callback(other_grid, functor, value());
     }
 
     template<typename FUNCTOR>
-    void callback(soa_grid<value_type> *other_grid, const FUNCTOR& functor) const
+    void callback(soa_grid *other_grid, const FUNCTOR& functor) const
     {
         typedef typename api_traits::select_asymmetric_dual_callback<value_type>::value value;
         dual_callback(other_grid, functor, value());
@@ -400,22 +416,22 @@ private:
     char_staging_buffer_type raw_staging_buffer;
 
     template<typename FUNCTOR>
-    void dual_callback(soa_grid<value_type> *other_grid, const FUNCTOR& functor, api_traits::true_type)
+    void dual_callback(soa_grid *other_grid, const FUNCTOR& functor, api_traits::true_type)
     {
         detail::flat_array::dual_callback_helper()(this, other_grid, functor);
     }
 
     template<typename FUNCTOR>
-    void dual_callback(soa_grid<value_type> *other_grid, const FUNCTOR& functor, api_traits::true_type) const
+    void dual_callback(soa_grid *other_grid, const FUNCTOR& functor, api_traits::true_type) const
     {
         detail::flat_array::dual_callback_helper()(this, other_grid, functor);
     }
 
     template<typename FUNCTOR>
-    void dual_callback(soa_grid<value_type> *other_grid, FUNCTOR& functor, api_traits::false_type) const
+    void dual_callback(soa_grid *other_grid, FUNCTOR& functor, api_traits::false_type) const
     {
         assert_same_grid_sizes(other_grid);
-        detail::flat_array::dual_callback_helper_symmetric<soa_grid<value_type>, FUNCTOR> helper(
+        detail::flat_array::dual_callback_helper_symmetric<soa_grid, FUNCTOR> helper(
             other_grid, functor);
 
         api_traits::select_sizes<value_type>()(
@@ -427,10 +443,10 @@ private:
     }
 
     template<typename FUNCTOR>
-    void dual_callback(soa_grid<value_type> *other_grid, const FUNCTOR& functor, api_traits::false_type) const
+    void dual_callback(soa_grid *other_grid, const FUNCTOR& functor, api_traits::false_type) const
     {
         assert_same_grid_sizes(other_grid);
-        detail::flat_array::const_dual_callback_helper_symmetric<soa_grid<value_type>, FUNCTOR> helper(
+        detail::flat_array::const_dual_callback_helper_symmetric<soa_grid, FUNCTOR> helper(
             other_grid, functor);
 
         api_traits::select_sizes<value_type>()(
@@ -443,7 +459,8 @@ private:
 
     void init()
     {
-        callback(detail::flat_array::construct_functor<value_type, USE_CUDA_FUNCTORS>(my_dim_x, my_dim_y, my_dim_z));
+        callback(detail::flat_array::construct_functor<value_type, USE_CUDA_FUNCTORS>(
+                     my_dim_x, my_dim_y, my_dim_z, parallel_construction<ALLOCATOR>()()));
     }
 
     void destroy_and_deallocate()
@@ -461,7 +478,7 @@ private:
         other.callback(this, detail::flat_array::copy_functor<value_type>(my_dim_x, my_dim_y, my_dim_z));
     }
 
-    void assert_same_grid_sizes(const soa_grid<value_type> *other_grid) const
+    void assert_same_grid_sizes(const soa_grid *other_grid) const
     {
         if ((my_dim_x != other_grid->my_dim_x) ||
             (my_dim_y != other_grid->my_dim_y) ||
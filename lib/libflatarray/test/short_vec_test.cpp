@@ -27,8 +27,10 @@
 #pragma warning( disable : 4514 )
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -44,6 +46,79 @@ namespace LibFlatArray {
 
 #define SHORT_VEC_TEMPLATE short_vec
 
+/**
+ * Tests exp(), log() and pow() as implemented by MATH, so that the
+ * lane-wise fallback (see short_vec_math.hpp) gets covered even on
+ * hosts where all backends have masks.
+ */
+template<typename CARGO, std::size_t ARITY, typename MATH>
+class TestMath
+{
+public:
+    void operator()() const
+    {
+        typedef SHORT_VEC_TEMPLATE<CARGO, ARITY> ShortVec;
+
+        // test exp, log, pow
+        {
+            const double tolerance = 4 * std::numeric_limits<CARGO>::epsilon();
+            std::vector<CARGO, aligned_allocator<CARGO, 64> > array1(ARITY * 10);
+            std::vector<CARGO, aligned_allocator<CARGO, 64> > array2(ARITY * 10);
+            std::vector<CARGO, aligned_allocator<CARGO, 64> > actual(ARITY * 10);
+
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                array1[i] = -80.0 + 160.0 * i / (ARITY * 10);
+            }
+            for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+                &actual[i] << MATH::exp(ShortVec(&array1[i]));
+            }
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                TEST_REAL_ACCURACY(std::exp(array1[i]), actual[i], tolerance);
+            }
+
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                array1[i] = std::pow(CARGO(10), CARGO(-30.0 + 60.0 * i / (ARITY * 10)));
+            }
+            array1[1] = std::numeric_limits<CARGO>::denorm_min() * 3;
+            array1[2] = CARGO(1);
+            array1[3] = CARGO(1.001);
+            for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+                &actual[i] << MATH::log(ShortVec(&array1[i]));
+            }
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                if (array1[i] == 1) {
+                    BOOST_TEST_EQ(CARGO(0), actual[i]);
+                } else {
+                    TEST_REAL_ACCURACY(std::log(array1[i]), actual[i], tolerance);
+                }
+            }
+
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                array1[i] = 0.5 + 9.5 * i / (ARITY * 10);
+                array2[i] = -3.0 + 6.0 * ((i * 7) % (ARITY * 10)) / (ARITY * 10);
+            }
+            for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+                &actual[i] << MATH::pow(ShortVec(&array1[i]), ShortVec(&array2[i]));
+            }
+            for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+                if (array2[i] == 0) {
+                    BOOST_TEST_EQ(CARGO(1), actual[i]);
+                } else {
+                    TEST_REAL_ACCURACY(std::pow(array1[i], array2[i]), actual[i], 4 * tolerance);
+                }
+            }
+
+            // special values:
+            const CARGO infinity = std::numeric_limits<CARGO>::infinity();
+            BOOST_TEST_EQ(infinity, get(MATH::exp(ShortVec(CARGO(1000))), 0));
+            BOOST_TEST_EQ(CARGO(0), get(MATH::exp(ShortVec(CARGO(-1000))), 0));
+            BOOST_TEST_EQ(-infinity, get(MATH::log(ShortVec(CARGO(0))), 0));
+            BOOST_TEST_EQ(infinity, get(MATH::log(ShortVec(infinity)), 0));
+            BOOST_TEST(get(MATH::log(ShortVec(CARGO(-1))), 0) != get(MATH::log(ShortVec(CARGO(-1))), 0));
+        }
+    }
+};
+
 template<typename CARGO, std::size_t ARITY>
 void testImplementationReal()
 {
@@ -627,6 +702,78 @@ void testImplementationReal()
         }
     }
 
+    // test fma, min, max, abs
+    {
+        std::vector<CARGO, aligned_allocator<CARGO, 64> > array1(ARITY * 10);
+        std::vector<CARGO, aligned_allocator<CARGO, 64> > array2(ARITY * 10);
+        std::vector<CARGO, aligned_allocator<CARGO, 64> > actual(ARITY * 10);
+
+        for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+            array1[i] = (i % 3) ? (i + 0.25) : (-1.0 * i - 0.5);
+            array2[i] = 17.0 - i * 0.75;
+        }
+
+        for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+            ShortVec a(&array1[i]);
+            ShortVec b(&array2[i]);
+            &actual[i] << fma(a, b, ShortVec(CARGO(3)));
+        }
+        for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+            TEST_REAL_ACCURACY(array1[i] * array2[i] + 3, actual[i], 0.00001);
+        }
+
+        for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+            &actual[i] << min(ShortVec(&array1[i]), ShortVec(&array2[i]));
+        }
+        for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+            BOOST_TEST_EQ((std::min)(array1[i], array2[i]), actual[i]);
+        }
+
+        for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+            &actual[i] << max(ShortVec(&array1[i]), ShortVec(&array2[i]));
+        }
+        for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+            BOOST_TEST_EQ((std::max)(array1[i], array2[i]), actual[i]);
+        }
+
+        for (std::size_t i = 0; i < (ARITY * 10); i += ARITY) {
+            &actual[i] << abs(ShortVec(&array1[i]));
+        }
+        for (std::size_t i = 0; i < (ARITY * 10); ++i) {
+            BOOST_TEST_EQ(std::abs(array1[i]), actual[i]);
+        }
+    }
+
+    // test horizontal reductions
+    {
+        std::vector<CARGO, aligned_allocator<CARGO, 64> > array(ARITY);
+        for (std::size_t i = 0; i < ARITY; ++i) {
+            array[i] = (i * 7) % ARITY + ((i % 2) ? 0.5 : -0.5 * ARITY);
+        }
+        ShortVec v(&array[0]);
+
+        CARGO sum = 0;
+        for (std::size_t i = 0; i < ARITY; ++i) {
+            sum += array[i];
+        }
+        TEST_REAL(sum, horizontal_sum(v));
+        BOOST_TEST_EQ(*std::min_element(array.begin(), array.end()), horizontal_min(v));
+        BOOST_TEST_EQ(*std::max_element(array.begin(), array.end()), horizontal_max(v));
+    }
+
+    TestMath<CARGO, ARITY, detail::short_vec_math::implementation<ShortVec> >()();
+    TestMath<CARGO, ARITY, detail::short_vec_math::implementation<ShortVec, false> >()();
+
+    // the free functions dispatch to one of the above:
+    {
+        const double tolerance = 4 * std::numeric_limits<CARGO>::epsilon();
+        TEST_REAL_ACCURACY(std::exp(CARGO(2.5)), get(exp(ShortVec(CARGO(2.5))), 0), tolerance);
+        TEST_REAL_ACCURACY(std::log(CARGO(2.5)), get(log(ShortVec(CARGO(2.5))), 0), tolerance);
+        TEST_REAL_ACCURACY(
+            std::pow(CARGO(2.5), CARGO(1.5)),
+            get(pow(ShortVec(CARGO(2.5)), ShortVec(CARGO(1.5))), 0),
+            4 * tolerance);
+    }
 
     // fixme: add all tests for int, too
 }
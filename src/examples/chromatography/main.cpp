@@ -428,7 +428,10 @@ public:
         ret->setEdge(ContainerCell());
 
         Grid<ContainerCell> grid = createBasicGrid();
-        fillGeometryData(&grid);
+        // only mesh our own part of the simulation space:
+        Region<2> region;
+        region << box;
+        fillGeometryData(&grid, region);
 
         for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
             ContainerCell c = grid[*i];
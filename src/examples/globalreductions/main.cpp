@@ -2,14 +2,12 @@
 
 using namespace LibGeoDecomp;
 
-class TemperatureRecorder;
 class RainMaker;
 
 class BushFireCell
 {
 public:
     friend void runSimulation();
-    friend class TemperatureRecorder;
     friend class RainMaker;
 
     enum State {BURNING, GUTTED};
@@ -224,38 +222,6 @@ private:
     }
 };
 
-class TemperatureRecorder : public Clonable<Writer<BushFireCell>, TemperatureRecorder>
-{
-public:
-    typedef Writer<BushFireCell>::GridType GridType;
-
-    explicit TemperatureRecorder(const unsigned outputPeriod) :
-        Clonable<Writer<BushFireCell>, TemperatureRecorder>("", outputPeriod),
-        avrgTemperature(0)
-    {}
-
-    void stepFinished(const GridType& grid, unsigned step, WriterEvent event)
-    {
-        avrgTemperature = 0;
-
-        CoordBox<2> box = grid.boundingBox();
-        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
-            avrgTemperature += grid.get(*i).temperature;
-        }
-
-        avrgTemperature /= box.dimensions.prod();
-        std::cout << "averageTemperature(" << step << ") = " << avrgTemperature << "\n";
-    }
-
-    double averageTemperature() const
-    {
-        return avrgTemperature;
-    }
-
-private:
-    double avrgTemperature;
-};
-
 class RainMaker : public Steerer<BushFireCell>
 {
 public:
@@ -263,10 +229,10 @@ public:
     using Steerer<BushFireCell>::GridType;
     using Steerer<BushFireCell>::Topology;
 
-    RainMaker(const unsigned ioPeriod, TemperatureRecorder *trigger) :
+    RainMaker(const unsigned ioPeriod, const Reduction<BushFireCell> *totalTemperature) :
         Steerer<BushFireCell>(ioPeriod),
         waterAvailable(true),
-        trigger(trigger)
+        totalTemperature(totalTemperature)
     {}
 
     void nextStep(
@@ -279,7 +245,13 @@ public:
         bool lastCall,
         SteererFeedback *feedback)
     {
-        if (waterAvailable && (trigger->averageTemperature() > 250)) {
+        double averageTemperature = totalTemperature->result() / globalDimensions.prod();
+        if ((rank == 0) && lastCall) {
+            std::cout << "averageTemperature(" << totalTemperature->resultStep() << ") = "
+                      << averageTemperature << "\n";
+        }
+
+        if (waterAvailable && (averageTemperature > 250)) {
             std::cout << "WARNING---------------------------------------------------\n"
                       << "WARNING: initiating rain at time step " << step << "\n"
                       << "WARNING---------------------------------------------------\n";
@@ -302,7 +274,7 @@ public:
 
 private:
     bool waterAvailable;
-    TemperatureRecorder *trigger;
+    const Reduction<BushFireCell> *totalTemperature;
 };
 
 void runSimulation()
@@ -324,9 +296,11 @@ void runSimulation()
 
     sim.addWriter(new TracingWriter<BushFireCell>(500, maxSteps));
 
-    TemperatureRecorder *temperatureRecorder = new TemperatureRecorder(100);
-    sim.addWriter(temperatureRecorder);
-    sim.addSteerer(new RainMaker(100, temperatureRecorder));
+    // evaluated after each step, without the need to collect the grid:
+    Reduction<BushFireCell> *totalTemperature =
+        new MemberReduction<BushFireCell, double>(&BushFireCell::temperature, REDUCTION_SUM);
+    sim.addReduction(totalTemperature);
+    sim.addSteerer(new RainMaker(100, totalTemperature));
 
     sim.run();
 }
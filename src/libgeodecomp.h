@@ -16,6 +16,7 @@
 
 #ifdef LIBGEODECOMP_WITH_MPI
 #include <mpi.h>
+#include <libgeodecomp/io/asyncparallelwriter.h>
 #include <libgeodecomp/io/collectingwriter.h>
 #include <libgeodecomp/io/parallelwriter.h>
 #include <libgeodecomp/parallelization/hiparsimulator.h>
@@ -34,6 +35,7 @@
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/geometry/voronoimesher.h>
+#include <libgeodecomp/io/asyncwriter.h>
 #include <libgeodecomp/io/ppmwriter.h>
 #include <libgeodecomp/io/remotesteerer.h>
 #include <libgeodecomp/io/serialbovwriter.h>
@@ -41,6 +43,7 @@
 #include <libgeodecomp/io/simplecellplotter.h>
 #include <libgeodecomp/io/simpleinitializer.h>
 #include <libgeodecomp/io/tracingwriter.h>
+#include <libgeodecomp/loadbalancer/costprofilebalancer.h>
 #include <libgeodecomp/loadbalancer/noopbalancer.h>
 #include <libgeodecomp/loadbalancer/oozebalancer.h>
 #include <libgeodecomp/loadbalancer/tracingbalancer.h>
@@ -48,16 +51,20 @@
 #include <libgeodecomp/misc/color.h>
 #include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/reduction.h>
 #include <libgeodecomp/parallelization/serialsimulator.h>
 #include <libgeodecomp/parallelization/stripingsimulator.h>
 #include <libgeodecomp/storage/boxcell.h>
 #include <libgeodecomp/storage/containercell.h>
 #include <libgeodecomp/storage/fixedarray.h>
 #include <libgeodecomp/storage/memberfilter.h>
+#include <libgeodecomp/storage/meshlessadapter.h>
+#include <libgeodecomp/storage/meshlesscelllist.h>
 #include <libgeodecomp/storage/multicontainercell.h>
 #include <libgeodecomp/storage/simplearrayfilter.h>
 #include <libgeodecomp/storage/simplefilter.h>
 #include <libgeodecomp/storage/passthroughcontainer.h>
 #include <libgeodecomp/storage/unstructuredlooppeeler.h>
+#include <libgeodecomp/storage/verletboxcell.h>
 
 #endif
@@ -17,6 +17,7 @@
 #include <libgeodecomp/misc/palette.h>
 #include <libgeodecomp/misc/quickpalette.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regioncodec.h>
 #include <libgeodecomp/geometry/streak.h>
 
 namespace LibGeoDecomp {
@@ -129,10 +130,7 @@ public:
     inline
     static void serialize(ARCHIVE& archive, LibGeoDecomp::Region<DIMENSIONS>& object, const unsigned /*version*/)
     {
-        archive & object.geometryCacheTainted;
-        archive & object.indices;
-        archive & object.myBoundingBox;
-        archive & object.mySize;
+        RegionCodec::serialize(archive, object);
     }
 
     template<typename ARCHIVE, int DIM>
@@ -17,6 +17,7 @@
 #include <libgeodecomp/misc/palette.h>
 #include <libgeodecomp/misc/quickpalette.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regioncodec.h>
 #include <libgeodecomp/geometry/streak.h>
 #include <libgeodecomp/misc/testcell.h>
 #include <libgeodecomp/misc/unstructuredtestcell.h>
@@ -131,10 +132,7 @@ public:
     inline
     static void serialize(ARCHIVE& archive, LibGeoDecomp::Region<DIMENSIONS>& object, const unsigned /*version*/)
     {
-        archive & object.geometryCacheTainted;
-        archive & object.indices;
-        archive & object.myBoundingBox;
-        archive & object.mySize;
+        RegionCodec::serialize(archive, object);
     }
 
     template<typename ARCHIVE, int DIM>
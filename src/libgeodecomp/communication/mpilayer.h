@@ -5,15 +5,70 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 
 #include <mpi.h>
+#include <deque>
 #include <map>
 #include <vector>
 #include <libgeodecomp/communication/typemaps.h>
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regioncodec.h>
 #include <libgeodecomp/storage/grid.h>
 
 namespace LibGeoDecomp {
 
+namespace MPILayerHelpers {
+
+/**
+ * Remembers encoded Regions exchanged with one peer, keyed by their
+ * hash. Sender and receiver evict in the same (FIFO) order, so both
+ * sides agree on the contents without further communication.
+ */
+class RegionCache
+{
+public:
+    explicit RegionCache(std::size_t capacity = 0) :
+        capacity(capacity)
+    {}
+
+    const std::vector<char> *find(unsigned long long hash) const
+    {
+        std::map<unsigned long long, std::vector<char> >::const_iterator i = entries.find(hash);
+        if (i == entries.end()) {
+            return 0;
+        }
+
+        return &i->second;
+    }
+
+    void insert(unsigned long long hash, const std::vector<char>& buffer)
+    {
+        if (capacity == 0) {
+            return;
+        }
+
+        std::map<unsigned long long, std::vector<char> >::iterator i = entries.find(hash);
+        if (i != entries.end()) {
+            i->second = buffer;
+            return;
+        }
+
+        if (order.size() == capacity) {
+            entries.erase(order.front());
+            order.pop_front();
+        }
+
+        entries[hash] = buffer;
+        order.push_back(hash);
+    }
+
+private:
+    std::size_t capacity;
+    std::map<unsigned long long, std::vector<char> > entries;
+    std::deque<unsigned long long> order;
+};
+
+}
+
 /**
  * MPILayer is a wrapper that provides a mostly 1:1 identical access
  * to MPI functions, but with a number of convenient twists, where
@@ -39,7 +94,9 @@ public:
         // links between any two nodes.
         PATCH_LINK = 100,
         PARALLEL_MEMORY_WRITER = 200,
-        COLLECTING_WRITER = 300
+        COLLECTING_WRITER = 300,
+        HIPAR_SIMULATOR = 400,
+        GLOBAL_REDUCTIONS = 500
     };
 
     typedef std::map<int, std::vector<MPI_Request> > RequestsMap;
@@ -51,7 +108,8 @@ public:
      */
     explicit MPILayer(MPI_Comm communicator = MPI_COMM_WORLD, int tag = 0) :
         comm(communicator),
-        tag(tag)
+        tag(tag),
+        regionCacheCapacity(0)
     {
         Typemaps::initializeMapsIfUninitialized();
     }
@@ -167,6 +225,29 @@ public:
         return ret;
     }
 
+    /**
+     * waits until any of the communication requests tagged with
+     * waitTag is finished and returns its index (requests are
+     * numbered in the order in which they were issued). Completed
+     * requests keep their index until wait() is called for waitTag.
+     * Returns -1 if no request is pending.
+     */
+    int waitAny(int waitTag)
+    {
+        std::vector<MPI_Request>& requestVec = requests[waitTag];
+        if (requestVec.size() == 0) {
+            return -1;
+        }
+
+        int index;
+        MPI_Waitany(requestVec.size(), &requestVec[0], &index, MPI_STATUS_IGNORE);
+        if (index == MPI_UNDEFINED) {
+            return -1;
+        }
+
+        return index;
+    }
+
     void testAll()
     {
         for (RequestsMap::iterator i = requests.begin();
@@ -254,17 +335,47 @@ public:
     }
 
     /**
-     * Sends a region object synchronously to another node.
+     * Makes sendRegion() skip Regions which the receiver already got
+     * from this MPILayer, remembering up to capacity Regions per
+     * peer. Only use this if both sides always use the same pair of
+     * MPILayer objects for sending and receiving Regions, as the
+     * caches would diverge otherwise. A capacity of 0 disables the
+     * cache.
+     */
+    void setRegionCacheCapacity(std::size_t capacity)
+    {
+        regionCacheCapacity = capacity;
+        sentRegions.clear();
+        receivedRegions.clear();
+    }
+
+    /**
+     * Sends a region object synchronously to another node, using the
+     * compact encoding of RegionCodec. A header (hash, length)
+     * precedes the payload; a length of 0 tells the receiver to take
+     * the Region from its cache.
      */
     template<int DIM>
     void sendRegion(const Region<DIM>& region, int dest)
     {
-        unsigned numStreaks = region.numStreaks();
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+        unsigned long long header[] = {RegionCodec::hash(buffer), buffer.size()};
+
+        if (regionCacheCapacity > 0) {
+            MPILayerHelpers::RegionCache& cache = regionCache(&sentRegions, dest);
+            const std::vector<char> *cached = cache.find(header[0]);
+            if (cached && (*cached == buffer)) {
+                header[1] = 0;
+            } else {
+                cache.insert(header[0], buffer);
+            }
+        }
+
         MPI_Request req;
-        MPI_Isend(&numStreaks, 1, MPI_UNSIGNED, dest, tag, comm, &req);
-        if(numStreaks > 0) {
-            std::vector<Streak<DIM> > buf = region.toVector();
-            MPI_Send(&buf[0], numStreaks, Typemaps::lookup<Streak<DIM> >(), dest, tag, comm);
+        MPI_Isend(header, 2, MPI_UNSIGNED_LONG_LONG, dest, tag, comm, &req);
+        if (header[1] > 0) {
+            MPI_Send(&buffer[0], buffer.size(), MPI_CHAR, dest, tag, comm);
         }
         MPI_Wait(&req, MPI_STATUS_IGNORE);
     }
@@ -275,16 +386,29 @@ public:
     template<int DIM>
     void recvRegion(Region<DIM> *region, int src)
     {
-        unsigned numStreaks;
-        MPI_Recv(&numStreaks, 1, MPI_UNSIGNED, src, tag, comm, MPI_STATUS_IGNORE);
-        if(numStreaks > 0) {
-            std::vector<Streak<DIM> > buf(numStreaks);
-            MPI_Recv(&buf[0], numStreaks, Typemaps::lookup<Streak<DIM> >(), src, tag, comm, MPI_STATUS_IGNORE);
-            region->clear();
-            region->load(buf.begin(), buf.end());
+        unsigned long long header[2];
+        MPI_Recv(header, 2, MPI_UNSIGNED_LONG_LONG, src, tag, comm, MPI_STATUS_IGNORE);
+
+        if (header[1] == 0) {
+            const std::vector<char> *cached = 0;
+            if (regionCacheCapacity > 0) {
+                cached = regionCache(&receivedRegions, src).find(header[0]);
+            }
+            if (cached == 0) {
+                throw std::logic_error("received reference to a Region which is not cached, "
+                                       "are sender and receiver using matching MPILayers?");
+            }
+
+            RegionCodec::decode(*cached, region);
+            return;
         }
-        else {
-            region->clear();
+
+        std::vector<char> buffer(header[1]);
+        MPI_Recv(&buffer[0], buffer.size(), MPI_CHAR, src, tag, comm, MPI_STATUS_IGNORE);
+        RegionCodec::decode(buffer, region);
+
+        if (regionCacheCapacity > 0) {
+            regionCache(&receivedRegions, src).insert(header[0], buffer);
         }
     }
 
@@ -382,7 +506,66 @@ public:
             comm);
     }
 
-    // fixme: add mpi_allreduce for minighost, add global reduction api for production code
+    /**
+     * Simple wrapper for MPI_Allreduce, returns the reduced value on
+     * all nodes.
+     */
+    template<typename T>
+    inline T allReduce(
+        const T& source,
+        MPI_Op op,
+        const MPI_Datatype& datatype = Typemaps::lookup<T>()) const
+    {
+        T ret;
+        allReduce(&source, &ret, 1, op, datatype);
+        return ret;
+    }
+
+    template<typename T>
+    inline void allReduce(
+        const T *source,
+        T *target,
+        int num,
+        MPI_Op op,
+        const MPI_Datatype& datatype = Typemaps::lookup<T>()) const
+    {
+        MPI_Allreduce(const_cast<T*>(source), target, num, datatype, op, comm);
+    }
+
+    /**
+     * Non-blocking variant of allReduce(). Neither source nor target
+     * may be touched until wait() has been called for waitTag.
+     */
+    template<typename T>
+    inline void allReduceNonBlocking(
+        const T *source,
+        T *target,
+        int num,
+        MPI_Op op,
+        int waitTag,
+        const MPI_Datatype& datatype = Typemaps::lookup<T>())
+    {
+        MPI_Request req;
+        MPI_Iallreduce(const_cast<T*>(source), target, num, datatype, op, comm, &req);
+        requests[waitTag].push_back(req);
+    }
+
+    /**
+     * Non-blocking variant of allGather(), target needs to hold
+     * num * size() elements.
+     */
+    template<typename T>
+    inline void allGatherNonBlocking(
+        const T *source,
+        T *target,
+        int num,
+        int waitTag,
+        const MPI_Datatype& datatype = Typemaps::lookup<T>())
+    {
+        MPI_Request req;
+        MPI_Iallgather(const_cast<T*>(source), num, datatype, target, num, datatype, comm, &req);
+        requests[waitTag].push_back(req);
+    }
 
     template<typename T>
     inline std::vector<T> gather(
@@ -528,9 +711,24 @@ public:
     }
 
 private:
+    typedef std::map<int, MPILayerHelpers::RegionCache> RegionCacheMap;
+
     MPI_Comm comm;
     int tag;
     RequestsMap requests;
+    std::size_t regionCacheCapacity;
+    RegionCacheMap sentRegions;
+    RegionCacheMap receivedRegions;
+
+    MPILayerHelpers::RegionCache& regionCache(RegionCacheMap *caches, int peer)
+    {
+        RegionCacheMap::iterator i = caches->find(peer);
+        if (i == caches->end()) {
+            i = caches->insert(std::make_pair(peer, MPILayerHelpers::RegionCache(regionCacheCapacity))).first;
+        }
+
+        return i->second;
+    }
 
     typedef std::pair<const void*, unsigned> ChunkSpec;
 
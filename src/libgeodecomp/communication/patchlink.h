@@ -5,7 +5,9 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 
 #include <deque>
+#include <vector>
 #include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/misc/eventtrace.h>
 #include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/storage/patchaccepter.h>
 #include <libgeodecomp/storage/patchprovider.h>
@@ -18,6 +20,23 @@ namespace LibGeoDecomp {
  * remote processes. PatchLink::Accepter takes the patches from a
  * Stepper hands them on to MPI, while PatchLink::Provider will receive
  * the patches from the net and provide then to a Stepper.
+ *
+ * Regions only change when the UpdateGroup is rebuilt (e.g. after
+ * load balancing), so links for fixed size cells set up persistent
+ * MPI requests (MPI_Send_init/MPI_Recv_init) on preallocated buffers
+ * once and merely restart them for each transmission. Large regions
+ * are split into chunks of at most maxChunkSize cells, each with its
+ * own buffer and request, so that packing of the next chunk overlaps
+ * with sending of the previous ones (and unpacking with receiving on
+ * the other side). Variable size cells (e.g. with
+ * Boost.Serialization) can't use persistent requests as their buffer
+ * size isn't known in advance and fall back to plain non-blocking
+ * transfers with a size header.
+ *
+ * If haloMembersOnly is set, SoA models which declare their halo
+ * members (see APITraits::HasHaloMembers) get only those members
+ * transmitted. As the set of members may vary with the nano step,
+ * each chunk gets one persistent request per nano step.
  */
 template<class GRID_TYPE>
 class PatchLink
@@ -28,8 +47,10 @@ public:
     typedef typename GRID_TYPE::CellType CellType;
     typedef typename SerializationBuffer<CellType>::BufferType BufferType;
     typedef typename SerializationBuffer<CellType>::FixedSize FixedSize;
+    typedef std::vector<Selector<CellType> > SelectorVec;
 
     const static int DIM = GRID_TYPE::DIM;
+    const static std::size_t DEFAULT_MAX_CHUNK_SIZE = 1 << 16;
 
     class Link
     {
@@ -43,18 +64,38 @@ public:
         inline Link(
             const Region<DIM>& region,
             int tag,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t maxChunkSize = DEFAULT_MAX_CHUNK_SIZE,
+            bool haloMembersOnly = false) :
             lastNanoStep(0),
             stride(1),
             mpiLayer(communicator),
             region(region),
-            buffer(SerializationBuffer<CellType>::create(region)),
-            tag(tag)
-        {}
+            buffer(createBuffer(region, FixedSize())),
+            tag(tag),
+            chunks(splitRegion(region, maxChunkSize, FixedSize())),
+            haloMembers(selectHaloMembers(
+                            haloMembersOnly,
+                            typename APITraits::SelectSoA<CellType>::Value(),
+                            typename APITraits::SelectHaloMembers<CellType>::Value())),
+            activeSlot(0),
+            persistentRequestsActive(false),
+            datatypeSize(0)
+        {
+            for (typename std::vector<Region<DIM> >::iterator i = chunks.begin(); i != chunks.end(); ++i) {
+                chunkBuffers.push_back(SerializationBuffer<CellType>::create(*i));
+            }
+        }
 
         virtual ~Link()
         {
             wait();
+
+            for (std::vector<MPI_Request>::iterator i = persistentRequests.begin();
+                 i != persistentRequests.end();
+                 ++i) {
+                MPI_Request_free(&*i);
+            }
         }
 
         /**
@@ -74,11 +115,63 @@ public:
         inline void wait()
         {
             mpiLayer.wait(tag);
+
+            if (persistentRequestsActive) {
+                MPI_Waitall(chunks.size(), activeRequests(), MPI_STATUSES_IGNORE);
+                persistentRequestsActive = false;
+            }
         }
 
         inline void cancel()
         {
             mpiLayer.cancelAll();
+
+            if (persistentRequestsActive) {
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    MPI_Cancel(activeRequests() + i);
+                }
+            }
+        }
+
+        /**
+         * Splits region into chunks of at most maxChunkSize cells.
+         * Streaks are split where necessary, the chunks are returned
+         * in streak order.
+         */
+        static std::vector<Region<DIM> > splitRegion(const Region<DIM>& region, std::size_t maxChunkSize)
+        {
+            if (maxChunkSize == 0) {
+                throw std::invalid_argument("maxChunkSize needs to be positive");
+            }
+
+            std::vector<Region<DIM> > ret;
+            Region<DIM> chunk;
+            std::size_t chunkSize = 0;
+
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                Streak<DIM> streak = *i;
+
+                while (streak.origin.x() < streak.endX) {
+                    int length = (std::min)(
+                        std::size_t(streak.length()),
+                        maxChunkSize - chunkSize);
+                    chunk << Streak<DIM>(streak.origin, streak.origin.x() + length);
+                    chunkSize += length;
+                    streak.origin.x() += length;
+
+                    if (chunkSize == maxChunkSize) {
+                        ret.push_back(chunk);
+                        chunk.clear();
+                        chunkSize = 0;
+                    }
+                }
+            }
+
+            if (chunkSize > 0) {
+                ret.push_back(chunk);
+            }
+
+            return ret;
         }
 
     protected:
@@ -88,6 +181,176 @@ public:
         Region<DIM> region;
         BufferType buffer;
         int tag;
+        std::vector<Region<DIM> > chunks;
+        std::vector<BufferType> chunkBuffers;
+        // one set of members per nano step, empty if all members are
+        // to be transmitted:
+        std::vector<SelectorVec> haloMembers;
+        // the persistent requests of slot s (i.e. for nano steps
+        // which are congruent to s) start at index s * chunks.size():
+        std::size_t activeSlot;
+        std::vector<MPI_Request> persistentRequests;
+        bool persistentRequestsActive;
+        // only needed for tracing the payload:
+        int datatypeSize;
+        std::vector<std::size_t> slotBytes;
+
+        std::size_t numSlots() const
+        {
+            return haloMembers.empty() ? 1 : haloMembers.size();
+        }
+
+        std::size_t slot(std::size_t nanoStep) const
+        {
+            return nanoStep % numSlots();
+        }
+
+        MPI_Request *activeRequests()
+        {
+            return &persistentRequests[activeSlot * chunks.size()];
+        }
+
+        /**
+         * Number of elements (as per the link's MPI datatype) to be
+         * transmitted for the given chunk and slot.
+         */
+        std::size_t chunkSize(std::size_t chunk, std::size_t slot) const
+        {
+            if (haloMembers.empty()) {
+                return chunkBuffers[chunk].size();
+            }
+
+            return SerializationBuffer<CellType>::minimumStorageSize(chunks[chunk], haloMembers[slot]);
+        }
+
+        void initPayloadSizes(const MPI_Datatype& datatype)
+        {
+            MPI_Type_size(datatype, &datatypeSize);
+            slotBytes.assign(numSlots(), 0);
+            for (std::size_t s = 0; s < numSlots(); ++s) {
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    slotBytes[s] += chunkSize(i, s) * datatypeSize;
+                }
+            }
+        }
+
+        /**
+         * Size of the last transmission in bytes.
+         */
+        std::size_t payloadBytes(APITraits::TrueType) const
+        {
+            return slotBytes[activeSlot];
+        }
+
+        std::size_t payloadBytes(APITraits::FalseType) const
+        {
+            return buffer.size() * datatypeSize;
+        }
+
+        void startPersistentRequests(std::size_t newSlot)
+        {
+            if (!chunks.empty()) {
+                activeSlot = newSlot;
+                // all chunks share source, communicator and tag, so they
+                // match the sender's chunks only if posted in order.
+                // MPI_Startall() doesn't guarantee any order:
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    MPI_Start(activeRequests() + i);
+                }
+                persistentRequestsActive = true;
+            }
+        }
+
+        void saveChunk(const GRID_TYPE& grid, std::size_t chunk)
+        {
+            saveChunkImplementation(grid, chunk, typename APITraits::SelectSoA<CellType>::Value());
+        }
+
+        void loadChunk(GRID_TYPE *grid, std::size_t chunk)
+        {
+            loadChunkImplementation(grid, chunk, typename APITraits::SelectSoA<CellType>::Value());
+        }
+
+    private:
+        static BufferType createBuffer(const Region<DIM>& /* unused */, APITraits::TrueType)
+        {
+            // fixed size cells are transmitted via chunkBuffers
+            return BufferType();
+        }
+
+        static BufferType createBuffer(const Region<DIM>& region, APITraits::FalseType)
+        {
+            return SerializationBuffer<CellType>::create(region);
+        }
+
+        void saveChunkImplementation(const GRID_TYPE& grid, std::size_t chunk, APITraits::TrueType /* has SoA */)
+        {
+            if (haloMembers.empty()) {
+                grid.saveRegion(&chunkBuffers[chunk], chunks[chunk]);
+            } else {
+                grid.saveRegion(&chunkBuffers[chunk], chunks[chunk], haloMembers[activeSlot]);
+            }
+        }
+
+        void saveChunkImplementation(const GRID_TYPE& grid, std::size_t chunk, APITraits::FalseType /* has SoA */)
+        {
+            grid.saveRegion(&chunkBuffers[chunk], chunks[chunk]);
+        }
+
+        void loadChunkImplementation(GRID_TYPE *grid, std::size_t chunk, APITraits::TrueType /* has SoA */)
+        {
+            if (haloMembers.empty()) {
+                grid->loadRegion(chunkBuffers[chunk], chunks[chunk]);
+            } else {
+                grid->loadRegion(chunkBuffers[chunk], chunks[chunk], haloMembers[activeSlot]);
+            }
+        }
+
+        void loadChunkImplementation(GRID_TYPE *grid, std::size_t chunk, APITraits::FalseType /* has SoA */)
+        {
+            grid->loadRegion(chunkBuffers[chunk], chunks[chunk]);
+        }
+
+        static std::vector<SelectorVec> selectHaloMembers(
+            bool haloMembersOnly,
+            APITraits::TrueType /* has SoA */,
+            APITraits::TrueType /* has halo members */)
+        {
+            std::vector<SelectorVec> ret;
+            if (haloMembersOnly) {
+                for (unsigned i = 0; i < APITraits::SelectNanoSteps<CellType>::VALUE; ++i) {
+                    ret << APITraits::SelectHaloMembers<CellType>::value(i);
+                }
+            }
+
+            return ret;
+        }
+
+        template<typename HAS_SOA, typename HAS_HALO_MEMBERS>
+        static std::vector<SelectorVec> selectHaloMembers(
+            bool /* unused */,
+            HAS_SOA /* unused */,
+            HAS_HALO_MEMBERS /* unused */)
+        {
+            // AoS and serialized models always transmit whole cells
+            return std::vector<SelectorVec>();
+        }
+
+        static std::vector<Region<DIM> > splitRegion(
+            const Region<DIM>& region,
+            std::size_t maxChunkSize,
+            APITraits::TrueType)
+        {
+            return splitRegion(region, maxChunkSize);
+        }
+
+        static std::vector<Region<DIM> > splitRegion(
+            const Region<DIM>& /* unused */,
+            std::size_t /* unused */,
+            APITraits::FalseType)
+        {
+            return std::vector<Region<DIM> >();
+        }
     };
 
     class Accepter :
@@ -95,10 +358,23 @@ public:
         public PatchAccepter<GRID_TYPE>
     {
     public:
+        using Link::activeRequests;
+        using Link::activeSlot;
         using Link::buffer;
+        using Link::chunkBuffers;
+        using Link::chunks;
+        using Link::chunkSize;
         using Link::lastNanoStep;
         using Link::mpiLayer;
+        using Link::initPayloadSizes;
+        using Link::numSlots;
+        using Link::payloadBytes;
+        using Link::persistentRequests;
+        using Link::persistentRequestsActive;
         using Link::region;
+        using Link::saveChunk;
+        using Link::slot;
+        using Link::startPersistentRequests;
         using Link::stride;
         using Link::tag;
         using Link::wait;
@@ -112,11 +388,28 @@ public:
             const int dest,
             const int tag,
             const MPI_Datatype& cellMPIDatatype,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
-            Link(region, tag, communicator),
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t maxChunkSize = DEFAULT_MAX_CHUNK_SIZE,
+            bool haloMembersOnly = false) :
+            Link(region, tag, communicator, maxChunkSize, haloMembersOnly),
             dest(dest),
             cellMPIDatatype(cellMPIDatatype)
-        {}
+        {
+            persistentRequests.resize(numSlots() * chunks.size());
+            for (std::size_t s = 0; s < numSlots(); ++s) {
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    MPI_Send_init(
+                        SerializationBuffer<CellType>::getData(chunkBuffers[i]),
+                        chunkSize(i, s),
+                        cellMPIDatatype,
+                        dest,
+                        tag,
+                        mpiLayer.communicator(),
+                        &persistentRequests[s * chunks.size() + i]);
+                }
+            }
+            initPayloadSizes(cellMPIDatatype);
+        }
 
         virtual void charge(std::size_t next, std::size_t last, std::size_t newStride)
         {
@@ -135,11 +428,10 @@ public:
                 return;
             }
 
+            double start = ScopedTimer::time();
             wait();
-            SerializationBuffer<CellType>::resize(&buffer, region);
-            grid.saveRegion(&buffer, region);
-            sendHeader(FixedSize());
-            mpiLayer.send(&buffer[0], dest, buffer.size(), tag, cellMPIDatatype);
+            send(grid, nanoStep, FixedSize());
+            EventTrace::recordCommunication(dest, payloadBytes(FixedSize()), true, start);
 
             std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
             if ((lastNanoStep == infinity()) ||
@@ -155,19 +447,34 @@ public:
         int dataSize;
         MPI_Datatype cellMPIDatatype;
 
-        void sendHeader(APITraits::TrueType)
+        void send(const GRID_TYPE& grid, std::size_t nanoStep, APITraits::TrueType)
         {
-            // we don't need any header for fixed size buffers
+            activeSlot = slot(nanoStep);
+
+            // start each chunk's transfer right away so that MPI can
+            // send it while we're packing the following chunks. The
+            // buffers never exceed their initial size, so the
+            // persistent requests' pointers remain valid:
+            for (std::size_t i = 0; i < chunks.size(); ++i) {
+                saveChunk(grid, i);
+                MPI_Start(activeRequests() + i);
+            }
+
+            persistentRequestsActive = !chunks.empty();
         }
 
-        void sendHeader(APITraits::FalseType)
+        void send(const GRID_TYPE& grid, std::size_t /* unused: nanoStep */, APITraits::FalseType)
         {
+            SerializationBuffer<CellType>::resize(&buffer, region);
+            grid.saveRegion(&buffer, region);
+
             if (buffer.size() > std::size_t(Limits<int>::getMax())) {
                 throw std::invalid_argument("buffer size exceeds std::numeric_limits<int>::max()");
             }
 
             dataSize = buffer.size();
             mpiLayer.send(&dataSize, dest, 1, tag, MPI_INT);
+            mpiLayer.send(&buffer[0], dest, buffer.size(), tag, cellMPIDatatype);
         }
     };
 
@@ -176,10 +483,23 @@ public:
         public PatchProvider<GRID_TYPE>
     {
     public:
+        using Link::activeRequests;
+        using Link::activeSlot;
         using Link::buffer;
+        using Link::chunkBuffers;
+        using Link::chunks;
+        using Link::chunkSize;
         using Link::lastNanoStep;
+        using Link::loadChunk;
         using Link::mpiLayer;
+        using Link::initPayloadSizes;
+        using Link::numSlots;
+        using Link::payloadBytes;
+        using Link::persistentRequests;
+        using Link::persistentRequestsActive;
         using Link::region;
+        using Link::slot;
+        using Link::startPersistentRequests;
         using Link::stride;
         using Link::tag;
         using Link::wait;
@@ -194,13 +514,30 @@ public:
             int source,
             int tag,
             const MPI_Datatype& cellMPIDatatype,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
-            Link(region, tag, communicator),
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t maxChunkSize = DEFAULT_MAX_CHUNK_SIZE,
+            bool haloMembersOnly = false) :
+            Link(region, tag, communicator, maxChunkSize, haloMembersOnly),
             source(source),
             dataSize(0),
             cellMPIDatatype(cellMPIDatatype),
             transmissionInFlight(false)
-        {}
+        {
+            persistentRequests.resize(numSlots() * chunks.size());
+            for (std::size_t s = 0; s < numSlots(); ++s) {
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    MPI_Recv_init(
+                        SerializationBuffer<CellType>::getData(chunkBuffers[i]),
+                        chunkSize(i, s),
+                        cellMPIDatatype,
+                        source,
+                        tag,
+                        mpiLayer.communicator(),
+                        &persistentRequests[s * chunks.size() + i]);
+                }
+            }
+            initPayloadSizes(cellMPIDatatype);
+        }
 
         virtual void cleanup()
         {
@@ -228,12 +565,11 @@ public:
             }
 
             checkNanoStepGet(nanoStep);
-            wait();
-            recvSecondPart(FixedSize());
+            double start = ScopedTimer::time();
+            receive(grid, FixedSize());
+            EventTrace::recordCommunication(source, payloadBytes(FixedSize()), false, start);
             transmissionInFlight = false;
 
-            grid->loadRegion(buffer, region);
-
             std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
             if ((lastNanoStep == infinity()) ||
                 (nextNanoStep < lastNanoStep)) {
@@ -246,7 +582,7 @@ public:
         void recv(const std::size_t nanoStep)
         {
             storedNanoSteps << nanoStep;
-            recvFirstPart(FixedSize());
+            recvFirstPart(nanoStep, FixedSize());
             transmissionInFlight = true;
         }
 
@@ -256,12 +592,12 @@ public:
         MPI_Datatype cellMPIDatatype;
         bool transmissionInFlight;
 
-        void recvFirstPart(APITraits::TrueType)
+        void recvFirstPart(std::size_t nanoStep, APITraits::TrueType)
         {
-            mpiLayer.recv(&buffer[0], source, buffer.size(), tag, cellMPIDatatype);
+            startPersistentRequests(slot(nanoStep));
         }
 
-        void recvFirstPart(APITraits::FalseType)
+        void recvFirstPart(std::size_t /* unused: nanoStep */, APITraits::FalseType)
         {
             mpiLayer.recv(&dataSize, source, 1, tag, MPI_INT);
         }
@@ -277,6 +613,32 @@ public:
             mpiLayer.recv(&buffer[0], source, dataSize, tag, cellMPIDatatype);
             wait();
         }
+
+        void receive(GRID_TYPE *grid, APITraits::TrueType)
+        {
+            if (!persistentRequestsActive) {
+                // chunks have already been received via wait()
+                for (std::size_t i = 0; i < chunks.size(); ++i) {
+                    loadChunk(grid, i);
+                }
+                return;
+            }
+
+            // unpack chunks in order of arrival:
+            for (std::size_t i = 0; i < chunks.size(); ++i) {
+                int index;
+                MPI_Waitany(chunks.size(), activeRequests(), &index, MPI_STATUS_IGNORE);
+                loadChunk(grid, index);
+            }
+            persistentRequestsActive = false;
+        }
+
+        void receive(GRID_TYPE *grid, APITraits::FalseType)
+        {
+            wait();
+            recvSecondPart(FixedSize());
+            grid->loadRegion(buffer, region);
+        }
     };
 
 };
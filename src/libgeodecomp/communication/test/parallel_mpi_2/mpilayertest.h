@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/misc/testhelper.h>
@@ -165,6 +166,32 @@ public:
         }
     }
 
+    void testSendRecvRegionCached()
+    {
+        MPILayer layer;
+        layer.setRegionCacheCapacity(2);
+
+        std::vector<Region<2> > regions(3);
+        regions[0] << Streak<2>(Coord<2>(10, 20), 30)
+                   << Streak<2>(Coord<2>(11, 21), 31);
+        regions[1] << CoordBox<2>(Coord<2>(-5, -5), Coord<2>(100, 200));
+
+        // the last Region evicts the first one, which needs to be
+        // transmitted in full again:
+        int sequence[] = {0, 0, 1, 0, 2, 1, 1, 0, 0};
+
+        for (int i = 0; i < 9; ++i) {
+            if (layer.rank() == 0) {
+                layer.sendRegion(regions[sequence[i]], 1);
+            } else {
+                Region<2> b;
+                b << Streak<2>(Coord<2>(0, 0), 1);
+                layer.recvRegion(&b, 0);
+                TS_ASSERT_EQUALS(regions[sequence[i]], b);
+            }
+        }
+    }
+
     void testAllGatherAgain()
     {
         MPILayer layer;
@@ -267,6 +294,39 @@ public:
         }
     }
 
+    void testAllReduce()
+    {
+        MPILayer layer;
+        TS_ASSERT_EQUALS(1, layer.allReduce(layer.rank(), MPI_SUM));
+        TS_ASSERT_EQUALS(1, layer.allReduce(layer.rank(), MPI_MAX));
+
+        double source[] = { 1.5 + layer.rank(), -2.0 * layer.rank() };
+        double target[] = { 0, 0 };
+        layer.allReduce(source, target, 2, MPI_MIN);
+        TS_ASSERT_EQUALS( 1.5, target[0]);
+        TS_ASSERT_EQUALS(-2.0, target[1]);
+    }
+
+    void testAllReduceNonBlocking()
+    {
+        MPILayer layer;
+        double source[] = { 1.5 + layer.rank(), -2.0 * layer.rank() };
+        double target[] = { 0, 0 };
+        std::vector<int> gathered(2 * layer.size());
+        int ranks[] = { layer.rank(), 10 * layer.rank() };
+
+        layer.allReduceNonBlocking(source, target, 2, MPI_SUM, 4714);
+        layer.allGatherNonBlocking(ranks, &gathered[0], 2, 4714);
+        TS_ASSERT_EQUALS(2, layer.wait(4714));
+
+        TS_ASSERT_EQUALS( 4.0, target[0]);
+        TS_ASSERT_EQUALS(-2.0, target[1]);
+
+        std::vector<int> expected;
+        expected << 0 << 0 << 1 << 10;
+        TS_ASSERT_EQUALS(expected, gathered);
+    }
+
     void testCancel()
     {
         if (MPILayer().rank() == 0) {
@@ -294,6 +354,35 @@ public:
         TS_ASSERT_EQUALS(layer.wait(4711), 2);
         TS_ASSERT_EQUALS(targetData, otherRank);
     }
+
+    void testWaitAny()
+    {
+        MPILayer layer;
+        TS_ASSERT_EQUALS(-1, layer.waitAny(4712));
+
+        int otherRank = 1 - layer.rank();
+        int sourceData[] = { 10 * layer.rank(), 10 * layer.rank() + 1 };
+        int targetData[] = { -1, -1 };
+
+        layer.send(&sourceData[0], otherRank, 1, 4712);
+        layer.send(&sourceData[1], otherRank, 1, 4713);
+        layer.recv(&targetData[0], otherRank, 1, 4712);
+        layer.recv(&targetData[1], otherRank, 1, 4713);
+
+        std::vector<int> completed;
+        for (int i = 0; i < 2; ++i) {
+            completed << layer.waitAny(4712);
+        }
+        std::sort(completed.begin(), completed.end());
+        TS_ASSERT_EQUALS(0, completed[0]);
+        TS_ASSERT_EQUALS(1, completed[1]);
+        TS_ASSERT_EQUALS(-1, layer.waitAny(4712));
+        TS_ASSERT_EQUALS(targetData[0], 10 * otherRank);
+
+        TS_ASSERT_EQUALS(2, layer.wait(4712));
+        layer.waitAll();
+        TS_ASSERT_EQUALS(targetData[1], 10 * otherRank + 1);
+    }
 };
 
 }
@@ -53,6 +53,52 @@ public:
     std::vector<int> cargo;
 };
 
+/**
+ * Neighbors read only member a in even nano steps and members a and c
+ * in odd ones, b is never read.
+ */
+class HaloMembersTestCell
+{
+public:
+    class API :
+        public APITraits::HasSoA,
+        public APITraits::HasHaloMembers,
+        public APITraits::HasNanoSteps<2>
+    {
+    public:
+        static std::vector<Selector<HaloMembersTestCell> > haloMembers(std::size_t nanoStep)
+        {
+            std::vector<Selector<HaloMembersTestCell> > ret;
+            ret << Selector<HaloMembersTestCell>(&HaloMembersTestCell::a, "a");
+            if (nanoStep == 1) {
+                ret << Selector<HaloMembersTestCell>(&HaloMembersTestCell::c, "c");
+            }
+
+            return ret;
+        }
+    };
+
+    explicit HaloMembersTestCell(double a = 0, int b = 0, double c = 0) :
+        a(a),
+        b(b),
+        c(c)
+    {}
+
+    double a;
+    int b;
+    double c;
+};
+
+}
+
+LIBFLATARRAY_REGISTER_SOA(
+    LibGeoDecomp::HaloMembersTestCell,
+    ((double)(a))
+    ((int)(b))
+    ((double)(c)))
+
+namespace LibGeoDecomp {
+
 class PatchLinkTest : public CxxTest::TestSuite
 {
 public:
@@ -238,6 +284,84 @@ public:
         }
     }
 
+    void testSplitRegion()
+    {
+        std::vector<Region<2> > chunks = PatchLink<GridType>::Link::splitRegion(region2, 4);
+        TS_ASSERT_EQUALS(std::size_t(2), chunks.size());
+
+        Region<2> expected0;
+        expected0 << Streak<2>(Coord<2>(0, 0), 4);
+        Region<2> expected1;
+        expected1 << Streak<2>(Coord<2>(4, 0), 6);
+        expected1 << Streak<2>(Coord<2>(4, 1), 5);
+
+        TS_ASSERT_EQUALS(expected0, chunks[0]);
+        TS_ASSERT_EQUALS(expected1, chunks[1]);
+
+        chunks = PatchLink<GridType>::Link::splitRegion(region1, 100);
+        TS_ASSERT_EQUALS(std::size_t(1), chunks.size());
+        TS_ASSERT_EQUALS(region1, chunks[0]);
+
+        TS_ASSERT_THROWS(PatchLink<GridType>::Link::splitRegion(region1, 0), std::invalid_argument&);
+    }
+
+    void testChunkedTransfer()
+    {
+        std::vector<SharedPtr<PatchAccepterType>::Type> accepters;
+        std::vector<SharedPtr<PatchProviderType>::Type> providers;
+        int stride = 3;
+        std::size_t maxNanoSteps = 40;
+        std::size_t maxChunkSize = 2;
+
+        Region<2> region = region1 + region2;
+        // testMultiple2() may leave unmatched messages for its tags behind:
+        int tagOffset = 1000;
+
+        for (int i = 0; i < mpiLayer->size(); ++i) {
+            if (i != mpiLayer->rank()) {
+                accepters << SharedPtr<PatchAccepterType>::Type(
+                    new PatchAccepterType(
+                        region,
+                        i,
+                        genTag(mpiLayer->rank(), i) + tagOffset,
+                        MPI_INT,
+                        MPI_COMM_WORLD,
+                        maxChunkSize));
+
+                providers << SharedPtr<PatchProviderType>::Type(
+                    new PatchProviderType(
+                        region,
+                        i,
+                        genTag(i, mpiLayer->rank()) + tagOffset,
+                        MPI_INT,
+                        MPI_COMM_WORLD,
+                        maxChunkSize));
+            }
+        }
+
+        for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+            accepters[i]->charge(0, maxNanoSteps, stride);
+            providers[i]->charge(0, maxNanoSteps, stride);
+        }
+
+        for (std::size_t nanoStep = 0; nanoStep < maxNanoSteps; nanoStep += stride) {
+            GridType mySendGrid = markGrid(region, mpiLayer->rank() * 10000 + nanoStep * 100);
+
+            for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                accepters[i]->put(mySendGrid, boundingRegion, boundingBox.dimensions, nanoStep, mpiLayer->rank());
+            }
+
+            for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                std::size_t senderRank = i >= mpiLayer->rank() ? i + 1 : i;
+                GridType expected = markGrid(region, senderRank * 10000 + nanoStep * 100);
+                GridType actual = zeroGrid;
+                providers[i]->get(&actual, boundingRegion, boundingBox.dimensions, nanoStep, senderRank);
+
+                TS_ASSERT_EQUALS(actual, expected);
+            }
+        }
+    }
+
     void testSoA()
     {
         Coord<3> dim(30, 20, 10);
@@ -308,6 +432,54 @@ public:
         accepter.wait();
     }
 
+    void testHaloMembers()
+    {
+        typedef SoAGrid<HaloMembersTestCell, Topologies::Cube<2>::Topology> GridType5;
+        typedef PatchLink<GridType5>::Accepter AccepterType;
+        typedef PatchLink<GridType5>::Provider ProviderType;
+
+        CoordBox<2> box(Coord<2>(), Coord<2>(10, 6));
+        Region<2> region;
+        region << Streak<2>(Coord<2>(0, 1), 10)
+               << Streak<2>(Coord<2>(3, 4),  8);
+        std::size_t maxNanoSteps = 4;
+        std::size_t maxChunkSize = 7;
+        int dest = (mpiLayer->rank() + 1) % mpiLayer->size();
+        int source = (mpiLayer->rank() + mpiLayer->size() - 1) % mpiLayer->size();
+
+        AccepterType accepter(region, dest, 2702, MPI_CHAR, MPI_COMM_WORLD, maxChunkSize, true);
+        ProviderType provider(region, source, 2702, MPI_CHAR, MPI_COMM_WORLD, maxChunkSize, true);
+        accepter.charge(0, maxNanoSteps, 1);
+        provider.charge(0, maxNanoSteps, 1);
+
+        for (std::size_t nanoStep = 0; nanoStep < maxNanoSteps; ++nanoStep) {
+            GridType5 sendGrid(box);
+            for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+                double value = mpiLayer->rank() * 1000 + nanoStep * 100 + i->y() * 10 + i->x();
+                sendGrid.set(*i, HaloMembersTestCell(value, value, value + 0.5));
+            }
+            accepter.put(sendGrid, region, box.dimensions, nanoStep, mpiLayer->rank());
+
+            GridType5 recvGrid(box, HaloMembersTestCell(-1, -1, -1));
+            provider.get(&recvGrid, region, box.dimensions, nanoStep, mpiLayer->rank());
+
+            for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+                double expected = source * 1000 + nanoStep * 100 + i->y() * 10 + i->x();
+                HaloMembersTestCell cell = recvGrid.get(*i);
+
+                TS_ASSERT_EQUALS(expected, cell.a);
+                TS_ASSERT_EQUALS(-1, cell.b);
+                if (nanoStep % 2) {
+                    TS_ASSERT_EQUALS(expected + 0.5, cell.c);
+                } else {
+                    TS_ASSERT_EQUALS(-1, cell.c);
+                }
+            }
+        }
+
+        accepter.wait();
+    }
+
     void testBoostSerialization1()
     {
 #ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
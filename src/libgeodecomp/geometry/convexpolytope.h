@@ -4,9 +4,13 @@
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/plane.h>
-#include <libgeodecomp/misc/random.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
 namespace LibGeoDecomp {
 
 /**
@@ -17,7 +21,6 @@ template<typename COORD, typename ID = int>
 class ConvexPolytope
 {
 public:
-    const static std::size_t SAMPLES = 1000;
     const static int DIM = COORD::DIM;
 
     typedef Plane<COORD, ID> EquationType;
@@ -56,7 +59,9 @@ public:
             bool pointIsBelow1 = ((delta1 * eq.dir) <= 0);
             bool pointIsBelow2 = ((delta2 * eq.dir) <= 0);
 
-            if (pointIsBelow1 || pointIsBelow2) {
+            // planes which merely touch a corner don't cut off
+            // anything and would only yield degenerate neighbors:
+            if (((delta1 * eq.dir) < 0) || ((delta2 * eq.dir) < 0)) {
                 newLimitIsSuperfluous = false;
             }
 
@@ -180,15 +185,7 @@ public:
             return;
         }
 
-        int hits = 0;
-        for (std::size_t i = 0; i < SAMPLES; ++i) {
-            COORD p = COORD(Random::genDouble(delta[0]),
-                            Random::genDouble(delta[1])) + minCoord;
-            if (includes(p)) {
-                ++hits;
-            }
-        }
-        area = 1.0 * hits / SAMPLES * delta.prod();
+        area = polygonArea();
 
         double newDiameter = delta.maxElement();
         if (newDiameter > diameter) {
@@ -205,9 +202,8 @@ public:
     }
 
     /**
-     * The ConvexPolytope's volume is determined via random sampling
-     * integration. Few samples are used, so this method is highly
-     * inaccurate.
+     * Returns the area of the polygon spanned by the cut points, as
+     * computed by updateGeometryData().
      */
     double getVolume() const
     {
@@ -229,6 +225,25 @@ public:
         return diameter;
     }
 
+    /**
+     * Squared distance from the center to the farthest corner. Only
+     * points closer than twice this distance can cut the polytope.
+     */
+    double maxCornerDistance2() const
+    {
+        double ret = 0;
+        for (std::size_t i = 0; i < cutPoints.size(); ++i) {
+            if (cutPoints[i] == farAway<2>()) {
+                return (std::numeric_limits<double>::max)();
+            }
+
+            COORD delta = cutPoints[i] - center;
+            ret = (std::max)(ret, delta * delta);
+        }
+
+        return ret;
+    }
+
 private:
     COORD center;
     COORD simSpaceDim;
@@ -244,6 +259,48 @@ private:
         return Coord<DIM>::diagonal(-1);
     }
 
+    /**
+     * Shoelace formula, applied to the cut points in counterclockwise
+     * order. As the polytope is convex, the points' mean lies within
+     * it and can serve as a reference for sorting them by angle.
+     */
+    double polygonArea() const
+    {
+        std::vector<COORD> corners;
+        // COORD may be integral, hence the mean is kept separately:
+        double meanX = 0;
+        double meanY = 0;
+        for (std::size_t i = 0; i < cutPoints.size(); ++i) {
+            if (cutPoints[i] == farAway<2>()) {
+                continue;
+            }
+            corners << cutPoints[i];
+            meanX += cutPoints[i][0];
+            meanY += cutPoints[i][1];
+        }
+
+        if (corners.size() < 3) {
+            return 0;
+        }
+        meanX /= corners.size();
+        meanY /= corners.size();
+
+        std::vector<std::pair<double, std::size_t> > order;
+        for (std::size_t i = 0; i < corners.size(); ++i) {
+            order << std::make_pair(std::atan2(corners[i][1] - meanY, corners[i][0] - meanX), i);
+        }
+        std::sort(order.begin(), order.end());
+
+        double sum = 0;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const COORD& a = corners[order[i].second];
+            const COORD& b = corners[order[(i + 1) % order.size()].second];
+            sum += double(a[0]) * b[1] - double(a[1]) * b[0];
+        }
+
+        return std::abs(sum) * 0.5;
+    }
+
     static COORD turnLeft90(const COORD& c)
     {
         return COORD(c[1], -c[0]);
@@ -79,6 +79,13 @@ public:
         regions.clear();
         outerGhostZoneFragments.clear();
         innerGhostZoneFragments.clear();
+        partitionRegions.clear();
+        // some partitions share work between nodes, so for them it's
+        // cheaper to fetch all regions at once. Others would have to
+        // walk the whole domain, so we query only the nodes we need:
+        if (partition->batchesRegions()) {
+            partitionRegions = partition->getRegions();
+        }
         fillOwnRegion();
     }
 
@@ -244,6 +251,7 @@ private:
     Region<DIM> outerRim;
     Region<DIM> volatileKernel;
     Region<DIM> innerRim;
+    std::vector<Region<DIM> > partitionRegions;
     RegionVecMap regions;
     RegionVecMap outerGhostZoneFragments;
     RegionVecMap innerGhostZoneFragments;
@@ -268,7 +276,11 @@ private:
     {
         std::vector<Region<DIM> >& regionExpansion = regions[node];
         regionExpansion.resize(getGhostZoneWidth() + 1);
-        regionExpansion[0] = partition->getRegion(node);
+        if (partitionRegions.empty()) {
+            regionExpansion[0] = partition->getRegion(node);
+        } else {
+            regionExpansion[0] = partitionRegions[node];
+        }
         for (std::size_t i = 1; i <= getGhostZoneWidth(); ++i) {
             Region<DIM> expanded;
             const Region<DIM>& reg = regionExpansion[i - 1];
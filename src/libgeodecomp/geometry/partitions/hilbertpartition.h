@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/partitions/spacefillingcurve.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/storage/grid.h>
 #include <iostream>
@@ -252,29 +253,7 @@ public:
             unsigned newOffset = pos - accuSizes[newQuarter];
             Coord<2> newOrigin;
             Coord<2> newDimensions;
-
-            switch (squareSectorTransitions[form][newQuarter]) {
-            case 0:
-                newOrigin = origin;
-                newDimensions = halfDimensions;
-                break;
-            case 1:
-                newOrigin.x() = origin.x() + halfDimensions.x();
-                newOrigin.y() = origin.y();
-                newDimensions.x() = dimensions.x() - halfDimensions.x();
-                newDimensions.y() = halfDimensions.y();
-                break;
-            case 2:
-                newOrigin.x() = origin.x();
-                newOrigin.y() = origin.y() + halfDimensions.y();
-                newDimensions.x() = halfDimensions.x();
-                newDimensions.y() = dimensions.y() - halfDimensions.y();
-                break;
-            case 3:
-                newOrigin = origin + halfDimensions;
-                newDimensions = dimensions - halfDimensions;
-                break;
-            };
+            sector(origin, dimensions, squareSectorTransitions[form][newQuarter], &newOrigin, &newDimensions);
 
             Form newForm = squareFormTransitions[form][newQuarter];
             Square newSquare(newOrigin, newDimensions, 0, newForm);
@@ -331,17 +310,107 @@ public:
 
     inline Region<2> getRegion(const std::size_t node) const
     {
-        return Region<2>(
-            (*this)[startOffsets[node + 0]],
-            (*this)[startOffsets[node + 1]]);
+        BoxLists boxes(1);
+        decomposeSquare(origin, dimensions, LL_TO_LR, 0, node, node + 1, &boxes);
+        return boxesToRegion(boxes[0]);
+    }
+
+    /**
+     * Decomposes the curve once for all nodes, then builds their
+     * Regions in parallel.
+     */
+    std::vector<Region<2> > getRegions() const
+    {
+        BoxLists boxes(weights.size());
+        decomposeSquare(origin, dimensions, LL_TO_LR, 0, 0, weights.size(), &boxes);
+        return boxListsToRegions(boxes);
+    }
+
+    bool batchesRegions() const
+    {
+        return true;
     }
 
 private:
     using SpaceFillingCurve<2>::startOffsets;
+    using SpaceFillingCurve<2>::weights;
 
     Coord<2> origin;
     Coord<2> dimensions;
 
+    /**
+     * Computes origin and dimensions of the given sector (see
+     * squareSectorTransitions) of a square.
+     */
+    static inline void sector(
+        const Coord<2>& origin,
+        const Coord<2>& dimensions,
+        int index,
+        Coord<2> *newOrigin,
+        Coord<2> *newDimensions)
+    {
+        Coord<2> halfDimensions = dimensions / 2;
+
+        switch (index) {
+        case 0:
+            *newOrigin = origin;
+            *newDimensions = halfDimensions;
+            break;
+        case 1:
+            newOrigin->x() = origin.x() + halfDimensions.x();
+            newOrigin->y() = origin.y();
+            newDimensions->x() = dimensions.x() - halfDimensions.x();
+            newDimensions->y() = halfDimensions.y();
+            break;
+        case 2:
+            newOrigin->x() = origin.x();
+            newOrigin->y() = origin.y() + halfDimensions.y();
+            newDimensions->x() = halfDimensions.x();
+            newDimensions->y() = dimensions.y() - halfDimensions.y();
+            break;
+        case 3:
+            *newOrigin = origin + halfDimensions;
+            *newDimensions = dimensions - halfDimensions;
+            break;
+        default:
+            throw std::invalid_argument("illegal sector");
+        };
+    }
+
+    /**
+     * Collects the maximal sub-squares of the given square which
+     * belong to nodes [firstNode, lastNode).
+     */
+    inline void decomposeSquare(
+        const Coord<2>& squareOrigin,
+        const Coord<2>& squareDimensions,
+        Form form,
+        std::size_t squareStart,
+        std::size_t firstNode,
+        std::size_t lastNode,
+        BoxLists *boxes) const
+    {
+        if (addSquare(squareOrigin, squareDimensions, squareStart, firstNode, lastNode, boxes)) {
+            return;
+        }
+
+        for (int quarter = 0; quarter < 4; ++quarter) {
+            Coord<2> newOrigin;
+            Coord<2> newDimensions;
+            sector(squareOrigin, squareDimensions, squareSectorTransitions[form][quarter], &newOrigin, &newDimensions);
+
+            decomposeSquare(
+                newOrigin,
+                newDimensions,
+                squareFormTransitions[form][quarter],
+                squareStart,
+                firstNode,
+                lastNode,
+                boxes);
+            squareStart += volume(newDimensions);
+        }
+    }
+
     static inline bool fillCaches()
     {
         Coord<2> maxDim(17, 17);
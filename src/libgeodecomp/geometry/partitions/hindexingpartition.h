@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/partitions/spacefillingcurve.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/storage/grid.h>
@@ -543,9 +544,11 @@ public:
 
     inline Region<2> getRegion(const std::size_t node) const
     {
-        return Region<2>(
+        RegionBuilder<2> builder;
+        builder.load(
             (*this)[startOffsets[node + 0]],
             (*this)[startOffsets[node + 1]]);
+        return builder.build();
     }
 
     inline Iterator operator[](unsigned pos) const
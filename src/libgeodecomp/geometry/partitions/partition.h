@@ -52,6 +52,31 @@ public:
 
     virtual Region<DIM> getRegion(const std::size_t node) const = 0;
 
+    /**
+     * Returns the Regions of all nodes. Partitions which can share
+     * work between nodes should override this and batchesRegions().
+     */
+    virtual std::vector<Region<DIM> > getRegions() const
+    {
+        std::vector<Region<DIM> > ret(weights.size());
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            ret[i] = getRegion(i);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Tells whether getRegions() is cheap enough to replace a few
+     * getRegion() calls. Otherwise callers which need only some
+     * nodes' Regions (e.g. the PartitionManager, which needs its own
+     * node and its neighbors) should query them one by one.
+     */
+    virtual bool batchesRegions() const
+    {
+        return false;
+    }
+
 protected:
     std::vector<std::size_t> weights;
     std::vector<std::size_t> startOffsets;
@@ -1,10 +1,15 @@
 #ifndef LIBGEODECOMP_GEOMETRY_PARTITIONS_SPACEFILLINGCURVE_H
 #define LIBGEODECOMP_GEOMETRY_PARTITIONS_SPACEFILLINGCURVE_H
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 #include <libgeodecomp/geometry/partitions/partition.h>
 
+#include <algorithm>
+
 namespace LibGeoDecomp {
 
 enum SpaceFillingCurveSublevelState {TRIVIAL, CACHED};
@@ -67,6 +72,146 @@ public:
         const std::vector<std::size_t>& weights) :
         Partition<DIM>(offset, weights)
     {}
+
+    /**
+     * Builds all nodes' Regions in parallel.
+     */
+    virtual std::vector<Region<DIM> > getRegions() const
+    {
+        std::vector<Region<DIM> > ret(weights.size());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < int(weights.size()); ++i) {
+            ret[i] = this->getRegion(i);
+        }
+
+        return ret;
+    }
+
+protected:
+    /**
+     * One list of sub-squares per node, see addSquare().
+     */
+    typedef std::vector<std::vector<CoordBox<DIM> > > BoxLists;
+
+    using Partition<DIM>::startOffsets;
+    using Partition<DIM>::weights;
+
+    static inline std::size_t volume(const Coord<DIM>& dimensions)
+    {
+        std::size_t ret = 1;
+        for (int d = 0; d < DIM; ++d) {
+            ret *= std::size_t(dimensions[d]);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Returns the node within [firstNode, lastNode) which owns the
+     * given position on the curve.
+     */
+    inline std::size_t owner(std::size_t pos, std::size_t firstNode, std::size_t lastNode) const
+    {
+        return std::upper_bound(
+            startOffsets.begin() + firstNode + 1,
+            startOffsets.begin() + lastNode,
+            pos) - startOffsets.begin() - 1;
+    }
+
+    /**
+     * Building a Region by walking the curve cell by cell is slow for
+     * large domains. Instead curves recurse into their sub-squares
+     * and call this function for each one. A square starting at
+     * curve position squareStart is attributed as a whole to
+     * the node owning it (or dropped if none of the nodes in
+     * [firstNode, lastNode) owns any of its cells). Squares that have
+     * degenerated to a line are split among their owners. Returns
+     * false if the square is shared and needs to be subdivided
+     * further.
+     */
+    inline bool addSquare(
+        const Coord<DIM>& origin,
+        const Coord<DIM>& dimensions,
+        std::size_t squareStart,
+        std::size_t firstNode,
+        std::size_t lastNode,
+        BoxLists *boxes) const
+    {
+        std::size_t squareEnd = squareStart + volume(dimensions);
+        std::size_t begin = (std::max)(squareStart, startOffsets[firstNode]);
+        std::size_t end = (std::min)(squareEnd, startOffsets[lastNode]);
+        if (begin >= end) {
+            return true;
+        }
+
+        std::size_t node = owner(begin, firstNode, lastNode);
+        if ((begin == squareStart) && (end == squareEnd) && (squareEnd <= startOffsets[node + 1])) {
+            (*boxes)[node - firstNode] << CoordBox<DIM>(origin, dimensions);
+            return true;
+        }
+
+        if (!Iterator::hasTrivialDimensions(dimensions)) {
+            return false;
+        }
+
+        // trivial squares are traversed along their only non-trivial
+        // dimension:
+        int direction = 0;
+        for (int d = 1; d < DIM; ++d) {
+            if (dimensions[d] > 1) {
+                direction = d;
+            }
+        }
+
+        for (; begin < end; ++node) {
+            std::size_t segmentEnd = (std::min)(end, startOffsets[node + 1]);
+            if (segmentEnd <= begin) {
+                continue;
+            }
+
+            Coord<DIM> segmentOrigin = origin;
+            Coord<DIM> segmentDimensions = dimensions;
+            segmentOrigin[direction] += int(begin - squareStart);
+            segmentDimensions[direction] = int(segmentEnd - begin);
+            (*boxes)[node - firstNode] << CoordBox<DIM>(segmentOrigin, segmentDimensions);
+            begin = segmentEnd;
+        }
+
+        return true;
+    }
+
+    static inline Region<DIM> boxesToRegion(const std::vector<CoordBox<DIM> >& boxes)
+    {
+        std::size_t numStreaks = 0;
+        for (typename std::vector<CoordBox<DIM> >::const_iterator i = boxes.begin(); i != boxes.end(); ++i) {
+            numStreaks += volume(i->dimensions) / std::size_t(i->dimensions.x());
+        }
+
+        RegionBuilder<DIM> builder;
+        builder.reserve(numStreaks);
+        for (typename std::vector<CoordBox<DIM> >::const_iterator i = boxes.begin(); i != boxes.end(); ++i) {
+            builder << *i;
+        }
+
+        return builder.build();
+    }
+
+    static inline std::vector<Region<DIM> > boxListsToRegions(const BoxLists& boxes)
+    {
+        std::vector<Region<DIM> > ret(boxes.size());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < int(boxes.size()); ++i) {
+            ret[i] = boxesToRegion(boxes[i]);
+        }
+
+        return ret;
+    }
 };
 
 }
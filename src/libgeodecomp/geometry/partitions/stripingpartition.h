@@ -34,7 +34,7 @@ public:
         origin(origin),
         dimensions(newDimensions)
     {
-        if (dimensions.prod() == 0) {
+        if (this->volume(dimensions) == 0) {
             // set all dimensions to 1 except for the last one to
             // avoid division by 0 in operator[]
             dimensions = Coord<DIM>::diagonal(1);
@@ -54,11 +54,25 @@ public:
         return Iterator(origin, origin + endOffset, dimensions);
     }
 
+    /**
+     * Emits whole rows instead of walking the stripe cell by cell.
+     * Positions are kept 64 bits wide as grids may well exceed 2^31
+     * cells.
+     */
     inline Region<DIM> getRegion(const std::size_t node) const
     {
-        return Region<DIM>(
-            (*this)[startOffsets[node + 0]],
-            (*this)[startOffsets[node + 1]]);
+        std::size_t end = (std::min)(startOffsets[node + 1], this->volume(dimensions));
+        std::size_t rowLength = dimensions.x();
+        RegionBuilder<DIM> builder;
+
+        for (std::size_t pos = startOffsets[node + 0]; pos < end;) {
+            Coord<DIM> cursor = indexToCoord(pos) + origin;
+            std::size_t length = (std::min)(rowLength - pos % rowLength, end - pos);
+            builder << Streak<DIM>(cursor, cursor.x() + int(length));
+            pos += length;
+        }
+
+        return builder.build();
     }
 
     Iterator operator[](unsigned pos) const
@@ -73,6 +87,21 @@ private:
 
     Coord<DIM> origin;
     Coord<DIM> dimensions;
+
+    /**
+     * Like Coord::indexToCoord(), but safe for indices beyond 2^31.
+     */
+    inline Coord<DIM> indexToCoord(std::size_t index) const
+    {
+        Coord<DIM> ret;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            ret[d] = int(index % std::size_t(dimensions[d]));
+            index /= std::size_t(dimensions[d]);
+        }
+        ret[DIM - 1] = int(index);
+
+        return ret;
+    }
 };
 
 template<typename _CharT, typename _Traits, int _Dim>
@@ -122,6 +122,14 @@ public:
         TS_ASSERT_EQUALS(expected, actual);
     }
 
+    void testGetRegionMatchesIteration()
+    {
+        checkRegions(Coord<2>(10, 20), Coord<2>(4, 4),     0, weights(3, 5));
+        checkRegions(Coord<2>(-3,  5), Coord<2>(37, 91),   7, weights(11, 300));
+        checkRegions(Coord<2>( 0,  0), Coord<2>(600, 350), 3, weights(7, 30000));
+        checkRegions(Coord<2>( 5,  5), Coord<2>(1, 100),  0, weights(4, 30));
+    }
+
     void testLarge()
     {
         Coord<2> offset(10, 20);
@@ -148,6 +156,37 @@ public:
 private:
     HilbertPartition partition;
     CoordVector expected, actual;
+
+    std::vector<std::size_t> weights(std::size_t numNodes, std::size_t weight)
+    {
+        std::vector<std::size_t> ret(numNodes, weight);
+        // nodes may be empty:
+        ret[1] = 0;
+        ret[numNodes - 1] /= 3;
+        return ret;
+    }
+
+    void checkRegions(
+        const Coord<2>& origin,
+        const Coord<2>& dimensions,
+        long offset,
+        const std::vector<std::size_t>& weights)
+    {
+        HilbertPartition curve(origin, dimensions, offset, weights);
+        std::vector<Region<2> > regions = curve.getRegions();
+        TS_ASSERT_EQUALS(weights.size(), regions.size());
+
+        HilbertPartition::Iterator iter = curve[offset];
+        for (std::size_t node = 0; node < weights.size(); ++node) {
+            Region<2> expectedRegion;
+            for (std::size_t i = 0; (i < weights[node]) && (iter != curve.end()); ++i, ++iter) {
+                expectedRegion << *iter;
+            }
+
+            TS_ASSERT_EQUALS(expectedRegion, curve.getRegion(node));
+            TS_ASSERT_EQUALS(expectedRegion, regions[node]);
+        }
+    }
 };
 
 }
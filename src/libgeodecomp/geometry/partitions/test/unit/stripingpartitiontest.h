@@ -102,6 +102,39 @@ public:
         TS_ASSERT_EQUALS(expected, actual);
     }
 
+    void testGetRegionMatchesIterators()
+    {
+        Coord<3> origin(4, 3, 5);
+        Coord<3> dim(7, 5, 6);
+        std::vector<std::size_t> weights;
+        weights << 1 << 12 << 0 << 7 << 40 << 9 << 120 << 21;
+        StripingPartition<3> p(origin, dim, 0, weights);
+        std::vector<Region<3> > regions = p.getRegions();
+        TS_ASSERT_EQUALS(weights.size(), regions.size());
+
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            // the old, cell by cell construction:
+            Region<3> expected(p[unsigned(p.startOffsets[i])], p[unsigned(p.startOffsets[i + 1])]);
+            TS_ASSERT_EQUALS(expected, p.getRegion(i));
+            TS_ASSERT_EQUALS(expected, regions[i]);
+        }
+    }
+
+    void testGetRegionBeyond2GiCells()
+    {
+        Coord<3> dim(4096, 4096, 256);
+        std::size_t start = (std::size_t(1) << 31) + 100;
+        std::vector<std::size_t> weights;
+        weights << start << 8192 << (std::size_t(dim.x()) * dim.y() * dim.z() - start - 8192);
+        StripingPartition<3> p(Coord<3>(), dim, 0, weights);
+
+        Region<3> expected;
+        expected << Streak<3>(Coord<3>(100, 0, 128), 4096)
+                 << Streak<3>(Coord<3>(  0, 1, 128), 4096)
+                 << Streak<3>(Coord<3>(  0, 2, 128),  100);
+        TS_ASSERT_EQUALS(expected, p.getRegion(1));
+    }
+
 private:
     CoordVector  expected;
 };
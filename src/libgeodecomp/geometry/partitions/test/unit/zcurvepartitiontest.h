@@ -179,6 +179,14 @@ public:
         TS_ASSERT_EQUALS(actual2, expected);
     }
 
+    void testGetRegionMatchesIteration()
+    {
+        checkRegions(Coord<2>(10, 20), Coord<2>(4, 4),     0, weights(3, 5));
+        checkRegions(Coord<2>(-3,  5), Coord<2>(37, 91),   7, weights(11, 300));
+        checkRegions(Coord<3>( 1,  2, 3), Coord<3>(20, 33, 17), 0, weights(9, 1100));
+        checkRegions(Coord<3>( 0,  0, 0), Coord<3>(70, 3, 40),  5, weights(6, 1000));
+    }
+
     void test3dLarge2()
     {
         largeTest(Coord<3>(5, 7, 20));
@@ -190,6 +198,38 @@ public:
 private:
     ZCurvePartition<2> partition;
     CoordVector expected, actual;
+
+    std::vector<std::size_t> weights(std::size_t numNodes, std::size_t weight)
+    {
+        std::vector<std::size_t> ret(numNodes, weight);
+        // nodes may be empty:
+        ret[1] = 0;
+        ret[numNodes - 1] /= 3;
+        return ret;
+    }
+
+    template<int DIM>
+    void checkRegions(
+        const Coord<DIM>& origin,
+        const Coord<DIM>& dimensions,
+        long offset,
+        const std::vector<std::size_t>& weights)
+    {
+        ZCurvePartition<DIM> curve(origin, dimensions, offset, weights);
+        std::vector<Region<DIM> > regions = curve.getRegions();
+        TS_ASSERT_EQUALS(weights.size(), regions.size());
+
+        typename ZCurvePartition<DIM>::Iterator iter = curve[offset];
+        for (std::size_t node = 0; node < weights.size(); ++node) {
+            Region<DIM> expectedRegion;
+            for (std::size_t i = 0; (i < weights[node]) && (iter != curve.end()); ++i, ++iter) {
+                expectedRegion << *iter;
+            }
+
+            TS_ASSERT_EQUALS(expectedRegion, curve.getRegion(node));
+            TS_ASSERT_EQUALS(expectedRegion, regions[node]);
+        }
+    }
 };
 
 }
@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/partitions/spacefillingcurve.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/storage/grid.h>
@@ -10,7 +11,7 @@
 #include <bitset>
 #include <sstream>
 #include <stdexcept>
-#include <list>
+#include <vector>
 
 namespace LibGeoDecomp {
 
@@ -98,7 +99,7 @@ public:
             return *this;
         }
     private:
-        std::list<Square> squareStack;
+        std::vector<Square> squareStack;
         unsigned trivialSquareDirDim;
         unsigned trivialSquareCounter;
         Coord<DIM> cachedSquareOrigin;
@@ -183,29 +184,10 @@ public:
 
         inline void digDownRecursion(unsigned offset, Square currentSquare)
         {
-            const Coord<DIM>& dimensions = currentSquare.dimensions;
-            Coord<DIM> halfDimensions = dimensions / 2;
-            Coord<DIM> remainingDimensions = dimensions - halfDimensions;
-
             const int numQuadrants = ZCurvePartition<DIM>::Iterator::NUM_QUADRANTS;
+            Coord<DIM> quadrantOffsets[numQuadrants];
             Coord<DIM> quadrantDims[numQuadrants];
-
-            for (int i = 0; i < numQuadrants; ++i) {
-                // high bits denote that the quadrant is in the upper
-                // half in respect to that dimension, e.g. quadrant 2
-                // would be (for 2D) in the lower half for dimension 0
-                // but in the higher half for dimension 1.
-                std::bitset<DIM> quadrantShift(i);
-                Coord<DIM> quadrantDim;
-
-                for (int d = 0; d < DIM; ++d) {
-                    quadrantDim[d] = quadrantShift[d]?
-                        remainingDimensions[d] :
-                        halfDimensions[d];
-                }
-
-                quadrantDims[i] = quadrantDim;
-            }
+            ZCurvePartition<DIM>::splitSquare(currentSquare.dimensions, quadrantOffsets, quadrantDims);
 
             unsigned accuSizes[numQuadrants];
             accuSizes[0] = 0;
@@ -225,13 +207,7 @@ public:
 
             unsigned newOffset = pos - accuSizes[index];
             Coord<DIM> newDimensions = quadrantDims[index];
-            Coord<DIM> newOrigin;
-
-            std::bitset<DIM> quadrantShift(index);
-            for (int d = 0; d < DIM; ++d) {
-                newOrigin[d] = quadrantShift[d]? halfDimensions[d] : 0;
-            }
-            newOrigin += currentSquare.origin;
+            Coord<DIM> newOrigin = currentSquare.origin + quadrantOffsets[index];
 
             currentSquare.quadrant = index;
             squareStack.push_back(currentSquare);
@@ -304,9 +280,53 @@ public:
 
     inline Region<DIM> getRegion(const std::size_t node) const
     {
-        return Region<DIM>(
-            (*this)[startOffsets[node + 0]],
-            (*this)[startOffsets[node + 1]]);
+        BoxLists boxes(1);
+        decomposeSquare(origin, dimensions, 0, node, node + 1, &boxes);
+        return boxesToRegion(boxes[0]);
+    }
+
+    /**
+     * Decomposes the curve once for all nodes, then builds their
+     * Regions in parallel.
+     */
+    std::vector<Region<DIM> > getRegions() const
+    {
+        BoxLists boxes(weights.size());
+        decomposeSquare(origin, dimensions, 0, 0, weights.size(), &boxes);
+        return boxListsToRegions(boxes);
+    }
+
+    bool batchesRegions() const
+    {
+        return true;
+    }
+
+    /**
+     * Splits a square into its quadrants, in the order in which the
+     * curve visits them. Offsets are relative to the square's origin.
+     */
+    static inline void splitSquare(
+        const Coord<DIM>& dimensions,
+        Coord<DIM> *quadrantOffsets,
+        Coord<DIM> *quadrantDims)
+    {
+        Coord<DIM> halfDimensions = dimensions / 2;
+        Coord<DIM> remainingDimensions = dimensions - halfDimensions;
+
+        for (int i = 0; i < Iterator::NUM_QUADRANTS; ++i) {
+            // high bits denote that the quadrant is in the upper
+            // half in respect to that dimension, e.g. quadrant 2
+            // would be (for 2D) in the lower half for dimension 0
+            // but in the higher half for dimension 1.
+            std::bitset<DIM> quadrantShift(i);
+
+            for (int d = 0; d < DIM; ++d) {
+                quadrantOffsets[i][d] = quadrantShift[d]? halfDimensions[d] : 0;
+                quadrantDims[i][d] = quadrantShift[d]?
+                    remainingDimensions[d] :
+                    halfDimensions[d];
+            }
+        }
     }
 
     static inline bool fillCaches()
@@ -335,7 +355,46 @@ public:
     }
 
 private:
+    using typename SpaceFillingCurve<DIM>::BoxLists;
+    using SpaceFillingCurve<DIM>::addSquare;
+    using SpaceFillingCurve<DIM>::boxesToRegion;
+    using SpaceFillingCurve<DIM>::boxListsToRegions;
     using SpaceFillingCurve<DIM>::startOffsets;
+    using SpaceFillingCurve<DIM>::volume;
+    using SpaceFillingCurve<DIM>::weights;
+
+    /**
+     * Collects the maximal sub-squares of the given square which
+     * belong to nodes [firstNode, lastNode).
+     */
+    inline void decomposeSquare(
+        const Coord<DIM>& squareOrigin,
+        const Coord<DIM>& squareDimensions,
+        std::size_t squareStart,
+        std::size_t firstNode,
+        std::size_t lastNode,
+        BoxLists *boxes) const
+    {
+        if (addSquare(squareOrigin, squareDimensions, squareStart, firstNode, lastNode, boxes)) {
+            return;
+        }
+
+        const int numQuadrants = Iterator::NUM_QUADRANTS;
+        Coord<DIM> quadrantOffsets[numQuadrants];
+        Coord<DIM> quadrantDims[numQuadrants];
+        splitSquare(squareDimensions, quadrantOffsets, quadrantDims);
+
+        for (int i = 0; i < numQuadrants; ++i) {
+            decomposeSquare(
+                squareOrigin + quadrantOffsets[i],
+                quadrantDims[i],
+                squareStart,
+                firstNode,
+                lastNode,
+                boxes);
+            squareStart += volume(quadrantDims[i]);
+        }
+    }
 
     static Cache coordsCache;
     static Coord<DIMENSIONS> maxCachedDimensions;
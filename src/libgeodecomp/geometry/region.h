@@ -16,6 +16,10 @@ template<typename CELL_TYPE, int DIM>
 class BOVOutput;
 
 class RegionTest;
+class RegionCodec;
+
+template<int DIM>
+class RegionBuilder;
 
 namespace RegionHelpers {
 
@@ -584,6 +588,8 @@ class Region
 public:
     friend class BoostSerialization;
     friend class HPXSerialization;
+    friend class CustomSerialization;
+    friend class RegionCodec;
 
     static const int DIM = DIMENSIONS;
 
@@ -591,6 +597,7 @@ public:
     template<int MY_DIM> friend class RegionHelpers::RegionLookupHelper;
     template<int MY_DIM> friend class RegionHelpers::RegionInsertHelper;
     template<int MY_DIM> friend class RegionHelpers::RegionRemoveHelper;
+    template<int MY_DIM> friend class RegionBuilder;
     friend class LibGeoDecomp::RegionTest;
 
     typedef std::pair<int, int> IntPair;
@@ -874,7 +881,9 @@ public:
         std::vector<int> neighbors;
 
         for (unsigned pass = 0; pass < width; ++pass) {
-            Region add;
+            // neighbors arrive in no particular order, so collecting
+            // them first is much cheaper than inserting them one by one:
+            RegionBuilder<DIM> builder;
 
             // walk over all indices and remember adjacent neighbors
             // this is done in a separate pass to ensure that
@@ -889,12 +898,13 @@ public:
                     for (std::vector<int>::const_iterator i = neighbors.begin(); i != neighbors.end(); ++i) {
                         Coord<DIM> c(*i);
                         if (ret.count(c) == 0) {
-                            add << c;
+                            builder << c;
                         }
                     }
                 }
             }
 
+            Region add = builder.build();
             ret += add;
             using std::swap;
             swap(add, newCoords);
@@ -1040,8 +1050,6 @@ public:
      */
     inline Region operator-(const Region& other) const
     {
-        using std::max;
-        using std::min;
         Region ret;
         // these conditionals are less a shortcut but more a guarantee
         // that the derefernce below will succeed:
@@ -1052,49 +1060,7 @@ public:
             return *this;
         }
 
-        StreakIterator myIter = beginStreak();
-        StreakIterator otherIter = other.beginStreak();
-
-        StreakIterator myEnd = endStreak();
-        StreakIterator otherEnd = other.endStreak();
-
-        Streak<DIM> cursor = *myIter;
-
-        for (;;) {
-            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::intersects(cursor, *otherIter)) {
-                int intersectionOriginX = (max)(cursor.origin.x(), otherIter->origin.x());
-                int intersectionEndX = (min)(cursor.endX, otherIter->endX);
-
-                ret << Streak<DIM>(cursor.origin, intersectionOriginX);
-                cursor.origin.x() = intersectionEndX;
-            }
-
-            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(cursor, *otherIter)) {
-                ret << cursor;
-                ++myIter;
-
-                if (myIter == myEnd) {
-                    break;
-                } else {
-                    cursor = *myIter;
-                }
-            } else {
-                ++otherIter;
-                if (otherIter == otherEnd) {
-                    break;
-                }
-            }
-        }
-
-        // don't loose the remainder
-        ret << cursor;
-        if (myIter != myEnd) {
-            ++myIter;
-            for (; myIter != myEnd; ++myIter) {
-                ret << *myIter;
-            }
-        }
-
+        difference(ret, beginStreak(), endStreak(), other.beginStreak(), other.endStreak());
         return ret;
     }
 
@@ -1109,35 +1075,8 @@ public:
      */
     inline Region operator&(const Region& other) const
     {
-        using std::max;
-        using std::min;
         Region ret;
-        StreakIterator myIter = beginStreak();
-        StreakIterator otherIter = other.beginStreak();
-
-        StreakIterator myEnd = endStreak();
-        StreakIterator otherEnd = other.endStreak();
-
-        for (;;) {
-            if ((myIter == myEnd) ||
-                (otherIter == otherEnd)) {
-                break;
-            }
-
-            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::intersects(*myIter, *otherIter)) {
-                Streak<DIM> intersection = *myIter;
-                intersection.origin.x() = (max)(myIter->origin.x(), otherIter->origin.x());
-                intersection.endX = (min)(myIter->endX, otherIter->endX);
-                ret << intersection;
-            }
-
-            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(*myIter, *otherIter)) {
-                ++myIter;
-            } else {
-                ++otherIter;
-            }
-        }
-
+        intersection(ret, beginStreak(), endStreak(), other.beginStreak(), other.endStreak());
         return ret;
     }
 
@@ -1479,8 +1418,110 @@ private:
         return RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(*lastStreakIter, *other.beginStreak());
     }
 
+    /**
+     * Writes all Streaks of [beginA, endA) minus those of [beginB,
+     * endB) to ret, in ascending order. SINK may be a Region or a
+     * RegionBuilder.
+     */
+    template<typename SINK>
+    inline static void difference(
+        SINK& ret,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB)
+    {
+        using std::max;
+        using std::min;
+
+        if (beginA == endA) {
+            return;
+        }
+        if (beginB == endB) {
+            for (StreakIterator i = beginA; i != endA; ++i) {
+                ret << *i;
+            }
+            return;
+        }
+
+        StreakIterator myIter = beginA;
+        StreakIterator otherIter = beginB;
+        Streak<DIM> cursor = *myIter;
+
+        for (;;) {
+            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::intersects(cursor, *otherIter)) {
+                int intersectionOriginX = (max)(cursor.origin.x(), otherIter->origin.x());
+                int intersectionEndX = (min)(cursor.endX, otherIter->endX);
+
+                ret << Streak<DIM>(cursor.origin, intersectionOriginX);
+                cursor.origin.x() = intersectionEndX;
+            }
+
+            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(cursor, *otherIter)) {
+                ret << cursor;
+                ++myIter;
+
+                if (myIter == endA) {
+                    break;
+                } else {
+                    cursor = *myIter;
+                }
+            } else {
+                ++otherIter;
+                if (otherIter == endB) {
+                    break;
+                }
+            }
+        }
+
+        // don't loose the remainder
+        ret << cursor;
+        if (myIter != endA) {
+            ++myIter;
+            for (; myIter != endA; ++myIter) {
+                ret << *myIter;
+            }
+        }
+    }
+
+    /**
+     * Writes the intersection of [beginA, endA) and [beginB, endB)
+     * to ret, see difference().
+     */
+    template<typename SINK>
+    inline static void intersection(
+        SINK& ret,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB)
+    {
+        using std::max;
+        using std::min;
+
+        StreakIterator myIter = beginA;
+        StreakIterator otherIter = beginB;
+
+        for (;;) {
+            if ((myIter == endA) ||
+                (otherIter == endB)) {
+                break;
+            }
+
+            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::intersects(*myIter, *otherIter)) {
+                Streak<DIM> intersection = *myIter;
+                intersection.origin.x() = (max)(myIter->origin.x(), otherIter->origin.x());
+                intersection.endX = (min)(myIter->endX, otherIter->endX);
+                ret << intersection;
+            }
+
+            if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(*myIter, *otherIter)) {
+                ++myIter;
+            } else {
+                ++otherIter;
+            }
+        }
+    }
+
+    template<typename SINK>
     inline static void merge2way(
-        Region& ret,
+        SINK& ret,
         const StreakIterator& beginA, const StreakIterator& endA,
         const StreakIterator& beginB, const StreakIterator& endB)
     {
@@ -2212,5 +2253,6 @@ operator<<(std::basic_ostream<_CharT, _Traits>& __os,
 }
 
 #include <libgeodecomp/io/bovoutput.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 
 #endif
@@ -0,0 +1,386 @@
+#ifndef LIBGEODECOMP_GEOMETRY_REGIONBUILDER_H
+#define LIBGEODECOMP_GEOMETRY_REGIONBUILDER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/region.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace RegionBuilderHelpers {
+
+/**
+ * Orders Streaks the way a Region stores them: by their higher
+ * dimensions first, then by their origin.
+ */
+template<int DIM>
+class StreakLess
+{
+public:
+    inline bool operator()(const Streak<DIM>& a, const Streak<DIM>& b) const
+    {
+        for (int d = DIM - 1; d > 0; --d) {
+            if (a.origin[d] != b.origin[d]) {
+                return a.origin[d] < b.origin[d];
+            }
+        }
+
+        return a.origin.x() < b.origin.x();
+    }
+};
+
+}
+
+/**
+ * Inserting Streaks into a Region one by one is cheap if they arrive
+ * in ascending order, but each out-of-order insert needs to shift the
+ * index vectors, which makes building large Regions from unordered
+ * input quadratic. RegionBuilder instead collects all Streaks, then
+ * sorts and merges them and constructs the index vectors in a single
+ * pass.
+ *
+ * It also provides variants of Region's set operations which split
+ * large Regions along their highest dimension and process the chunks
+ * in parallel via OpenMP.
+ */
+template<int DIM>
+class RegionBuilder
+{
+public:
+    typedef typename Region<DIM>::StreakIterator StreakIterator;
+    typedef RegionBuilderHelpers::StreakLess<DIM> StreakLess;
+
+    /**
+     * Regions with fewer Streaks are not worth the threading overhead.
+     */
+    static const std::size_t PARALLEL_THRESHOLD = 1 << 14;
+
+    RegionBuilder() :
+        sorted(true)
+    {}
+
+    inline RegionBuilder& operator<<(const Streak<DIM>& s)
+    {
+        if (s.endX <= s.origin.x()) {
+            return *this;
+        }
+
+        if (!streaks.empty()) {
+            Streak<DIM>& back = streaks.back();
+            // space-filling curves and the like tend to emit runs of
+            // adjacent Coords, which we coalesce right away:
+            if ((s.origin.x() == back.endX) && sameRow(s, back)) {
+                back.endX = s.endX;
+                return *this;
+            }
+
+            if (sorted && StreakLess()(s, back)) {
+                sorted = false;
+            }
+        }
+        streaks.push_back(s);
+
+        return *this;
+    }
+
+    inline RegionBuilder& operator<<(const Coord<DIM>& c)
+    {
+        return *this << Streak<DIM>(c, c.x() + 1);
+    }
+
+    inline RegionBuilder& operator<<(const CoordBox<DIM>& box)
+    {
+        for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak();
+             i != box.endStreak();
+             ++i) {
+            *this << *i;
+        }
+
+        return *this;
+    }
+
+    template<class ITERATOR1, class ITERATOR2>
+    inline void load(const ITERATOR1& start, const ITERATOR2& end)
+    {
+        for (ITERATOR1 i = start; i != end; ++i) {
+            *this << *i;
+        }
+    }
+
+    inline void reserve(std::size_t numStreaks)
+    {
+        streaks.reserve(numStreaks);
+    }
+
+    inline void clear()
+    {
+        streaks.clear();
+        sorted = true;
+    }
+
+    /**
+     * Number of Streaks collected so far. Overlapping Streaks are
+     * counted individually.
+     */
+    inline std::size_t numStreaks() const
+    {
+        return streaks.size();
+    }
+
+    inline Region<DIM> build()
+    {
+        Region<DIM> ret;
+        build(&ret);
+        return ret;
+    }
+
+    /**
+     * Replaces the contents of target by the union of all collected
+     * Streaks. The builder is left empty.
+     */
+    inline void build(Region<DIM> *target)
+    {
+        target->clear();
+        if (streaks.empty()) {
+            return;
+        }
+
+        if (!sorted) {
+            std::sort(streaks.begin(), streaks.end(), StreakLess());
+        }
+
+        Streak<DIM> current = streaks.front();
+        bool first = true;
+        Streak<DIM> last;
+
+        for (typename std::vector<Streak<DIM> >::const_iterator i = streaks.begin() + 1;
+             i != streaks.end();
+             ++i) {
+            if (sameRow(current, *i) && (i->origin.x() <= current.endX)) {
+                current.endX = (std::max)(current.endX, i->endX);
+                continue;
+            }
+
+            append(target, current, first, last);
+            first = false;
+            last = current;
+            current = *i;
+        }
+
+        append(target, current, first, last);
+        target->geometryCacheTainted = true;
+        clear();
+    }
+
+    /**
+     * Same as a + b.
+     */
+    static Region<DIM> parallelSum(const Region<DIM>& a, const Region<DIM>& b)
+    {
+        if (!isWorthSplitting(a, b)) {
+            return a + b;
+        }
+
+        return parallelOperation(a, b, &mergeChunk);
+    }
+
+    /**
+     * Same as a - b.
+     */
+    static Region<DIM> parallelDifference(const Region<DIM>& a, const Region<DIM>& b)
+    {
+        if (!isWorthSplitting(a, b)) {
+            return a - b;
+        }
+
+        return parallelOperation(a, b, &differenceChunk);
+    }
+
+    /**
+     * Same as a & b.
+     */
+    static Region<DIM> parallelIntersection(const Region<DIM>& a, const Region<DIM>& b)
+    {
+        if (!isWorthSplitting(a, b)) {
+            return a & b;
+        }
+
+        return parallelOperation(a, b, &intersectionChunk);
+    }
+
+private:
+    typedef void (*ChunkOperation)(
+        RegionBuilder *sink,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB);
+
+    std::vector<Streak<DIM> > streaks;
+    bool sorted;
+
+    static inline bool sameRow(const Streak<DIM>& a, const Streak<DIM>& b)
+    {
+        for (int d = 1; d < DIM; ++d) {
+            if (a.origin[d] != b.origin[d]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Appends s to the index vectors of target. s has to be located
+     * behind all Streaks in target and must not touch the previously
+     * appended Streak last.
+     */
+    static inline void append(Region<DIM> *target, const Streak<DIM>& s, bool first, const Streak<DIM>& last)
+    {
+        // the highest dimension in which s leaves the current plane
+        // determines which index vectors need a new entry:
+        int changedDim = first ? DIM - 1 : 0;
+        for (int d = DIM - 1; d > changedDim; --d) {
+            if (s.origin[d] != last.origin[d]) {
+                changedDim = d;
+                break;
+            }
+        }
+
+        for (int d = changedDim; d > 0; --d) {
+            target->indices[d].push_back(std::make_pair(s.origin[d], int(target->indices[d - 1].size())));
+        }
+        target->indices[0].push_back(std::make_pair(s.origin.x(), s.endX));
+    }
+
+    static inline bool isWorthSplitting(const Region<DIM>& a, const Region<DIM>& b)
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        // 1D Regions can't be split along planes, which would be
+        // required to keep the chunks independent.
+        return (DIM > 1) &&
+            (omp_get_max_threads() > 1) &&
+            ((a.numStreaks() + b.numStreaks()) >= PARALLEL_THRESHOLD);
+#else
+        return false;
+#endif
+    }
+
+    static void mergeChunk(
+        RegionBuilder *sink,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB)
+    {
+        Region<DIM>::merge2way(*sink, beginA, endA, beginB, endB);
+    }
+
+    static void differenceChunk(
+        RegionBuilder *sink,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB)
+    {
+        Region<DIM>::difference(*sink, beginA, endA, beginB, endB);
+    }
+
+    static void intersectionChunk(
+        RegionBuilder *sink,
+        const StreakIterator& beginA, const StreakIterator& endA,
+        const StreakIterator& beginB, const StreakIterator& endB)
+    {
+        Region<DIM>::intersection(*sink, beginA, endA, beginB, endB);
+    }
+
+    /**
+     * Returns the iterator pointing to the first Streak whose highest
+     * coordinate is at least coord.
+     */
+    static inline StreakIterator planeBegin(const Region<DIM>& region, int coord)
+    {
+        typename Region<DIM>::IndexVectorType::const_iterator i = std::lower_bound(
+            region.indicesBegin(DIM - 1),
+            region.indicesEnd(DIM - 1),
+            std::make_pair(coord, (std::numeric_limits<int>::min)()));
+
+        return region.planeStreakIterator(std::size_t(i - region.indicesBegin(DIM - 1)));
+    }
+
+    /**
+     * Chunks are delimited by planes (coordinates in the highest
+     * dimension) so no Streak and no overlap between the two
+     * operands crosses a chunk boundary. This also means that the
+     * chunks' results can simply be concatenated.
+     */
+    static Region<DIM> parallelOperation(const Region<DIM>& a, const Region<DIM>& b, ChunkOperation op)
+    {
+        std::vector<int> planes;
+        planes.reserve(a.numPlanes() + b.numPlanes());
+        for (std::size_t i = 0; i < a.numPlanes(); ++i) {
+            planes.push_back(a.indicesAt(DIM - 1, i)->first);
+        }
+        for (std::size_t i = 0; i < b.numPlanes(); ++i) {
+            planes.push_back(b.indicesAt(DIM - 1, i)->first);
+        }
+        std::sort(planes.begin(), planes.end());
+        planes.erase(std::unique(planes.begin(), planes.end()), planes.end());
+
+        int numChunks = 0;
+#ifdef LIBGEODECOMP_WITH_THREADS
+        // oversubscribe to balance unevenly sized planes:
+        numChunks = (std::min)(int(planes.size()), 4 * omp_get_max_threads());
+#endif
+        if (numChunks < 2) {
+            Region<DIM> ret;
+            RegionBuilder builder;
+            op(&builder, a.beginStreak(), a.endStreak(), b.beginStreak(), b.endStreak());
+            builder.build(&ret);
+            return ret;
+        }
+
+        std::vector<int> chunkStarts(numChunks);
+        for (int i = 0; i < numChunks; ++i) {
+            chunkStarts[i] = planes[planes.size() * i / numChunks];
+        }
+
+        std::vector<RegionBuilder> sinks(numChunks);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < numChunks; ++i) {
+            StreakIterator beginA = planeBegin(a, chunkStarts[i]);
+            StreakIterator beginB = planeBegin(b, chunkStarts[i]);
+            StreakIterator endA = (i == (numChunks - 1)) ? a.endStreak() : planeBegin(a, chunkStarts[i + 1]);
+            StreakIterator endB = (i == (numChunks - 1)) ? b.endStreak() : planeBegin(b, chunkStarts[i + 1]);
+
+            op(&sinks[i], beginA, endA, beginB, endB);
+            if (!sinks[i].sorted) {
+                std::sort(sinks[i].streaks.begin(), sinks[i].streaks.end(), StreakLess());
+            }
+        }
+
+        std::size_t numStreaks = 0;
+        for (int i = 0; i < numChunks; ++i) {
+            numStreaks += sinks[i].numStreaks();
+        }
+
+        RegionBuilder builder;
+        builder.reserve(numStreaks);
+        for (int i = 0; i < numChunks; ++i) {
+            builder.streaks.insert(builder.streaks.end(), sinks[i].streaks.begin(), sinks[i].streaks.end());
+            std::vector<Streak<DIM> >().swap(sinks[i].streaks);
+        }
+
+        Region<DIM> ret;
+        builder.build(&ret);
+        return ret;
+    }
+};
+
+}
+
+#endif
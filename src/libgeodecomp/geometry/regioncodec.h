@@ -0,0 +1,305 @@
+#ifndef LIBGEODECOMP_GEOMETRY_REGIONCODEC_H
+#define LIBGEODECOMP_GEOMETRY_REGIONCODEC_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/region.h>
+
+#ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
+#include <libgeodecomp/misc/cudaboostworkaround.h>
+#include <boost/serialization/vector.hpp>
+#endif
+
+#ifdef LIBGEODECOMP_WITH_HPX
+#include <libgeodecomp/misc/cudaboostworkaround.h>
+#include <hpx/runtime/serialization/input_archive.hpp>
+#include <hpx/runtime/serialization/output_archive.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#endif
+
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace RegionCodecHelpers {
+
+inline void putVarint(std::vector<char> *buffer, unsigned long long value)
+{
+    while (value >= 0x80) {
+        buffer->push_back(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer->push_back(char(value));
+}
+
+inline void putSigned(std::vector<char> *buffer, long long value)
+{
+    // zigzag encoding maps small negative numbers to small unsigned ones
+    putVarint(buffer, (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63));
+}
+
+/**
+ * Tells loading from saving archives: Boost archives export this
+ * as a nested type, HPX has dedicated archive classes.
+ */
+template<typename ARCHIVE>
+class IsLoading
+{
+public:
+    static const bool VALUE = ARCHIVE::is_loading::value;
+};
+
+#ifdef LIBGEODECOMP_WITH_HPX
+/**
+ * see above
+ */
+template<>
+class IsLoading<hpx::serialization::input_archive>
+{
+public:
+    static const bool VALUE = true;
+};
+
+/**
+ * see above
+ */
+template<>
+class IsLoading<hpx::serialization::output_archive>
+{
+public:
+    static const bool VALUE = false;
+};
+#endif
+
+/**
+ * Bounds-checked reader for the encoded format.
+ */
+class Reader
+{
+public:
+    Reader(const char *cursor, const char *end) :
+        cursor(cursor),
+        end(end)
+    {}
+
+    unsigned long long getVarint()
+    {
+        unsigned long long ret = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) {
+                throw std::invalid_argument("truncated Region encoding");
+            }
+
+            unsigned char byte = static_cast<unsigned char>(*cursor++);
+            ret |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return ret;
+            }
+        }
+
+        throw std::invalid_argument("malformed varint in Region encoding");
+    }
+
+    long long getSigned()
+    {
+        unsigned long long value = getVarint();
+        return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+    }
+
+    bool done() const
+    {
+        return cursor == end;
+    }
+
+    std::size_t remaining() const
+    {
+        return end - cursor;
+    }
+
+private:
+    const char *cursor;
+    const char *end;
+};
+
+}
+
+/**
+ * Compact wire format for Regions. Plain boxes are stored as origin
+ * and dimensions. All other Regions are stored as their per
+ * dimension index vectors, delta- and varint-encoded, which usually
+ * shrinks them to one or two bytes per entry. Decoding rebuilds the
+ * index vectors directly, which is cheaper than re-inserting Streaks.
+ */
+class RegionCodec
+{
+public:
+    enum Format {
+        EMPTY = 0,
+        BOX = 1,
+        INDICES = 2
+    };
+
+    template<int DIM>
+    static void encode(const Region<DIM>& region, std::vector<char> *buffer)
+    {
+        using RegionCodecHelpers::putSigned;
+        using RegionCodecHelpers::putVarint;
+
+        buffer->clear();
+        putVarint(buffer, DIM);
+
+        if (region.empty()) {
+            putVarint(buffer, EMPTY);
+            return;
+        }
+
+        const CoordBox<DIM>& box = region.boundingBox();
+        if (region.size() == box.size()) {
+            putVarint(buffer, BOX);
+            for (int d = 0; d < DIM; ++d) {
+                putSigned(buffer, box.origin[d]);
+                putVarint(buffer, box.dimensions[d]);
+            }
+            return;
+        }
+
+        putVarint(buffer, INDICES);
+        for (int d = 0; d < DIM; ++d) {
+            const typename Region<DIM>::IndexVectorType& indices = region.indices[d];
+            putVarint(buffer, indices.size());
+
+            long long prevFirst = 0;
+            long long prevSecond = 0;
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                putSigned(buffer, indices[i].first - prevFirst);
+                if (d == 0) {
+                    // streaks: start relative to the previous start, then length
+                    putVarint(buffer, indices[i].second - indices[i].first);
+                } else {
+                    // coordinate and (strictly increasing) offset into the next lower dimension
+                    putVarint(buffer, indices[i].second - prevSecond);
+                }
+
+                prevFirst = indices[i].first;
+                prevSecond = indices[i].second;
+            }
+        }
+    }
+
+    template<int DIM>
+    static void decode(const std::vector<char>& buffer, Region<DIM> *region)
+    {
+        const char *begin = buffer.empty() ? 0 : &buffer[0];
+        decode(begin, begin + buffer.size(), region);
+    }
+
+    /**
+     * Throws std::invalid_argument if the input is malformed.
+     */
+    template<int DIM>
+    static void decode(const char *begin, const char *end, Region<DIM> *region)
+    {
+        try {
+            decodeImplementation(begin, end, region);
+        } catch (...) {
+            region->clear();
+            throw;
+        }
+    }
+
+    /**
+     * FNV-1a hash of an encoded Region, used to identify Regions
+     * which a peer has already received.
+     */
+    static unsigned long long hash(const std::vector<char>& buffer)
+    {
+        unsigned long long ret = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < buffer.size(); ++i) {
+            ret ^= static_cast<unsigned char>(buffer[i]);
+            ret *= 1099511628211ULL;
+        }
+
+        return ret;
+    }
+
+    /**
+     * Hook for the Boost and HPX serializers: ship Regions in the
+     * compact format instead of their raw index vectors.
+     */
+    template<typename ARCHIVE, int DIM>
+    static void serialize(ARCHIVE& archive, Region<DIM>& region)
+    {
+        std::vector<char> buffer;
+        if (!RegionCodecHelpers::IsLoading<ARCHIVE>::VALUE) {
+            encode(region, &buffer);
+        }
+
+        archive & buffer;
+
+        if (RegionCodecHelpers::IsLoading<ARCHIVE>::VALUE) {
+            decode(buffer, &region);
+        }
+    }
+
+private:
+    template<int DIM>
+    static void decodeImplementation(const char *begin, const char *end, Region<DIM> *region)
+    {
+        RegionCodecHelpers::Reader reader(begin, end);
+        region->clear();
+
+        if (reader.getVarint() != DIM) {
+            throw std::invalid_argument("Region encoding has mismatched dimensionality");
+        }
+
+        unsigned long long format = reader.getVarint();
+        if (format == BOX) {
+            CoordBox<DIM> box;
+            for (int d = 0; d < DIM; ++d) {
+                box.origin[d] = reader.getSigned();
+                box.dimensions[d] = reader.getVarint();
+            }
+            *region << box;
+        } else if (format == INDICES) {
+            for (int d = 0; d < DIM; ++d) {
+                typename Region<DIM>::IndexVectorType& indices = region->indices[d];
+                std::size_t lowerSize = (d == 0) ? 0 : region->indices[d - 1].size();
+                std::size_t count = reader.getVarint();
+                // each entry takes at least two bytes
+                if (count > reader.remaining() / 2) {
+                    throw std::invalid_argument("truncated Region encoding");
+                }
+                indices.resize(count);
+
+                long long prevFirst = 0;
+                long long prevSecond = 0;
+                for (std::size_t i = 0; i < indices.size(); ++i) {
+                    indices[i].first = prevFirst + reader.getSigned();
+                    if (d == 0) {
+                        indices[i].second = indices[i].first + reader.getVarint();
+                    } else {
+                        indices[i].second = prevSecond + reader.getVarint();
+                        if ((indices[i].second < 0) || (std::size_t(indices[i].second) >= lowerSize)) {
+                            throw std::invalid_argument("Region encoding has invalid offsets");
+                        }
+                    }
+
+                    prevFirst = indices[i].first;
+                    prevSecond = indices[i].second;
+                }
+            }
+            region->geometryCacheTainted = true;
+        } else if (format != EMPTY) {
+            throw std::invalid_argument("unknown Region encoding");
+        }
+
+        if (!reader.done()) {
+            throw std::invalid_argument("trailing bytes in Region encoding");
+        }
+    }
+};
+
+}
+
+#endif
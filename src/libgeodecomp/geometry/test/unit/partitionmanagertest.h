@@ -6,6 +6,49 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+/**
+ * Counts how often the PartitionManager queries single Regions vs.
+ * all of them at once.
+ */
+class CountingPartition : public StripingPartition<2>
+{
+public:
+    CountingPartition(
+        const Coord<2>& dimensions,
+        const std::vector<std::size_t>& weights,
+        bool batches) :
+        StripingPartition<2>(Coord<2>(), dimensions, 0, weights),
+        batches(batches),
+        singleQueries(0),
+        batchQueries(0)
+    {}
+
+    Region<2> getRegion(const std::size_t node) const
+    {
+        ++singleQueries;
+        return StripingPartition<2>::getRegion(node);
+    }
+
+    std::vector<Region<2> > getRegions() const
+    {
+        ++batchQueries;
+        std::vector<Region<2> > ret;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            ret << StripingPartition<2>::getRegion(i);
+        }
+        return ret;
+    }
+
+    bool batchesRegions() const
+    {
+        return batches;
+    }
+
+    bool batches;
+    mutable int singleQueries;
+    mutable int batchQueries;
+};
+
 class PartitionManagerTest : public CxxTest::TestSuite
 {
 public:
@@ -150,6 +193,47 @@ public:
         TS_ASSERT_EQUALS(expected, partitionManager.getOuterRim());
     }
 
+    void testQueriesOnlyNeededRegionsFromNonBatchingPartitions()
+    {
+        std::vector<std::size_t> weights(100, 4);
+        SharedPtr<CountingPartition>::Type partition(
+            new CountingPartition(Coord<2>(20, 20), weights, false));
+        SharedPtr<AdjacencyManufacturer<2> >::Type dummyAdjacencyManufacturer(new DummyAdjacencyManufacturer<2>);
+
+        PartitionManager<Topologies::Cube<2>::Topology> partitionManager;
+        partitionManager.resetRegions(
+            dummyAdjacencyManufacturer,
+            CoordBox<2>(Coord<2>(), Coord<2>(20, 20)),
+            partition,
+            50,
+            1);
+        TS_ASSERT_EQUALS(1, partition->singleQueries);
+        TS_ASSERT_EQUALS(0, partition->batchQueries);
+
+        checkRegion(partitionManager.getRegion(51, 0), 204, 208, partition);
+        TS_ASSERT_EQUALS(2, partition->singleQueries);
+        TS_ASSERT_EQUALS(0, partition->batchQueries);
+    }
+
+    void testQueriesAllRegionsAtOnceFromBatchingPartitions()
+    {
+        std::vector<std::size_t> weights(100, 4);
+        SharedPtr<CountingPartition>::Type partition(
+            new CountingPartition(Coord<2>(20, 20), weights, true));
+        SharedPtr<AdjacencyManufacturer<2> >::Type dummyAdjacencyManufacturer(new DummyAdjacencyManufacturer<2>);
+
+        PartitionManager<Topologies::Cube<2>::Topology> partitionManager;
+        partitionManager.resetRegions(
+            dummyAdjacencyManufacturer,
+            CoordBox<2>(Coord<2>(), Coord<2>(20, 20)),
+            partition,
+            50,
+            1);
+        checkRegion(partitionManager.getRegion(51, 0), 204, 208, partition);
+        TS_ASSERT_EQUALS(0, partition->singleQueries);
+        TS_ASSERT_EQUALS(1, partition->batchQueries);
+    }
+
     void test3DFirst()
     {
         int ghostZoneWidth = 4;
@@ -0,0 +1,169 @@
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
+#include <libgeodecomp/misc/random.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class RegionBuilderTest : public CxxTest::TestSuite
+{
+public:
+    template<int DIM>
+    Streak<DIM> randomStreak(int maxCoord, int maxLength)
+    {
+        Coord<DIM> origin;
+        for (int d = 0; d < DIM; ++d) {
+            origin[d] = int(Random::genUnsigned(maxCoord)) - maxCoord / 2;
+        }
+
+        return Streak<DIM>(origin, origin.x() + int(Random::genUnsigned(maxLength)));
+    }
+
+    template<int DIM>
+    Region<DIM> randomRegion(int numStreaks, int maxCoord, int maxLength)
+    {
+        RegionBuilder<DIM> builder;
+        for (int i = 0; i < numStreaks; ++i) {
+            builder << randomStreak<DIM>(maxCoord, maxLength);
+        }
+
+        return builder.build();
+    }
+
+    void testEmpty()
+    {
+        RegionBuilder<2> builder;
+        builder << Streak<2>(Coord<2>(10, 10), 10);
+        TS_ASSERT_EQUALS(std::size_t(0), builder.numStreaks());
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(1, 2), 3);
+        builder.build(&region);
+        TS_ASSERT(region.empty());
+        TS_ASSERT_EQUALS(Region<2>(), region);
+    }
+
+    void testOverlappingAndAdjacentStreaks()
+    {
+        RegionBuilder<2> builder;
+        builder << Streak<2>(Coord<2>(10, 5), 20)
+                << Streak<2>(Coord<2>( 0, 7),  3)
+                << Streak<2>(Coord<2>(15, 5), 30)
+                << Streak<2>(Coord<2>(30, 5), 35)
+                << Streak<2>(Coord<2>(40, 5), 45)
+                << Coord<2>(3, 7);
+
+        Region<2> expected;
+        expected << Streak<2>(Coord<2>(10, 5), 35)
+                 << Streak<2>(Coord<2>(40, 5), 45)
+                 << Streak<2>(Coord<2>( 0, 7),  4);
+
+        Region<2> actual = builder.build();
+        TS_ASSERT_EQUALS(expected, actual);
+        TS_ASSERT_EQUALS(expected.size(), actual.size());
+        TS_ASSERT_EQUALS(expected.boundingBox(), actual.boundingBox());
+        TS_ASSERT_EQUALS(std::size_t(0), builder.numStreaks());
+    }
+
+    void testRandomMatchesRegionInsert()
+    {
+        for (int run = 0; run < 10; ++run) {
+            Region<1> expected1;
+            Region<2> expected2;
+            Region<3> expected3;
+            RegionBuilder<1> builder1;
+            RegionBuilder<2> builder2;
+            RegionBuilder<3> builder3;
+
+            for (int i = 0; i < 300; ++i) {
+                Streak<1> s1 = randomStreak<1>(1000, 20);
+                Streak<2> s2 = randomStreak<2>(50, 20);
+                Streak<3> s3 = randomStreak<3>(20, 10);
+                expected1 << s1;
+                expected2 << s2;
+                expected3 << s3;
+                builder1 << s1;
+                builder2 << s2;
+                builder3 << s3;
+            }
+
+            Region<1> actual1 = builder1.build();
+            Region<2> actual2 = builder2.build();
+            Region<3> actual3 = builder3.build();
+            TS_ASSERT_EQUALS(expected1, actual1);
+            TS_ASSERT_EQUALS(expected2, actual2);
+            TS_ASSERT_EQUALS(expected3, actual3);
+            TS_ASSERT_EQUALS(expected3.size(), actual3.size());
+            TS_ASSERT_EQUALS(expected3.boundingBox(), actual3.boundingBox());
+
+            // the resulting Regions must be fully functional:
+            TS_ASSERT((actual3 - expected3).empty());
+            TS_ASSERT_EQUALS(expected2, actual2 + expected2);
+        }
+    }
+
+    void testBox()
+    {
+        CoordBox<3> box(Coord<3>(-5, 10, 20), Coord<3>(30, 20, 10));
+        RegionBuilder<3> builder;
+        // insert the Coords backwards to defeat the ordered shortcut:
+        for (int z = 29; z >= 20; --z) {
+            for (int y = 29; y >= 10; --y) {
+                for (int x = 24; x >= -5; --x) {
+                    builder << Coord<3>(x, y, z);
+                }
+            }
+        }
+
+        Region<3> expected;
+        expected << box;
+        TS_ASSERT_EQUALS(expected, builder.build());
+    }
+
+    void testParallelOperations()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        int numThreads = omp_get_max_threads();
+        omp_set_num_threads(4);
+#endif
+
+        // large enough to exceed RegionBuilder::PARALLEL_THRESHOLD:
+        Region<2> a2 = randomRegion<2>(20000, 2000, 10);
+        Region<2> b2 = randomRegion<2>(20000, 2000, 10);
+        Region<3> a3 = randomRegion<3>(30000,  60, 10);
+        Region<3> b3 = randomRegion<3>(30000,  60, 10);
+        TS_ASSERT_LESS_THAN_EQUALS(RegionBuilder<2>::PARALLEL_THRESHOLD, a2.numStreaks() + b2.numStreaks());
+        TS_ASSERT_LESS_THAN_EQUALS(RegionBuilder<3>::PARALLEL_THRESHOLD, a3.numStreaks() + b3.numStreaks());
+
+        TS_ASSERT_EQUALS(a2 + b2, RegionBuilder<2>::parallelSum(a2, b2));
+        TS_ASSERT_EQUALS(a2 - b2, RegionBuilder<2>::parallelDifference(a2, b2));
+        TS_ASSERT_EQUALS(a2 & b2, RegionBuilder<2>::parallelIntersection(a2, b2));
+        TS_ASSERT_EQUALS(a3 + b3, RegionBuilder<3>::parallelSum(a3, b3));
+        TS_ASSERT_EQUALS(a3 - b3, RegionBuilder<3>::parallelDifference(a3, b3));
+        TS_ASSERT_EQUALS(a3 & b3, RegionBuilder<3>::parallelIntersection(a3, b3));
+
+        Region<3> empty;
+        TS_ASSERT_EQUALS(a3, RegionBuilder<3>::parallelSum(a3, empty));
+        TS_ASSERT_EQUALS(a3, RegionBuilder<3>::parallelDifference(a3, empty));
+        TS_ASSERT(RegionBuilder<3>::parallelIntersection(empty, a3).empty());
+
+        // operands that only partially overlap in their highest dimension:
+        Region<3> c3 = a3;
+        c3 >> CoordBox<3>(Coord<3>(-100, -100, -100), Coord<3>(200, 200, 100));
+        TS_ASSERT_EQUALS(b3 - c3, RegionBuilder<3>::parallelDifference(b3, c3));
+        TS_ASSERT_EQUALS(c3 & b3, RegionBuilder<3>::parallelIntersection(c3, b3));
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+        omp_set_num_threads(numThreads);
+#endif
+    }
+};
+
+}
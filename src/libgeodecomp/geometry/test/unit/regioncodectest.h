@@ -0,0 +1,191 @@
+#include <libgeodecomp/config.h>
+
+#ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
+#include <libgeodecomp/communication/boostserialization.h>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#endif
+
+#include <libgeodecomp/geometry/regioncodec.h>
+#include <libgeodecomp/misc/random.h>
+
+#include <sstream>
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class RegionCodecTest : public CxxTest::TestSuite
+{
+public:
+    template<int DIM>
+    Region<DIM> roundTrip(const Region<DIM>& region)
+    {
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+
+        Region<DIM> ret;
+        RegionCodec::decode(buffer, &ret);
+        return ret;
+    }
+
+    void testEmpty()
+    {
+        Region<2> region;
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+        TS_ASSERT_EQUALS(std::size_t(2), buffer.size());
+
+        Region<2> decoded;
+        decoded << Streak<2>(Coord<2>(1, 2), 3);
+        RegionCodec::decode(buffer, &decoded);
+        TS_ASSERT(decoded.empty());
+    }
+
+    void testBox()
+    {
+        CoordBox<3> box(Coord<3>(-10, 20, 30), Coord<3>(400, 500, 600));
+        Region<3> region;
+        region << box;
+
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+        // dimension, format, 3x origin, 3x dimensions:
+        TS_ASSERT_LESS_THAN_EQUALS(buffer.size(), std::size_t(2 + 6 * 2));
+
+        Region<3> decoded = roundTrip(region);
+        TS_ASSERT_EQUALS(region, decoded);
+        TS_ASSERT_EQUALS(box, decoded.boundingBox());
+        TS_ASSERT_EQUALS(region.size(), decoded.size());
+    }
+
+    void testIrregular1D()
+    {
+        Region<1> region;
+        region << Streak<1>(Coord<1>(-5), 10)
+               << Streak<1>(Coord<1>(20), 30)
+               << Streak<1>(Coord<1>(1000000), 1000001);
+
+        Region<1> decoded = roundTrip(region);
+        TS_ASSERT_EQUALS(region, decoded);
+        TS_ASSERT_EQUALS(region.boundingBox(), decoded.boundingBox());
+        TS_ASSERT_EQUALS(region.size(), decoded.size());
+    }
+
+    void testIrregular2D()
+    {
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(0, 0), Coord<2>(100, 50))
+               << Streak<2>(Coord<2>(-30, -20), -10)
+               << Streak<2>(Coord<2>(200, 60), 210);
+        region >> CoordBox<2>(Coord<2>(10, 10), Coord<2>(20, 20));
+
+        Region<2> decoded = roundTrip(region);
+        TS_ASSERT_EQUALS(region, decoded);
+        TS_ASSERT_EQUALS(region.boundingBox(), decoded.boundingBox());
+        TS_ASSERT_EQUALS(region.size(), decoded.size());
+        TS_ASSERT_EQUALS(region.numStreaks(), decoded.numStreaks());
+    }
+
+    void testRandom3D()
+    {
+        for (int run = 0; run < 10; ++run) {
+            Region<3> region;
+            for (int i = 0; i < 200; ++i) {
+                Coord<3> origin(
+                    int(Random::genUnsigned(500)) - 250,
+                    Random::genUnsigned(100),
+                    Random::genUnsigned(100));
+                region << Streak<3>(origin, origin.x() + 1 + Random::genUnsigned(50));
+            }
+
+            Region<3> decoded = roundTrip(region);
+            TS_ASSERT_EQUALS(region, decoded);
+            TS_ASSERT_EQUALS(region.size(), decoded.size());
+
+            // the decoded Region must be fully functional:
+            Region<3> sum = decoded + region;
+            TS_ASSERT_EQUALS(region, sum);
+            TS_ASSERT((decoded - region).empty());
+        }
+    }
+
+    void testCompactness()
+    {
+        Region<2> region;
+        for (int y = 0; y < 1000; ++y) {
+            region << Streak<2>(Coord<2>(1000 + y, y), 1100 + y);
+        }
+
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+        std::size_t rawSize = region.numStreaks() * sizeof(Streak<2>);
+        TS_ASSERT_LESS_THAN(buffer.size() * 2, rawSize);
+    }
+
+    void testHash()
+    {
+        Region<2> a;
+        a << Streak<2>(Coord<2>(10, 20), 30);
+        Region<2> b = a;
+        b << Streak<2>(Coord<2>(10, 21), 30);
+
+        std::vector<char> bufferA;
+        std::vector<char> bufferA2;
+        std::vector<char> bufferB;
+        RegionCodec::encode(a, &bufferA);
+        RegionCodec::encode(a, &bufferA2);
+        RegionCodec::encode(b, &bufferB);
+
+        TS_ASSERT_EQUALS(RegionCodec::hash(bufferA), RegionCodec::hash(bufferA2));
+        TS_ASSERT_DIFFERS(RegionCodec::hash(bufferA), RegionCodec::hash(bufferB));
+    }
+
+    void testMalformedInput()
+    {
+        Region<2> region;
+        region << Streak<2>(Coord<2>(10, 20), 30)
+               << Streak<2>(Coord<2>(10, 25), 30);
+
+        std::vector<char> buffer;
+        RegionCodec::encode(region, &buffer);
+
+        Region<2> decoded;
+        std::vector<char> truncated(buffer.begin(), buffer.end() - 1);
+        TS_ASSERT_THROWS(RegionCodec::decode(truncated, &decoded), std::invalid_argument&);
+        TS_ASSERT(decoded.empty());
+
+        std::vector<char> trailing = buffer;
+        trailing.push_back(0);
+        TS_ASSERT_THROWS(RegionCodec::decode(trailing, &decoded), std::invalid_argument&);
+
+        Region<3> wrongDim;
+        TS_ASSERT_THROWS(RegionCodec::decode(buffer, &wrongDim), std::invalid_argument&);
+    }
+
+    void testSerializationWithBoostSerialization()
+    {
+#ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
+        Region<2> region;
+        region << Streak<2>(Coord<2>(10, 20), 30)
+               << Streak<2>(Coord<2>(11, 21), 31)
+               << CoordBox<2>(Coord<2>(-100, 40), Coord<2>(10, 5));
+        Region<2> decoded;
+
+        std::stringstream buf;
+        {
+            boost::archive::text_oarchive archive(buf);
+            archive << region;
+        }
+        {
+            boost::archive::text_iarchive archive(buf);
+            archive >> decoded;
+        }
+        TS_ASSERT_EQUALS(region, decoded);
+        TS_ASSERT_EQUALS(region.boundingBox(), decoded.boundingBox());
+#endif
+    }
+};
+
+}
@@ -62,7 +62,8 @@ public:
 
     virtual void addCell(ContainerCellType *container, const FloatCoord<DIM>& center)
     {
-        container->insert(cellCounter++, DummyCell(center));
+        int id = cellCounter++;
+        container->insert(id, DummyCell(center, id));
     }
 
     int cellCounter;
@@ -92,24 +93,8 @@ public:
         Coord<2> dim(5, 3);
         CoordBox<2> box(Coord<2>(), dim);
         FloatCoord<2> quadrantSize(100, 100);
-        double minCellDistance = 20;
         Grid<ContainerCellType> grid(dim);
-        MockMesher mesher(dim, quadrantSize, minCellDistance);
-
-        for (int y = 0; y < dim.y(); ++y) {
-            for (int x = 0; x < dim.x(); ++x) {
-                Coord<2> c(x, y);
-
-                for (int subY = 0; subY < 4; ++subY) {
-                    for (int subX = 0; subX < 4; ++subX) {
-                        FloatCoord<2> realPos(
-                            x * quadrantSize[0] + subX * 25.0,
-                            y * quadrantSize[1] + subY * 25.0);
-                        mesher.addCell(&grid[c], realPos);
-                    }
-                }
-            }
-        }
+        MockMesher mesher = initLattice(&grid, dim, quadrantSize);
 
         mesher.fillGeometryData(&grid);
 
@@ -126,6 +111,55 @@ public:
                 TS_ASSERT(j->area > 0);
             }
         }
+
+        // elements in the interior are squares of 25x25, bordering
+        // on their 4 direct neighbors only:
+        ContainerCellType cell = grid[Coord<2>(2, 1)];
+        for (ContainerCellType::Iterator j = cell.begin(); j != cell.end(); ++j) {
+            TS_ASSERT_DELTA(625.0, j->area, 1e-6);
+            TS_ASSERT_EQUALS(std::size_t(4), j->numberOfNeighbors());
+
+            for (std::size_t k = 0; k < j->neighborIDs.size(); ++k) {
+                TS_ASSERT_DIFFERS(j->id, j->neighborIDs[k]);
+                TS_ASSERT_DELTA(25.0, j->neighborBoundaryLengths[k], 1e-6);
+            }
+        }
+    }
+
+    void testFillGeometryDataForRegion()
+    {
+        Coord<2> dim(6, 5);
+        FloatCoord<2> quadrantSize(100, 100);
+        Grid<ContainerCellType> grid1(dim);
+        Grid<ContainerCellType> grid2(dim);
+        MockMesher mesher1 = initLattice(&grid1, dim, quadrantSize);
+        MockMesher mesher2 = initLattice(&grid2, dim, quadrantSize);
+
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(1, 1), Coord<2>(3, 2))
+               << Coord<2>(5, 4);
+        mesher1.fillGeometryData(&grid1);
+        mesher2.fillGeometryData(&grid2, region);
+
+        CoordBox<2> box = grid1.boundingBox();
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            ContainerCellType cell1 = grid1[*i];
+            ContainerCellType cell2 = grid2[*i];
+            TS_ASSERT_EQUALS(cell1.size(), cell2.size());
+
+            for (std::size_t j = 0; j < cell1.size(); ++j) {
+                const DummyCell& element1 = *(cell1.begin() + j);
+                const DummyCell& element2 = *(cell2.begin() + j);
+
+                if (region.count(*i)) {
+                    TS_ASSERT_EQUALS(element1.shape, element2.shape);
+                    TS_ASSERT_EQUALS(element1.area, element2.area);
+                    TS_ASSERT_EQUALS(element1.neighborIDs, element2.neighborIDs);
+                } else {
+                    TS_ASSERT_EQUALS(std::size_t(0), element2.shape.size());
+                }
+            }
+        }
     }
 
     void testAddRandomCells()
@@ -183,6 +217,28 @@ public:
         mesher.addRandomCells(&grid, Coord<2>(0, 0), numCells);
     }
 
+private:
+    MockMesher initLattice(Grid<ContainerCellType> *grid, const Coord<2>& dim, const FloatCoord<2>& quadrantSize)
+    {
+        MockMesher mesher(dim, quadrantSize, 20);
+
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                Coord<2> c(x, y);
+
+                for (int subY = 0; subY < 4; ++subY) {
+                    for (int subX = 0; subX < 4; ++subX) {
+                        FloatCoord<2> realPos(
+                            x * quadrantSize[0] + subX * 25.0,
+                            y * quadrantSize[1] + subY * 25.0);
+                        mesher.addCell(&(*grid)[c], realPos);
+                    }
+                }
+            }
+        }
+
+        return mesher;
+    }
 };
 
 }
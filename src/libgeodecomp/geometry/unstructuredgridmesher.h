@@ -1,6 +1,8 @@
 #ifndef LIBGEODECOMP_GEOMETRY_UNSTRUCTUREDGRIDMESHER_H
 #define LIBGEODECOMP_GEOMETRY_UNSTRUCTUREDGRIDMESHER_H
 
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/floatcoord.h>
 #include <cmath>
 
 namespace LibGeoDecomp {
@@ -86,14 +88,37 @@ private:
         minCoord = points[0];
         maxCoord = points[0];
 
-        for (std::size_t i = 0; i < points.size(); ++i) {
-            for (typename CoordsArrayType::const_iterator j = neighbors[i].begin(); j != neighbors[i].end(); ++j) {
-                FloatCoord<DIM> delta = (points[i] - points[*j]).abs();
-                maxDelta = (maxDelta.max)(delta);
+        // each thread reduces its share of the points, the partial
+        // results get merged afterwards:
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            FloatCoord<DIM> localMaxDelta;
+            FloatCoord<DIM> localMinCoord = points[0];
+            FloatCoord<DIM> localMaxCoord = points[0];
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(static)
+#endif
+            for (long i = 0; i < long(points.size()); ++i) {
+                for (typename CoordsArrayType::const_iterator j = neighbors[i].begin(); j != neighbors[i].end(); ++j) {
+                    FloatCoord<DIM> delta = (points[i] - points[*j]).abs();
+                    localMaxDelta = (localMaxDelta.max)(delta);
+                }
+
+                localMinCoord = (localMinCoord.min)(points[i]);
+                localMaxCoord = (localMaxCoord.max)(points[i]);
             }
 
-            minCoord = (minCoord.min)(points[i]);
-            maxCoord = (maxCoord.max)(points[i]);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+            {
+                maxDelta = (maxDelta.max)(localMaxDelta);
+                minCoord = (minCoord.min)(localMinCoord);
+                maxCoord = (maxCoord.max)(localMaxCoord);
+            }
         }
 
         gridDim = maxCoord - minCoord;
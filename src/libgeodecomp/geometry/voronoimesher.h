@@ -1,15 +1,22 @@
 #ifndef LIBGEODECOMP_GEOMETRY_VORONOIMESHER_H
 #define LIBGEODECOMP_GEOMETRY_VORONOIMESHER_H
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/geometry/convexpolytope.h>
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/plane.h>
+#include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <algorithm>
+#include <map>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace LibGeoDecomp {
 
@@ -80,71 +87,213 @@ public:
     void fillGeometryData(GridType *grid)
     {
         CoordBox<DIM> box = grid->boundingBox();
-        FloatCoord<DIM> simSpaceDim = quadrantSize.scale(box.dimensions);
-        // statistics:
-        std::size_t maxShape = 0;
-        std::size_t maxNeighbors = 0;
-        std::size_t maxCells = 0;
-        double maxDiameter = 0;
-
-        for (typename CoordBox<DIM>::Iterator iter = box.begin(); iter != box.end(); ++iter) {
-            Coord<2> containerCoord = *iter;
-            ContainerCellType container = grid->get(containerCoord);
-            maxCells = (std::max)(maxCells, container.size());
-
-            for (typename ContainerCellType::Iterator i = container.begin(); i != container.end(); ++i) {
-                Cargo& cell = *i;
-                ElementType e(cell.center, simSpaceDim);
-                for (int y = -1; y < 2; ++y) {
-                    for (int x = -1; x < 2; ++x) {
-                        ContainerCellType container2 =
-                            grid->get(containerCoord + Coord<2>(x, y));
-                        for (typename ContainerCellType::Iterator j = container2.begin();
-                             j != container2.end();
-                             ++j) {
-                            if (cell.center != j->center) {
-                                e << std::make_pair(j->center, i->id);
-                            }
-                        }
-                    }
-                }
+        Region<DIM> region;
+        region << box;
+        fillGeometryData(grid, region, quadrantSize.scale(box.dimensions));
+    }
 
-                e.updateGeometryData();
-                if (e.getDiameter() > quadrantSize.minElement()) {
-                    throw std::logic_error("element geometry too large for container cell");
-                }
+    /**
+     * Computes the elements of those container cells in region only,
+     * e.g. a node's part of the simulation space in a distributed
+     * setup. The centers of all elements in the container cells
+     * surrounding region (halo width 1) need to be present in grid,
+     * too. The simulation space is assumed to span gridDim quadrants.
+     */
+    void fillGeometryData(GridType *grid, const Region<DIM>& region)
+    {
+        fillGeometryData(grid, region, quadrantSize.scale(gridDim));
+    }
 
-                cell.setArea(e.getVolume());
-                cell.setShape(e.getShape());
+    virtual void addCell(ContainerCellType *container, const FloatCoord<DIM>& center) = 0;
 
-                for (typename std::vector<EquationType>::const_iterator l = e.getLimits().begin();
-                     l != e.getLimits().end();
-                     ++l) {
-                    cell.pushNeighbor(l->neighborID, l->length, l->dir);
-                }
+protected:
+    typedef typename APITraits::SelectCoordType<CONTAINER_CELL>::Value CoordType;
+    typedef typename APITraits::SelectIDType<CONTAINER_CELL>::Value IDType;
+    typedef std::vector<std::pair<CoordType, IDType> > CandidateVec;
+    typedef std::map<Coord<DIM>, CandidateVec> CandidateMap;
+
+    /**
+     * Mesh statistics, only used for logging.
+     */
+    class Statistics
+    {
+    public:
+        Statistics() :
+            maxShape(0),
+            maxNeighbors(0),
+            maxCells(0),
+            maxDiameter(0)
+        {}
+
+        void merge(const Statistics& other)
+        {
+            maxShape     = (std::max)(maxShape,     other.maxShape);
+            maxNeighbors = (std::max)(maxNeighbors, other.maxNeighbors);
+            maxCells     = (std::max)(maxCells,     other.maxCells);
+            maxDiameter  = (std::max)(maxDiameter,  other.maxDiameter);
+        }
 
-                maxShape     = (std::max)(maxShape,     cell.shape.size());
-                maxNeighbors = (std::max)(maxNeighbors, cell.numberOfNeighbors());
-                maxDiameter  = (std::max)(maxDiameter,  e.getDiameter());
+        std::size_t maxShape;
+        std::size_t maxNeighbors;
+        std::size_t maxCells;
+        double maxDiameter;
+    };
+
+    Coord<DIM> gridDim;
+    FloatCoord<DIM> quadrantSize;
+    double minCellDistance;
+
+    /**
+     * Container cells are meshed in parallel. All reads from and
+     * writes to grid happen serially though, as GridBase
+     * implementations aren't required to be thread-safe.
+     */
+    void fillGeometryData(GridType *grid, const Region<DIM>& region, const CoordType& simSpaceDim)
+    {
+        CandidateMap centers;
+        Region<DIM> halo = region.expand(1);
+        for (typename Region<DIM>::Iterator i = halo.begin(); i != halo.end(); ++i) {
+            ContainerCellType container = grid->get(*i);
+            CandidateVec& candidates = centers[*i];
+            for (typename ContainerCellType::Iterator j = container.begin(); j != container.end(); ++j) {
+                candidates << std::make_pair(j->center, j->id);
             }
+        }
 
-            grid->set(containerCoord, container);
+        std::vector<Coord<DIM> > coords;
+        std::vector<ContainerCellType> containers;
+        coords.reserve(region.size());
+        containers.reserve(region.size());
+        for (typename Region<DIM>::Iterator i = region.begin(); i != region.end(); ++i) {
+            coords << *i;
+            containers << grid->get(*i);
+        }
+
+        Statistics statistics;
+        std::string error;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            // scratch space, reused for all container cells of a thread:
+            CandidateVec candidates;
+            std::vector<std::pair<double, std::size_t> > order;
+            Statistics localStatistics;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic)
+#endif
+            for (long i = 0; i < long(coords.size()); ++i) {
+                try {
+                    fillContainer(
+                        &containers[i], coords[i], centers, simSpaceDim,
+                        &candidates, &order, &localStatistics);
+                } catch (const std::exception& e) {
+                    // exceptions must not escape OpenMP threads:
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+                    {
+                        if (error.empty()) {
+                            error = e.what();
+                        }
+                    }
+                }
+            }
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+            statistics.merge(localStatistics);
+        }
+
+        if (!error.empty()) {
+            throw std::logic_error(error);
+        }
+
+        for (std::size_t i = 0; i < coords.size(); ++i) {
+            grid->set(coords[i], containers[i]);
         }
 
         LOG(DBG,
-            "VoronoiMesher::fillGeometryData(maxShape: " << maxShape
-            << ", maxNeighbors: " << maxNeighbors
-            << ", maxDiameter: " << maxDiameter
-            << ", maxCells: " << maxCells << ")");
+            "VoronoiMesher::fillGeometryData(maxShape: " << statistics.maxShape
+            << ", maxNeighbors: " << statistics.maxNeighbors
+            << ", maxDiameter: " << statistics.maxDiameter
+            << ", maxCells: " << statistics.maxCells << ")");
     }
 
-    virtual void addCell(ContainerCellType *container, const FloatCoord<DIM>& center) = 0;
+    /**
+     * Candidates are inserted into an element in the order of their
+     * distance, which quickly shrinks it to its final shape. Once the
+     * remaining candidates are farther away than twice the distance
+     * of the element's farthest corner, their bisectors can't cut the
+     * element anymore and we can skip them.
+     */
+    void fillContainer(
+        ContainerCellType *container,
+        const Coord<DIM>& coord,
+        const CandidateMap& centers,
+        const CoordType& simSpaceDim,
+        CandidateVec *candidates,
+        std::vector<std::pair<double, std::size_t> > *order,
+        Statistics *statistics)
+    {
+        candidates->clear();
+        CoordBox<DIM> box(coord - Coord<DIM>::diagonal(1), Coord<DIM>::diagonal(3));
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            typename CandidateMap::const_iterator iter = centers.find(*i);
+            if (iter != centers.end()) {
+                candidates->insert(candidates->end(), iter->second.begin(), iter->second.end());
+            }
+        }
 
-protected:
-    Coord<DIM> gridDim;
-    FloatCoord<DIM> quadrantSize;
-    double minCellDistance;
+        statistics->maxCells = (std::max)(statistics->maxCells, container->size());
+
+        for (typename ContainerCellType::Iterator i = container->begin(); i != container->end(); ++i) {
+            Cargo& cell = *i;
+
+            order->clear();
+            for (std::size_t j = 0; j < candidates->size(); ++j) {
+                CoordType delta = (*candidates)[j].first - cell.center;
+                *order << std::make_pair(delta * delta, j);
+            }
+            std::sort(order->begin(), order->end());
 
+            ElementType e(cell.center, simSpaceDim);
+            for (std::size_t j = 0; j < order->size(); ++j) {
+                double distance2 = (*order)[j].first;
+                if (distance2 == 0) {
+                    continue;
+                }
+                // some slack so we still catch bisectors which merely
+                // touch a corner, despite rounding errors:
+                if (distance2 > (4 * (1 + 1e-9) * e.maxCornerDistance2())) {
+                    break;
+                }
+
+                e << (*candidates)[(*order)[j].second];
+            }
+
+            e.updateGeometryData();
+            if (e.getDiameter() > quadrantSize.minElement()) {
+                throw std::logic_error("element geometry too large for container cell");
+            }
+
+            cell.setArea(e.getVolume());
+            cell.setShape(e.getShape());
+
+            for (typename std::vector<EquationType>::const_iterator l = e.getLimits().begin();
+                 l != e.getLimits().end();
+                 ++l) {
+                cell.pushNeighbor(l->neighborID, l->length, l->dir);
+            }
+
+            statistics->maxShape     = (std::max)(statistics->maxShape,     cell.shape.size());
+            statistics->maxNeighbors = (std::max)(statistics->maxNeighbors, cell.numberOfNeighbors());
+            statistics->maxDiameter  = (std::max)(statistics->maxDiameter,  e.getDiameter());
+        }
+    }
 
     FloatCoord<DIM> randCoord()
     {
@@ -0,0 +1,128 @@
+#ifndef LIBGEODECOMP_IO_ASYNCPARALLELWRITER_H
+#define LIBGEODECOMP_IO_ASYNCPARALLELWRITER_H
+
+#include <libgeodecomp/io/asyncwriter.h>
+#include <libgeodecomp/io/parallelwriter.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Counterpart of AsyncWriter for ParallelWriters: stepFinished()
+ * only copies the selected members within validRegion, the delegate
+ * is called back on a background thread.
+ *
+ * Beware: delegates which communicate (e.g. via MPI IO or
+ * collectives) would do so from the background thread, concurrently
+ * with the simulator. Only use this with delegates that write
+ * node-local data, unless your MPI implementation provides
+ * MPI_THREAD_MULTIPLE.
+ */
+template<typename CELL_TYPE>
+class AsyncParallelWriter :
+        public ParallelWriter<CELL_TYPE>,
+        private AsyncWriterHelpers::SnapshotConsumer<CELL_TYPE, ParallelWriter<CELL_TYPE>::Topology::DIM>
+{
+public:
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+    typedef AsyncWriterHelpers::SnapshotPipeline<CELL_TYPE> Pipeline;
+    typedef typename Pipeline::SnapshotType SnapshotType;
+
+    static const int DIM = Topology::DIM;
+
+    AsyncParallelWriter(
+        ParallelWriter<CELL_TYPE> *delegate,
+        const std::vector<Selector<CELL_TYPE> >& selectors,
+        std::size_t queueDepth = 2) :
+        ParallelWriter<CELL_TYPE>(delegate->getPrefix(), delegate->getPeriod()),
+        delegate(delegate),
+        selectors(selectors),
+        pipeline(this, selectors, queueDepth)
+    {}
+
+    AsyncParallelWriter(
+        ParallelWriter<CELL_TYPE> *delegate,
+        const Selector<CELL_TYPE>& selector,
+        std::size_t queueDepth = 2) :
+        ParallelWriter<CELL_TYPE>(delegate->getPrefix(), delegate->getPeriod()),
+        delegate(delegate),
+        selectors(1, selector),
+        pipeline(this, selectors, queueDepth)
+    {}
+
+    virtual ~AsyncParallelWriter()
+    {
+        pipeline.shutdown();
+    }
+
+    virtual ParallelWriter<CELL_TYPE> *clone() const
+    {
+        return new AsyncParallelWriter(delegate->clone(), selectors, pipeline.queueDepth());
+    }
+
+    /**
+     * Pending steps are flushed first as the delegate must not see
+     * the new region while still writing data from the old one.
+     */
+    virtual void setRegion(const Region<DIM>& newRegion)
+    {
+        pipeline.flush();
+        ParallelWriter<CELL_TYPE>::setRegion(newRegion);
+        delegate->setRegion(newRegion);
+    }
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        SnapshotType *snapshot = pipeline.acquire();
+        snapshot->globalDimensions = globalDimensions;
+        snapshot->step = step;
+        snapshot->event = event;
+        snapshot->rank = rank;
+        snapshot->lastCall = lastCall;
+        pipeline.capture(grid, grid.boundingBox(), validRegion, snapshot);
+        pipeline.submit(snapshot);
+
+        if ((event == WRITER_ALL_DONE) && lastCall) {
+            pipeline.flush();
+        }
+    }
+
+    /**
+     * blocks until the delegate has processed all pending steps.
+     */
+    void flush()
+    {
+        pipeline.flush();
+    }
+
+private:
+    typename SharedPtr<ParallelWriter<CELL_TYPE> >::Type delegate;
+    std::vector<Selector<CELL_TYPE> > selectors;
+    Pipeline pipeline;
+
+    AsyncParallelWriter(const AsyncParallelWriter& other);
+    AsyncParallelWriter& operator=(const AsyncParallelWriter& other);
+
+    virtual void consume(const GridType& grid, const SnapshotType& snapshot)
+    {
+        delegate->stepFinished(
+            grid,
+            snapshot.region,
+            snapshot.globalDimensions,
+            snapshot.step,
+            snapshot.event,
+            snapshot.rank,
+            snapshot.lastCall);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,412 @@
+#ifndef LIBGEODECOMP_IO_ASYNCWRITER_H
+#define LIBGEODECOMP_IO_ASYNCWRITER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/io/writer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/gridtypeselector.h>
+#include <libgeodecomp/storage/selector.h>
+
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace LibGeoDecomp {
+
+namespace AsyncWriterHelpers {
+
+/**
+ * Holds a copy of the selected members of a grid, along with all
+ * meta data required to hand it to a Writer or ParallelWriter at a
+ * later time. Instances are recycled by the SnapshotPipeline, so
+ * the member buffers only need to grow once.
+ */
+template<typename CELL, int DIM>
+class Snapshot
+{
+public:
+    std::vector<std::vector<char> > members;
+    CELL edge;
+    CoordBox<DIM> box;
+    Region<DIM> region;
+    Coord<DIM> globalDimensions;
+    unsigned step;
+    WriterEvent event;
+    std::size_t rank;
+    bool lastCall;
+};
+
+/**
+ * Callback interface for the final stage of the SnapshotPipeline.
+ * consume() is invoked on the pipeline's worker thread.
+ */
+template<typename CELL, int DIM>
+class SnapshotConsumer
+{
+public:
+    virtual ~SnapshotConsumer()
+    {}
+
+    virtual void consume(const GridBase<CELL, DIM>& grid, const Snapshot<CELL, DIM>& snapshot) = 0;
+};
+
+/**
+ * Decouples output from the simulation: capture() copies the
+ * selected members of the grid into one of queueDepth recycled
+ * Snapshots, submit() enqueues it for a background thread, which
+ * rebuilds a grid from it and passes it on to the SnapshotConsumer.
+ * If all Snapshots are in flight, acquire() blocks until the worker
+ * has released one, so a slow consumer throttles the simulation
+ * instead of exhausting memory.
+ *
+ * Exceptions thrown by the consumer are caught on the worker thread
+ * and rethrown from the next call to acquire() or flush(). Without
+ * LIBGEODECOMP_WITH_THREADS snapshots are processed synchronously in
+ * submit().
+ */
+template<typename CELL>
+class SnapshotPipeline
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL>::Value Topology;
+    static const int DIM = Topology::DIM;
+    typedef typename APITraits::SelectSoA<CELL>::Value SupportsSoA;
+    typedef typename GridTypeSelector<CELL, Topology, false, SupportsSoA>::Value StorageGridType;
+    typedef Snapshot<CELL, DIM> SnapshotType;
+
+    SnapshotPipeline(
+        SnapshotConsumer<CELL, DIM> *consumer,
+        const std::vector<Selector<CELL> >& selectors,
+        std::size_t queueDepth) :
+        consumer(consumer),
+        selectors(selectors),
+        snapshots(queueDepth)
+#ifdef LIBGEODECOMP_WITH_THREADS
+        ,
+        busy(false),
+        stop(false)
+#endif
+    {
+        if (queueDepth == 0) {
+            throw std::invalid_argument("queue depth must be positive");
+        }
+
+        for (std::size_t i = 0; i < snapshots.size(); ++i) {
+            snapshots[i].members.resize(selectors.size());
+            freeSnapshots.push_back(&snapshots[i]);
+        }
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+        worker = std::thread(&SnapshotPipeline::run, this);
+#endif
+    }
+
+    ~SnapshotPipeline()
+    {
+        shutdown();
+    }
+
+    std::size_t queueDepth() const
+    {
+        return snapshots.size();
+    }
+
+    /**
+     * returns an unused Snapshot, blocks while none is available.
+     */
+    SnapshotType *acquire()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        std::unique_lock<std::mutex> lock(mutex);
+        while (freeSnapshots.empty() && !error) {
+            snapshotReleased.wait(lock);
+        }
+#endif
+        rethrowError();
+
+        SnapshotType *snapshot = freeSnapshots.back();
+        freeSnapshots.pop_back();
+        return snapshot;
+    }
+
+    /**
+     * Copies the selected members of all cells in region from grid
+     * to snapshot. This is the only part of the output which is paid
+     * for by the caller.
+     */
+    void capture(
+        const GridBase<CELL, DIM>& grid,
+        const CoordBox<DIM>& box,
+        const Region<DIM>& region,
+        SnapshotType *snapshot)
+    {
+        snapshot->edge = grid.getEdge();
+        snapshot->box = box;
+        snapshot->region = region;
+
+        for (std::size_t i = 0; i < selectors.size(); ++i) {
+            std::vector<char>& buffer = snapshot->members[i];
+            buffer.resize(region.size() * selectors[i].sizeOfExternal());
+            if (buffer.empty()) {
+                continue;
+            }
+
+            grid.saveMemberUnchecked(&buffer[0], MemoryLocation::HOST, selectors[i], region);
+        }
+    }
+
+    void submit(SnapshotType *snapshot)
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(snapshot);
+        snapshotQueued.notify_one();
+#else
+        process(snapshot);
+        freeSnapshots.push_back(snapshot);
+        rethrowError();
+#endif
+    }
+
+    /**
+     * blocks until all submitted Snapshots have been consumed.
+     */
+    void flush()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!queue.empty() || busy) {
+            snapshotReleased.wait(lock);
+        }
+#endif
+        rethrowError();
+    }
+
+    /**
+     * Drains the queue and terminates the worker. Errors raised
+     * during the final Snapshots are dropped as this is called from
+     * destructors.
+     */
+    void shutdown()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+            snapshotQueued.notify_one();
+        }
+
+        if (worker.joinable()) {
+            worker.join();
+        }
+#endif
+    }
+
+private:
+    SnapshotConsumer<CELL, DIM> *consumer;
+    std::vector<Selector<CELL> > selectors;
+    std::vector<SnapshotType> snapshots;
+    std::vector<SnapshotType*> freeSnapshots;
+    StorageGridType storage;
+    std::exception_ptr error;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+    std::deque<SnapshotType*> queue;
+    std::mutex mutex;
+    std::condition_variable snapshotQueued;
+    std::condition_variable snapshotReleased;
+    std::thread worker;
+    bool busy;
+    bool stop;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (;;) {
+            while (queue.empty() && !stop) {
+                snapshotQueued.wait(lock);
+            }
+            if (queue.empty()) {
+                return;
+            }
+
+            SnapshotType *snapshot = queue.front();
+            queue.pop_front();
+            busy = true;
+            bool skip = bool(error);
+
+            lock.unlock();
+            if (!skip) {
+                process(snapshot);
+            }
+            lock.lock();
+
+            busy = false;
+            freeSnapshots.push_back(snapshot);
+            snapshotReleased.notify_all();
+        }
+    }
+#endif
+
+    /**
+     * Rebuilds a grid from the snapshot. Only the selected members
+     * of the cells hold meaningful values.
+     */
+    void process(SnapshotType *snapshot)
+    {
+        try {
+            if ((storage.boundingBox() != snapshot->box) ||
+                (storage.topologicalDimensions() != snapshot->globalDimensions)) {
+                storage = StorageGridType(
+                    snapshot->box,
+                    CELL(),
+                    snapshot->edge,
+                    snapshot->globalDimensions);
+            }
+            storage.setEdge(snapshot->edge);
+
+            for (std::size_t i = 0; i < selectors.size(); ++i) {
+                if (snapshot->members[i].empty()) {
+                    continue;
+                }
+
+                storage.loadMemberUnchecked(
+                    &snapshot->members[i][0],
+                    MemoryLocation::HOST,
+                    selectors[i],
+                    snapshot->region);
+            }
+
+            consumer->consume(storage, *snapshot);
+        } catch (...) {
+#ifdef LIBGEODECOMP_WITH_THREADS
+            std::lock_guard<std::mutex> lock(mutex);
+#endif
+            error = std::current_exception();
+        }
+    }
+
+    /**
+     * expects the mutex to be held by the caller.
+     */
+    void rethrowError()
+    {
+        if (error) {
+            std::exception_ptr e = error;
+            error = std::exception_ptr();
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+}
+
+/**
+ * AsyncWriter moves the actual output of a Writer off the simulation
+ * thread: in stepFinished() it merely copies the selected members of
+ * the grid into a recycled buffer. Encoding and file IO are then
+ * carried out by the delegate on a background thread, operating on a
+ * grid rebuilt from these members. At most queueDepth steps may be in
+ * flight; beyond that stepFinished() blocks until the delegate has
+ * caught up.
+ *
+ * Caveat: the delegate may only access the selected members, all
+ * others are undefined. The output is complete once the simulation
+ * returns, as WRITER_ALL_DONE flushes the queue.
+ */
+template<typename CELL_TYPE>
+class AsyncWriter :
+        public Writer<CELL_TYPE>,
+        private AsyncWriterHelpers::SnapshotConsumer<CELL_TYPE, Writer<CELL_TYPE>::DIM>
+{
+public:
+    typedef typename Writer<CELL_TYPE>::GridType GridType;
+    typedef AsyncWriterHelpers::SnapshotPipeline<CELL_TYPE> Pipeline;
+    typedef typename Pipeline::SnapshotType SnapshotType;
+
+    static const int DIM = Writer<CELL_TYPE>::DIM;
+
+    AsyncWriter(
+        Writer<CELL_TYPE> *delegate,
+        const std::vector<Selector<CELL_TYPE> >& selectors,
+        std::size_t queueDepth = 2) :
+        Writer<CELL_TYPE>(delegate->getPrefix(), delegate->getPeriod()),
+        delegate(delegate),
+        selectors(selectors),
+        pipeline(this, selectors, queueDepth)
+    {}
+
+    AsyncWriter(
+        Writer<CELL_TYPE> *delegate,
+        const Selector<CELL_TYPE>& selector,
+        std::size_t queueDepth = 2) :
+        Writer<CELL_TYPE>(delegate->getPrefix(), delegate->getPeriod()),
+        delegate(delegate),
+        selectors(1, selector),
+        pipeline(this, selectors, queueDepth)
+    {}
+
+    virtual ~AsyncWriter()
+    {
+        pipeline.shutdown();
+    }
+
+    virtual Writer<CELL_TYPE> *clone() const
+    {
+        return new AsyncWriter(delegate->clone(), selectors, pipeline.queueDepth());
+    }
+
+    virtual void stepFinished(const GridType& grid, unsigned step, WriterEvent event)
+    {
+        CoordBox<DIM> box = grid.boundingBox();
+        if (box != region.boundingBox()) {
+            region.clear();
+            region << box;
+        }
+
+        SnapshotType *snapshot = pipeline.acquire();
+        snapshot->globalDimensions = box.dimensions;
+        snapshot->step = step;
+        snapshot->event = event;
+        pipeline.capture(grid, box, region, snapshot);
+        pipeline.submit(snapshot);
+
+        if (event == WRITER_ALL_DONE) {
+            pipeline.flush();
+        }
+    }
+
+    /**
+     * blocks until the delegate has processed all pending steps.
+     */
+    void flush()
+    {
+        pipeline.flush();
+    }
+
+private:
+    typename SharedPtr<Writer<CELL_TYPE> >::Type delegate;
+    std::vector<Selector<CELL_TYPE> > selectors;
+    Region<DIM> region;
+    Pipeline pipeline;
+
+    AsyncWriter(const AsyncWriter& other);
+    AsyncWriter& operator=(const AsyncWriter& other);
+
+    virtual void consume(const GridType& grid, const SnapshotType& snapshot)
+    {
+        delegate->stepFinished(grid, snapshot.step, snapshot.event);
+    }
+};
+
+}
+
+#endif
@@ -5,10 +5,12 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 
 #include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/geometry/regioncodec.h>
 #include <libgeodecomp/io/parallelwriter.h>
 #include <libgeodecomp/misc/clonable.h>
-#include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/gridtypeselector.h>
 
 namespace LibGeoDecomp {
 
@@ -17,6 +19,12 @@ namespace LibGeoDecomp {
  * together with a DistributedSimulator. Good for testing, but doesn't
  * scale, as all memory is concentrated on one node and IO is
  * serialized to that node. Use with care!
+ *
+ * The root learns the size of all contributions via a single gather,
+ * then receives from all other processes concurrently and unpacks
+ * their data while the remaining transfers are still in flight.
+ * Regions are sent in RegionCodec's compact format, and only if
+ * they differ from the one the root received last time.
  */
 template<typename CELL_TYPE>
 class CollectingWriter : public Clonable<ParallelWriter<CELL_TYPE>, CollectingWriter<CELL_TYPE> >
@@ -70,59 +78,127 @@ public:
         SerializationBuffer<CELL_TYPE>::resize(&buffer, validRegion);
         grid.saveRegion(&buffer, validRegion);
 
-        if (mpiLayer.rank() == root) {
-            if (globalGrid.boundingBox().dimensions != globalDimensions) {
-                Region<DIM> region;
-                region << CoordBox<DIM>(Coord<DIM>(), globalDimensions);
-                globalGrid = StorageGridType(region);
-            }
+        RegionCodec::encode(validRegion, &regionBuffer);
+        // size of the encoded Region (0 if the root already has it)
+        // and number of buffer elements per process:
+        Coord<2> lengths((regionBuffer == sentRegion) ? 0 : regionBuffer.size(), buffer.size());
+        std::vector<Coord<2> > allLengths = mpiLayer.gather(lengths, root);
 
-            globalGrid.loadRegion(buffer, validRegion);
-            globalGrid.setEdge(grid.getEdge());
-        }
-
-        for (int sender = 0; sender < mpiLayer.size(); ++sender) {
-            if (sender != root) {
-                if (mpiLayer.rank() == root) {
-                    Region<DIM> recvRegion;
-                    mpiLayer.recvRegion(&recvRegion, sender);
-                    SerializationBuffer<CELL_TYPE>::resize(&buffer, recvRegion);
-
-                    mpiLayer.recv(
-                        buffer.data(),
-                        sender,
-                        buffer.size(),
-                        MPILayer::COLLECTING_WRITER,
-                        SerializationBuffer<CELL_TYPE>::cellMPIDataType());
-                    mpiLayer.waitAll();
-                    globalGrid.loadRegion(buffer, recvRegion);
-                }
-                if (mpiLayer.rank() == sender) {
-                    mpiLayer.sendRegion(validRegion, root);
+        if (mpiLayer.rank() != root) {
+            if (lengths.y() > 0) {
+                if (lengths.x() > 0) {
+                    std::swap(sentRegion, regionBuffer);
                     mpiLayer.send(
-                        buffer.data(),
+                        &sentRegion[0],
                         root,
-                        buffer.size(),
-                        MPILayer::COLLECTING_WRITER,
-                        SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+                        sentRegion.size(),
+                        REGION_TAG,
+                        MPI_CHAR);
                 }
+                mpiLayer.send(
+                    buffer.data(),
+                    root,
+                    buffer.size(),
+                    BUFFER_TAG,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType());
             }
+            mpiLayer.waitAll();
+            return;
         }
 
-        mpiLayer.waitAll();
+        if (globalGrid.boundingBox().dimensions != globalDimensions) {
+            Region<DIM> region;
+            region << CoordBox<DIM>(Coord<DIM>(), globalDimensions);
+            globalGrid = StorageGridType(region);
+        }
+
+        receiveAll(allLengths);
+
+        globalGrid.loadRegion(buffer, validRegion);
+        globalGrid.setEdge(grid.getEdge());
+        unpackAll();
 
-        if (lastCall && (mpiLayer.rank() == root)) {
+        if (lastCall) {
             writer->stepFinished(globalGrid, step, event);
         }
     }
 
 private:
+    static const int REGION_TAG = MPILayer::COLLECTING_WRITER;
+    static const int BUFFER_TAG = MPILayer::COLLECTING_WRITER + 1;
+
     typename SharedPtr<Writer<CELL_TYPE> >::Type writer;
     MPILayer mpiLayer;
     int root;
     StorageGridType globalGrid;
     BufferType buffer;
     MPI_Datatype datatype;
+    std::vector<char> regionBuffer;
+    std::vector<char> sentRegion;
+    std::vector<int> senders;
+    std::vector<std::vector<char> > senderRegionBuffers;
+    std::vector<Region<DIM> > senderRegions;
+    std::vector<BufferType> senderBuffers;
+
+    /**
+     * Posts receives for all senders at once so that transfers may
+     * proceed concurrently instead of one rank after another.
+     */
+    void receiveAll(const std::vector<Coord<2> >& allLengths)
+    {
+        senders.clear();
+        senderRegionBuffers.resize(allLengths.size());
+        senderRegions.resize(allLengths.size());
+        senderBuffers.resize(allLengths.size());
+
+        for (int sender = 0; sender < int(allLengths.size()); ++sender) {
+            if ((sender == root) || (allLengths[sender].y() == 0)) {
+                continue;
+            }
+
+            // a length of 0 means we may reuse the sender's previous Region:
+            senderRegionBuffers[sender].resize(allLengths[sender].x());
+            if (allLengths[sender].x() > 0) {
+                mpiLayer.recv(
+                    &senderRegionBuffers[sender][0],
+                    sender,
+                    senderRegionBuffers[sender].size(),
+                    REGION_TAG,
+                    MPI_CHAR);
+            }
+
+            senderBuffers[sender].resize(allLengths[sender].y());
+            mpiLayer.recv(
+                senderBuffers[sender].data(),
+                sender,
+                senderBuffers[sender].size(),
+                BUFFER_TAG,
+                SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+            senders << sender;
+        }
+    }
+
+    /**
+     * Copies the received buffers to the global grid in the order in
+     * which they arrive.
+     */
+    void unpackAll()
+    {
+        mpiLayer.wait(REGION_TAG);
+
+        for (std::size_t i = 0; i < senders.size(); ++i) {
+            int sender = senders[mpiLayer.waitAny(BUFFER_TAG)];
+            if (!senderRegionBuffers[sender].empty()) {
+                RegionCodec::decode(senderRegionBuffers[sender], &senderRegions[sender]);
+            }
+            globalGrid.loadRegion(senderBuffers[sender], senderRegions[sender]);
+
+            // release memory early, as the root might be tight on memory:
+            BufferType().swap(senderBuffers[sender]);
+        }
+
+        mpiLayer.wait(BUFFER_TAG);
+    }
 };
 
 }
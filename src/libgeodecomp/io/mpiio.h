@@ -4,16 +4,174 @@
 #define LIBGEODECOMP_IO_MPIIO_H
 
 #include <mpi.h>
+#include <algorithm>
+#include <limits>
 
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/communication/typemaps.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/loadbalancer/randombalancer.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
 
 namespace LibGeoDecomp {
 
+namespace MPIIOHelpers {
+
+/**
+ * Maps a Region to the cells it covers in a snapshot file. Streaks
+ * are normalized and split at the wrap-around of the x-axis, sorted
+ * by their offset in the file, and merged into contiguous blocks.
+ * Unless mergeRows is set (which is only valid for cell types
+ * without padding, see MPIIO), blocks don't span multiple rows.
+ * Collective I/O needs this as MPI file views have to be
+ * monotonically non-decreasing and must not overlap when writing.
+ */
+template<int DIM, typename TOPOLOGY>
+class FileLayout
+{
+public:
+    class Piece
+    {
+    public:
+        Piece(std::size_t fileIndex, const Streak<DIM>& streak) :
+            fileIndex(fileIndex),
+            streak(streak),
+            bufferIndex(0)
+        {}
+
+        bool operator<(const Piece& other) const
+        {
+            return fileIndex < other.fileIndex;
+        }
+
+        std::size_t fileIndex;
+        Streak<DIM> streak;
+        std::size_t bufferIndex;
+    };
+
+    FileLayout(const Region<DIM>& region, const Coord<DIM>& dimensions, bool mergeRows) :
+        bufferSize(0),
+        rowLength(dimensions.x())
+    {
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak();
+             i != region.endStreak();
+             ++i) {
+            addStreak(*i, dimensions);
+        }
+        std::sort(pieces.begin(), pieces.end());
+
+        for (typename std::vector<Piece>::iterator i = pieces.begin(); i != pieces.end(); ++i) {
+            std::size_t length = i->streak.length();
+            bool merge = !blockOffsets.empty() &&
+                (i->fileIndex <= (blockOffsets.back() + blockLengths.back())) &&
+                (mergeRows || ((i->fileIndex / rowLength) == (blockOffsets.back() / rowLength))) &&
+                ((i->fileIndex + length - blockOffsets.back()) < std::size_t(std::numeric_limits<int>::max()));
+
+            if (merge) {
+                std::size_t newEnd = (std::max)(
+                    blockOffsets.back() + blockLengths.back(),
+                    i->fileIndex + length);
+                bufferSize -= blockLengths.back();
+                blockLengths.back() = newEnd - blockOffsets.back();
+                bufferSize += blockLengths.back();
+            } else {
+                blockOffsets << i->fileIndex;
+                blockLengths << length;
+                blockBufferIndices << bufferSize;
+                bufferSize += length;
+            }
+
+            i->bufferIndex = blockBufferIndices.back() + i->fileIndex - blockOffsets.back();
+        }
+    }
+
+    /**
+     * Yields a file type which selects all blocks of this layout
+     * from a file whose rows start at slots which are cellLength
+     * bytes apart and hold their cells' packed data (cellSize bytes
+     * each). Needs to be freed by the caller.
+     */
+    MPI_Datatype fileType(int cellSize, MPI_Aint cellLength) const
+    {
+        MPI_Datatype packedCell;
+        MPI_Type_contiguous(cellSize, MPI_BYTE, &packedCell);
+
+        std::vector<int> lengths(blockLengths.size());
+        std::vector<MPI_Aint> displacements(blockOffsets.size());
+        for (std::size_t i = 0; i < blockOffsets.size(); ++i) {
+            lengths[i] = blockLengths[i];
+            std::size_t x = blockOffsets[i] % rowLength;
+            displacements[i] = MPI_Aint(blockOffsets[i] - x) * cellLength + MPI_Aint(x) * cellSize;
+        }
+
+        MPI_Datatype ret;
+        MPI_Type_create_hindexed(
+            int(lengths.size()),
+            lengths.empty() ? 0 : &lengths[0],
+            displacements.empty() ? 0 : &displacements[0],
+            packedCell,
+            &ret);
+        MPI_Type_commit(&ret);
+        MPI_Type_free(&packedCell);
+        return ret;
+    }
+
+    std::vector<Piece> pieces;
+    std::vector<std::size_t> blockOffsets;
+    std::vector<std::size_t> blockLengths;
+    std::vector<std::size_t> blockBufferIndices;
+    std::size_t bufferSize;
+
+private:
+    std::size_t rowLength;
+
+    void addStreak(const Streak<DIM>& streak, const Coord<DIM>& dimensions)
+    {
+        // the coords need to be normalized because on torus
+        // topologies the coordnates may exceed the bounding box
+        // (especially negative coordnates may occurr). Streaks are
+        // split wherever they wrap around the x-axis.
+        Coord<DIM> coord = TOPOLOGY::normalize(streak.origin, dimensions);
+        Coord<DIM> origin = streak.origin;
+        int remainder = streak.length();
+
+        while (remainder > 0) {
+            int length = remainder;
+            if (TOPOLOGY::wrapsAxis(0)) {
+                length = (std::min)(length, dimensions.x() - coord.x());
+            }
+
+            pieces << Piece(coord.toIndex(dimensions), Streak<DIM>(origin, origin.x() + length));
+            remainder -= length;
+            origin.x() += length;
+            coord.x() = 0;
+        }
+    }
+};
+
+}
+
 /**
  * Utility class which bundles common MPI-based input/output code.
+ *
+ * Snapshots consist of a header (grid dimensions, current time
+ * step, maximum number of time steps, and the edge cell) which is
+ * followed by the cells in row-major order. Each row starts at the
+ * slot of its first cell (slots being as wide as the extent of the
+ * cells' MPI datatype) and holds the packed data of its cells. For
+ * cell types without padding this is a plain array of cells. Types
+ * with padding leave a gap at the end of each row, just like
+ * snapshots written by previous versions from Regions of whole rows
+ * (e.g. by MPIIOWriter), so these remain readable.
+ *
+ * Each operation comes in two flavors: readRegion() and
+ * writeRegion() access each streak of the Region individually,
+ * which is fine for small, serial runs. readRegionCollectively() and
+ * writeRegionCollectively() describe the Region as an MPI file view
+ * and transfer it with a single collective call, which lets the MPI
+ * implementation aggregate requests (two-phase I/O) instead of
+ * flooding the file system with tiny requests. These need to be
+ * called by all processes in the communicator.
  */
 template<
     typename CELL_TYPE,
@@ -51,7 +209,7 @@ public:
             Coord<DIM> coord = TOPOLOGY::normalize(i->origin, dimensions);
             MPI_File_seek(
                 file,
-                offset(headerLength, coord, dimensions, cellLength),
+                offset(headerLength, coord, dimensions, cellLength, mpiDatatype),
                 MPI_SEEK_SET);
             int length = i->endX - i->origin.x();
             std::vector<CELL_TYPE> vec(length);
@@ -63,6 +221,49 @@ public:
         MPI_File_close(&file);
     }
 
+    template<typename GRID_TYPE, int DIM>
+    void readRegionCollectively(
+        GRID_TYPE *grid,
+        const std::string& filename,
+        const Region<DIM>& region,
+        const MPI_Comm& comm = MPI_COMM_WORLD,
+        const MPI_Datatype& mpiDatatype = Typemaps::lookup<CELL_TYPE>())
+    {
+        MPI_File file = openFileForRead(filename, comm);
+        MPI_Aint headerLength;
+        MPI_Aint cellLength;
+        getLengths<DIM>(&headerLength, &cellLength, mpiDatatype);
+
+        Coord<DIM> dimensions;
+        MPI_File_read_at_all(
+            file, 0, &dimensions, 1, Typemaps::lookup<Coord<DIM> >(), MPI_STATUS_IGNORE);
+        // edge cell is the last element of the header:
+        CELL_TYPE cell;
+        MPI_File_read_at_all(
+            file, headerLength - cellLength, &cell, 1, mpiDatatype, MPI_STATUS_IGNORE);
+        grid->setEdge(cell);
+
+        MPIIOHelpers::FileLayout<DIM, TOPOLOGY> layout(
+            region, dimensions, isPacked(cellLength, mpiDatatype));
+        std::vector<CELL_TYPE> buffer(layout.bufferSize);
+        setView(file, layout, headerLength, cellLength, mpiDatatype, "romio_cb_read");
+        MPI_File_read_all(
+            file,
+            buffer.empty() ? 0 : &buffer[0],
+            buffer.size(),
+            mpiDatatype,
+            MPI_STATUS_IGNORE);
+
+        for (typename std::vector<typename MPIIOHelpers::FileLayout<DIM, TOPOLOGY>::Piece>::const_iterator i =
+                 layout.pieces.begin();
+             i != layout.pieces.end();
+             ++i) {
+            grid->set(i->streak, &buffer[i->bufferIndex]);
+        }
+
+        MPI_File_close(&file);
+    }
+
     template<int DIM>
     void readMetadata(
         Coord<DIM> *dimensions,
@@ -97,18 +298,7 @@ public:
         MPI_Comm_rank(comm, &rank);
 
         if (rank == 0) {
-            CELL_TYPE cell = grid.getEdge();
-            MPI_File_write(file, const_cast<Coord<DIM>*>(&dimensions),
-                           1, Typemaps::lookup<Coord<DIM> >(), MPI_STATUS_IGNORE);
-
-            MPI_File_write(file, const_cast<unsigned*>(&step),
-                           1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
-
-            MPI_File_write(file, const_cast<unsigned*>(&maxSteps),
-                           1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
-
-            MPI_File_write(file, &cell,
-                           1, mpiDatatype,  MPI_STATUS_IGNORE);
+            writeHeader(file, grid, dimensions, step, maxSteps, mpiDatatype);
         }
 
         for (typename Region<DIM>::StreakIterator i = region.beginStreak();
@@ -120,7 +310,7 @@ public:
             Coord<DIM> coord = TOPOLOGY::normalize(i->origin, dimensions);
             MPI_File_seek(
                 file,
-                offset(headerLength, coord, dimensions, cellLength),
+                offset(headerLength, coord, dimensions, cellLength, mpiDatatype),
                 MPI_SEEK_SET);
 
             int length = i->endX - i->origin.x();
@@ -133,6 +323,49 @@ public:
         MPI_File_close(&file);
     }
 
+    template<typename GRID_TYPE, int DIM>
+    void writeRegionCollectively(
+        const GRID_TYPE& grid,
+        const Coord<DIM>& dimensions,
+        unsigned step,
+        unsigned maxSteps,
+        const std::string& filename,
+        const Region<DIM>& region,
+        const MPI_Datatype& mpiDatatype = Typemaps::lookup<CELL_TYPE>(),
+        const MPI_Comm& comm = MPI_COMM_WORLD)
+    {
+        MPI_File file = openFileForWrite(filename, comm);
+        MPI_Aint headerLength = 0;
+        MPI_Aint cellLength = 0;
+        getLengths<DIM>(&headerLength, &cellLength, mpiDatatype);
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        if (rank == 0) {
+            writeHeader(file, grid, dimensions, step, maxSteps, mpiDatatype);
+        }
+
+        MPIIOHelpers::FileLayout<DIM, TOPOLOGY> layout(
+            region, dimensions, isPacked(cellLength, mpiDatatype));
+        std::vector<CELL_TYPE> buffer(layout.bufferSize);
+        for (typename std::vector<typename MPIIOHelpers::FileLayout<DIM, TOPOLOGY>::Piece>::const_iterator i =
+                 layout.pieces.begin();
+             i != layout.pieces.end();
+             ++i) {
+            grid.get(i->streak, &buffer[i->bufferIndex]);
+        }
+
+        setView(file, layout, headerLength, cellLength, mpiDatatype, "romio_cb_write");
+        MPI_File_write_all(
+            file,
+            buffer.empty() ? 0 : &buffer[0],
+            buffer.size(),
+            mpiDatatype,
+            MPI_STATUS_IGNORE);
+
+        MPI_File_close(&file);
+    }
+
     MPI_File openFileForRead(
         const std::string& filename,
         MPI_Comm comm)
@@ -177,9 +410,12 @@ private:
         const MPI_Offset& headerLength,
         const Coord<DIM>& c,
         const Coord<DIM>& dimensions,
-        const MPI_Aint& cellLength)
+        const MPI_Aint& cellLength,
+        const MPI_Datatype& mpiDatatype)
     {
-        return headerLength + c.toIndex(dimensions) * cellLength;
+        int cellSize;
+        MPI_Type_size(mpiDatatype, &cellSize);
+        return headerLength + (c.toIndex(dimensions) - c.x()) * cellLength + c.x() * cellSize;
     }
 
     template<int DIM>
@@ -194,6 +430,69 @@ private:
         *headerLength = coordLength + 2 * unsignedLength + *cellLength;
     }
 
+    /**
+     * Without padding a row's packed cells fill its slots exactly,
+     * so blocks may extend into the next row.
+     */
+    bool isPacked(MPI_Aint cellLength, const MPI_Datatype& mpiDatatype)
+    {
+        int size;
+        MPI_Type_size(mpiDatatype, &size);
+        return size == cellLength;
+    }
+
+    template<typename GRID_TYPE, int DIM>
+    void writeHeader(
+        MPI_File file,
+        const GRID_TYPE& grid,
+        const Coord<DIM>& dimensions,
+        unsigned step,
+        unsigned maxSteps,
+        const MPI_Datatype& mpiDatatype)
+    {
+        CELL_TYPE cell = grid.getEdge();
+        MPI_File_write(file, const_cast<Coord<DIM>*>(&dimensions),
+                       1, Typemaps::lookup<Coord<DIM> >(), MPI_STATUS_IGNORE);
+
+        MPI_File_write(file, const_cast<unsigned*>(&step),
+                       1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+
+        MPI_File_write(file, const_cast<unsigned*>(&maxSteps),
+                       1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+
+        MPI_File_write(file, &cell,
+                       1, mpiDatatype,  MPI_STATUS_IGNORE);
+    }
+
+    /**
+     * Restricts the file to the cells covered by layout.
+     * aggregationHint enables ROMIO's collective buffering, other
+     * MPI-IO implementations will ignore it.
+     */
+    template<int DIM>
+    void setView(
+        MPI_File file,
+        const MPIIOHelpers::FileLayout<DIM, TOPOLOGY>& layout,
+        MPI_Aint headerLength,
+        MPI_Aint cellLength,
+        const MPI_Datatype& mpiDatatype,
+        const char *aggregationHint)
+    {
+        int cellSize;
+        MPI_Type_size(mpiDatatype, &cellSize);
+        MPI_Datatype fileType = layout.fileType(cellSize, cellLength);
+
+        MPI_Info info;
+        MPI_Info_create(&info);
+        MPI_Info_set(info, const_cast<char*>(aggregationHint), const_cast<char*>("enable"));
+
+        MPI_File_set_view(
+            file, headerLength, MPI_BYTE, fileType, const_cast<char*>("native"), info);
+
+        MPI_Info_free(&info);
+        MPI_Type_free(&fileType);
+    }
+
     template<int DIM>
     Coord<DIM> getDimensions(MPI_File file)
     {
@@ -16,6 +16,9 @@ namespace LibGeoDecomp {
  * long-running jobs which might either be shot down because of wall
  * clock limitations or node failures: here checkpoints can save
  * captital amounts of compute time.
+ *
+ * All processes need to call grid() as the snapshot is read
+ * collectively, unless collectiveIO is set to false.
  */
 template<typename CELL_TYPE>
 class MPIIOInitializer : public Initializer<CELL_TYPE>
@@ -27,10 +30,12 @@ public:
     explicit MPIIOInitializer(
         const std::string& filename,
         const MPI_Datatype& mpiDatatype = Typemaps::lookup<CELL_TYPE>(),
-        const MPI_Comm& comm = MPI_COMM_WORLD) :
+        const MPI_Comm& comm = MPI_COMM_WORLD,
+        bool collectiveIO = true) :
         file(filename),
         datatype(mpiDatatype),
-        communicator(comm)
+        communicator(comm),
+        collectiveIO(collectiveIO)
     {
         mpiio.readMetadata(
             &dimensions, &currentStep, &maximumSteps, file, communicator);
@@ -40,7 +45,11 @@ public:
     {
         Region<DIM> region;
         region << target->boundingBox();
-        mpiio.readRegion(target, file, region, communicator, datatype);
+        if (collectiveIO) {
+            mpiio.readRegionCollectively(target, file, region, communicator, datatype);
+        } else {
+            mpiio.readRegion(target, file, region, communicator, datatype);
+        }
     }
 
     virtual Coord<DIM> gridDimensions() const
@@ -62,6 +71,7 @@ private:
     std::string file;
     MPI_Datatype datatype;
     MPI_Comm communicator;
+    bool collectiveIO;
     MPIIO<CELL_TYPE> mpiio;
     unsigned currentStep;
     unsigned maximumSteps;
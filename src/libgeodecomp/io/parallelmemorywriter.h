@@ -31,7 +31,10 @@ public:
         MPI_Comm communicator = MPI_COMM_WORLD) :
         Clonable<ParallelWriter<CELL_TYPE>, ParallelMemoryWriter<CELL_TYPE> >("", period),
         mpiLayer(communicator, MPILayer::PARALLEL_MEMORY_WRITER)
-    {}
+    {
+        // validRegion rarely changes between steps:
+        mpiLayer.setRegionCacheCapacity(4);
+    }
 
     virtual void stepFinished(
         const WriterGridType& grid,
@@ -16,6 +16,11 @@ namespace LibGeoDecomp {
  * simulation for checkpoint/restart capabilities. Use this class for
  * parallel runs. Consider MPIIOInitializer for restarting from a
  * snapshot.
+ *
+ * By default all processes write their share of the grid with a
+ * single collective call, see MPIIO::writeRegionCollectively(). Pass
+ * collectiveIO = false to fall back to independent writes per
+ * streak.
  */
 template<typename CELL_TYPE>
 class ParallelMPIIOWriter : public Clonable<ParallelWriter<CELL_TYPE>, ParallelMPIIOWriter<CELL_TYPE> >
@@ -32,10 +37,12 @@ public:
         const std::string& prefix,
         const unsigned period,
         const unsigned maxSteps,
-        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        const MPI_Comm& communicator = MPI_COMM_WORLD,
+        bool collectiveIO = true) :
         Clonable<ParallelWriter<CELL_TYPE>, ParallelMPIIOWriter<CELL_TYPE> >(prefix, period),
         maxSteps(maxSteps),
-        comm(communicator)
+        comm(communicator),
+        collectiveIO(collectiveIO)
     {}
 
     virtual void stepFinished(
@@ -51,21 +58,34 @@ public:
             return;
         }
 
-        mpiio.writeRegion(
-            grid,
-            globalDimensions,
-            step,
-            maxSteps,
-            filename(step),
-            validRegion,
-            APITraits::SelectMPIDataType<CELL_TYPE>::value(),
-            comm);
+        if (collectiveIO) {
+            mpiio.writeRegionCollectively(
+                grid,
+                globalDimensions,
+                step,
+                maxSteps,
+                filename(step),
+                validRegion,
+                APITraits::SelectMPIDataType<CELL_TYPE>::value(),
+                comm);
+        } else {
+            mpiio.writeRegion(
+                grid,
+                globalDimensions,
+                step,
+                maxSteps,
+                filename(step),
+                validRegion,
+                APITraits::SelectMPIDataType<CELL_TYPE>::value(),
+                comm);
+        }
     }
 
 private:
     MPIIO<CELL_TYPE> mpiio;
     unsigned maxSteps;
     MPI_Comm comm;
+    bool collectiveIO;
 
     std::string filename(unsigned step) const
     {
@@ -0,0 +1,872 @@
+#ifndef LIBGEODECOMP_IO_SPARSEMATRIXCACHE_H
+#define LIBGEODECOMP_IO_SPARSEMATRIXCACHE_H
+
+#include <libgeodecomp/config.h>
+
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/storage/sellcsigmasparsematrixcontainer.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace SparseMatrixCacheHelpers {
+
+/**
+ * Read-only memory mapping of a section of a file. The section
+ * doesn't need to be page aligned, the mapping is extended as
+ * necessary.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& fileName) :
+        mapping(0),
+        mappingLength(0),
+        begin(0),
+        length(0)
+    {
+        map(fileName, 0, fileSize(fileName));
+    }
+
+    MappedFile(const std::string& fileName, std::size_t offset, std::size_t length) :
+        mapping(0),
+        mappingLength(0),
+        begin(0),
+        length(0)
+    {
+        if ((offset + length) > fileSize(fileName)) {
+            throw FileReadException(fileName);
+        }
+        map(fileName, offset, length);
+    }
+
+    ~MappedFile()
+    {
+        if (mapping) {
+            munmap(mapping, mappingLength);
+        }
+    }
+
+    const char *data() const
+    {
+        return begin;
+    }
+
+    std::size_t size() const
+    {
+        return length;
+    }
+
+    static std::size_t fileSize(const std::string& fileName)
+    {
+        struct stat status;
+        if (stat(fileName.c_str(), &status) != 0) {
+            throw FileOpenException(fileName);
+        }
+
+        return status.st_size;
+    }
+
+private:
+    void *mapping;
+    std::size_t mappingLength;
+    const char *begin;
+    std::size_t length;
+
+    MappedFile(const MappedFile& other);
+    MappedFile& operator=(const MappedFile& other);
+
+    void map(const std::string& fileName, std::size_t offset, std::size_t newLength)
+    {
+        length = newLength;
+        if (length == 0) {
+            return;
+        }
+
+        int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0) {
+            throw FileOpenException(fileName);
+        }
+
+        std::size_t pageSize = sysconf(_SC_PAGESIZE);
+        std::size_t start = offset / pageSize * pageSize;
+        mappingLength = length + offset - start;
+        mapping = mmap(0, mappingLength, PROT_READ, MAP_PRIVATE, file, start);
+        close(file);
+
+        if (mapping == MAP_FAILED) {
+            mapping = 0;
+            throw FileReadException(fileName);
+        }
+        begin = static_cast<const char*>(mapping) + offset - start;
+    }
+};
+
+/**
+ * Leads all cache files. All following sections start at multiples
+ * of ALIGNMENT bytes. Data is stored in the host's byte order.
+ */
+class Header
+{
+public:
+    static const std::size_t ALIGNMENT = 64;
+
+    Header(const char *newMagic = "", std::uint64_t dimension = 0, std::uint64_t numberOfColumns = 0,
+           std::uint64_t nonZeros = 0, std::uint32_t valueSize = 0, std::uint32_t c = 0, std::uint32_t sigma = 0) :
+        dimension(dimension),
+        numberOfColumns(numberOfColumns),
+        nonZeros(nonZeros),
+        valueSize(valueSize),
+        c(c),
+        sigma(sigma),
+        reserved(0)
+    {
+        std::fill(magic, magic + sizeof(magic), 0);
+        std::fill(padding, padding + sizeof(padding), 0);
+        std::memcpy(magic, newMagic, (std::min)(std::strlen(newMagic), sizeof(magic) - 1));
+    }
+
+    static std::uint64_t align(std::uint64_t offset)
+    {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    char magic[8];
+    std::uint64_t dimension;
+    std::uint64_t numberOfColumns;
+    // CSR: number of entries, SELL: number of slots including padding
+    std::uint64_t nonZeros;
+    std::uint32_t valueSize;
+    std::uint32_t c;
+    std::uint32_t sigma;
+    std::uint32_t reserved;
+    char padding[16];
+};
+
+static_assert(sizeof(Header) == Header::ALIGNMENT, "cache file header needs to fill exactly one section");
+
+/**
+ * Parsed entry of a MatrixMarket file, using 0-based indices.
+ */
+template<typename VALUETYPE>
+class Entry
+{
+public:
+    int row;
+    int column;
+    VALUETYPE value;
+};
+
+}
+
+/**
+ * Converting text matrices (MatrixMarket) into a
+ * SellCSigmaSparseMatrixContainer takes much longer than most SpMV
+ * benchmarks. SparseMatrixCache converts them (once, with a parallel
+ * parser) into a binary CSR file which is then memory mapped and fed
+ * directly into SellCSigmaSparseMatrixContainer::initFromCSR(). Each
+ * rank may map just its own range of rows.
+ *
+ * Alternatively a fully built container can be stored in SELL
+ * format. Loading it requires no sorting at all, merely one copy per
+ * array from the mapping to the container's aligned storage.
+ */
+class SparseMatrixCache
+{
+public:
+    typedef SparseMatrixCacheHelpers::Header Header;
+    typedef SparseMatrixCacheHelpers::MappedFile MappedFile;
+
+    /**
+     * Parses a MatrixMarket file in coordinate format (real, integer
+     * or pattern; general, symmetric or skew-symmetric) and stores
+     * it as binary CSR with ascending columns per row.
+     */
+    template<typename VALUETYPE = double>
+    static void convertMatrixMarket(const std::string& matrixMarketFile, const std::string& cacheFile)
+    {
+        typedef SparseMatrixCacheHelpers::Entry<VALUETYPE> Entry;
+
+        MappedFile file(matrixMarketFile);
+        const char *begin = file.data();
+        const char *end = file.data() + file.size();
+
+        const char *cursor = begin;
+        std::string banner = toLower(nextLine(&cursor, end));
+        std::vector<std::string> tokens = tokenize(banner);
+        if ((tokens.size() != 5) ||
+            (tokens[0] != "%%matrixmarket") ||
+            (tokens[1] != "matrix") ||
+            (tokens[2] != "coordinate")) {
+            throw IOException("unsupported MatrixMarket banner in " + matrixMarketFile + ": " + banner);
+        }
+        const bool pattern = (tokens[3] == "pattern");
+        if (!pattern && (tokens[3] != "real") && (tokens[3] != "integer")) {
+            throw IOException("unsupported MatrixMarket field type " + tokens[3]);
+        }
+        const bool symmetric = (tokens[4] == "symmetric");
+        const bool skewSymmetric = (tokens[4] == "skew-symmetric");
+        if (!symmetric && !skewSymmetric && (tokens[4] != "general")) {
+            throw IOException("unsupported MatrixMarket symmetry " + tokens[4]);
+        }
+
+        std::string sizeLine;
+        do {
+            sizeLine = nextLine(&cursor, end);
+        } while ((cursor != end) && (sizeLine.empty() || (sizeLine[0] == '%')));
+        long rows = 0;
+        long columns = 0;
+        long nonZeros = 0;
+        std::stringstream sizeBuf(sizeLine);
+        sizeBuf >> rows >> columns >> nonZeros;
+        if (!sizeBuf || (rows <= 0) || (columns <= 0) || (rows > std::numeric_limits<int>::max())) {
+            throw IOException("could not parse MatrixMarket size line: " + sizeLine);
+        }
+
+        // 1. parse the body in parallel, pieces are split at line breaks:
+        const char *body = cursor;
+        const long numPieces = maxThreads() * 4;
+        std::vector<std::vector<Entry> > pieces(numPieces);
+        std::string error;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (long piece = 0; piece < numPieces; ++piece) {
+            const char *pieceBegin = lineStart(body, end, body + (end - body) * piece / numPieces);
+            const char *pieceEnd = lineStart(body, end, body + (end - body) * (piece + 1) / numPieces);
+            std::string message = parsePiece(
+                pieceBegin, pieceEnd, rows, columns, pattern, symmetric, skewSymmetric, &pieces[piece]);
+
+            if (!message.empty()) {
+                // exceptions must not escape OpenMP threads:
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+                {
+                    error = message;
+                }
+            }
+        }
+
+        if (!error.empty()) {
+            throw IOException("could not parse " + matrixMarketFile + ": " + error);
+        }
+
+        std::size_t numEntries = 0;
+        for (long piece = 0; piece < numPieces; ++piece) {
+            numEntries += pieces[piece].size();
+        }
+        if (!symmetric && !skewSymmetric && (numEntries != std::size_t(nonZeros))) {
+            throw IOException("unexpected number of entries in " + matrixMarketFile);
+        }
+
+        // 2. convert to CSR: count row lengths, prefix sum, scatter:
+        std::vector<std::int64_t> rowOffsets(rows + 1, 0);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (long piece = 0; piece < numPieces; ++piece) {
+            for (typename std::vector<Entry>::iterator i = pieces[piece].begin(); i != pieces[piece].end(); ++i) {
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp atomic
+#endif
+                ++rowOffsets[i->row + 1];
+            }
+        }
+
+        for (long row = 0; row < rows; ++row) {
+            rowOffsets[row + 1] += rowOffsets[row];
+        }
+
+        std::vector<std::int64_t> cursors(rowOffsets.begin(), rowOffsets.end() - 1);
+        std::vector<int> columnVec(numEntries);
+        std::vector<VALUETYPE> valueVec(numEntries);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (long piece = 0; piece < numPieces; ++piece) {
+            for (typename std::vector<Entry>::iterator i = pieces[piece].begin(); i != pieces[piece].end(); ++i) {
+                std::int64_t index;
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp atomic capture
+#endif
+                index = cursors[i->row]++;
+
+                columnVec[index] = i->column;
+                valueVec[index] = i->value;
+            }
+            std::vector<Entry>().swap(pieces[piece]);
+        }
+
+        sortColumns(rowOffsets, &columnVec, &valueVec);
+        writeCSR(cacheFile, rowOffsets, columnVec, valueVec, columns);
+    }
+
+    /**
+     * Stores a CSR matrix: the entries of row i are located at
+     * [rowOffsets[i], rowOffsets[i + 1]) in columns and values.
+     * numberOfColumns defaults to the number of rows.
+     */
+    template<typename OFFSET, typename VALUETYPE>
+    static void writeCSR(
+        const std::string& cacheFile,
+        const std::vector<OFFSET>& rowOffsets,
+        const std::vector<int>& columns,
+        const std::vector<VALUETYPE>& values,
+        std::size_t numberOfColumns = 0)
+    {
+        if (rowOffsets.empty() || (columns.size() != values.size()) ||
+            (std::size_t(rowOffsets.back()) != values.size())) {
+            throw std::invalid_argument("CSR arrays don't match in size");
+        }
+
+        std::size_t dimension = rowOffsets.size() - 1;
+        Header header(
+            csrMagic(),
+            dimension,
+            numberOfColumns ? numberOfColumns : dimension,
+            values.size(),
+            sizeof(VALUETYPE));
+
+        std::vector<std::int64_t> offsets(rowOffsets.begin(), rowOffsets.end());
+        std::ofstream file(cacheFile.c_str(), std::ios::binary);
+        if (!file) {
+            throw FileOpenException(cacheFile);
+        }
+
+        writeSection(&file, &header, 1);
+        writeSection(&file, offsets.data(), offsets.size());
+        writeSection(&file, columns.data(), columns.size());
+        writeSection(&file, values.data(), values.size());
+
+        if (!file) {
+            throw FileWriteException(cacheFile);
+        }
+    }
+
+    /**
+     * Stores the complete SELL data structure of container.
+     */
+    template<typename VALUETYPE, int C, int SIGMA>
+    static void writeSell(
+        const std::string& cacheFile,
+        const SellCSigmaSparseMatrixContainer<VALUETYPE, C, SIGMA>& container)
+    {
+        Header header(
+            sellMagic(),
+            container.dim(),
+            container.dim(),
+            container.valuesVec().size(),
+            sizeof(VALUETYPE),
+            C,
+            SIGMA);
+
+        std::ofstream file(cacheFile.c_str(), std::ios::binary);
+        if (!file) {
+            throw FileOpenException(cacheFile);
+        }
+
+        writeSection(&file, &header, 1);
+        writeSection(&file, container.rowLengthVec().data(),     container.rowLengthVec().size());
+        writeSection(&file, container.chunkLengthVec().data(),   container.chunkLengthVec().size());
+        writeSection(&file, container.chunkOffsetVec().data(),   container.chunkOffsetVec().size());
+        writeSection(&file, container.chunkRowToRealVec().data(), container.chunkRowToRealVec().size());
+        writeSection(&file, container.columnVec().data(),        container.columnVec().size());
+        writeSection(&file, container.valuesVec().data(),        container.valuesVec().size());
+
+        if (!file) {
+            throw FileWriteException(cacheFile);
+        }
+    }
+
+    static Header readHeader(const std::string& cacheFile)
+    {
+        MappedFile mapping(cacheFile, 0, sizeof(Header));
+        Header header;
+        std::memcpy(&header, mapping.data(), sizeof(Header));
+
+        if ((std::strncmp(header.magic, csrMagic(),  sizeof(header.magic)) != 0) &&
+            (std::strncmp(header.magic, sellMagic(), sizeof(header.magic)) != 0)) {
+            throw IOException(cacheFile + " is no sparse matrix cache file");
+        }
+
+        return header;
+    }
+
+    /**
+     * Rows [first, second) of a CSR cache file for the given rank,
+     * chosen so that all ranks get roughly the same number of
+     * entries. Only the row offsets are read.
+     */
+    static std::pair<std::size_t, std::size_t> rowRange(
+        const std::string& cacheFile,
+        std::size_t rank,
+        std::size_t size)
+    {
+        Header header = readCSRHeader(cacheFile);
+        MappedFile offsets(cacheFile, rowOffsetsSection(), (header.dimension + 1) * sizeof(std::int64_t));
+        const std::int64_t *begin = reinterpret_cast<const std::int64_t*>(offsets.data());
+        const std::int64_t *end = begin + header.dimension + 1;
+
+        std::size_t first = splitRow(begin, end, header.nonZeros * rank / size);
+        std::size_t last = splitRow(begin, end, header.nonZeros * (rank + 1) / size);
+        if (rank + 1 == size) {
+            last = header.dimension;
+        }
+
+        return std::make_pair(first, last);
+    }
+
+    /**
+     * Initializes container from rows [firstRow, firstRow + numRows)
+     * of a CSR cache file. All other rows aren't touched, so each
+     * rank can load its own part of the matrix. Column indices remain
+     * global. numRows defaults to all remaining rows.
+     */
+    template<typename VALUETYPE, int C, int SIGMA>
+    static void loadCSR(
+        const std::string& cacheFile,
+        SellCSigmaSparseMatrixContainer<VALUETYPE, C, SIGMA> *container,
+        std::size_t firstRow = 0,
+        std::size_t numRows = std::size_t(-1))
+    {
+        Header header = readCSRHeader(cacheFile);
+        checkValueSize<VALUETYPE>(header, cacheFile);
+        numRows = checkRowRange(header, firstRow, numRows);
+
+        std::vector<int> rowOffsets;
+        std::int64_t firstEntry = readRowOffsets(cacheFile, header, firstRow, numRows, &rowOffsets);
+        MappedFile columns(
+            cacheFile,
+            columnsSection(header) + firstEntry * sizeof(int),
+            rowOffsets.back() * sizeof(int));
+        MappedFile values(
+            cacheFile,
+            valuesSection(header) + firstEntry * sizeof(VALUETYPE),
+            rowOffsets.back() * sizeof(VALUETYPE));
+
+        *container = SellCSigmaSparseMatrixContainer<VALUETYPE, C, SIGMA>(numRows);
+        container->initFromCSR(
+            rowOffsets.data(),
+            reinterpret_cast<const int*>(columns.data()),
+            reinterpret_cast<const VALUETYPE*>(values.data()));
+    }
+
+    /**
+     * Same as above, but copies the CSR arrays to the given vectors,
+     * e.g. for reference kernels. rowOffsets are rebased to start
+     * at 0.
+     */
+    template<typename VALUETYPE>
+    static void loadCSR(
+        const std::string& cacheFile,
+        std::vector<int> *rowOffsets,
+        std::vector<int> *columns,
+        std::vector<VALUETYPE> *values,
+        std::size_t firstRow = 0,
+        std::size_t numRows = std::size_t(-1))
+    {
+        Header header = readCSRHeader(cacheFile);
+        checkValueSize<VALUETYPE>(header, cacheFile);
+        numRows = checkRowRange(header, firstRow, numRows);
+
+        std::int64_t firstEntry = readRowOffsets(cacheFile, header, firstRow, numRows, rowOffsets);
+        MappedFile columnMapping(
+            cacheFile,
+            columnsSection(header) + firstEntry * sizeof(int),
+            rowOffsets->back() * sizeof(int));
+        MappedFile valueMapping(
+            cacheFile,
+            valuesSection(header) + firstEntry * sizeof(VALUETYPE),
+            rowOffsets->back() * sizeof(VALUETYPE));
+
+        const int *columnBegin = reinterpret_cast<const int*>(columnMapping.data());
+        const VALUETYPE *valueBegin = reinterpret_cast<const VALUETYPE*>(valueMapping.data());
+        columns->assign(columnBegin, columnBegin + rowOffsets->back());
+        values->assign(valueBegin, valueBegin + rowOffsets->back());
+    }
+
+    /**
+     * Restores a container saved via writeSell(). C, SIGMA and
+     * VALUETYPE need to match.
+     */
+    template<typename VALUETYPE, int C, int SIGMA>
+    static void loadSell(
+        const std::string& cacheFile,
+        SellCSigmaSparseMatrixContainer<VALUETYPE, C, SIGMA> *container)
+    {
+        Header header = readHeader(cacheFile);
+        if (std::strncmp(header.magic, sellMagic(), sizeof(header.magic)) != 0) {
+            throw IOException(cacheFile + " doesn't contain a SELL matrix");
+        }
+        checkValueSize<VALUETYPE>(header, cacheFile);
+        if ((header.c != std::uint32_t(C)) || (header.sigma != std::uint32_t(SIGMA))) {
+            throw IOException(cacheFile + " was stored with different C or SIGMA");
+        }
+
+        MappedFile file(cacheFile);
+        const std::size_t dimension = header.dimension;
+        const std::size_t numberOfChunks = (dimension - 1) / C + 1;
+        const std::size_t rowsPadded = numberOfChunks * C;
+
+        *container = SellCSigmaSparseMatrixContainer<VALUETYPE, C, SIGMA>(dimension);
+        std::uint64_t offset = Header::align(sizeof(Header));
+        offset = readSection(file, offset, rowsPadded,          &container->rowLength);
+        offset = readSection(file, offset, numberOfChunks,      &container->chunkLength);
+        offset = readSection(file, offset, numberOfChunks + 1,  &container->chunkOffset);
+        offset = readSection(file, offset, rowsPadded,          &container->chunkRowToReal);
+        offset = readSection(file, offset, header.nonZeros,     &container->column);
+        offset = readSection(file, offset, header.nonZeros,     &container->values);
+
+        container->realRowToSorted.resize(rowsPadded);
+        for (std::size_t i = 0; i < rowsPadded; ++i) {
+            int realRow = container->chunkRowToReal[i];
+            container->realRowToSorted[realRow] = std::make_pair(realRow, int(i));
+        }
+    }
+
+private:
+    static const char *csrMagic()
+    {
+        return "LGDCSR";
+    }
+
+    static const char *sellMagic()
+    {
+        return "LGDSELL";
+    }
+
+    static std::string nextLine(const char **cursor, const char *end)
+    {
+        const char *lineEnd = std::find(*cursor, end, '\n');
+        std::string ret(*cursor, lineEnd);
+        *cursor = (lineEnd == end) ? end : lineEnd + 1;
+        if (!ret.empty() && (ret[ret.size() - 1] == '\r')) {
+            ret.resize(ret.size() - 1);
+        }
+
+        return ret;
+    }
+
+    static std::string toLower(std::string string)
+    {
+        for (std::size_t i = 0; i < string.size(); ++i) {
+            string[i] = std::tolower(string[i]);
+        }
+
+        return string;
+    }
+
+    static std::vector<std::string> tokenize(const std::string& line)
+    {
+        std::vector<std::string> ret;
+        std::stringstream buf(line);
+        std::string token;
+        while (buf >> token) {
+            ret.push_back(token);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Returns the start of the first line which begins at or after
+     * position, except for position == begin.
+     */
+    static const char *lineStart(const char *begin, const char *end, const char *position)
+    {
+        if ((position == begin) || (position == end)) {
+            return position;
+        }
+        if (position[-1] == '\n') {
+            return position;
+        }
+
+        const char *lineEnd = std::find(position, end, '\n');
+        return (lineEnd == end) ? end : lineEnd + 1;
+    }
+
+    static const char *skipBlanks(const char *cursor, const char *end)
+    {
+        while ((cursor != end) && ((*cursor == ' ') || (*cursor == '\t') || (*cursor == '\r'))) {
+            ++cursor;
+        }
+
+        return cursor;
+    }
+
+    static bool parseLong(const char **cursor, const char *end, long *value)
+    {
+        const char *i = skipBlanks(*cursor, end);
+        const char *start = i;
+        *value = 0;
+        while ((i != end) && (*i >= '0') && (*i <= '9')) {
+            *value = *value * 10 + (*i - '0');
+            ++i;
+        }
+
+        *cursor = i;
+        return i != start;
+    }
+
+    /**
+     * The mapping isn't null-terminated, so we copy the token before
+     * handing it to strtod().
+     */
+    static bool parseDouble(const char **cursor, const char *end, double *value)
+    {
+        const char *i = skipBlanks(*cursor, end);
+        char buf[64];
+        std::size_t length = 0;
+        while ((i != end) && !std::isspace(*i) && (length < (sizeof(buf) - 1))) {
+            buf[length++] = *i++;
+        }
+        buf[length] = 0;
+
+        char *tokenEnd;
+        *value = std::strtod(buf, &tokenEnd);
+        *cursor = i;
+        return (length > 0) && (*tokenEnd == 0);
+    }
+
+    /**
+     * Returns an error message instead of throwing as it's being
+     * called from within OpenMP threads.
+     */
+    template<typename VALUETYPE>
+    static std::string parsePiece(
+        const char *cursor,
+        const char *end,
+        long rows,
+        long columns,
+        bool pattern,
+        bool symmetric,
+        bool skewSymmetric,
+        std::vector<SparseMatrixCacheHelpers::Entry<VALUETYPE> > *entries)
+    {
+        typedef SparseMatrixCacheHelpers::Entry<VALUETYPE> Entry;
+
+        while (cursor != end) {
+            cursor = skipBlanks(cursor, end);
+            if ((cursor != end) && ((*cursor == '\n') || (*cursor == '%'))) {
+                cursor = std::find(cursor, end, '\n');
+                if (cursor != end) {
+                    ++cursor;
+                }
+                continue;
+            }
+            if (cursor == end) {
+                break;
+            }
+
+            long row;
+            long column;
+            double value = 1;
+            if (!parseLong(&cursor, end, &row) ||
+                !parseLong(&cursor, end, &column) ||
+                (!pattern && !parseDouble(&cursor, end, &value))) {
+                return "malformed entry";
+            }
+            if ((row < 1) || (row > rows) || (column < 1) || (column > columns)) {
+                return "index out of bounds";
+            }
+
+            Entry entry;
+            entry.row = row - 1;
+            entry.column = column - 1;
+            entry.value = value;
+            entries->push_back(entry);
+
+            if ((symmetric || skewSymmetric) && (row != column)) {
+                std::swap(entry.row, entry.column);
+                if (skewSymmetric) {
+                    entry.value = -entry.value;
+                }
+                entries->push_back(entry);
+            }
+
+            cursor = std::find(cursor, end, '\n');
+        }
+
+        return "";
+    }
+
+    template<typename VALUETYPE>
+    static void sortColumns(
+        const std::vector<std::int64_t>& rowOffsets,
+        std::vector<int> *columns,
+        std::vector<VALUETYPE> *values)
+    {
+        const long rows = rowOffsets.size() - 1;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            std::vector<std::pair<int, VALUETYPE> > row;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic, 1024)
+#endif
+            for (long i = 0; i < rows; ++i) {
+                row.clear();
+                for (std::int64_t j = rowOffsets[i]; j < rowOffsets[i + 1]; ++j) {
+                    row.push_back(std::make_pair((*columns)[j], (*values)[j]));
+                }
+                std::sort(row.begin(), row.end());
+
+                for (std::size_t j = 0; j < row.size(); ++j) {
+                    (*columns)[rowOffsets[i] + j] = row[j].first;
+                    (*values)[rowOffsets[i] + j] = row[j].second;
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    static void writeSection(std::ofstream *file, const T *data, std::size_t num)
+    {
+        file->write(reinterpret_cast<const char*>(data), num * sizeof(T));
+
+        std::size_t position = file->tellp();
+        std::vector<char> padding(Header::align(position) - position, 0);
+        file->write(padding.data(), padding.size());
+    }
+
+    template<typename VECTOR>
+    static std::uint64_t readSection(
+        const MappedFile& file,
+        std::uint64_t offset,
+        std::uint64_t num,
+        VECTOR *target)
+    {
+        typedef typename VECTOR::value_type ValueType;
+
+        if ((offset + num * sizeof(ValueType)) > file.size()) {
+            throw IOException("sparse matrix cache file truncated");
+        }
+
+        const ValueType *begin = reinterpret_cast<const ValueType*>(file.data() + offset);
+        target->assign(begin, begin + num);
+
+        return Header::align(offset + num * sizeof(ValueType));
+    }
+
+    static Header readCSRHeader(const std::string& cacheFile)
+    {
+        Header header = readHeader(cacheFile);
+        if (std::strncmp(header.magic, csrMagic(), sizeof(header.magic)) != 0) {
+            throw IOException(cacheFile + " doesn't contain a CSR matrix");
+        }
+
+        return header;
+    }
+
+    template<typename VALUETYPE>
+    static void checkValueSize(const Header& header, const std::string& cacheFile)
+    {
+        if (header.valueSize != sizeof(VALUETYPE)) {
+            throw IOException(cacheFile + " was stored with a different value type");
+        }
+    }
+
+    static std::size_t checkRowRange(const Header& header, std::size_t firstRow, std::size_t numRows)
+    {
+        if (firstRow > header.dimension) {
+            throw std::invalid_argument("firstRow exceeds matrix dimension");
+        }
+        numRows = (std::min)(numRows, std::size_t(header.dimension - firstRow));
+        if (numRows == 0) {
+            throw std::invalid_argument("row range is empty");
+        }
+
+        return numRows;
+    }
+
+    static std::uint64_t rowOffsetsSection()
+    {
+        return Header::align(sizeof(Header));
+    }
+
+    static std::uint64_t columnsSection(const Header& header)
+    {
+        return Header::align(rowOffsetsSection() + (header.dimension + 1) * sizeof(std::int64_t));
+    }
+
+    static std::uint64_t valuesSection(const Header& header)
+    {
+        return Header::align(columnsSection(header) + header.nonZeros * sizeof(int));
+    }
+
+    /**
+     * Reads and rebases the offsets of the given row range, returns
+     * the global index of the range's first entry.
+     */
+    static std::int64_t readRowOffsets(
+        const std::string& cacheFile,
+        const Header& header,
+        std::size_t firstRow,
+        std::size_t numRows,
+        std::vector<int> *rowOffsets)
+    {
+        MappedFile mapping(
+            cacheFile,
+            rowOffsetsSection() + firstRow * sizeof(std::int64_t),
+            (numRows + 1) * sizeof(std::int64_t));
+        const std::int64_t *offsets = reinterpret_cast<const std::int64_t*>(mapping.data());
+
+        if ((offsets[numRows] - offsets[0]) > std::numeric_limits<int>::max()) {
+            throw std::invalid_argument("row range holds too many entries for int indices");
+        }
+
+        rowOffsets->resize(numRows + 1);
+        for (std::size_t i = 0; i <= numRows; ++i) {
+            (*rowOffsets)[i] = offsets[i] - offsets[0];
+        }
+
+        return offsets[0];
+    }
+
+    static std::size_t splitRow(const std::int64_t *begin, const std::int64_t *end, std::uint64_t entry)
+    {
+        return std::lower_bound(begin, end, std::int64_t(entry)) - begin;
+    }
+
+    static long maxThreads()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+};
+
+}
+
+#endif
+#endif
@@ -1,8 +1,12 @@
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/io/mpiio.h>
 #include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
 #include <libgeodecomp/storage/grid.h>
 
+#include <fstream>
+#include <iterator>
 #include <unistd.h>
 #include <cxxtest/TestSuite.h>
 
@@ -79,6 +83,152 @@ public:
             }
         }
     }
+
+    void testCollectiveReadWrite()
+    {
+        typedef TestCell<2> CellType;
+        typedef Topologies::Torus<2>::Topology Topology;
+        MPIIO<CellType, Topology> mpiio;
+
+        Coord<2> dim(13, 9);
+        unsigned step = 5;
+        unsigned maxSteps = 17;
+        int rank = MPILayer().rank();
+        std::string filename = TempFile::parallel("mpiio");
+
+        Grid<CellType, Topology> grid1(dim);
+        grid1.setEdge(CellType(Coord<2>(-1, -1), dim, 0, -1));
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                Coord<2> c(x, y);
+                grid1[c] = CellType(c, dim, 0, y * 100 + x);
+            }
+        }
+
+        // interleaved rows yield many small, disjoint chunks per process:
+        Region<2> region;
+        for (int y = rank; y < dim.y(); y += 2) {
+            region << Streak<2>(Coord<2>(0, y), dim.x());
+        }
+        mpiio.writeRegionCollectively(grid1, dim, step, maxSteps, filename, region);
+
+        // rows start at slots as wide as the cells' extent, but
+        // hold packed cells, just like snapshots written by earlier
+        // versions:
+        MPI_Aint cellLength = mpiio.getLength(Typemaps::lookup<CellType>());
+        int cellSize;
+        MPI_Type_size(Typemaps::lookup<CellType>(), &cellSize);
+        MPI_Aint headerLength =
+            mpiio.getLength(Typemaps::lookup<Coord<2> >()) +
+            2 * mpiio.getLength(MPI_UNSIGNED) +
+            cellLength;
+        std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+        TS_ASSERT_EQUALS(
+            std::streamoff(headerLength + (dim.prod() - dim.x()) * cellLength + dim.x() * cellSize),
+            std::streamoff(file.tellg()));
+
+        // files written collectively are compatible with independent I/O:
+        Grid<CellType, Topology> grid2(dim);
+        Region<2> wholeGrid;
+        wholeGrid << grid2.boundingBox();
+        mpiio.readRegion(&grid2, filename, wholeGrid);
+        TS_ASSERT_EQUALS(grid1, grid2);
+
+        // ghost zones on a torus wrap around the grid's boundaries:
+        CoordBox<2> box(Coord<2>(-2, rank * 4 - 1), Coord<2>(dim.x() + 3, 6));
+        DisplacedGrid<CellType, Topology> grid3(box);
+        Region<2> boxRegion;
+        boxRegion << box;
+        mpiio.readRegionCollectively(&grid3, filename, boxRegion);
+
+        TS_ASSERT_EQUALS(grid1.getEdge(), grid3.getEdge());
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TS_ASSERT_EQUALS(grid1[*i], grid3[*i]);
+        }
+    }
+
+    void testReadSnapshotOfPreviousVersion()
+    {
+        typedef TestCell<2> CellType;
+        typedef Topologies::Torus<2>::Topology Topology;
+        MPIIO<CellType, Topology> mpiio;
+        MPI_Datatype mpiDatatype = Typemaps::lookup<CellType>();
+
+        Coord<2> dim(11, 6);
+        unsigned step = 3;
+        unsigned maxSteps = 8;
+        int rank = MPILayer().rank();
+        std::string filename = TempFile::parallel("mpiio");
+
+        // the padding is what sets the old layout apart from a plain
+        // array of cells:
+        MPI_Aint cellLength = mpiio.getLength(mpiDatatype);
+        int cellSize;
+        MPI_Type_size(mpiDatatype, &cellSize);
+        TS_ASSERT_LESS_THAN(MPI_Aint(cellSize), cellLength);
+
+        Grid<CellType, Topology> grid1(dim);
+        grid1.setEdge(CellType(Coord<2>(-1, -1), dim, 0, -1));
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                Coord<2> c(x, y);
+                grid1[c] = CellType(c, dim, 0, y * 100 + x);
+            }
+        }
+
+        // write whole rows the way writeRegion() used to: seek to
+        // each streak's slot and dump its cells right there.
+        MPI_File file = mpiio.openFileForWrite(filename, MPI_COMM_WORLD);
+        MPI_Aint headerLength =
+            mpiio.getLength(Typemaps::lookup<Coord<2> >()) +
+            2 * mpiio.getLength(MPI_UNSIGNED) +
+            cellLength;
+        if (rank == 0) {
+            CellType edge = grid1.getEdge();
+            MPI_File_write(file, &dim, 1, Typemaps::lookup<Coord<2> >(), MPI_STATUS_IGNORE);
+            MPI_File_write(file, &step, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+            MPI_File_write(file, &maxSteps, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+            MPI_File_write(file, &edge, 1, mpiDatatype, MPI_STATUS_IGNORE);
+        }
+        for (int y = rank * 3; y < (rank * 3 + 3); ++y) {
+            std::vector<CellType> row(dim.x());
+            grid1.get(Streak<2>(Coord<2>(0, y), dim.x()), &row[0]);
+            MPI_File_seek(file, headerLength + y * dim.x() * cellLength, MPI_SEEK_SET);
+            MPI_File_write(file, &row[0], dim.x(), mpiDatatype, MPI_STATUS_IGNORE);
+        }
+        MPI_File_close(&file);
+
+        Grid<CellType, Topology> grid2(dim);
+        Region<2> wholeGrid;
+        wholeGrid << grid2.boundingBox();
+        mpiio.readRegion(&grid2, filename, wholeGrid);
+        TS_ASSERT_EQUALS(grid1, grid2);
+
+        // partial rows, also wrapping around the torus:
+        CoordBox<2> box(Coord<2>(rank * 5 - 3, -1), Coord<2>(7, dim.y() + 2));
+        DisplacedGrid<CellType, Topology> grid3(box);
+        Region<2> boxRegion;
+        boxRegion << box;
+        mpiio.readRegionCollectively(&grid3, filename, boxRegion);
+
+        TS_ASSERT_EQUALS(grid1.getEdge(), grid3.getEdge());
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TS_ASSERT_EQUALS(grid1[*i], grid3[*i]);
+        }
+
+        // ...and new snapshots of whole rows match the old ones byte by byte:
+        std::string filename2 = TempFile::parallel("mpiio");
+        Region<2> rows;
+        rows << CoordBox<2>(Coord<2>(0, rank * 3), Coord<2>(dim.x(), 3));
+        mpiio.writeRegionCollectively(grid1, dim, step, maxSteps, filename2, rows);
+
+        std::ifstream oldFile(filename.c_str(), std::ios::binary);
+        std::ifstream newFile(filename2.c_str(), std::ios::binary);
+        std::string oldBytes((std::istreambuf_iterator<char>(oldFile)), std::istreambuf_iterator<char>());
+        std::string newBytes((std::istreambuf_iterator<char>(newFile)), std::istreambuf_iterator<char>());
+        TS_ASSERT_EQUALS(oldBytes.size(), newBytes.size());
+        TS_ASSERT(oldBytes == newBytes);
+    }
 };
 
 }
@@ -0,0 +1,187 @@
+#include <libgeodecomp/io/asyncparallelwriter.h>
+#include <libgeodecomp/io/asyncwriter.h>
+#include <libgeodecomp/io/memorywriter.h>
+#include <libgeodecomp/io/mockwriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Fails after a given number of calls to check that errors on the
+ * background thread reach the simulator.
+ */
+class FailingWriter : public Clonable<Writer<TestCell<2> >, FailingWriter>
+{
+public:
+    explicit FailingWriter(unsigned failAfter) :
+        Clonable<Writer<TestCell<2> >, FailingWriter>("", 1),
+        failAfter(failAfter),
+        calls(0)
+    {}
+
+    void stepFinished(const GridType& grid, unsigned step, WriterEvent event)
+    {
+        if (++calls > failAfter) {
+            throw std::runtime_error("disk full");
+        }
+    }
+
+private:
+    unsigned failAfter;
+    unsigned calls;
+};
+
+/**
+ * Records the values of a member within validRegion.
+ */
+class ValueRecordingParallelWriter : public Clonable<ParallelWriter<TestCell<2> >, ValueRecordingParallelWriter>
+{
+public:
+    ValueRecordingParallelWriter() :
+        Clonable<ParallelWriter<TestCell<2> >, ValueRecordingParallelWriter>("", 1)
+    {}
+
+    void stepFinished(
+        const GridType& grid,
+        const Region<2>& validRegion,
+        const Coord<2>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        for (Region<2>::Iterator i = validRegion.begin(); i != validRegion.end(); ++i) {
+            values << grid.get(*i).testValue;
+        }
+        dimensions << globalDimensions;
+        lastRegion = region;
+    }
+
+    std::vector<double> values;
+    std::vector<Coord<2> > dimensions;
+    Region<2> lastRegion;
+};
+
+class AsyncWriterTest : public CxxTest::TestSuite
+{
+public:
+    typedef MockWriter<>::Event Event;
+    typedef MockWriter<>::EventsStore EventsStore;
+    typedef Grid<TestCell<2>, Topologies::Cube<2>::Topology> StorageGrid;
+
+    void setUp()
+    {
+        selectors.clear();
+        selectors << Selector<TestCell<2> >(&TestCell<2>::testValue,    "testValue")
+                  << Selector<TestCell<2> >(&TestCell<2>::cycleCounter, "cycleCounter");
+    }
+
+    void testEventsMatchSynchronousWriter()
+    {
+        SharedPtr<EventsStore>::Type expectedEvents(new EventsStore);
+        SharedPtr<EventsStore>::Type actualEvents(new EventsStore);
+
+        {
+            SerialSimulator<TestCell<2> > sim(new TestInitializer<TestCell<2> >());
+            sim.addWriter(new MockWriter<>(expectedEvents, 3));
+            sim.addWriter(new AsyncWriter<TestCell<2> >(new MockWriter<>(actualEvents, 3), selectors, 1));
+            sim.run();
+        }
+
+        TS_ASSERT_EQUALS(expectedEvents->size(), actualEvents->size());
+        TS_ASSERT_EQUALS(*expectedEvents, *actualEvents);
+    }
+
+    void testSelectedMembersMatchSynchronousWriter()
+    {
+        SerialSimulator<TestCell<2> > sim(new TestInitializer<TestCell<2> >());
+        MemoryWriter<TestCell<2> > *expected = new MemoryWriter<TestCell<2> >(2);
+        MemoryWriter<TestCell<2> > *actual = new MemoryWriter<TestCell<2> >(2);
+        sim.addWriter(expected);
+        sim.addWriter(new AsyncWriter<TestCell<2> >(actual, selectors, 2));
+        sim.run();
+
+        TS_ASSERT_EQUALS(expected->getGrids().size(), actual->getGrids().size());
+
+        for (std::size_t i = 0; i < expected->getGrids().size(); ++i) {
+            StorageGrid& expectedGrid = expected->getGrids()[i];
+            StorageGrid& actualGrid = actual->getGrids()[i];
+            TS_ASSERT_EQUALS(expectedGrid.getDimensions(), actualGrid.getDimensions());
+
+            CoordBox<2> box = expectedGrid.boundingBox();
+            for (CoordBox<2>::Iterator j = box.begin(); j != box.end(); ++j) {
+                TS_ASSERT_EQUALS(expectedGrid[*j].testValue,    actualGrid[*j].testValue);
+                TS_ASSERT_EQUALS(expectedGrid[*j].cycleCounter, actualGrid[*j].cycleCounter);
+            }
+        }
+    }
+
+    void testErrorsArePropagated()
+    {
+        SerialSimulator<TestCell<2> > sim(new TestInitializer<TestCell<2> >());
+        sim.addWriter(new AsyncWriter<TestCell<2> >(
+                          new FailingWriter(5),
+                          Selector<TestCell<2> >(&TestCell<2>::testValue, "testValue"),
+                          2));
+
+        TS_ASSERT_THROWS(sim.run(), std::runtime_error&);
+    }
+
+    void testInvalidQueueDepth()
+    {
+        SharedPtr<EventsStore>::Type events(new EventsStore);
+        TS_ASSERT_THROWS(
+            AsyncWriter<TestCell<2> >(new MockWriter<>(events), selectors, 0),
+            std::invalid_argument&);
+    }
+
+    void testParallelWriter()
+    {
+        CoordBox<2> box(Coord<2>(10, 20), Coord<2>(30, 15));
+        DisplacedGrid<TestCell<2> > grid(box);
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TestCell<2> cell;
+            cell.testValue = i->x() * 1000 + i->y();
+            grid.set(*i, cell);
+        }
+
+        Region<2> region;
+        region << box;
+        Region<2> validRegion;
+        validRegion << Streak<2>(Coord<2>(12, 21), 20)
+                    << Streak<2>(Coord<2>(15, 30), 38);
+
+        ValueRecordingParallelWriter *delegate = new ValueRecordingParallelWriter();
+        AsyncParallelWriter<TestCell<2> > writer(delegate, selectors, 1);
+        writer.setRegion(region);
+
+        for (int step = 0; step < 4; ++step) {
+            writer.stepFinished(grid, validRegion, Coord<2>(100, 50), step, WRITER_STEP_FINISHED, 0, true);
+        }
+        writer.flush();
+
+        std::vector<double> expected;
+        for (int step = 0; step < 4; ++step) {
+            for (Region<2>::Iterator i = validRegion.begin(); i != validRegion.end(); ++i) {
+                expected << (i->x() * 1000 + i->y());
+            }
+        }
+
+        TS_ASSERT_EQUALS(expected, delegate->values);
+        TS_ASSERT_EQUALS(std::size_t(4), delegate->dimensions.size());
+        TS_ASSERT_EQUALS(Coord<2>(100, 50), delegate->dimensions.back());
+        TS_ASSERT_EQUALS(region, delegate->lastRegion);
+    }
+
+private:
+    std::vector<Selector<TestCell<2> > > selectors;
+};
+
+}
@@ -0,0 +1,212 @@
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/io/sparsematrixcache.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/tempfile.h>
+
+#include <cxxtest/TestSuite.h>
+#include <fstream>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SparseMatrixCacheTest : public CxxTest::TestSuite
+{
+public:
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+    typedef SellCSigmaSparseMatrixContainer<double, 2, 4> Container;
+    typedef Container::SparseMatrix SparseMatrix;
+#endif
+
+    std::vector<std::string> files;
+
+    void setUp()
+    {
+        files.clear();
+    }
+
+    void tearDown()
+    {
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            unlink(files[i].c_str());
+        }
+    }
+
+    void testConvertAndLoadCSR()
+    {
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+        std::string mtx = writeFile(
+            "%%MatrixMarket matrix coordinate real general\n"
+            "% a comment\n"
+            "5 5 8\n"
+            "3 1 -2.5\n"
+            "1 1 1.0\n"
+            "5 5 5e2\n"
+            "\n"
+            "1 4 4.0\n"
+            "2 2 2.0\n"
+            "5 1 0.25\n"
+            "3 3 3.0\n"
+            "4 2 -1\n");
+        std::string cache = newFile();
+        SparseMatrixCache::convertMatrixMarket(mtx, cache);
+
+        SparseMatrix matrix;
+        matrix << std::make_pair(Coord<2>(0, 0), 1.0)
+               << std::make_pair(Coord<2>(0, 3), 4.0)
+               << std::make_pair(Coord<2>(1, 1), 2.0)
+               << std::make_pair(Coord<2>(2, 0), -2.5)
+               << std::make_pair(Coord<2>(2, 2), 3.0)
+               << std::make_pair(Coord<2>(3, 1), -1.0)
+               << std::make_pair(Coord<2>(4, 0), 0.25)
+               << std::make_pair(Coord<2>(4, 4), 500.0);
+        Container expected(5);
+        expected.initFromMatrix(matrix);
+
+        Container actual;
+        SparseMatrixCache::loadCSR(cache, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        std::vector<int> rowOffsets;
+        std::vector<int> columns;
+        std::vector<double> values;
+        SparseMatrixCache::loadCSR(cache, &rowOffsets, &columns, &values, 2, 2);
+        TS_ASSERT_EQUALS(std::vector<int>({0, 2, 3}), rowOffsets);
+        TS_ASSERT_EQUALS(std::vector<int>({0, 2, 1}), columns);
+        TS_ASSERT_EQUALS(std::vector<double>({-2.5, 3.0, -1.0}), values);
+#endif
+    }
+
+    void testLoadRowRange()
+    {
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+        std::vector<long> rowOffsets;
+        std::vector<int> columns;
+        std::vector<double> values;
+        rowOffsets << 0;
+        for (int row = 0; row < 100; ++row) {
+            for (int column = 0; column < 100; column += (row % 7 + 1)) {
+                columns << column;
+                values << row * 1000 + column;
+            }
+            rowOffsets << long(columns.size());
+        }
+
+        std::string cache = newFile();
+        SparseMatrixCache::writeCSR(cache, rowOffsets, columns, values);
+
+        std::pair<std::size_t, std::size_t> range = SparseMatrixCache::rowRange(cache, 1, 3);
+        TS_ASSERT_LESS_THAN(std::size_t(0), range.first);
+        TS_ASSERT_LESS_THAN(range.first, range.second);
+        TS_ASSERT_LESS_THAN(range.second, std::size_t(100));
+        TS_ASSERT_EQUALS(std::size_t(100), SparseMatrixCache::rowRange(cache, 2, 3).second);
+        TS_ASSERT_EQUALS(range.second, SparseMatrixCache::rowRange(cache, 2, 3).first);
+
+        std::size_t numRows = range.second - range.first;
+        Container part;
+        SparseMatrixCache::loadCSR(cache, &part, range.first, numRows);
+        TS_ASSERT_EQUALS(numRows, part.dim());
+
+        for (std::size_t row = 0; row < numRows; ++row) {
+            std::vector<std::pair<int, double> > entries =
+                part.getRow(part.realRowToSortedVec()[row].second);
+            std::size_t globalRow = range.first + row;
+            TS_ASSERT_EQUALS(std::size_t(rowOffsets[globalRow + 1] - rowOffsets[globalRow]), entries.size());
+
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                TS_ASSERT_EQUALS(columns[rowOffsets[globalRow] + i], entries[i].first);
+                TS_ASSERT_EQUALS(globalRow * 1000.0 + entries[i].first, entries[i].second);
+            }
+        }
+#endif
+    }
+
+    void testSymmetricPattern()
+    {
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+        std::string mtx = writeFile(
+            "%%MatrixMarket matrix coordinate pattern symmetric\n"
+            "3 3 3\n"
+            "1 1\n"
+            "3 1\n"
+            "3 2\n");
+        std::string cache = newFile();
+        SparseMatrixCache::convertMatrixMarket(mtx, cache);
+
+        std::vector<int> rowOffsets;
+        std::vector<int> columns;
+        std::vector<double> values;
+        SparseMatrixCache::loadCSR(cache, &rowOffsets, &columns, &values);
+        TS_ASSERT_EQUALS(std::vector<int>({0, 2, 3, 5}), rowOffsets);
+        TS_ASSERT_EQUALS(std::vector<int>({0, 2, 2, 0, 1}), columns);
+        TS_ASSERT_EQUALS(std::vector<double>(5, 1.0), values);
+
+        Container container;
+        TS_ASSERT_THROWS(SparseMatrixCache::loadSell(cache, &container), IOException&);
+        std::vector<float> floats;
+        TS_ASSERT_THROWS(SparseMatrixCache::loadCSR(cache, &rowOffsets, &columns, &floats), IOException&);
+#endif
+    }
+
+    void testMalformedInput()
+    {
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+        std::string cache = newFile();
+        std::string mtx = writeFile(
+            "%%MatrixMarket matrix coordinate real general\n"
+            "2 2 2\n"
+            "1 1 1.0\n"
+            "3 1 1.0\n");
+        TS_ASSERT_THROWS(SparseMatrixCache::convertMatrixMarket(mtx, cache), IOException&);
+
+        mtx = writeFile(
+            "%%MatrixMarket matrix array real general\n"
+            "2 2\n");
+        TS_ASSERT_THROWS(SparseMatrixCache::convertMatrixMarket(mtx, cache), IOException&);
+#endif
+    }
+
+    void testSellRoundTrip()
+    {
+#if defined(LIBGEODECOMP_WITH_CPP14) && !defined(_WIN32)
+        SparseMatrix matrix;
+        for (int row = 0; row < 13; ++row) {
+            for (int column = row % 3; column < 13; column += (row % 4 + 1)) {
+                matrix << std::make_pair(Coord<2>(row, column), row + 0.1 * column);
+            }
+        }
+        Container expected(13);
+        expected.initFromMatrix(matrix);
+
+        std::string cache = newFile();
+        SparseMatrixCache::writeSell(cache, expected);
+
+        Container actual;
+        SparseMatrixCache::loadSell(cache, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+        TS_ASSERT_EQUALS(expected.chunkOffsetVec(),    actual.chunkOffsetVec());
+        TS_ASSERT_EQUALS(expected.realRowToSortedVec(), actual.realRowToSortedVec());
+
+        SellCSigmaSparseMatrixContainer<double, 4, 4> other;
+        TS_ASSERT_THROWS(SparseMatrixCache::loadSell(cache, &other), IOException&);
+#endif
+    }
+
+private:
+    std::string newFile()
+    {
+        files << TempFile::serial("sparsematrixcache");
+        return files.back();
+    }
+
+    std::string writeFile(const std::string& content)
+    {
+        std::string name = newFile();
+        std::ofstream file(name.c_str());
+        file << content;
+        return name;
+    }
+};
+
+}
@@ -0,0 +1,60 @@
+#include <stdexcept>
+#include <libgeodecomp/loadbalancer/costprofilebalancer.h>
+
+namespace LibGeoDecomp {
+
+CostProfileBalancer::WeightVec CostProfileBalancer::balance(
+    const CostProfileBalancer::WeightVec& weights,
+    const CostProfileBalancer::LoadVec& relativeLoads)
+{
+    if (weights.size() != relativeLoads.size()) {
+        throw std::invalid_argument("weights and relativeLoads need to match in size");
+    }
+
+    LoadVec itemCosts;
+    itemCosts.reserve(sum(weights));
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        for (std::size_t j = 0; j < weights[i]; ++j) {
+            itemCosts << relativeLoads[i] / weights[i];
+        }
+    }
+
+    return balance(weights, relativeLoads, itemCosts);
+}
+
+
+CostProfileBalancer::WeightVec CostProfileBalancer::balance(
+    const CostProfileBalancer::WeightVec& weights,
+    const CostProfileBalancer::LoadVec& /* relativeLoads */,
+    const CostProfileBalancer::LoadVec& itemCosts)
+{
+    if (itemCosts.size() != sum(weights)) {
+        throw std::invalid_argument("number of item costs doesn't match number of items");
+    }
+
+    double totalCost = sum(itemCosts);
+    if (totalCost <= 0) {
+        return weights;
+    }
+
+    std::size_t n = weights.size();
+    WeightVec ret(n, 0);
+    double accumulatedCost = 0;
+    std::size_t node = 0;
+
+    // an item goes to the node on whose share its center of mass
+    // falls, so boundaries land on the cost profile's equipartition:
+    for (std::size_t i = 0; i < itemCosts.size(); ++i) {
+        double center = accumulatedCost + 0.5 * itemCosts[i];
+        while ((node < (n - 1)) && (center > (totalCost * (node + 1) / n))) {
+            ++node;
+        }
+
+        ++ret[node];
+        accumulatedCost += itemCosts[i];
+    }
+
+    return ret;
+}
+
+}
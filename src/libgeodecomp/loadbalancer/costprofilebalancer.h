@@ -0,0 +1,43 @@
+#ifndef LIBGEODECOMP_LOADBALANCER_COSTPROFILEBALANCER_H
+#define LIBGEODECOMP_LOADBALANCER_COSTPROFILEBALANCER_H
+
+#include <libgeodecomp/loadbalancer/loadbalancer.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * The CostProfileBalancer doesn't assume that all items on a node
+ * are equally expensive. Instead it expects the measured cost of
+ * each individual item (e.g. the time spent on each row of a
+ * stripe, see StripingSimulator) and cuts the sequence of items into
+ * consecutive chunks of (nearly) equal cost.
+ *
+ * As the cost profile moves along with the items, hot spots which
+ * wander through the simulation space are tracked within a few
+ * balancing rounds, instead of making the decomposition oscillate
+ * around them.
+ */
+class HPX_COMPONENT_EXPORT CostProfileBalancer : public LoadBalancer
+{
+public:
+    /**
+     * Without a cost profile we can only assume that all items on a
+     * node are equally expensive, so we'll derive the profile from
+     * relativeLoads.
+     */
+    virtual WeightVec balance(const WeightVec& weights, const LoadVec& relativeLoads);
+
+    /**
+     * itemCosts[i] is the measured cost of the i-th item, counted
+     * across all nodes in the order given by weights. Its size has
+     * to match the sum of all weights.
+     */
+    virtual WeightVec balance(
+        const WeightVec& weights,
+        const LoadVec& relativeLoads,
+        const LoadVec& itemCosts);
+};
+
+}
+
+#endif
@@ -18,7 +18,7 @@ OozeBalancer::LoadVec OozeBalancer::expectedOptimalDistribution(
     const OozeBalancer::WeightVec& weights,
     const OozeBalancer::LoadVec& relativeLoads) const
 {
-    unsigned n = weights.size();
+    std::size_t n = weights.size();
     // calculate approximate load share we want on each node
     double targetLoadPerNode = sum(relativeLoads) / n;
 
@@ -26,39 +26,44 @@ OozeBalancer::LoadVec OozeBalancer::expectedOptimalDistribution(
         return LoadVec(n, sum(weights)/ (double)n);
     }
 
+    // All items of a node are assumed to be equally expensive, so
+    // the load function is piecewise constant with one segment per
+    // node. We can therefore assign whole segments (or fractions
+    // thereof) instead of single items. Nodes without items don't
+    // contribute a segment.
     LoadVec ret(n, 0);
-    LoadVec loadPerItem;
-    for (unsigned i = 0; i < n; i++) {
-        if (weights[i]) {
-            LoadVec add(weights[i], relativeLoads[i] / weights[i]);
-            append(loadPerItem, add);
-        }
-    }
-    // stores the remaining fraction, which is still to be assigned,
-    // of each item.
-    LoadVec remFractPerItem(sum(weights), 1.0);
+    std::size_t segment = 0;
+    // the number of items (possibly fractional) which is still to
+    // be assigned from the current segment:
+    double remItems = weights[0];
 
     // now fill up one node after another so that each gets his
     // targeted share...
-    for (unsigned nodeC = 0; nodeC < n - 1; nodeC++) {
+    for (std::size_t nodeC = 0; nodeC < n - 1; nodeC++) {
         double remLoad = targetLoadPerNode;
 
-        for (unsigned itemC = 0; itemC < loadPerItem.size(); itemC++) {
-            // skip already assigned items
-            if (remFractPerItem[itemC] == 0) {
+        while (segment < n) {
+            // skip already assigned segments
+            if (remItems == 0) {
+                ++segment;
+                if (segment < n) {
+                    remItems = weights[segment];
+                }
                 continue;
             }
 
+            double loadPerItem = relativeLoads[segment] / weights[segment];
+
             // can we assign the whole remainder?
-            double l = remFractPerItem[itemC] * loadPerItem[itemC];
+            double l = remItems * loadPerItem;
             if (l <= remLoad) {
-                ret[nodeC] += remFractPerItem[itemC];
-                remFractPerItem[itemC] = 0;
+                ret[nodeC] += remItems;
+                remItems = 0;
                 remLoad -= l;
             } else {
-                double consumedFract = remLoad / loadPerItem[itemC];
-                ret[nodeC] += consumedFract;
-                remFractPerItem[itemC] -= consumedFract;
+                double consumedItems = remLoad / loadPerItem;
+                ret[nodeC] += consumedItems;
+                remItems -= consumedItems;
                 remLoad = 0;
             }
 
@@ -70,7 +75,10 @@ OozeBalancer::LoadVec OozeBalancer::expectedOptimalDistribution(
     }
 
     // add remainder to last node
-    ret.back() += sum(remFractPerItem);
+    ret.back() += remItems;
+    for (++segment; segment < n; ++segment) {
+        ret.back() += weights[segment];
+    }
 
     return ret;
 }
@@ -118,7 +126,7 @@ OozeBalancer::WeightVec OozeBalancer::equalize(const LoadVec& loads)
     for (unsigned i = 0; i < ret.size() - 1; i++) {
         double f = frac(loads[i]);
         double roundUpCost = 1 - f;
-        ret[i] = (long)loads[i];
+        ret[i] = (std::size_t)loads[i];
 
         if (roundUpCost < balance) {
             balance -= roundUpCost;
@@ -128,7 +136,7 @@ OozeBalancer::WeightVec OozeBalancer::equalize(const LoadVec& loads)
         }
     }
 
-    ret.back() = (long)loads.back();
+    ret.back() = (std::size_t)loads.back();
     if (frac(loads.back())  > (0.5 - balance)) {
         ret.back()++;
     }
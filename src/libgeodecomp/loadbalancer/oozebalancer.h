@@ -70,6 +70,10 @@ private:
      * \f]
      *
      * (\f$t\f$ is currently computed on node \f$a\f$.)
+     *
+     * As \f$f\f$ is piecewise constant, the cuts are computed per
+     * node, not per item: runtime is \f$O(n)\f$, independent of
+     * the number of items.
      */
     LoadVec expectedOptimalDistribution(
         const WeightVec& weights,
@@ -0,0 +1,67 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/loadbalancer/costprofilebalancer.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class CostProfileBalancerTest : public CxxTest::TestSuite
+{
+public:
+    void testUniformCosts()
+    {
+        CostProfileBalancer b;
+        CostProfileBalancer::WeightVec weights;
+        weights << 10 << 0 << 2;
+        CostProfileBalancer::LoadVec costs(12, 1.0);
+
+        CostProfileBalancer::WeightVec expected;
+        expected << 4 << 4 << 4;
+        TS_ASSERT_EQUALS(expected, b.balance(weights, CostProfileBalancer::LoadVec(3, 0.5), costs));
+    }
+
+    void testHotSpot()
+    {
+        CostProfileBalancer b;
+        CostProfileBalancer::WeightVec weights;
+        weights << 5 << 5 << 5;
+        CostProfileBalancer::LoadVec costs(15, 1.0);
+        // rows 6 and 7 are as expensive as all others together:
+        costs[6] = 6.5;
+        costs[7] = 6.5;
+
+        CostProfileBalancer::WeightVec expected;
+        expected << 6 << 2 << 7;
+        CostProfileBalancer::WeightVec actual = b.balance(weights, CostProfileBalancer::LoadVec(3, 0.5), costs);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        // balancing the same profile again must not alter the decomposition:
+        TS_ASSERT_EQUALS(expected, b.balance(actual, CostProfileBalancer::LoadVec(3, 0.5), costs));
+    }
+
+    void testNoMeasurements()
+    {
+        CostProfileBalancer b;
+        CostProfileBalancer::WeightVec weights;
+        weights << 1 << 2 << 3;
+
+        TS_ASSERT_EQUALS(weights, b.balance(weights, CostProfileBalancer::LoadVec(3, 0), CostProfileBalancer::LoadVec(6, 0)));
+        TS_ASSERT_THROWS(b.balance(weights, CostProfileBalancer::LoadVec(3, 0), CostProfileBalancer::LoadVec(5, 1)),
+                         std::invalid_argument&);
+    }
+
+    void testFallbackToRelativeLoads()
+    {
+        CostProfileBalancer b;
+        CostProfileBalancer::WeightVec weights;
+        weights << 4 << 4;
+        CostProfileBalancer::LoadVec relativeLoads;
+        relativeLoads << 0.6 << 0.2;
+
+        CostProfileBalancer::WeightVec expected;
+        expected << 3 << 5;
+        TS_ASSERT_EQUALS(expected, b.balance(weights, relativeLoads));
+    }
+};
+
+}
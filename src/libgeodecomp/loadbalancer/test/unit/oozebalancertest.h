@@ -1,5 +1,6 @@
 #include <limits>
 #include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/random.h>
 #include <libgeodecomp/misc/testhelper.h>
 #include <libgeodecomp/loadbalancer/mockbalancer.h>
 #include <libgeodecomp/loadbalancer/oozebalancer.h>
@@ -110,6 +111,103 @@ public:
 
         checkExpectedOptimalDistribution(expected, loads, relLoads);
     }
+
+    void testOptDistMatchesPerItemDistribution()
+    {
+        Random::seed(4711);
+        OozeBalancer b;
+
+        for (int round = 0; round < 100; ++round) {
+            std::size_t n = 1 + Random::genUnsigned(20);
+            OozeBalancer::WeightVec loads(n);
+            OozeBalancer::LoadVec relLoads(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                // sprinkle in some idle and some empty nodes:
+                loads[i] = (Random::genUnsigned(5) == 0) ? 0 : Random::genUnsigned(50);
+                relLoads[i] = (Random::genUnsigned(5) == 0) ? 0 : Random::genDouble(1.0);
+            }
+
+            OozeBalancer::LoadVec expected = perItemDistribution(loads, relLoads);
+            OozeBalancer::LoadVec actual = b.expectedOptimalDistribution(loads, relLoads);
+
+            TS_ASSERT_EQUALS(expected.size(), actual.size());
+            for (std::size_t i = 0; i < n; ++i) {
+                TS_ASSERT_DELTA(expected[i], actual[i], 1e-9);
+            }
+        }
+    }
+
+    void testHugeNumberOfItems()
+    {
+        // 4e10 items would have been far too many to be handled one by one:
+        std::size_t n = 1000;
+        OozeBalancer::WeightVec loads(n, 40000000);
+        OozeBalancer::LoadVec relLoads(n, 0.5);
+        relLoads[0] = 1.0;
+
+        OozeBalancer::WeightVec actual = OozeBalancer().balance(loads, relLoads);
+        TS_ASSERT_EQUALS(sum(loads), sum(actual));
+        TS_ASSERT(actual[0] < loads[0]);
+        TS_ASSERT(actual.back() > loads.back());
+    }
+
+private:
+    /**
+     * reference implementation which cuts the sequence of items
+     * item by item.
+     */
+    OozeBalancer::LoadVec perItemDistribution(
+        const OozeBalancer::WeightVec& weights,
+        const OozeBalancer::LoadVec& relativeLoads)
+    {
+        unsigned n = weights.size();
+        double targetLoadPerNode = sum(relativeLoads) / n;
+
+        if (targetLoadPerNode == 0) {
+            return OozeBalancer::LoadVec(n, sum(weights)/ (double)n);
+        }
+
+        OozeBalancer::LoadVec ret(n, 0);
+        OozeBalancer::LoadVec loadPerItem;
+        for (unsigned i = 0; i < n; i++) {
+            if (weights[i]) {
+                OozeBalancer::LoadVec add(weights[i], relativeLoads[i] / weights[i]);
+                append(loadPerItem, add);
+            }
+        }
+        OozeBalancer::LoadVec remFractPerItem(sum(weights), 1.0);
+
+        for (unsigned nodeC = 0; nodeC < n - 1; nodeC++) {
+            double remLoad = targetLoadPerNode;
+
+            for (unsigned itemC = 0; itemC < loadPerItem.size(); itemC++) {
+                if (remFractPerItem[itemC] == 0) {
+                    continue;
+                }
+
+                double l = remFractPerItem[itemC] * loadPerItem[itemC];
+                if (l <= remLoad) {
+                    ret[nodeC] += remFractPerItem[itemC];
+                    remFractPerItem[itemC] = 0;
+                    remLoad -= l;
+                } else {
+                    double consumedFract = remLoad / loadPerItem[itemC];
+                    ret[nodeC] += consumedFract;
+                    remFractPerItem[itemC] -= consumedFract;
+                    remLoad = 0;
+                }
+
+                if (remLoad == 0) {
+                    break;
+                }
+            }
+        }
+
+        ret.back() += sum(remFractPerItem);
+
+        return ret;
+    }
 };
 
 
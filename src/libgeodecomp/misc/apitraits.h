@@ -18,6 +18,9 @@
 
 namespace LibGeoDecomp {
 
+template<typename CELL>
+class Selector;
+
 #ifdef LIBGEODECOMP_WITH_MPI
 class Typemaps;
 #endif
@@ -1169,6 +1172,78 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    template<typename CELL, typename HAS_HALO_MEMBERS = void>
+    class SelectHaloMembers
+    {
+    public:
+        typedef FalseType Value;
+    };
+
+    template<typename CELL>
+    class SelectHaloMembers<CELL, typename CELL::API::SupportsHaloMembers>
+    {
+    public:
+        typedef TrueType Value;
+
+        static std::vector<Selector<CELL> > value(std::size_t nanoStep)
+        {
+            return CELL::API::haloMembers(nanoStep);
+        }
+    };
+
+    /**
+     * Models with SoA layout whose neighbors only read some of a
+     * cell's members (e.g. the particle distribution functions of a
+     * lattice Boltzmann model) can use this trait to restrict ghost
+     * zone synchronization to these members. The API needs to
+     * provide a function
+     *
+     *   static std::vector<Selector<CELL> > haloMembers(std::size_t nanoStep)
+     *
+     * which returns the members that neighboring cells read during
+     * the given nano step (0 <= nanoStep < NANO_STEPS).
+     *
+     * This only applies to ghost zones of width 1: wider ghost zones
+     * get updated locally and hence need the cells' complete state.
+     */
+    class HasHaloMembers
+    {
+    public:
+        typedef void SupportsHaloMembers;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
+    template<typename CELL, typename HAS_PADDED_TORUS_GRID = void>
+    class SelectPaddedTorusGrid
+    {
+    public:
+        typedef FalseType Value;
+    };
+
+    template<typename CELL>
+    class SelectPaddedTorusGrid<CELL, typename CELL::API::SupportsPaddedTorusGrid>
+    {
+    public:
+        typedef TrueType Value;
+    };
+
+    /**
+     * Requests that SerialSimulator and OpenMPSimulator store the
+     * grid in a PaddedTorusGrid: a ghost frame as wide as the
+     * stencil's radius is refreshed once per nano step, so updates
+     * near the boundaries of periodic topologies don't need to wrap
+     * coordinates. Only applies to models without SoA layout. Cells
+     * must not read beyond their stencil.
+     */
+    class HasPaddedTorusGrid
+    {
+    public:
+        typedef void SupportsPaddedTorusGrid;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     // Trait Template:
 
     // template<typename CELL, typename HAS_TEMPLATE_NAME = void>
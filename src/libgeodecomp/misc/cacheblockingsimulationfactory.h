@@ -18,6 +18,7 @@ public:
     using SimulationFactory<CELL>::addSteerers;
     using SimulationFactory<CELL>::addWriters;
     typedef typename SimulationFactory<CELL>::InitPtr InitPtr;
+    static const int DIM = APITraits::SelectTopology<CELL>::Value::DIM;
 
     explicit
     CacheBlockingSimulationFactory<CELL>(InitPtr initializer):
@@ -42,7 +43,12 @@ protected:
         int wavefrontWidth  = params["WavefrontWidth"];
         int wavefrontHeight = params["WavefrontHeight"];
 
-        Coord<2> wavefrontDim(wavefrontWidth, wavefrontHeight);
+        int extents[] = { wavefrontWidth, wavefrontHeight };
+        Coord<DIM - 1> wavefrontDim;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            wavefrontDim[d] = extents[d];
+        }
+
         CacheBlockingSimulator<CELL> *sim =
             new CacheBlockingSimulator<CELL>(
                 initializer->clone(),
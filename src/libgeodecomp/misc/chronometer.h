@@ -1,9 +1,14 @@
 #ifndef LIBGEODECOMP_MISC_CHRONOMETER_H
 #define LIBGEODECOMP_MISC_CHRONOMETER_H
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/misc/scopedtimer.h>
 #include <libgeodecomp/storage/fixedarray.h>
 
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <atomic>
+#endif
+
 #include <iomanip>
 #include <sstream>
 
@@ -11,6 +16,30 @@ namespace LibGeoDecomp {
 
 namespace ChronometerHelpers {
 
+/**
+ * Callback type for tracing individual events (see EventTrace).
+ * Receives the event's ID plus its start and end time.
+ */
+typedef void (*EventHook)(int id, double start, double end);
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+typedef std::atomic<EventHook> SharedEventHook;
+#else
+typedef EventHook SharedEventHook;
+#endif
+
+/**
+ * The hook is global so that tracing doesn't alter the layout of
+ * Chronometer, which is serialized and sent via MPI. A null hook
+ * disables tracing. It's set by the thread which activates an
+ * EventTrace, but read by all timing threads, hence it's atomic.
+ */
+inline SharedEventHook& eventHook()
+{
+    static SharedEventHook hook(0);
+    return hook;
+}
+
 /**
  * This class is a tool for counting the number of events and
  * converting their IDs to strings.
@@ -134,7 +163,13 @@ public:
                                                                     \
         ~CLASS_NAME()                                               \
         {                                                           \
+            double start = t;                                       \
             t = elapsed();                                          \
+            ChronometerHelpers::EventHook hook =                    \
+                ChronometerHelpers::eventHook();                    \
+            if (hook) {                                             \
+                hook(ID, start, start + t);                         \
+            }                                                       \
         }                                                           \
     };
 }
@@ -319,7 +354,12 @@ public:
     template<typename EVENT>
     void tock(double startTime)
     {
-        addTime<EVENT>(ScopedTimer::time() - startTime);
+        double endTime = ScopedTimer::time();
+        addTime<EVENT>(endTime - startTime);
+        ChronometerHelpers::EventHook hook = ChronometerHelpers::eventHook();
+        if (hook) {
+            hook(EVENT::ID, startTime, endTime);
+        }
     }
 
     std::string report()
@@ -0,0 +1,618 @@
+#ifndef LIBGEODECOMP_MISC_EVENTTRACE_H
+#define LIBGEODECOMP_MISC_EVENTTRACE_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/scopedtimer.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <atomic>
+#include <mutex>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Whereas the Chronometer only accumulates the time spent per event
+ * ID, the EventTrace records every single event: its start and end
+ * time, the nano step during which it occurred and -- for ghost zone
+ * communication -- the neighbor's rank and the number of bytes
+ * transferred. This allows us to spot skew between ranks and late
+ * neighbors, e.g. when tuning the ghostZoneWidth.
+ *
+ * Once activated, all timers of all Chronometers and all PatchLinks
+ * of the process record into the trace. Events are stored in one
+ * ring buffer per thread, so only the most recent events are
+ * retained. Threads register on their first event, which is the only
+ * time recording takes a lock. This includes threads which OpenMP
+ * doesn't know about, e.g. the AsyncWriter's worker or HPX threads.
+ * (Without C++14 support buffers are assigned by OpenMP thread ID
+ * instead, so only OpenMP threads may record then.) The nano step is
+ * set by the Steppers. Both it and the active trace are atomic as
+ * they're read by all recording threads.
+ *
+ * The trace can be exported in Chrome's trace event format (view it
+ * via chrome://tracing or ui.perfetto.dev) and condensed into one
+ * StepSummary per nano step, which is the input for
+ * criticalPathReport().
+ */
+class EventTrace
+{
+public:
+    static const std::size_t DEFAULT_CAPACITY = 1 << 16;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+    typedef std::atomic<EventTrace*> SharedTracePointer;
+    typedef std::atomic<long> SharedNanoStep;
+#else
+    typedef EventTrace *SharedTracePointer;
+    typedef long SharedNanoStep;
+#endif
+
+    /**
+     * A single traced event. peer is the neighbor's rank for
+     * communication events and -1 otherwise.
+     */
+    class Event
+    {
+    public:
+        inline explicit Event(
+            int id = 0,
+            double start = 0,
+            double end = 0,
+            long nanoStep = -1,
+            int thread = 0,
+            int peer = -1,
+            std::size_t bytes = 0,
+            bool outgoing = false) :
+            id(id),
+            start(start),
+            end(end),
+            nanoStep(nanoStep),
+            thread(thread),
+            peer(peer),
+            bytes(bytes),
+            outgoing(outgoing)
+        {}
+
+        inline double duration() const
+        {
+            return end - start;
+        }
+
+        /**
+         * Orders by start time, enclosing events come first.
+         */
+        inline bool operator<(const Event& other) const
+        {
+            return (start < other.start) ||
+                ((start == other.start) && (end > other.end));
+        }
+
+        int id;
+        double start;
+        double end;
+        long nanoStep;
+        int thread;
+        int peer;
+        std::size_t bytes;
+        bool outgoing;
+    };
+
+    /**
+     * Aggregate of all events of one nano step on one rank. wait is
+     * the time spent receiving ghost zones, send the time spent
+     * packing and sending them. slowestPeer is the neighbor we waited
+     * for longest. Summaries contain no pointers so that they can be
+     * gathered as raw bytes.
+     */
+    class StepSummary
+    {
+    public:
+        inline explicit StepSummary(long nanoStep = -1) :
+            nanoStep(nanoStep),
+            start(0),
+            end(0),
+            compute(0),
+            wait(0),
+            send(0),
+            bytes(0),
+            slowestPeer(-1),
+            slowestPeerWait(0)
+        {}
+
+        inline double span() const
+        {
+            return end - start;
+        }
+
+        long nanoStep;
+        double start;
+        double end;
+        double compute;
+        double wait;
+        double send;
+        std::size_t bytes;
+        int slowestPeer;
+        double slowestPeerWait;
+    };
+
+    inline explicit EventTrace(std::size_t capacity = DEFAULT_CAPACITY) :
+        capacity(capacity),
+#ifdef LIBGEODECOMP_WITH_CPP14
+        id(nextID()++),
+#else
+        buffers(maxThreads(), RingBuffer(capacity)),
+#endif
+        startTime(ScopedTimer::time()),
+        nanoStep(-1)
+    {}
+
+    ~EventTrace()
+    {
+        deactivate();
+    }
+
+    /**
+     * Routes all events of this process to this trace. Only one
+     * trace can be active at a time.
+     */
+    void activate()
+    {
+        activeTrace() = this;
+        ChronometerHelpers::eventHook() = &recordTimer;
+    }
+
+    void deactivate()
+    {
+        if (activeTrace() == this) {
+            activeTrace() = 0;
+            ChronometerHelpers::eventHook() = 0;
+        }
+    }
+
+    static EventTrace *active()
+    {
+        return activeTrace();
+    }
+
+    /**
+     * Events recorded from now on will be attributed to the given
+     * nano step.
+     */
+    static void setNanoStep(long nanoStep)
+    {
+        EventTrace *trace = active();
+        if (trace) {
+            trace->nanoStep = nanoStep;
+        }
+    }
+
+    /**
+     * Records a ghost zone transfer to (outgoing) or from peer.
+     */
+    static void recordCommunication(int peer, std::size_t bytes, bool outgoing, double start)
+    {
+        EventTrace *trace = active();
+        if (trace) {
+            trace->record(Event(
+                              TimeCommunication::ID,
+                              start,
+                              ScopedTimer::time(),
+                              trace->nanoStep,
+                              0,
+                              peer,
+                              bytes,
+                              outgoing));
+        }
+    }
+
+    /**
+     * Stores event in the calling thread's buffer. The thread ID
+     * given in the event is overwritten with the index of that
+     * buffer.
+     */
+    inline void record(Event event)
+    {
+        int thread;
+        RingBuffer *buffer = threadBuffer(&thread);
+        if (!buffer) {
+            return;
+        }
+
+        event.thread = thread;
+        buffer->push(event);
+    }
+
+    /**
+     * Returns all retained events, ordered by their start time.
+     */
+    std::vector<Event> events() const
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        std::vector<Event> ret;
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            buffers[i].copyTo(&ret);
+        }
+        std::stable_sort(ret.begin(), ret.end());
+
+        return ret;
+    }
+
+    /**
+     * Number of events which were dropped due to the limited
+     * capacity of the ring buffers.
+     */
+    std::size_t lostEvents() const
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            ret += buffers[i].lost();
+        }
+
+        return ret;
+    }
+
+    void clear()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            buffers[i].clear();
+        }
+    }
+
+    /**
+     * Time at which the trace was created, serves as the time origin
+     * of chromeTrace().
+     */
+    double origin() const
+    {
+        return startTime;
+    }
+
+    std::vector<StepSummary> stepSummaries() const
+    {
+        std::map<long, StepSummary> summaries;
+        std::vector<Event> events = this->events();
+
+        for (std::vector<Event>::iterator i = events.begin(); i != events.end(); ++i) {
+            if (i->nanoStep < 0) {
+                continue;
+            }
+
+            std::map<long, StepSummary>::iterator iter = summaries.find(i->nanoStep);
+            if (iter == summaries.end()) {
+                StepSummary summary(i->nanoStep);
+                summary.start = i->start;
+                summary.end = i->end;
+                iter = summaries.insert(std::make_pair(i->nanoStep, summary)).first;
+            }
+            StepSummary& summary = iter->second;
+
+            summary.start = (std::min)(summary.start, i->start);
+            summary.end = (std::max)(summary.end, i->end);
+
+            if ((i->id == TimeCompute::ID) ||
+                (i->id == TimeComputeInner::ID) ||
+                (i->id == TimeComputeGhost::ID)) {
+                summary.compute += i->duration();
+            }
+
+            if (i->peer < 0) {
+                continue;
+            }
+
+            summary.bytes += i->bytes;
+            if (i->outgoing) {
+                summary.send += i->duration();
+            } else {
+                summary.wait += i->duration();
+                if (i->duration() > summary.slowestPeerWait) {
+                    summary.slowestPeer = i->peer;
+                    summary.slowestPeerWait = i->duration();
+                }
+            }
+        }
+
+        std::vector<StepSummary> ret;
+        for (std::map<long, StepSummary>::iterator i = summaries.begin(); i != summaries.end(); ++i) {
+            ret.push_back(i->second);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Returns the events as a comma separated list of JSON objects in
+     * Chrome's trace event format. Timestamps are given in
+     * microseconds since epoch, pid is used to tell ranks apart.
+     */
+    std::string chromeTraceEvents(int pid, double epoch) const
+    {
+        std::stringstream buf;
+        buf << std::fixed << std::setprecision(3);
+        buf << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"args\":{\"name\":\"rank " << pid << "\"}}";
+
+        std::vector<Event> events = this->events();
+        for (std::vector<Event>::iterator i = events.begin(); i != events.end(); ++i) {
+            buf << ",\n{\"name\":\"" << ChronometerHelpers::EventToString()(i->id)
+                << "\",\"cat\":\"libgeodecomp\",\"ph\":\"X\",\"pid\":" << pid
+                << ",\"tid\":" << i->thread
+                << ",\"ts\":" << (i->start - epoch) * 1e6
+                << ",\"dur\":" << i->duration() * 1e6
+                << ",\"args\":{\"nano_step\":" << i->nanoStep;
+            if (i->peer >= 0) {
+                buf << ",\"peer\":" << i->peer
+                    << ",\"bytes\":" << i->bytes
+                    << ",\"direction\":\"" << (i->outgoing ? "send" : "recv") << "\"";
+            }
+            buf << "}}";
+        }
+
+        return buf.str();
+    }
+
+    /**
+     * Wraps the output of one or more calls to chromeTraceEvents()
+     * into a complete trace.
+     */
+    static std::string chromeTrace(const std::string& events)
+    {
+        return "{\"traceEvents\":[\n" + events + "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    std::string chromeTrace(int pid = 0) const
+    {
+        return chromeTrace(chromeTraceEvents(pid, origin()));
+    }
+
+    /**
+     * Condenses the step summaries of all ranks (indexed by rank)
+     * into a table with one row per nano step: the wall clock time
+     * spanned by the step, the rank with the highest compute time
+     * (i.e. the one all others are likely waiting for), the longest
+     * ghost zone wait and for whom this rank was waiting. If waits
+     * are long compared to compute times, increasing the
+     * ghostZoneWidth may help to hide the latency.
+     */
+    static std::string criticalPathReport(const std::vector<std::vector<StepSummary> >& summaries)
+    {
+        std::map<long, std::vector<std::pair<int, StepSummary> > > steps;
+        for (std::size_t rank = 0; rank < summaries.size(); ++rank) {
+            for (std::size_t i = 0; i < summaries[rank].size(); ++i) {
+                steps[summaries[rank][i].nanoStep].push_back(
+                    std::make_pair(int(rank), summaries[rank][i]));
+            }
+        }
+
+        std::stringstream buf;
+        buf << std::left
+            << std::setw(10) << "nano_step"
+            << std::setw(12) << "span[s]"
+            << std::setw(10) << "critical"
+            << std::setw(12) << "compute[s]"
+            << std::setw(12) << "wait[s]"
+            << std::setw(10) << "waiting"
+            << std::setw(10) << "late_peer"
+            << "bytes\n";
+
+        double totalSpan = 0;
+        double totalCompute = 0;
+        double totalWait = 0;
+        std::map<int, int> criticalCount;
+
+        for (std::map<long, std::vector<std::pair<int, StepSummary> > >::iterator i = steps.begin();
+             i != steps.end();
+             ++i) {
+            const std::vector<std::pair<int, StepSummary> >& ranks = i->second;
+            double start = ranks[0].second.start;
+            double end = ranks[0].second.end;
+            std::size_t critical = 0;
+            std::size_t waiting = 0;
+            std::size_t bytes = 0;
+
+            for (std::size_t j = 0; j < ranks.size(); ++j) {
+                const StepSummary& summary = ranks[j].second;
+                start = (std::min)(start, summary.start);
+                end = (std::max)(end, summary.end);
+                bytes += summary.bytes;
+
+                if (summary.compute > ranks[critical].second.compute) {
+                    critical = j;
+                }
+                if (summary.wait > ranks[waiting].second.wait) {
+                    waiting = j;
+                }
+            }
+
+            const StepSummary& criticalSummary = ranks[critical].second;
+            const StepSummary& waitingSummary = ranks[waiting].second;
+            totalSpan += end - start;
+            totalCompute += criticalSummary.compute;
+            totalWait += waitingSummary.wait;
+            ++criticalCount[ranks[critical].first];
+
+            buf << std::setw(10) << i->first
+                << std::setw(12) << end - start
+                << std::setw(10) << ranks[critical].first
+                << std::setw(12) << criticalSummary.compute
+                << std::setw(12) << waitingSummary.wait
+                << std::setw(10) << ranks[waiting].first
+                << std::setw(10) << waitingSummary.slowestPeer
+                << bytes << "\n";
+        }
+
+        buf << "total span: " << totalSpan
+            << "s, critical compute: " << totalCompute
+            << "s, max wait: " << totalWait << "s\n";
+        buf << "critical rank histogram:";
+        for (std::map<int, int>::iterator i = criticalCount.begin(); i != criticalCount.end(); ++i) {
+            buf << " " << i->first << ":" << i->second;
+        }
+        buf << "\n";
+
+        return buf.str();
+    }
+
+private:
+    /**
+     * Fixed capacity buffer which overwrites the oldest events once
+     * it's full. Padded to avoid false sharing between threads.
+     */
+    class RingBuffer
+    {
+    public:
+        inline explicit RingBuffer(std::size_t capacity = 0) :
+            buffer(capacity),
+            next(0),
+            counter(0)
+        {}
+
+        inline void push(const Event& event)
+        {
+            if (buffer.empty()) {
+                return;
+            }
+
+            buffer[next] = event;
+            ++counter;
+            if (++next == buffer.size()) {
+                next = 0;
+            }
+        }
+
+        void copyTo(std::vector<Event> *target) const
+        {
+            if (counter >= buffer.size()) {
+                target->insert(target->end(), buffer.begin() + next, buffer.end());
+            }
+            target->insert(target->end(), buffer.begin(), buffer.begin() + next);
+        }
+
+        std::size_t lost() const
+        {
+            return counter - (std::min)(counter, buffer.size());
+        }
+
+        void clear()
+        {
+            next = 0;
+            counter = 0;
+        }
+
+    private:
+        std::vector<Event> buffer;
+        std::size_t next;
+        std::size_t counter;
+        char padding[64];
+    };
+
+    std::size_t capacity;
+#ifdef LIBGEODECOMP_WITH_CPP14
+    std::size_t id;
+    mutable std::mutex mutex;
+#endif
+    // a deque doesn't move its elements on push_back(), so threads
+    // may hold on to their buffers while others register:
+    std::deque<RingBuffer> buffers;
+    double startTime;
+    // written by the simulation's thread, read by all recording threads:
+    SharedNanoStep nanoStep;
+
+    EventTrace(const EventTrace& other);
+    EventTrace& operator=(const EventTrace& other);
+
+    static SharedTracePointer& activeTrace()
+    {
+        static SharedTracePointer trace(0);
+        return trace;
+    }
+
+    static void recordTimer(int id, double start, double end)
+    {
+        EventTrace *trace = active();
+        if (trace) {
+            trace->record(Event(id, start, end, trace->nanoStep));
+        }
+    }
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+    /**
+     * Hands out unique IDs so that threads can tell traces apart even
+     * if one is allocated at the address of a deleted one.
+     */
+    static std::atomic<std::size_t>& nextID()
+    {
+        static std::atomic<std::size_t> id(0);
+        return id;
+    }
+
+    /**
+     * Returns the calling thread's buffer, registering the thread on
+     * its first call.
+     */
+    RingBuffer *threadBuffer(int *thread)
+    {
+        typedef std::map<std::size_t, std::pair<int, RingBuffer*> > SlotMap;
+        static thread_local SlotMap slots;
+
+        SlotMap::iterator i = slots.find(id);
+        if (i == slots.end()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(RingBuffer(capacity));
+            i = slots.insert(
+                std::make_pair(id, std::make_pair(int(buffers.size() - 1), &buffers.back()))).first;
+        }
+
+        *thread = i->second.first;
+        return i->second.second;
+    }
+#else
+    static std::size_t maxThreads()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    RingBuffer *threadBuffer(int *thread)
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        *thread = omp_get_thread_num();
+#else
+        *thread = 0;
+#endif
+        if (std::size_t(*thread) >= buffers.size()) {
+            return 0;
+        }
+
+        return &buffers[*thread];
+    }
+#endif
+};
+
+}
+
+#endif
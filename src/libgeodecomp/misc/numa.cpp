@@ -0,0 +1,208 @@
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/misc/numa.h>
+#include <libgeodecomp/misc/stringops.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+
+namespace LibGeoDecomp {
+
+namespace {
+
+bool firstTouchEnabled = false;
+
+/**
+ * Parses lists such as "0-3,8,10-11" as found in sysfs.
+ */
+std::vector<int> parseCPUList(const std::string& list)
+{
+    std::vector<int> ret;
+    StringVec ranges = StringOps::tokenize(list, ", \n");
+
+    for (StringVec::iterator i = ranges.begin(); i != ranges.end(); ++i) {
+        StringVec bounds = StringOps::tokenize(*i, "-");
+        if (bounds.empty()) {
+            continue;
+        }
+
+        int first = StringOps::atoi(bounds[0]);
+        int last = (bounds.size() > 1) ? StringOps::atoi(bounds[1]) : first;
+        for (int cpu = first; cpu <= last; ++cpu) {
+            ret.push_back(cpu);
+        }
+    }
+
+    return ret;
+}
+
+std::string readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName.c_str());
+    std::string ret;
+    std::getline(file, ret);
+    return ret;
+}
+
+}
+
+void NUMA::enableFirstTouch(bool enable)
+{
+    firstTouchEnabled = enable;
+}
+
+bool NUMA::firstTouch()
+{
+    return firstTouchEnabled;
+}
+
+void NUMA::touch(char *begin, std::size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+
+    // iterating over whole pages ensures that no page is touched by
+    // two threads, the first one may be partially outside the range:
+    const std::size_t page = pageSize();
+    const std::size_t offset = reinterpret_cast<std::size_t>(begin) % page;
+    const long numPages = (offset + bytes + page - 1) / page;
+    char *firstPage = begin - offset;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < numPages; ++i) {
+        char *cursor = (std::max)(firstPage + i * page, begin);
+        *cursor = 0;
+    }
+}
+
+std::vector<int> NUMA::pinThreads(PinningPolicy policy)
+{
+    std::vector<int> ret;
+#ifdef __linux__
+    std::vector<int> order = cpuOrder(policy, nodes());
+    if (order.empty()) {
+        return ret;
+    }
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+    ret.resize(omp_get_max_threads());
+#pragma omp parallel
+#else
+    ret.resize(1);
+#endif
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        int thread = omp_get_thread_num();
+#else
+        int thread = 0;
+#endif
+        int cpu = order[thread % order.size()];
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        // pid 0 refers to the calling thread:
+        if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+            ret[thread] = cpu;
+        } else {
+            ret[thread] = -1;
+        }
+    }
+#endif
+
+    return ret;
+}
+
+std::vector<std::vector<int> > NUMA::nodes()
+{
+    std::vector<std::vector<int> > ret;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return ret;
+    }
+
+    std::vector<int> online = parseCPUList(readFile("/sys/devices/system/node/online"));
+    for (std::vector<int>::iterator node = online.begin(); node != online.end(); ++node) {
+        std::vector<int> cpus = parseCPUList(readFile(
+            "/sys/devices/system/node/node" + StringOps::itoa(*node) + "/cpulist"));
+        std::vector<int> usable;
+
+        for (std::vector<int>::iterator cpu = cpus.begin(); cpu != cpus.end(); ++cpu) {
+            if ((*cpu < CPU_SETSIZE) && CPU_ISSET(*cpu, &allowed)) {
+                usable.push_back(*cpu);
+            }
+        }
+
+        if (!usable.empty()) {
+            ret.push_back(usable);
+        }
+    }
+
+    // no sysfs (e.g. in some containers): treat the machine as one node
+    if (ret.empty()) {
+        ret.resize(1);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                ret[0].push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    return ret;
+}
+
+std::size_t NUMA::pageSize()
+{
+#ifdef _WIN32
+    return 4096;
+#else
+    return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+std::vector<int> NUMA::cpuOrder(PinningPolicy policy, const std::vector<std::vector<int> >& nodes)
+{
+    std::vector<int> ret;
+
+    if (policy == PIN_COMPACT) {
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            ret.insert(ret.end(), nodes[i].begin(), nodes[i].end());
+        }
+    }
+
+    if (policy == PIN_SCATTER) {
+        std::size_t maxCPUs = 0;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            maxCPUs = (std::max)(maxCPUs, nodes[i].size());
+        }
+
+        for (std::size_t cpu = 0; cpu < maxCPUs; ++cpu) {
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                if (cpu < nodes[i].size()) {
+                    ret.push_back(nodes[i][cpu]);
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+}
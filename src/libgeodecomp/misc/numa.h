@@ -0,0 +1,64 @@
+#ifndef LIBGEODECOMP_MISC_NUMA_H
+#define LIBGEODECOMP_MISC_NUMA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Controls how grid memory is being placed on NUMA systems. Pages
+ * are assigned to a NUMA node when they're being written to for the
+ * first time. By default all grids are initialized by a single
+ * thread, so all their memory ends up on that thread's node.
+ *
+ * With first touch enabled, grids instead have their pages touched
+ * by all OpenMP threads, using the same static plane-to-thread
+ * mapping the UpdateFunctor uses. Combined with pinned threads, each
+ * thread then updates mostly memory on its own node.
+ */
+class NUMA
+{
+public:
+    enum PinningPolicy {
+        // leave placement to the OS
+        PIN_NONE,
+        // fill up one node before moving to the next one
+        PIN_COMPACT,
+        // distribute consecutive threads round-robin over all nodes
+        PIN_SCATTER
+    };
+
+    static void enableFirstTouch(bool enable = true);
+    static bool firstTouch();
+
+    /**
+     * Writes to each page of [begin, begin + bytes), split statically
+     * among all OpenMP threads.
+     */
+    static void touch(char *begin, std::size_t bytes);
+
+    /**
+     * Binds each OpenMP thread to one CPU (in order of thread IDs)
+     * and returns the CPUs chosen. Returns an empty vector if
+     * pinning is not supported on this platform.
+     */
+    static std::vector<int> pinThreads(PinningPolicy policy);
+
+    /**
+     * CPUs available to this process, grouped by NUMA node.
+     */
+    static std::vector<std::vector<int> > nodes();
+
+    static std::size_t pageSize();
+
+    /**
+     * Order in which CPUs are assigned to threads for the given
+     * policy, based on the node layout.
+     */
+    static std::vector<int> cpuOrder(PinningPolicy policy, const std::vector<std::vector<int> >& nodes);
+};
+
+}
+
+#endif
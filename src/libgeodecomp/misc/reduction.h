@@ -0,0 +1,173 @@
+#ifndef LIBGEODECOMP_MISC_REDUCTION_H
+#define LIBGEODECOMP_MISC_REDUCTION_H
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace LibGeoDecomp {
+
+enum ReductionOperator {
+    REDUCTION_SUM,
+    REDUCTION_MIN,
+    REDUCTION_MAX,
+    REDUCTION_CUSTOM
+};
+
+/**
+ * A Reduction computes a global quantity (e.g. the total energy or
+ * the maximum temperature) from all cells of a simulation. Each
+ * cell's contribution is given by extract(), contributions are then
+ * combined via one of the built-in operators or a custom combiner,
+ * which has to be associative and commutative.
+ *
+ * Reductions are registered with a Simulator (see
+ * Simulator::addReduction()) which will evaluate them for each
+ * time step. Steerers may keep a pointer to a Reduction to query
+ * its latest result, resultStep() tells which step that is.
+ */
+template<typename CELL_TYPE>
+class Reduction
+{
+public:
+    typedef double (*Combiner)(double, double);
+
+    explicit Reduction(ReductionOperator op) :
+        op(op),
+        combiner(0),
+        identityValue(identityOf(op)),
+        lastResult(identityValue),
+        lastStep(0),
+        valid(false)
+    {
+        if (op == REDUCTION_CUSTOM) {
+            throw std::invalid_argument("custom Reductions need a combiner");
+        }
+    }
+
+    Reduction(Combiner combiner, double identity) :
+        op(REDUCTION_CUSTOM),
+        combiner(combiner),
+        identityValue(identity),
+        lastResult(identity),
+        lastStep(0),
+        valid(false)
+    {
+        if (combiner == 0) {
+            throw std::invalid_argument("custom Reductions need a combiner");
+        }
+    }
+
+    virtual ~Reduction()
+    {}
+
+    /**
+     * returns a single cell's contribution to the reduction.
+     */
+    virtual double extract(const CELL_TYPE& cell) const = 0;
+
+    inline double combine(double a, double b) const
+    {
+        switch (op) {
+        case REDUCTION_SUM:
+            return a + b;
+        case REDUCTION_MIN:
+            return (std::min)(a, b);
+        case REDUCTION_MAX:
+            return (std::max)(a, b);
+        default:
+            return combiner(a, b);
+        }
+    }
+
+    inline ReductionOperator getOperator() const
+    {
+        return op;
+    }
+
+    inline double identity() const
+    {
+        return identityValue;
+    }
+
+    /**
+     * true once the Simulator has published at least one result.
+     */
+    inline bool hasResult() const
+    {
+        return valid;
+    }
+
+    inline double result() const
+    {
+        return lastResult;
+    }
+
+    /**
+     * the time step whose grid result() was computed from.
+     */
+    inline unsigned resultStep() const
+    {
+        return lastStep;
+    }
+
+    void setResult(double value, unsigned step)
+    {
+        lastResult = value;
+        lastStep = step;
+        valid = true;
+    }
+
+private:
+    ReductionOperator op;
+    Combiner combiner;
+    double identityValue;
+    double lastResult;
+    unsigned lastStep;
+    bool valid;
+
+    static double identityOf(ReductionOperator op)
+    {
+        switch (op) {
+        case REDUCTION_MIN:
+            return (std::numeric_limits<double>::max)();
+        case REDUCTION_MAX:
+            return -(std::numeric_limits<double>::max)();
+        default:
+            return 0;
+        }
+    }
+};
+
+/**
+ * Reduces a single data member of all cells, e.g.
+ * MemberReduction<MyCell, double>(&MyCell::temperature, REDUCTION_MAX).
+ */
+template<typename CELL_TYPE, typename MEMBER>
+class MemberReduction : public Reduction<CELL_TYPE>
+{
+public:
+    typedef typename Reduction<CELL_TYPE>::Combiner Combiner;
+
+    MemberReduction(MEMBER CELL_TYPE:: *member, ReductionOperator op) :
+        Reduction<CELL_TYPE>(op),
+        member(member)
+    {}
+
+    MemberReduction(MEMBER CELL_TYPE:: *member, Combiner combiner, double identity) :
+        Reduction<CELL_TYPE>(combiner, identity),
+        member(member)
+    {}
+
+    double extract(const CELL_TYPE& cell) const
+    {
+        return cell.*member;
+    }
+
+private:
+    MEMBER CELL_TYPE:: *member;
+};
+
+}
+
+#endif
@@ -0,0 +1,233 @@
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_HPX
+#include <hpx/config.hpp>
+#endif
+
+#include <libgeodecomp/misc/eventtrace.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/stringops.h>
+
+#include <cxxtest/TestSuite.h>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <set>
+#include <thread>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class EventTraceTest : public CxxTest::TestSuite
+{
+public:
+    typedef EventTrace::Event Event;
+    typedef EventTrace::StepSummary StepSummary;
+
+    void testInactiveTraceRecordsNothing()
+    {
+        EventTrace trace;
+        Chronometer chrono;
+        {
+            TimeCompute t(&chrono);
+        }
+        EventTrace::recordCommunication(1, 100, true, ScopedTimer::time());
+
+        TS_ASSERT_EQUALS(std::size_t(0), trace.events().size());
+        TS_ASSERT(!EventTrace::active());
+    }
+
+    void testTimers()
+    {
+        Chronometer chrono;
+        EventTrace trace;
+        trace.activate();
+        TS_ASSERT_EQUALS(&trace, EventTrace::active());
+
+        EventTrace::setNanoStep(4);
+        {
+            TimeTotal t(&chrono);
+            {
+                TimeComputeInner t(&chrono);
+                ScopedTimer::busyWait(10000);
+            }
+            EventTrace::setNanoStep(5);
+            double start = ScopedTimer::time();
+            ScopedTimer::busyWait(5000);
+            chrono.tock<TimeOutput>(start);
+        }
+        trace.deactivate();
+        {
+            TimeTotal t(&chrono);
+        }
+
+        std::vector<Event> events = trace.events();
+        TS_ASSERT_EQUALS(std::size_t(3), events.size());
+        TS_ASSERT_EQUALS(TimeTotal::ID,        events[0].id);
+        TS_ASSERT_EQUALS(TimeComputeInner::ID, events[1].id);
+        TS_ASSERT_EQUALS(TimeOutput::ID,       events[2].id);
+        TS_ASSERT_EQUALS(5, events[0].nanoStep);
+        TS_ASSERT_EQUALS(4, events[1].nanoStep);
+        TS_ASSERT_EQUALS(5, events[2].nanoStep);
+
+        // the trace mirrors the Chronometer's measurements:
+        TS_ASSERT_DELTA(chrono.interval<TimeComputeInner>(), events[1].duration(), 1e-9);
+        TS_ASSERT_DELTA(chrono.interval<TimeOutput>(),       events[2].duration(), 1e-9);
+        TS_ASSERT_LESS_THAN_EQUALS(events[0].start, events[1].start);
+        TS_ASSERT_LESS_THAN_EQUALS(events[2].end,   events[0].end);
+    }
+
+    void testRingBufferRetainsLatestEvents()
+    {
+        EventTrace trace(4);
+        for (int i = 0; i < 10; ++i) {
+            trace.record(Event(TimeInput::ID, i, i + 0.5, i));
+        }
+
+        std::vector<Event> events = trace.events();
+        TS_ASSERT_EQUALS(std::size_t(4), events.size());
+        TS_ASSERT_EQUALS(std::size_t(6), trace.lostEvents());
+        for (int i = 0; i < 4; ++i) {
+            TS_ASSERT_EQUALS(6 + i, events[i].nanoStep);
+        }
+
+        trace.clear();
+        TS_ASSERT_EQUALS(std::size_t(0), trace.events().size());
+        TS_ASSERT_EQUALS(std::size_t(0), trace.lostEvents());
+    }
+
+    void testThreads()
+    {
+        EventTrace trace(1000);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < 1000; ++i) {
+            trace.record(Event(TimeCompute::ID, i, i + 1, 0));
+        }
+
+        std::vector<Event> events = trace.events();
+        TS_ASSERT_EQUALS(std::size_t(1000), events.size());
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            TS_ASSERT_EQUALS(double(i), events[i].start);
+        }
+    }
+
+    void testThreadsOutsideOfOpenMP()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        // all of these threads would claim to be OpenMP thread 0:
+        EventTrace trace(1000);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.push_back(std::thread([&trace, t]() {
+                        for (int i = 0; i < 200; ++i) {
+                            trace.record(Event(TimeOutput::ID, t * 1000 + i, t * 1000 + i + 1, 0));
+                        }
+                    }));
+        }
+        for (std::size_t t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+
+        std::vector<Event> events = trace.events();
+        TS_ASSERT_EQUALS(std::size_t(800), events.size());
+        TS_ASSERT_EQUALS(std::size_t(0), trace.lostEvents());
+
+        std::set<int> threadIDs;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            int t = i / 200;
+            TS_ASSERT_EQUALS(double(t * 1000 + i % 200), events[i].start);
+            threadIDs.insert(events[i].thread);
+            if (i % 200) {
+                TS_ASSERT_EQUALS(events[i - 1].thread, events[i].thread);
+            }
+        }
+        TS_ASSERT_EQUALS(std::size_t(4), threadIDs.size());
+#endif
+    }
+
+    void testStepSummaries()
+    {
+        EventTrace trace;
+        trace.record(Event(TimeTotal::ID,         10.0, 20.0, 7));
+        trace.record(Event(TimeComputeInner::ID,  10.0, 14.0, 7));
+        trace.record(Event(TimeCommunication::ID, 14.0, 15.0, 7, 0, 2, 800, true));
+        trace.record(Event(TimeCommunication::ID, 15.0, 17.0, 7, 0, 3, 400, false));
+        trace.record(Event(TimeCommunication::ID, 17.0, 17.5, 7, 0, 1, 400, false));
+        trace.record(Event(TimeComputeGhost::ID,  17.5, 19.0, 7));
+        trace.record(Event(TimeComputeGhost::ID,  20.0, 21.0, 8));
+        trace.record(Event(TimeInput::ID,          0.0,  1.0));
+
+        std::vector<StepSummary> summaries = trace.stepSummaries();
+        TS_ASSERT_EQUALS(std::size_t(2), summaries.size());
+
+        TS_ASSERT_EQUALS(7, summaries[0].nanoStep);
+        TS_ASSERT_EQUALS(10.0, summaries[0].span());
+        TS_ASSERT_EQUALS(5.5,  summaries[0].compute);
+        TS_ASSERT_EQUALS(2.5,  summaries[0].wait);
+        TS_ASSERT_EQUALS(1.0,  summaries[0].send);
+        TS_ASSERT_EQUALS(std::size_t(1600), summaries[0].bytes);
+        TS_ASSERT_EQUALS(3, summaries[0].slowestPeer);
+        TS_ASSERT_EQUALS(2.0, summaries[0].slowestPeerWait);
+
+        TS_ASSERT_EQUALS(8, summaries[1].nanoStep);
+        TS_ASSERT_EQUALS(1.0, summaries[1].compute);
+        TS_ASSERT_EQUALS(-1, summaries[1].slowestPeer);
+    }
+
+    void testChromeTrace()
+    {
+        EventTrace trace;
+        double origin = trace.origin();
+        trace.record(Event(TimeComputeInner::ID,  origin + 1.0, origin + 1.5, 3));
+        trace.record(Event(TimeCommunication::ID, origin + 2.0, origin + 2.25, 3, 0, 1, 64, false));
+
+        std::string json = trace.chromeTrace(2);
+        TS_ASSERT_EQUALS(std::string("{\"traceEvents\":["), json.substr(0, 16));
+        TS_ASSERT_DIFFERS(std::string::npos, json.find("\"name\":\"rank 2\""));
+        TS_ASSERT_DIFFERS(
+            std::string::npos,
+            json.find("{\"name\":\"compute_time_inner\",\"cat\":\"libgeodecomp\",\"ph\":\"X\","
+                      "\"pid\":2,\"tid\":0,\"ts\":1000000.000,\"dur\":500000.000,"
+                      "\"args\":{\"nano_step\":3}}"));
+        TS_ASSERT_DIFFERS(
+            std::string::npos,
+            json.find("\"args\":{\"nano_step\":3,\"peer\":1,\"bytes\":64,\"direction\":\"recv\"}"));
+    }
+
+    void testCriticalPathReport()
+    {
+        std::vector<std::vector<StepSummary> > summaries(2);
+        StepSummary summary(0);
+        summary.start = 0;
+        summary.end = 2;
+        summary.compute = 1.5;
+        summary.wait = 0.1;
+        summary.slowestPeer = 1;
+        summaries[0] << summary;
+
+        summary.end = 3;
+        summary.compute = 1.0;
+        summary.wait = 1.2;
+        summary.slowestPeer = 0;
+        summaries[1] << summary;
+
+        std::string report = EventTrace::criticalPathReport(summaries);
+        std::vector<std::string> lines = StringOps::tokenize(report, "\n");
+        TS_ASSERT_EQUALS(std::size_t(4), lines.size());
+
+        std::vector<std::string> fields = StringOps::tokenize(lines[1], " ");
+        TS_ASSERT_EQUALS(std::size_t(8), fields.size());
+        TS_ASSERT_EQUALS("0",   fields[0]);
+        TS_ASSERT_EQUALS("3",   fields[1]);
+        TS_ASSERT_EQUALS("0",   fields[2]);
+        TS_ASSERT_EQUALS("1.5", fields[3]);
+        TS_ASSERT_EQUALS("1.2", fields[4]);
+        TS_ASSERT_EQUALS("1",   fields[5]);
+        TS_ASSERT_EQUALS("0",   fields[6]);
+        TS_ASSERT_EQUALS(std::string("critical rank histogram: 0:1"), lines[3]);
+    }
+};
+
+}
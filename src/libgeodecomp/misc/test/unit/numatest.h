@@ -0,0 +1,61 @@
+#include <libgeodecomp/misc/numa.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class NUMATest : public CxxTest::TestSuite
+{
+public:
+    void testCPUOrder()
+    {
+        std::vector<std::vector<int> > nodes(2);
+        nodes[0] << 0 << 1 << 2;
+        nodes[1] << 4 << 5;
+
+        TS_ASSERT_EQUALS(std::vector<int>(), NUMA::cpuOrder(NUMA::PIN_NONE, nodes));
+        TS_ASSERT_EQUALS(std::vector<int>({0, 1, 2, 4, 5}), NUMA::cpuOrder(NUMA::PIN_COMPACT, nodes));
+        TS_ASSERT_EQUALS(std::vector<int>({0, 4, 1, 5, 2}), NUMA::cpuOrder(NUMA::PIN_SCATTER, nodes));
+    }
+
+    void testTouch()
+    {
+        std::size_t page = NUMA::pageSize();
+        std::vector<char> buffer(5 * page, 1);
+        char *begin = &buffer[page / 2];
+        std::size_t bytes = 3 * page;
+
+        NUMA::touch(begin, bytes);
+
+        // one byte per page, partial pages at both ends included:
+        std::size_t offset = reinterpret_cast<std::size_t>(begin) % page;
+        std::size_t expectedPages = (offset + bytes + page - 1) / page;
+        std::size_t touched = 0;
+        for (std::size_t i = 0; i < buffer.size(); ++i) {
+            if (buffer[i] == 0) {
+                TS_ASSERT_LESS_THAN_EQUALS(begin, &buffer[i]);
+                TS_ASSERT_LESS_THAN(&buffer[i], begin + bytes);
+                ++touched;
+            }
+        }
+        TS_ASSERT_EQUALS(expectedPages, touched);
+        TS_ASSERT_EQUALS(0, *begin);
+    }
+
+    void testNodes()
+    {
+#ifdef __linux__
+        std::vector<std::vector<int> > nodes = NUMA::nodes();
+        TS_ASSERT(!nodes.empty());
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            TS_ASSERT(!nodes[i].empty());
+        }
+#endif
+        TS_ASSERT_EQUALS(std::vector<int>(), NUMA::pinThreads(NUMA::PIN_NONE));
+    }
+};
+
+}
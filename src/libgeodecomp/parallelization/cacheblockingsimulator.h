@@ -6,6 +6,7 @@
 
 #include <omp.h>
 #include <libgeodecomp/io/logger.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
 #include <libgeodecomp/parallelization/monolithicsimulator.h>
 #include <libgeodecomp/storage/displacedgrid.h>
 #include <libgeodecomp/storage/updatefunctor.h>
@@ -13,9 +14,30 @@
 namespace LibGeoDecomp {
 
 /**
- * CacheBlockingSimulator is an experimental simulator to explore the
- * infrastructure required to implement a pipelined wavefront update
- * algorith and which benefits is may provide.
+ * CacheBlockingSimulator implements a pipelined wavefront update
+ * (temporal blocking): the grid is cut into columns which span the
+ * whole grid along the outermost axis and which are wavefrontDim
+ * cells wide along the remaining axes. Each column is advanced by up
+ * to pipelineLength nano steps in one sweep, so that every cell is
+ * loaded from main memory just once per sweep, rather than once per
+ * nano step.
+ *
+ * Each stage of the pipeline lags two planes behind its predecessor.
+ * Intermediate time levels are kept in two thread-private ring
+ * buffers, each of which holds just 2 * pipelineLength + 2 planes of
+ * the column, so that the working set stays in cache regardless of
+ * the grid's height. The columns include a halo of pipelineLength
+ * cells, which is recomputed redundantly by adjacent columns
+ * (overlapped tiling), which makes all columns independent of each
+ * other. Along axes which wrap around (Topologies::Torus) the halo
+ * extends beyond the grid's boundaries and is filled from the
+ * opposite side, along all other axes it's clipped to the grid.
+ *
+ * Sweeps never skip a step at which a Writer or Steerer needs to be
+ * called, so I/O is handled exactly as by the SerialSimulator.
+ * Reductions are accumulated by the last stage of each sweep's final
+ * hop while it writes the new grid, which yields results for all
+ * steps at which Writers or Steerers may query them.
  */
 template<typename CELL>
 class CacheBlockingSimulator : public MonolithicSimulator<CELL>
@@ -24,11 +46,13 @@ public:
     friend class CacheBlockingSimulatorTest;
 
     typedef typename APITraits::SelectTopology<CELL>::Value Topology;
-    typedef typename TopologiesHelpers::Topology<3, Topology::template WrapsAxis<0>::VALUE, Topology::template WrapsAxis<1>::VALUE, true> BufferTopology;
     typedef Grid<CELL, Topology> GridType;
-    typedef DisplacedGrid<CELL, BufferTopology> BufferType;
-    typedef std::vector<std::vector<Region<3> > > WavefrontFrames;
+    typedef typename Steerer<CELL>::SteererFeedback SteererFeedback;
     static const int DIM = Topology::DIM;
+    // wraps only the outermost axis, which turns the buffers into rings of planes:
+    typedef TopologiesHelpers::Topology<DIM, DIM == 1, DIM == 2, DIM == 3> RingTopology;
+    typedef DisplacedGrid<CELL, RingTopology> BufferType;
+    typedef ReductionAccumulator<CELL, DIM, UpdateFunctorHelpers::ConcurrencyNoP> Accumulator;
 
     using MonolithicSimulator<CELL>::NANO_STEPS;
     using MonolithicSimulator<CELL>::chronometer;
@@ -38,30 +62,29 @@ public:
         int pipelineLength,
         const Coord<DIM - 1>& wavefrontDim) :
         MonolithicSimulator<CELL>(initializer),
-        buffers(omp_get_max_threads()),
         pipelineLength(pipelineLength),
         wavefrontDim(wavefrontDim)
     {
+        if (pipelineLength < 1) {
+            throw std::invalid_argument("CacheBlockingSimulator needs a pipelineLength of at least 1");
+        }
+        for (int d = 0; d < (DIM - 1); ++d) {
+            if (wavefrontDim[d] < 1) {
+                throw std::invalid_argument("CacheBlockingSimulator needs a non-empty wavefront");
+            }
+        }
+
         Coord<DIM> dim = initializer->gridBox().dimensions;
         curGrid = new GridType(dim);
         newGrid = new GridType(dim);
         initializer->grid(curGrid);
         initializer->grid(newGrid);
-
-        Coord<DIM> bufferDim;
-
-        for (int i = 0; i < DIM - 1; ++i) {
-            bufferDim[i] = wavefrontDim[i] + 2 * pipelineLength - 2;
-        }
-        bufferDim[DIM - 1] = pipelineLength * 4 - 4;
-
-        for (std::size_t i = 0; i < buffers.size(); ++i) {
-            buffers[i] = BufferType(CoordBox<DIM>(Coord<DIM>(), bufferDim), curGrid->getEdgeCell(), curGrid->getEdgeCell());
-        }
-        LOG(DBG, "created " << buffers.size() << " buffers");
-
-        generateFrames();
+        stepNum = initializer->startStep();
         nanoStep = 0;
+        simArea << curGrid->boundingBox();
+
+        generateColumns();
+        LOG(DBG, "created " << columns.size() << " columns");
     }
 
     virtual ~CacheBlockingSimulator()
@@ -70,35 +93,60 @@ public:
         delete curGrid;
     }
 
+    /**
+     * performs a single simulation step.
+     */
     virtual void step()
     {
-        // fixme
+        SteererFeedback feedback;
+        step(&feedback);
     }
 
+    virtual void step(SteererFeedback *feedback)
+    {
+        TimeTotal t(&chronometer);
+
+        handleInput(STEERER_NEXT_STEP, feedback);
+        advance(NANO_STEPS);
+        reductions.complete(stepNum);
+        handleOutput();
+    }
+
+    /**
+     * continue simulating until the maximum number of steps is
+     * reached. Contrary to step() this will run as many steps per
+     * sweep as the pipeline length and the I/O schedule permit.
+     */
     virtual void run()
     {
         initializer->grid(curGrid);
         stepNum = initializer->startStep();
         nanoStep = 0;
+        setIORegions();
+        evaluateReductions();
 
-        for(unsigned i = 0; i < writers.size(); ++i) {
-            writers[i]->stepFinished(
-                *getGrid(),
-                getStep(),
-                WRITER_INITIALIZED);
-        }
+        SteererFeedback feedback;
+        handleInput(STEERER_INITIALIZED, &feedback);
+        handleOutput(WRITER_INITIALIZED);
 
-        for (stepNum = initializer->startStep();
-             stepNum < initializer->maxSteps();) {
-            hop();
-        }
+        while (stepNum < initializer->maxSteps()) {
+            if (feedback.simulationEnded()) {
+                break;
+            }
 
-        for(unsigned i = 0; i < writers.size(); ++i) {
-            writers[i]->stepFinished(
-                *getGrid(),
-                getStep(),
-                WRITER_ALL_DONE);
+            TimeTotal t(&chronometer);
+            handleInput(STEERER_NEXT_STEP, &feedback);
+            advance(stepsToNextEvent() * NANO_STEPS);
+            reductions.complete(stepNum);
+            handleOutput();
         }
+
+        handleInput(STEERER_ALL_DONE, &feedback);
+    }
+
+    virtual void addReduction(Reduction<CELL> *reduction)
+    {
+        reductions.add(reduction);
     }
 
     virtual const GridType *getGrid()
@@ -112,225 +160,337 @@ private:
     using MonolithicSimulator<CELL>::stepNum;
     using MonolithicSimulator<CELL>::writers;
     using MonolithicSimulator<CELL>::getStep;
+    using MonolithicSimulator<CELL>::gridDim;
+    using MonolithicSimulator<CELL>::reductions;
 
     GridType *curGrid;
     GridType *newGrid;
+    Region<DIM> simArea;
     std::vector<BufferType> buffers;
     int pipelineLength;
     Coord<DIM - 1> wavefrontDim;
-    Grid<WavefrontFrames> frames;
+    std::vector<CoordBox<DIM> > columns;
     unsigned nanoStep;
 
-    void generateFrames()
+    void generateColumns()
     {
-        Coord<DIM> gridDim = initializer->gridBox().dimensions;
+        Coord<DIM> dim = initializer->gridBox().dimensions;
 
-        Coord<DIM - 1> framesDim;
-        for (int i = 0; i < (DIM - 1); ++i) {
-            framesDim[i] = gridDim[i] / wavefrontDim[i];
-            if ((gridDim[i] % wavefrontDim[i]) != 0) {
-                framesDim[i] += 1;
+        Coord<DIM - 1> columnsDim;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            columnsDim[d] = dim[d] / wavefrontDim[d];
+            if ((dim[d] % wavefrontDim[d]) != 0) {
+                columnsDim[d] += 1;
             }
         }
-        frames.resize(framesDim);
-
-        for (int y = 0; y < framesDim.y(); ++y) {
-            for (int x = 0; x < framesDim.x(); ++x) {
-                frames[Coord<2>(x, y)] = generateWavefrontFrames(
-                    Coord<3>(x * wavefrontDim.x(),
-                             y * wavefrontDim.y(),
-                             0));
 
+        columns.clear();
+        CoordBox<DIM - 1> columnsBox(Coord<DIM - 1>(), columnsDim);
+        for (typename CoordBox<DIM - 1>::Iterator i = columnsBox.begin(); i != columnsBox.end(); ++i) {
+            CoordBox<DIM> column(Coord<DIM>(), dim);
+            for (int d = 0; d < (DIM - 1); ++d) {
+                column.origin[d] = (*i)[d] * wavefrontDim[d];
+                column.dimensions[d] = (std::min)(wavefrontDim[d], dim[d] - column.origin[d]);
             }
+            columns << column;
         }
     }
 
-    WavefrontFrames generateWavefrontFrames(const Coord<DIM> offset)
+    /**
+     * Determines how many steps we may run before a Writer or
+     * Steerer needs to be notified.
+     */
+    unsigned stepsToNextEvent() const
     {
-        Coord<DIM> gridDim = initializer->gridBox().dimensions;
-        Coord<DIM> wavefrontRegionDim;
-        for (int i = 0; i < (DIM - 1); ++i) {
-            wavefrontRegionDim[i] = wavefrontDim[i];
+        unsigned nextEvent = initializer->maxSteps();
+
+        for (std::size_t i = 0; i < writers.size(); ++i) {
+            unsigned period = writers[i]->getPeriod();
+            nextEvent = (std::min)(nextEvent, (stepNum / period + 1) * period);
         }
-        wavefrontRegionDim[DIM - 1] = gridDim[DIM - 1] - offset[DIM - 1];
-        Region<DIM> region;
-        region << CoordBox<DIM>(offset, wavefrontRegionDim);
-        std::vector<Region<3> > regions(pipelineLength);
-        regions[pipelineLength - 1] = region.expandWithTopology(
-            0, gridDim, Topologies::Cube<3>::Topology());
-
-        for (int i = pipelineLength - 2; i >= 0; --i) {
-            regions[i] = regions[i + 1].expandWithTopology(
-                1, gridDim, Topologies::Cube<3>::Topology());
+        for (std::size_t i = 0; i < steerers.size(); ++i) {
+            unsigned period = steerers[i]->getPeriod();
+            nextEvent = (std::min)(nextEvent, (stepNum / period + 1) * period);
         }
 
-        int wavefrontLength = gridDim[DIM - 1] + 1;
-        WavefrontFrames ret(wavefrontLength, std::vector<Region<DIM> >(pipelineLength));
-
-        for (int index = 0; index < wavefrontLength; ++index) {
-            Coord<DIM> maskOrigin;
-            maskOrigin[DIM - 1] = index;
-            Topology::normalize(maskOrigin, initializer->gridDimensions());
-            Coord<DIM> maskDim = gridDim;
-            maskDim[DIM - 1] = 1;
+        return nextEvent - stepNum;
+    }
 
-            Region<DIM> mask;
-            mask << CoordBox<DIM>(maskOrigin, maskDim);
-            for (int i = 0; i < pipelineLength; ++i) {
-                ret[index][i] = regions[i] & mask;
-            }
+    /**
+     * The last hop also accumulates the cells of the final grid for
+     * all Reductions.
+     */
+    void advance(std::size_t nanoSteps)
+    {
+        while (nanoSteps > 0) {
+            int length = (std::min)(std::size_t(pipelineLength), nanoSteps);
+            nanoSteps -= length;
+            hop(length, !reductions.empty() && (nanoSteps == 0));
         }
-
-        return ret;
     }
 
-    void hop()
+    /**
+     * Advances the whole grid by length nano steps (length <= pipelineLength).
+     */
+    void hop(int length, bool reduce = false)
     {
         using std::swap;
-        TimeTotal t(&chronometer);
+        TimeCompute t(&chronometer);
+
+        if (reduce) {
+            reductions.beginSweep();
+        }
 
-        CoordBox<DIM - 1> frameBox = frames.boundingBox();
-        // for (typename CoordBox<DIM -1>::Iterator waveIter = frameBox.begin();
-        //      waveIter != frameBox.end();
-        //      ++waveIter) {
-        //     updateWavefront(*waveIter);
-        // }
-
-#pragma omp parallel for
-        for (int y = 0; y < frameBox.dimensions.y(); ++y) {
-            for (int x = 0; x < frameBox.dimensions.x(); ++x) {
-                updateWavefront(&buffers[omp_get_thread_num()], Coord<2>(x, y));
+#pragma omp parallel
+        {
+            // buffers are indexed by thread number, so they need to
+            // be sized for the actual team:
+#pragma omp single
+            {
+                std::size_t numBuffers = 2 * std::size_t(omp_get_num_threads());
+                if (buffers.size() < numBuffers) {
+                    buffers.resize(numBuffers);
+                }
+            }
+
+#pragma omp for schedule(dynamic)
+            for (int i = 0; i < int(columns.size()); ++i) {
+                BufferType *threadBuffers = &buffers[2 * omp_get_thread_num()];
+                updateColumn(threadBuffers, columns[i], length, reduce);
             }
         }
 
         swap(curGrid, newGrid);
-        int curNanoStep = nanoStep + pipelineLength;
-        stepNum += curNanoStep / NANO_STEPS;
-        nanoStep = curNanoStep % NANO_STEPS;
+        unsigned globalNanoStep = nanoStep + length;
+        stepNum += globalNanoStep / NANO_STEPS;
+        nanoStep = globalNanoStep % NANO_STEPS;
+
+        if (reduce) {
+            reductions.endSweep(stepNum);
+        }
     }
 
-    void updateWavefront(BufferType *buffer, const Coord<DIM - 1>& wavefrontCoord)
+    /**
+     * Runs the pipeline for a single column. Stage 0 copies the
+     * column (including its halo) from curGrid to the buffers, stage
+     * s (1 <= s <= length) computes nano step s - 1. The last stage
+     * writes to newGrid, optionally accumulating the cells for all
+     * Reductions.
+     *
+     * Plane z of any time level is stored in slot (z - firstPlane) %
+     * ringDepth of its buffer. Stage s reads the three planes around
+     * its own from the level below, which are overwritten no earlier
+     * than 2 * length + 2 wavefronts later. If the outermost axis
+     * doesn't wrap, each intermediate level gets an additional plane
+     * of edge cells on either end, as reads beyond the grid would
+     * otherwise hit other slots of the ring.
+     */
+    void updateColumn(BufferType *threadBuffers, const CoordBox<DIM>& column, int length, bool reduce)
     {
-        LOG(INFO, "wavefrontCoord(" << wavefrontCoord << ")");
-        buffer->setEdge(curGrid->getEdge());
-        // buffer->fill(buffer->boundingBox(), curGrid->getEdgeCell());
-        fixBufferOrigin(buffer, wavefrontCoord);
-
-        int index = 0;
-        CoordBox<DIM> boundingBox = curGrid->boundingBox();
-        int maxIndex = boundingBox.origin[DIM - 1] + boundingBox.dimensions[DIM - 1];
-
-        // fill pipeline
-        for (; index < 2 * pipelineLength - 2; ++index) {
-            int lastStage = (index >> 1) + 1;
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, 0, lastStage);
+        std::vector<CoordBox<DIM> > footprints;
+        for (int s = 0; s <= length; ++s) {
+            footprints << expandColumn(column, length - s);
         }
 
-        // normal operation
-        for (; index < maxIndex; ++index) {
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, 0, pipelineLength);
+        int margin = Topology::wrapsAxis(DIM - 1) ? 0 : 1;
+        int ringDepth = 2 * length + 2;
+        int firstPlane = footprints[0].origin[DIM - 1] - margin;
+        int numWavefronts = footprints[0].dimensions[DIM - 1] + margin + 2 * length;
+
+        CoordBox<DIM> ringBox = footprints[0];
+        ringBox.origin[DIM - 1] = firstPlane;
+        ringBox.dimensions[DIM - 1] = ringDepth;
+        for (int i = 0; i < 2; ++i) {
+            threadBuffers[i].resize(ringBox);
+            threadBuffers[i].setEdge(curGrid->getEdge());
         }
 
-        // let pipeline drain
-        for (; index < (maxIndex + 2 * pipelineLength - 2); ++index) {
-            int firstStage = (index - maxIndex + 1) >> 1 ;
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, firstStage, pipelineLength);
+        for (int wavefront = 0; wavefront < numWavefronts; ++wavefront) {
+            // RingTopology wraps relative coordinates just once, so
+            // the origin needs to follow the wavefront:
+            if ((wavefront % ringDepth) == 0) {
+                ringBox.origin[DIM - 1] = firstPlane + wavefront;
+                threadBuffers[0].setOrigin(ringBox.origin);
+                threadBuffers[1].setOrigin(ringBox.origin);
+            }
+
+            for (int s = 0; s <= length; ++s) {
+                int plane = firstPlane + wavefront - 2 * s;
+                const CoordBox<DIM>& footprint = footprints[s];
+                int planesStart = footprint.origin[DIM - 1];
+                int planesEnd = footprint.origin[DIM - 1] + footprint.dimensions[DIM - 1];
+                if (s < length) {
+                    planesStart -= margin;
+                    planesEnd += margin;
+                }
+                if ((plane < planesStart) || (plane >= planesEnd)) {
+                    continue;
+                }
+
+                CoordBox<DIM> planeBox = footprint;
+                planeBox.origin[DIM - 1] = plane;
+                planeBox.dimensions[DIM - 1] = 1;
+
+                if ((plane < footprint.origin[DIM - 1]) ||
+                    (plane >= footprint.origin[DIM - 1] + footprint.dimensions[DIM - 1])) {
+                    fillPlane(planeBox, &threadBuffers[s % 2]);
+                    continue;
+                }
+
+                if (s == 0) {
+                    copyPlane(planeBox, &threadBuffers[0]);
+                    continue;
+                }
+
+                Region<DIM> region;
+                region << planeBox;
+                const BufferType& source = threadBuffers[(s - 1) % 2];
+                unsigned curNanoStep = (nanoStep + s - 1) % NANO_STEPS;
+
+                if ((s == length) && reduce) {
+                    UpdateFunctor<CELL, Accumulator>()(
+                        region, Coord<DIM>(), Coord<DIM>(), source, newGrid, curNanoStep,
+                        Accumulator(UpdateFunctorHelpers::ConcurrencyNoP(), &reductions, &region));
+                } else if (s == length) {
+                    UpdateFunctor<CELL>()(region, Coord<DIM>(), Coord<DIM>(), source, newGrid, curNanoStep);
+                } else {
+                    UpdateFunctor<CELL>()(region, Coord<DIM>(), Coord<DIM>(), source, &threadBuffers[s % 2], curNanoStep);
+                }
+            }
         }
     }
 
-    void fixBufferOrigin(BufferType *buffer, const Coord<DIM - 1>& frameCoord)
+    /**
+     * Copies the plane row by row from curGrid to the buffer.
+     * Coordinates outside of the grid are wrapped according to the
+     * Topology, which is how the halo of columns on a torus is filled.
+     */
+    void copyPlane(const CoordBox<DIM>& planeBox, BufferType *buffer)
     {
-        Coord<DIM> bufferOrigin;
-        // fixme: wrong on boundary with Torus topology
-        for (int d = 0; d < (DIM - 1); ++d) {
-            bufferOrigin[d] = (std::max)(0, frameCoord[d] * wavefrontDim[d] - pipelineLength + 1);
+        CoordBox<DIM> rows = planeBox;
+        rows.dimensions.x() = 1;
+        int width = planeBox.dimensions.x();
+
+        for (typename CoordBox<DIM>::Iterator i = rows.begin(); i != rows.end(); ++i) {
+            Coord<DIM> cursor = *i;
+            int endX = cursor.x() + width;
+
+            while (cursor.x() < endX) {
+                Coord<DIM> source = wrap(cursor);
+                int length = (std::min)(endX - cursor.x(), gridDim.x() - source.x());
+                curGrid->get(Streak<DIM>(source, source.x() + length), &(*buffer)[cursor]);
+                cursor.x() += length;
+            }
         }
-        bufferOrigin[DIM - 1] = 0;
-        buffer->setOrigin(bufferOrigin);
     }
 
-    void pipelinedUpdate(
-        BufferType *buffer,
-        const Coord<DIM - 1>& frameCoord,
-        int globalIndex,
-        int localIndex,
-        int firstStage,
-        int lastStage)
+    void fillPlane(const CoordBox<DIM>& planeBox, BufferType *buffer)
     {
-        LOG(DBG, "  pipelinedUpdate(frameCoord = " << frameCoord << ", globalIndex = " << globalIndex << ", localIndex = " << localIndex << ", firstStage = " << firstStage << ", lastStage = " << lastStage << ")");
-
-        for (int i = firstStage; i < lastStage; ++i) {
-            bool firstIteration = (i == 0);
-            bool lastIteration =  (i == (pipelineLength - 1));
-            int currentGlobalIndex = globalIndex - 2 * i;
-            bool needsFlushing = (i == firstStage) &&
-                (currentGlobalIndex >= newGrid->getDimensions()[DIM - 1]);
-            int sourceIndex = firstIteration ? currentGlobalIndex : normalizeIndex(localIndex + 2 - 4 * i);
-            int targetIndex = lastIteration  ? currentGlobalIndex : normalizeIndex(localIndex + 0 - 4 * i);
-
-            const Region<DIM>& updateFrame = frames[frameCoord][globalIndex - 2 * i][i];
-            unsigned curNanoStep = (nanoStep + i) % NANO_STEPS;
-
-            if ( firstIteration &&  lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *curGrid, newGrid, curNanoStep);
-            }
+        const CELL& edgeCell = buffer->getEdge();
+        for (typename CoordBox<DIM>::Iterator i = planeBox.begin(); i != planeBox.end(); ++i) {
+            (*buffer)[*i] = edgeCell;
+        }
+    }
 
-            if ( firstIteration && !lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *curGrid, buffer,  curNanoStep);
-            }
+    /**
+     * Maps coord into the grid. Halos may be wider than the grid
+     * itself, so this may need to wrap more than once.
+     */
+    Coord<DIM> wrap(Coord<DIM> coord) const
+    {
+        for (int d = 0; d < DIM; ++d) {
+            coord[d] = ((coord[d] % gridDim[d]) + gridDim[d]) % gridDim[d];
+        }
+
+        return coord;
+    }
+
+    CoordBox<DIM> expandColumn(const CoordBox<DIM>& column, int width) const
+    {
+        CoordBox<DIM> ret = column;
 
-            if (!firstIteration &&  lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *buffer,  newGrid, curNanoStep);
+        for (int d = 0; d < DIM; ++d) {
+            int start = column.origin[d] - width;
+            int end = column.origin[d] + column.dimensions[d] + width;
+
+            if (!Topology::wrapsAxis(d)) {
+                start = (std::max)(start, 0);
+                end = (std::min)(end, gridDim[d]);
             }
 
-            if (!firstIteration && !lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *buffer,  buffer,  curNanoStep);
+            ret.origin[d] = start;
+            ret.dimensions[d] = end - start;
+        }
+
+        return ret;
+    }
+
+    void evaluateReductions()
+    {
+        if (reductions.empty()) {
+            return;
+        }
+
+        TimeCompute t(&chronometer);
+        reductions.evaluate(*curGrid, simArea, stepNum);
+        reductions.complete(stepNum);
+    }
+
+    /**
+     * notifies all registered Writers
+     */
+    void handleOutput(WriterEvent event)
+    {
+        TimeOutput t(&chronometer);
+
+        for (unsigned i = 0; i < writers.size(); i++) {
+            if ((event != WRITER_STEP_FINISHED) ||
+                ((getStep() % writers[i]->getPeriod()) == 0)) {
+                writers[i]->stepFinished(
+                    *curGrid,
+                    getStep(),
+                    event);
             }
         }
     }
 
-    template<class GRID1, class GRID2>
-    void frameUpdate(
-        bool needsFlushing,
-        const Region<DIM>& updateFrame,
-        int sourceIndex,
-        int targetIndex,
-        const GRID1& sourceGrid,
-        GRID2 *targetGrid,
-        unsigned curNanoStep)
+    void handleOutput()
     {
-        LOG(DBG, "    frameUpdate("
-            << needsFlushing << ", "
-            << updateFrame.boundingBox() << ", "
-            << sourceIndex << ", "
-            << targetIndex <<  ")");
-
-        if (needsFlushing) {
-            // fixme: only works with cube topologies
-            Coord<DIM> fillOrigin = buffers[omp_get_thread_num()].getOrigin();
-            fillOrigin[DIM - 1] = targetIndex;
-            Coord<DIM> fillDim = buffers[omp_get_thread_num()].getDimensions();
-            fillDim[DIM - 1] = 1;
-
-            // buffers[omp_get_thread_num()].fill(
-            //     CoordBox<DIM>(fillOrigin, fillDim),
-            //     buffers[omp_get_thread_num()].getEdgeCell());
-        } else {
-            Coord<DIM> sourceOffset;
-            Coord<DIM> targetOffset;
-            sourceOffset[DIM - 1] = sourceIndex;
-            targetOffset[DIM - 1] = targetIndex;
-
-            UpdateFunctor<CELL>()(updateFrame, sourceOffset, targetOffset, sourceGrid, targetGrid, curNanoStep);
+        WriterEvent event = WRITER_STEP_FINISHED;
+        if (stepNum == initializer->maxSteps()) {
+            event = WRITER_ALL_DONE;
         }
-     }
+        handleOutput(event);
+    }
 
-    // wraps the index (for 3D this will be the Z coordinate) around
-    // the buffer's dimension
-    int normalizeIndex(int localIndex)
+    /**
+     * notifies all registered Steerers
+     */
+    void handleInput(SteererEvent event, SteererFeedback *feedback)
     {
-        int bufferSize = buffers[0].getDimensions()[DIM - 1];
-        return (localIndex + bufferSize) % bufferSize;
+        TimeInput t(&chronometer);
+
+        for (unsigned i = 0; i < steerers.size(); ++i) {
+            if ((event != STEERER_NEXT_STEP) ||
+                (stepNum % steerers[i]->getPeriod() == 0)) {
+                steerers[i]->nextStep(
+                    curGrid,
+                    simArea,
+                    gridDim,
+                    getStep(),
+                    event,
+                    0,
+                    true,
+                    feedback);
+            }
+        }
+    }
+
+    void setIORegions()
+    {
+        for (unsigned i = 0; i < steerers.size(); i++) {
+            steerers[i]->setRegion(simArea);
+        }
     }
 };
 
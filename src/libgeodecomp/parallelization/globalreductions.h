@@ -0,0 +1,490 @@
+#ifndef LIBGEODECOMP_PARALLELIZATION_GLOBALREDUCTIONS_H
+#define LIBGEODECOMP_PARALLELIZATION_GLOBALREDUCTIONS_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/reduction.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <libgeodecomp/storage/workdecomposition.h>
+#endif
+
+#ifdef LIBGEODECOMP_WITH_MPI
+#include <libgeodecomp/communication/mpilayer.h>
+#endif
+
+#include <map>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Holds all Reductions registered with a Simulator. Cells are
+ * accumulated while they're being updated: a ReductionAccumulator
+ * passed to the UpdateFunctor adds each freshly updated Streak to
+ * the partials of the updating thread. endSweep() folds these
+ * thread-local partials into the partials of the time step the
+ * cells belong to. A node may contribute to a step in several sweeps
+ * (e.g. ghost zone and inner set), possibly interleaved with sweeps
+ * of other steps.
+ *
+ * complete() hands a step's partials over to the Reductions. If an
+ * MPILayer has been set, these are combined across all nodes
+ * instead: for built-in operators all values are combined with a
+ * single non-blocking MPI_Iallreduce per operator. Custom combiners
+ * can't be mapped to MPI_Ops, so their partials are gathered on all
+ * nodes and combined locally. The combination is only waited for
+ * upon completion of the next step (or by finish()), so it overlaps
+ * with that step's computation.
+ */
+template<typename CELL_TYPE, int DIM>
+class GlobalReductions
+{
+public:
+    typedef typename SharedPtr<Reduction<CELL_TYPE> >::Type ReductionPtr;
+
+    /**
+     * long Streaks will be split into tranches of this length for
+     * threaded evaluation.
+     */
+    static const int GRANULARITY = 1024;
+
+    inline GlobalReductions() :
+        completedAny(false),
+        lastCompletedStep(0)
+#ifdef LIBGEODECOMP_WITH_MPI
+        ,
+        mpiLayer(0),
+        waitTag(0),
+        combining(false),
+        combiningStep(0)
+#endif
+    {}
+
+    void add(Reduction<CELL_TYPE> *reduction)
+    {
+        reductions << ReductionPtr(reduction);
+    }
+
+    inline std::size_t size() const
+    {
+        return reductions.size();
+    }
+
+    inline bool empty() const
+    {
+        return reductions.empty();
+    }
+
+    /**
+     * true if partials have been accumulated, but not yet been handed
+     * over to the Reductions.
+     */
+    inline bool isPending() const
+    {
+#ifdef LIBGEODECOMP_WITH_MPI
+        if (combining) {
+            return true;
+        }
+#endif
+        return !stepPartials.empty();
+    }
+
+    /**
+     * false if the given step has already been completed, i.e. if
+     * accumulating its cells would be superfluous.
+     */
+    inline bool needsStep(unsigned step) const
+    {
+        return !completedAny || (step > lastCompletedStep);
+    }
+
+    /**
+     * resets the thread-local partials. Needs to be called outside
+     * of any parallel region before cells are accumulated.
+     */
+    void beginSweep()
+    {
+        std::size_t numSlots = 1;
+#ifdef LIBGEODECOMP_WITH_THREADS
+        numSlots = omp_get_max_threads();
+#endif
+        // the last slot catches threads which exceed the expected
+        // team size (e.g. from nested parallel regions):
+        threadPartials.resize(numSlots + 1);
+        for (std::size_t i = 0; i < threadPartials.size(); ++i) {
+            resetPartials(&threadPartials[i]);
+        }
+    }
+
+    /**
+     * adds all cells of the streak to the calling thread's partials.
+     * Coordinates are passed as-is to grid's operator[], which is
+     * what an UpdateFunctor does for the cells it has just written.
+     */
+    template<typename GRID>
+    void accumulate(const Streak<DIM>& streak, const GRID& grid)
+    {
+        std::size_t slot = 0;
+#ifdef LIBGEODECOMP_WITH_THREADS
+        slot = omp_get_thread_num();
+#endif
+
+        if ((slot + 1) < threadPartials.size()) {
+            addStreak(streak, grid, &threadPartials[slot]);
+            return;
+        }
+
+        std::vector<double> partials;
+        resetPartials(&partials);
+        addStreak(streak, grid, &partials);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical(LibGeoDecompGlobalReductions)
+#endif
+        combineInto(partials, &threadPartials.back());
+    }
+
+    /**
+     * adds all cells of the region to the partials. Coordinates in
+     * region are logical ones (i.e. not remapped). This is used for
+     * the initial grid and for grids whose cells can't be read
+     * directly after the update of a Streak (SoA, unstructured).
+     */
+    template<typename GRID>
+    void accumulate(const GRID& grid, const Region<DIM>& region, bool threaded = true)
+    {
+        if (reductions.empty() || region.empty()) {
+            return;
+        }
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+        if (threaded) {
+            std::size_t numSlots = threadPartials.size() - 1;
+            std::vector<std::vector<CELL_TYPE> > buffers(numSlots);
+
+            WorkDecompositionCache<DIM>::instance()(region, GRANULARITY, numSlots)(
+                [&](const Streak<DIM> *streak) {
+                    std::size_t slot = omp_get_thread_num();
+                    if (slot < numSlots) {
+                        addBuffered(grid, *streak, &buffers[slot], &threadPartials[slot]);
+                        return;
+                    }
+
+                    std::vector<CELL_TYPE> buffer;
+                    std::vector<double> partials;
+                    resetPartials(&partials);
+                    addBuffered(grid, *streak, &buffer, &partials);
+#pragma omp critical(LibGeoDecompGlobalReductions)
+                    combineInto(partials, &threadPartials.back());
+                });
+            return;
+        }
+#endif
+
+        std::vector<CELL_TYPE> buffer;
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            addBuffered(grid, *i, &buffer, &threadPartials[0]);
+        }
+    }
+
+    /**
+     * adds the thread-local partials to the partials of the given
+     * step.
+     */
+    void endSweep(unsigned step)
+    {
+        if (reductions.empty()) {
+            return;
+        }
+
+        typename StepPartialsMap::iterator i = stepPartials.find(step);
+        if (i == stepPartials.end()) {
+            i = stepPartials.insert(std::make_pair(step, std::vector<double>())).first;
+            resetPartials(&i->second);
+        }
+
+        for (std::size_t t = 0; t < threadPartials.size(); ++t) {
+            combineInto(threadPartials[t], &i->second);
+        }
+    }
+
+    /**
+     * convenience function which accumulates the whole region of
+     * grid in a single sweep.
+     */
+    template<typename GRID>
+    void evaluate(const GRID& grid, const Region<DIM>& region, unsigned step)
+    {
+        beginSweep();
+        accumulate(grid, region);
+        endSweep(step);
+    }
+
+    /**
+     * signals that all cells of the given step have been
+     * accumulated. Results will either be published right away or,
+     * if an MPILayer has been set, after the next call to complete()
+     * or finish().
+     */
+    void complete(unsigned step)
+    {
+        typename StepPartialsMap::iterator i = stepPartials.find(step);
+        if (i == stepPartials.end()) {
+            return;
+        }
+
+        std::vector<double> partials;
+        std::swap(partials, i->second);
+        stepPartials.erase(i);
+        completedAny = true;
+        lastCompletedStep = step;
+
+#ifdef LIBGEODECOMP_WITH_MPI
+        if (mpiLayer) {
+            finishCombination();
+            startCombination(partials, step);
+            return;
+        }
+#endif
+
+        publish(partials, step);
+    }
+
+    /**
+     * waits for any pending combination and publishes its results.
+     */
+    void finish()
+    {
+#ifdef LIBGEODECOMP_WITH_MPI
+        finishCombination();
+#endif
+    }
+
+    /**
+     * drops the partials of all steps after the given one. Required
+     * if these steps are going to be recomputed from scratch, e.g.
+     * after repartitioning.
+     */
+    void discardAfter(unsigned step)
+    {
+        stepPartials.erase(stepPartials.upper_bound(step), stepPartials.end());
+    }
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    /**
+     * makes complete() combine the partials of all nodes in
+     * mpiLayer's communicator. waitTag identifies the combination's
+     * requests within mpiLayer.
+     */
+    void setMPILayer(MPILayer *newMPILayer, int newWaitTag)
+    {
+        mpiLayer = newMPILayer;
+        waitTag = newWaitTag;
+    }
+#endif
+
+private:
+    typedef std::map<unsigned, std::vector<double> > StepPartialsMap;
+
+    static const int NUM_BUILTINS = 3;
+
+    std::vector<ReductionPtr> reductions;
+    std::vector<std::vector<double> > threadPartials;
+    StepPartialsMap stepPartials;
+    bool completedAny;
+    unsigned lastCompletedStep;
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    MPILayer *mpiLayer;
+    int waitTag;
+    bool combining;
+    unsigned combiningStep;
+    std::vector<double> sendBuffers[NUM_BUILTINS];
+    std::vector<double> recvBuffers[NUM_BUILTINS];
+    std::vector<double> customSendBuffer;
+    std::vector<double> customRecvBuffer;
+#endif
+
+    void resetPartials(std::vector<double> *partials) const
+    {
+        partials->resize(reductions.size());
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            (*partials)[i] = reductions[i]->identity();
+        }
+    }
+
+    void combineInto(const std::vector<double>& source, std::vector<double> *target) const
+    {
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            (*target)[i] = reductions[i]->combine((*target)[i], source[i]);
+        }
+    }
+
+    inline void addCell(const CELL_TYPE& cell, std::vector<double> *target) const
+    {
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            const Reduction<CELL_TYPE>& reduction = *reductions[i];
+            (*target)[i] = reduction.combine((*target)[i], reduction.extract(cell));
+        }
+    }
+
+    template<typename GRID>
+    void addStreak(const Streak<DIM>& streak, const GRID& grid, std::vector<double> *target) const
+    {
+        Coord<DIM> c = streak.origin;
+        for (; c.x() < streak.endX; ++c.x()) {
+            addCell(grid[c], target);
+        }
+    }
+
+    template<typename GRID>
+    void addBuffered(
+        const GRID& grid,
+        const Streak<DIM>& streak,
+        std::vector<CELL_TYPE> *buffer,
+        std::vector<double> *target) const
+    {
+        buffer->resize(streak.length());
+        grid.get(streak, &(*buffer)[0]);
+
+        for (std::size_t j = 0; j < buffer->size(); ++j) {
+            addCell((*buffer)[j], target);
+        }
+    }
+
+    void publish(const std::vector<double>& partials, unsigned step)
+    {
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            reductions[i]->setResult(partials[i], step);
+        }
+    }
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    void startCombination(const std::vector<double>& partials, unsigned step)
+    {
+        // indexed by ReductionOperator:
+        MPI_Op mpiOps[NUM_BUILTINS] = {
+            MPI_SUM,
+            MPI_MIN,
+            MPI_MAX
+        };
+
+        for (int op = 0; op < NUM_BUILTINS; ++op) {
+            sendBuffers[op].clear();
+        }
+        customSendBuffer.clear();
+
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            ReductionOperator op = reductions[i]->getOperator();
+            if (op == REDUCTION_CUSTOM) {
+                customSendBuffer << partials[i];
+            } else {
+                sendBuffers[op] << partials[i];
+            }
+        }
+
+        for (int op = 0; op < NUM_BUILTINS; ++op) {
+            recvBuffers[op].resize(sendBuffers[op].size());
+            if (!sendBuffers[op].empty()) {
+                mpiLayer->allReduceNonBlocking(
+                    &sendBuffers[op][0],
+                    &recvBuffers[op][0],
+                    sendBuffers[op].size(),
+                    mpiOps[op],
+                    waitTag);
+            }
+        }
+
+        customRecvBuffer.resize(customSendBuffer.size() * mpiLayer->size());
+        if (!customSendBuffer.empty()) {
+            mpiLayer->allGatherNonBlocking(
+                &customSendBuffer[0],
+                &customRecvBuffer[0],
+                customSendBuffer.size(),
+                waitTag);
+        }
+
+        combining = true;
+        combiningStep = step;
+    }
+
+    void finishCombination()
+    {
+        if (!combining) {
+            return;
+        }
+
+        mpiLayer->wait(waitTag);
+        combining = false;
+
+        std::size_t indices[NUM_BUILTINS] = { 0, 0, 0 };
+        std::size_t numCustoms = customSendBuffer.size();
+        std::size_t customIndex = 0;
+        std::vector<double> partials(reductions.size());
+
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            ReductionOperator op = reductions[i]->getOperator();
+            if (op != REDUCTION_CUSTOM) {
+                partials[i] = recvBuffers[op][indices[op]++];
+                continue;
+            }
+
+            double value = reductions[i]->identity();
+            for (int rank = 0; rank < mpiLayer->size(); ++rank) {
+                value = reductions[i]->combine(value, customRecvBuffer[rank * numCustoms + customIndex]);
+            }
+            partials[i] = value;
+            ++customIndex;
+        }
+
+        publish(partials, combiningStep);
+    }
+#endif
+};
+
+/**
+ * A CONCURRENCY_FUNCTOR for the UpdateFunctor which behaves just like
+ * the CONCURRENCY_SPEC it wraps, but also accumulates all updated
+ * cells into the thread-local partials of the GlobalReductions while
+ * they're still in cache. logicalRegion is the (not remapped)
+ * counterpart of the Region passed to the UpdateFunctor. It's only
+ * read if the UpdateFunctor can't hand out updated Streaks.
+ *
+ * GlobalReductions::beginSweep() and endSweep() need to be called
+ * around the update(s).
+ */
+template<typename CELL_TYPE, int DIM, typename CONCURRENCY_SPEC>
+class ReductionAccumulator : public CONCURRENCY_SPEC
+{
+public:
+    inline ReductionAccumulator(
+        const CONCURRENCY_SPEC& spec,
+        GlobalReductions<CELL_TYPE, DIM> *reductions,
+        const Region<DIM> *logicalRegion) :
+        CONCURRENCY_SPEC(spec),
+        reductions(reductions),
+        logicalRegion(logicalRegion)
+    {}
+
+    template<typename GRID>
+    void streakUpdated(const Streak<DIM>& streak, const GRID& grid) const
+    {
+        reductions->accumulate(streak, grid);
+    }
+
+    template<typename GRID>
+    void regionUpdated(const GRID& grid) const
+    {
+        reductions->accumulate(grid, *logicalRegion, this->enableOpenMP());
+    }
+
+private:
+    GlobalReductions<CELL_TYPE, DIM> *reductions;
+    const Region<DIM> *logicalRegion;
+};
+
+}
+
+#endif
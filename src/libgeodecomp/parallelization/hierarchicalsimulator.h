@@ -55,6 +55,9 @@ protected:
                 balanceLoad();
                 insertNextLoadBalancingEvent();
             }
+            if (*i == REPARTITION) {
+                repartition();
+            }
         }
         events.erase(events.begin());
     }
@@ -73,6 +76,15 @@ protected:
 
     virtual void balanceLoad() = 0;
 
+    /**
+     * Simulators may defer the application of a new domain
+     * decomposition (e.g. until their local state is consistent) by
+     * inserting a REPARTITION event. Only those Simulators which
+     * actually migrate cells need to override this.
+     */
+    virtual void repartition()
+    {}
+
     /**
      * returns the number of nano steps until the next event needs to be handled.
      */
@@ -10,11 +10,14 @@
 #include <libgeodecomp/geometry/partitions/unstructuredstripingpartition.h>
 #include <libgeodecomp/geometry/partitions/distributedptscotchunstructuredpartition.h>
 #include <libgeodecomp/loadbalancer/loadbalancer.h>
+#include <libgeodecomp/misc/eventtrace.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/parallelization/hierarchicalsimulator.h>
+#include <libgeodecomp/parallelization/nesting/migrationinitializer.h>
 #include <libgeodecomp/parallelization/nesting/parallelwriteradapter.h>
 #include <libgeodecomp/parallelization/nesting/steereradapter.h>
 #include <libgeodecomp/parallelization/nesting/mpiupdategroup.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
 #include <cmath>
 #include <stdexcept>
 
@@ -29,6 +32,20 @@ namespace LibGeoDecomp {
  * inter-node or inter-NUMA-domain communication and OpenMP and/or
  * CUDA for local paralelism.
  *
+ * Load balancing is done at runtime: the LoadBalancer on rank 0 is
+ * fed with the compute/wall clock time ratios of all ranks. If it
+ * returns a new weight distribution, then cells are migrated between
+ * the ranks and the UpdateGroup (including all PatchLinks) is rebuilt
+ * for the new Partition. Migration requires the local subdomains to
+ * be consistent, which is only guaranteed right after a ghost zone
+ * update at the beginning of a time step. Hence repartitioning may be
+ * deferred by a few nano steps after balancing.
+ *
+ * Reductions are accumulated by the Stepper while it updates the
+ * inner set and the rim. As the rim runs ahead of the inner set, a
+ * step is complete once the inner set has reached it. The
+ * combination across all ranks then overlaps with the next step.
+ *
  * fixme: check if code runs with a communicator which is merely a subset of MPI_COMM_WORLD
  */
 template<
@@ -54,6 +71,10 @@ public:
     typedef typename ParentType::GridType GridType;
     typedef ParallelWriterAdapter<typename UpdateGroupType::GridType, CELL_TYPE> ParallelWriterAdapterType;
     typedef SteererAdapter<typename UpdateGroupType::GridType, CELL_TYPE> SteererAdapterType;
+    typedef typename SharedPtr<ParallelWriterAdapterType>::Type ParallelWriterAdapterPtr;
+    typedef typename SharedPtr<SteererAdapterType>::Type SteererAdapterPtr;
+    typedef typename SerializationBuffer<CELL_TYPE>::BufferType BufferType;
+    typedef typename UpdateGroupType::PartitionManagerType PartitionManagerType;
 
     static const int DIM = Topology::DIM;
 
@@ -70,14 +91,23 @@ public:
             enableFineGrainedParallelism),
         balancer(balancer),
         ghostZoneWidth(ghostZoneWidth),
-        mpiLayer(communicator)
-    {}
+        mpiLayer(communicator),
+        lastRepartitioningNanoStep(0)
+    {
+        reductions.setMPILayer(&mpiLayer, MPILayer::GLOBAL_REDUCTIONS);
+    }
+
+    virtual ~HiParSimulator()
+    {
+        reductions.finish();
+    }
 
     inline void run()
     {
         initSimulation();
 
         nanoStep(timeToLastEvent());
+        reductions.finish();
     }
 
     inline void step()
@@ -87,6 +117,20 @@ public:
         nanoStep(NANO_STEPS);
     }
 
+    /**
+     * Reductions need to be added before the first call to run() or
+     * step(), as the Stepper accumulates them from its creation on.
+     */
+    virtual void addReduction(Reduction<CELL_TYPE> *reduction)
+    {
+        if (updateGroup) {
+            delete reduction;
+            throw std::logic_error("Reductions need to be added before the simulation starts");
+        }
+
+        reductions.add(reduction);
+    }
+
     virtual unsigned getStep() const
     {
         if (updateGroup) {
@@ -101,14 +145,14 @@ public:
         DistributedSimulator<CELL_TYPE>::addSteerer(steerer);
 
         // two adapters needed, just as for the writers
-        typename UpdateGroupType::PatchProviderPtr adapterGhost(
+        SteererAdapterPtr adapterGhost(
             new SteererAdapterType(
                 steerers.back(),
                 initializer->startStep(),
                 initializer->maxSteps(),
                 false));
 
-        typename UpdateGroupType::PatchProviderPtr adapterInnerSet(
+        SteererAdapterPtr adapterInnerSet(
             new SteererAdapterType(
                 steerers.back(),
                 initializer->startStep(),
@@ -117,6 +161,7 @@ public:
 
         steererAdaptersGhost.push_back(adapterGhost);
         steererAdaptersInner.push_back(adapterInnerSet);
+        steererAdapters << adapterGhost << adapterInnerSet;
     }
 
     virtual void addWriter(ParallelWriter<CELL_TYPE> *writer)
@@ -126,13 +171,13 @@ public:
         // we need two adapters as each ParallelWriter needs to be
         // notified twice: once for the (inner) ghost zone, and once
         // for the inner set.
-        typename UpdateGroupType::PatchAccepterPtr adapterGhost(
+        ParallelWriterAdapterPtr adapterGhost(
             new ParallelWriterAdapterType(
                 writers.back(),
                 initializer->startStep(),
                 initializer->maxSteps(),
                 false));
-        typename UpdateGroupType::PatchAccepterPtr adapterInnerSet(
+        ParallelWriterAdapterPtr adapterInnerSet(
             new ParallelWriterAdapterType(
                 writers.back(),
                 initializer->startStep(),
@@ -141,16 +186,87 @@ public:
 
         writerAdaptersGhost.push_back(adapterGhost);
         writerAdaptersInner.push_back(adapterInnerSet);
+        writerAdapters << adapterGhost << adapterInnerSet;
     }
 
     std::vector<Chronometer> gatherStatistics()
     {
-        Chronometer stats = chronometer + updateGroup->statistics();
+        Chronometer stats = chronometer + retiredStatistics + updateGroup->statistics();
         return mpiLayer.gather(stats, 0);
     }
 
+    /**
+     * Starts recording all timed events and ghost zone transfers of
+     * this rank in an EventTrace. capacity limits the number of
+     * events retained per thread.
+     */
+    void enableEventTrace(std::size_t capacity = EventTrace::DEFAULT_CAPACITY)
+    {
+        eventTrace.reset(new EventTrace(capacity));
+        eventTrace->activate();
+    }
+
+    /**
+     * Collects the event traces of all ranks in Chrome's trace event
+     * format on rank 0, with one process per rank. Returns an empty
+     * string on all other ranks. Needs to be called by all ranks.
+     */
+    std::string gatherEventTrace()
+    {
+        checkEventTrace();
+        double epoch = mpiLayer.allReduce(eventTrace->origin(), MPI_MIN);
+        std::vector<std::string> traces = gatherStrings(
+            eventTrace->chromeTraceEvents(mpiLayer.rank(), epoch));
+
+        std::string events;
+        for (std::size_t i = 0; i < traces.size(); ++i) {
+            if (i > 0) {
+                events += ",\n";
+            }
+            events += traces[i];
+        }
+
+        if (mpiLayer.rank() != 0) {
+            return "";
+        }
+        return EventTrace::chromeTrace(events);
+    }
+
+    /**
+     * Gathers the per nano step summaries of all ranks' event traces
+     * and returns EventTrace::criticalPathReport() on rank 0, an empty
+     * string on all other ranks. Needs to be called by all ranks.
+     */
+    std::string gatherCriticalPathReport()
+    {
+        typedef EventTrace::StepSummary StepSummary;
+
+        checkEventTrace();
+        std::vector<StepSummary> summaries = eventTrace->stepSummaries();
+        std::string buffer(
+            reinterpret_cast<const char*>(summaries.empty() ? 0 : &summaries[0]),
+            summaries.size() * sizeof(StepSummary));
+        std::vector<std::string> buffers = gatherStrings(buffer);
+
+        if (mpiLayer.rank() != 0) {
+            return "";
+        }
+
+        std::vector<std::vector<StepSummary> > allSummaries(buffers.size());
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            allSummaries[i].resize(buffers[i].size() / sizeof(StepSummary));
+            std::copy(
+                buffers[i].begin(),
+                buffers[i].end(),
+                reinterpret_cast<char*>(allSummaries[i].empty() ? 0 : &allSummaries[i][0]));
+        }
+
+        return EventTrace::criticalPathReport(allSummaries);
+    }
+
 private:
     using DistributedSimulator<CELL_TYPE>::initializer;
+    using DistributedSimulator<CELL_TYPE>::reductions;
     using DistributedSimulator<CELL_TYPE>::steerers;
     using DistributedSimulator<CELL_TYPE>::writers;
 
@@ -163,6 +279,47 @@ private:
     typename UpdateGroupType::PatchProviderVec steererAdaptersInner;
     typename UpdateGroupType::PatchAccepterVec writerAdaptersGhost;
     typename UpdateGroupType::PatchAccepterVec writerAdaptersInner;
+    // all adapters, regardless of their type. we need to retain them
+    // to be able to hand them over to new UpdateGroups.
+    std::vector<ParallelWriterAdapterPtr> writerAdapters;
+    std::vector<SteererAdapterPtr> steererAdapters;
+
+    // measurements of UpdateGroups which have been replaced while
+    // repartitioning:
+    Chronometer retiredStatistics;
+    // statistics of the current UpdateGroup at the previous load
+    // balancing event, required to compute the load since then:
+    Chronometer lastStatistics;
+    LoadBalancer::WeightVec pendingWeights;
+    long lastRepartitioningNanoStep;
+    SharedPtr<EventTrace>::Type eventTrace;
+
+    inline void checkEventTrace()
+    {
+        if (!eventTrace) {
+            throw std::logic_error("event trace needs to be enabled first");
+        }
+    }
+
+    /**
+     * Collects the strings of all ranks on rank 0, ordered by rank.
+     */
+    std::vector<std::string> gatherStrings(const std::string& local)
+    {
+        std::vector<char> source(local.begin(), local.end());
+        std::vector<int> lengths = mpiLayer.gather(int(source.size()), 0);
+        std::vector<char> target(sum(lengths));
+        mpiLayer.gatherV(source, lengths, 0, target, MPI_CHAR);
+
+        std::vector<std::string> ret;
+        std::vector<char>::iterator offset = target.begin();
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            ret.push_back(std::string(offset, offset + lengths[i]));
+            offset += lengths[i];
+        }
+
+        return ret;
+    }
 
     inline void nanoStep(long s)
     {
@@ -192,8 +349,6 @@ private:
         }
 
         CoordBox<DIM> box = initializer->gridBox();
-        Region<DIM> globalRegion;
-        globalRegion << box;
 
         double mySpeed = APITraits::SelectSpeedGuide<CELL_TYPE>::value();
         std::vector<double> rankSpeeds = mpiLayer.allGather(mySpeed);
@@ -201,34 +356,50 @@ private:
             box.dimensions.prod(),
             rankSpeeds);
 
-        typename SharedPtr<PARTITION>::Type partition(
+        createUpdateGroup(makePartition(weights), initializer);
+        lastRepartitioningNanoStep = currentNanoStep();
+
+        initEvents();
+    }
+
+    inline typename SharedPtr<PARTITION>::Type makePartition(const LoadBalancer::WeightVec& weights)
+    {
+        CoordBox<DIM> box = initializer->gridBox();
+        Region<DIM> globalRegion;
+        globalRegion << box;
+
+        return typename SharedPtr<PARTITION>::Type(
             new PARTITION(
                 box.origin,
                 box.dimensions,
                 0,
                 weights,
                 initializer->getAdjacency(globalRegion)));
+    }
 
+    /**
+     * The adapters for writers and steerers are retained (and not
+     * cleared after creation of the UpdateGroup) as they need to be
+     * handed over to the new UpdateGroup when repartitioning.
+     */
+    inline void createUpdateGroup(
+        typename SharedPtr<PARTITION>::Type partition,
+        typename UpdateGroupType::InitPtr groupInitializer)
+    {
         updateGroup.reset(
             new UpdateGroupType(
                 partition,
-                box,
+                initializer->gridBox(),
                 ghostZoneWidth,
-                initializer,
+                groupInitializer,
                 static_cast<STEPPER*>(0),
                 writerAdaptersGhost,
                 writerAdaptersInner,
                 steererAdaptersGhost,
                 steererAdaptersInner,
                 enableFineGrainedParallelism,
-                mpiLayer.communicator()));
-
-        writerAdaptersGhost.clear();
-        writerAdaptersInner.clear();
-        steererAdaptersGhost.clear();
-        steererAdaptersInner.clear();
-
-        initEvents();
+                mpiLayer.communicator(),
+                &reductions));
     }
 
     inline long currentNanoStep() const
@@ -237,17 +408,225 @@ private:
         return (long)now.first * NANO_STEPS + now.second;
     }
 
+    /**
+     * Gathers the ratio of compute time vs. wall clock time (since
+     * the last load balancing event) of all ranks and lets the
+     * LoadBalancer on rank 0 derive new weights. These are then
+     * broadcast to all ranks and repartitioning is scheduled for the
+     * next time step at which the grid is in a consistent state.
+     */
     inline void balanceLoad()
     {
-        if (mpiLayer.rank() == 0) {
-            if (!balancer) {
-                return;
+        const Chronometer& stats = updateGroup->statistics();
+        double computeTime =
+            stats.template interval<TimeCompute>() -
+            lastStatistics.template interval<TimeCompute>();
+        double totalTime =
+            stats.template interval<TimeTotal>() -
+            lastStatistics.template interval<TimeTotal>();
+        lastStatistics = stats;
+
+        // same fallback as in Chronometer::ratio():
+        double myLoad = 0.5;
+        if (totalTime > 0) {
+            myLoad = computeTime / totalTime;
+        }
+        LoadBalancer::LoadVec loads = mpiLayer.gather(myLoad, 0);
+
+        LoadBalancer::WeightVec oldWeights = updateGroup->getWeights();
+        LoadBalancer::WeightVec newWeights;
+        if ((mpiLayer.rank() == 0) && balancer) {
+            newWeights = balancer->balance(oldWeights, loads);
+            validateWeights(newWeights, oldWeights);
+        }
+
+        newWeights = mpiLayer.broadcastVector(newWeights, 0);
+        if (newWeights.empty() || (newWeights == oldWeights)) {
+            return;
+        }
+
+        pendingWeights = newWeights;
+        long now = currentNanoStep();
+        long next = now;
+        while (((next - lastRepartitioningNanoStep) % ghostZoneWidth) ||
+               (next % NANO_STEPS)) {
+            ++next;
+        }
+
+        long lastNanoStep = initializer->maxSteps() * NANO_STEPS;
+        if (next >= lastNanoStep) {
+            // no point in migrating cells if no further updates are due
+            pendingWeights.clear();
+            return;
+        }
+
+        if (next == now) {
+            repartition();
+        } else {
+            events[next] << REPARTITION;
+        }
+    }
+
+    /**
+     * Migrates cells according to pendingWeights and replaces the
+     * UpdateGroup by one that is set up for the new Partition. Expects
+     * that the whole subdomain of this rank is at the current time
+     * step, which is the case right after the Stepper has updated the
+     * ghost zones.
+     */
+    inline void repartition()
+    {
+        if (pendingWeights.empty()) {
+            return;
+        }
+
+        typename SharedPtr<PARTITION>::Type newPartition = makePartition(pendingWeights);
+        pendingWeights.clear();
+
+        long nanoStep = currentNanoStep();
+        typename SharedPtr<MigrationInitializer<CELL_TYPE> >::Type migrationInitializer(
+            new MigrationInitializer<CELL_TYPE>(
+                initializer,
+                nanoStep / NANO_STEPS,
+                updateGroup->grid().getEdge()));
+        migrateCells(newPartition, &*migrationInitializer);
+
+        retiredStatistics += updateGroup->statistics();
+        lastStatistics = Chronometer();
+
+        // The old UpdateGroup needs to be torn down before the new
+        // one gets created so that its PatchLinks can complete all
+        // pending transmissions. Otherwise these might be mistaken
+        // for messages of the new PatchLinks.
+        updateGroup.reset();
+
+        // The new Stepper will revisit time steps which the old one
+        // might already have reported (its ghost zone is always a
+        // couple of steps ahead), so IO needs to be re-synchronized
+        // and the partial Reductions of these steps are void:
+        reductions.discardAfter(nanoStep / NANO_STEPS);
+        for (typename std::vector<ParallelWriterAdapterPtr>::iterator i = writerAdapters.begin();
+             i != writerAdapters.end();
+             ++i) {
+            (*i)->reschedule(nanoStep);
+        }
+        for (typename std::vector<SteererAdapterPtr>::iterator i = steererAdapters.begin();
+             i != steererAdapters.end();
+             ++i) {
+            (*i)->reschedule(nanoStep);
+        }
+
+        createUpdateGroup(newPartition, migrationInitializer);
+        lastRepartitioningNanoStep = nanoStep;
+    }
+
+    /**
+     * Sends all cells of the current subdomain which are required by
+     * other ranks for the new partition (including their ghost
+     * zones) and hands the received cells to the target Initializer.
+     * Only ranks whose bounding boxes intersect will communicate.
+     */
+    inline void migrateCells(
+        typename SharedPtr<PARTITION>::Type newPartition,
+        MigrationInitializer<CELL_TYPE> *target)
+    {
+        PartitionManagerType& oldManager = updateGroup->getPartitionManager();
+        PartitionManagerType newManager;
+        newManager.resetRegions(
+            initializer,
+            initializer->gridBox(),
+            newPartition,
+            mpiLayer.rank(),
+            ghostZoneWidth);
+
+        const Region<DIM>& oldRegion = oldManager.ownRegion();
+        const Region<DIM>& newRegion = newManager.ownExpandedRegion();
+        std::vector<CoordBox<DIM> > oldBoxes = mpiLayer.allGather(oldRegion.boundingBox());
+        std::vector<CoordBox<DIM> > newBoxes = mpiLayer.allGather(newRegion.boundingBox());
+
+        const typename UpdateGroupType::GridType& grid = updateGroup->grid();
+        int size = mpiLayer.size();
+        int rank = mpiLayer.rank();
+        std::vector<Region<DIM> > sendRegions(size);
+        std::vector<Region<DIM> > recvRegions(size);
+        std::vector<BufferType> sendBuffers(size);
+        std::vector<BufferType> recvBuffers(size);
+        std::vector<std::size_t> sendSizes(size);
+        std::vector<std::size_t> recvSizes(size);
+
+        // 1: exchange buffer sizes, required for cells with variable size
+        for (int i = 0; i < size; ++i) {
+            if (i == rank) {
+                continue;
+            }
+
+            if (newBoxes[i].intersects(oldBoxes[rank])) {
+                sendRegions[i] = newManager.getRegion(i, ghostZoneWidth) & oldRegion;
+                if (!sendRegions[i].empty()) {
+                    SerializationBuffer<CELL_TYPE>::resize(&sendBuffers[i], sendRegions[i]);
+                    grid.saveRegion(&sendBuffers[i], sendRegions[i]);
+                    sendSizes[i] = sendBuffers[i].size();
+                    mpiLayer.send(&sendSizes[i], i, 1, MPILayer::HIPAR_SIMULATOR);
+                }
             }
 
-            LoadBalancer::LoadVec loads(mpiLayer.size(), 1.0);
-            LoadBalancer::WeightVec newWeights =
-                balancer->balance(updateGroup->getWeights(), loads);
-            // fixme: actually balance the load!
+            if (newBoxes[rank].intersects(oldBoxes[i])) {
+                recvRegions[i] = newRegion & oldManager.getRegion(i, 0);
+                if (!recvRegions[i].empty()) {
+                    mpiLayer.recv(&recvSizes[i], i, 1, MPILayer::HIPAR_SIMULATOR);
+                }
+            }
+        }
+        mpiLayer.wait(MPILayer::HIPAR_SIMULATOR);
+
+        // 2: actual cell migration
+        for (int i = 0; i < size; ++i) {
+            if (!recvRegions[i].empty()) {
+                recvBuffers[i].resize(recvSizes[i]);
+                mpiLayer.recv(
+                    recvBuffers[i].data(),
+                    i,
+                    recvSizes[i],
+                    MPILayer::HIPAR_SIMULATOR,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+            }
+            if (!sendRegions[i].empty()) {
+                mpiLayer.send(
+                    sendBuffers[i].data(),
+                    i,
+                    sendSizes[i],
+                    MPILayer::HIPAR_SIMULATOR,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+            }
+        }
+
+        // cells which stay on this rank don't need to be sent at all:
+        Region<DIM> localRegion = newRegion & oldRegion;
+        BufferType localBuffer;
+        SerializationBuffer<CELL_TYPE>::resize(&localBuffer, localRegion);
+        grid.saveRegion(&localBuffer, localRegion);
+        target->addPatch(localRegion, localBuffer);
+
+        mpiLayer.wait(MPILayer::HIPAR_SIMULATOR);
+
+        for (int i = 0; i < size; ++i) {
+            if (!recvRegions[i].empty()) {
+                target->addPatch(recvRegions[i], recvBuffers[i]);
+            }
+        }
+    }
+
+    /**
+     * ensures that the LoadBalancer didn't lose (or invent) any work items.
+     */
+    inline void validateWeights(
+        const LoadBalancer::WeightVec& newWeights,
+        const LoadBalancer::WeightVec& oldWeights) const
+    {
+        if ((newWeights.size() != oldWeights.size()) ||
+            (sum(newWeights) != sum(oldWeights))) {
+            throw std::invalid_argument(
+                "newWeights and oldWeights do not maintain invariance");
         }
     }
 };
@@ -1,6 +1,7 @@
 #ifndef LIBGEODECOMP_PARALLELIZATION_NESTING_COMMONSTEPPER_H
 #define LIBGEODECOMP_PARALLELIZATION_NESTING_COMMONSTEPPER_H
 
+#include <libgeodecomp/misc/eventtrace.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/parallelization/nesting/stepper.h>
 #include <libgeodecomp/storage/patchbufferfixed.h>
@@ -27,6 +28,7 @@ public:
     typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
+    typedef typename ParentType::GlobalReductionsType GlobalReductionsType;
 
     using Stepper<CELL_TYPE>::guessOffset;
     using Stepper<CELL_TYPE>::addPatchAccepter;
@@ -48,11 +50,13 @@ public:
         const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
         const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
         const PatchProviderVec& innerSetPatchProviders  = PatchProviderVec(),
-        bool enableFineGrainedParallelism = false) :
+        bool enableFineGrainedParallelism = false,
+        GlobalReductionsType *reductions = 0) :
         Stepper<CELL_TYPE>(
             partitionManager,
             initializer),
-        enableFineGrainedParallelism(enableFineGrainedParallelism)
+        enableFineGrainedParallelism(enableFineGrainedParallelism),
+        reductions(reductions)
     {
         curStep = initializer->startStep();
         curNanoStep = 0;
@@ -78,6 +82,7 @@ public:
     inline virtual void update(std::size_t nanoSteps)
     {
         for (std::size_t i = 0; i < nanoSteps; ++i) {
+            EventTrace::setNanoStep(globalNanoStep());
             update1();
         }
     }
@@ -100,6 +105,8 @@ public:
 protected:
     std::vector<Region<DIM> > remappedInnerSets;
     std::vector<Region<DIM> > remappedRims;
+    std::vector<Region<DIM> > remappedInnerSetFringes;
+    std::vector<Region<DIM> > remappedRimFringes;
     std::size_t curStep;
     std::size_t curNanoStep;
     unsigned validGhostZoneWidth;
@@ -109,6 +116,7 @@ protected:
     PatchBufferType1 kernelBuffer;
     Region<DIM> kernelFraction;
     bool enableFineGrainedParallelism;
+    GlobalReductionsType *reductions;
 
     virtual inline void notifyPatchAccepters(
         const Region<DIM>& region,
@@ -160,6 +168,49 @@ protected:
         return curStep * NANO_STEPS + curNanoStep;
     }
 
+    /**
+     * true if the upcoming nano step completes a time step whose
+     * cells need to be accumulated for the Reductions.
+     */
+    inline bool reducing() const
+    {
+        return reductions && !reductions->empty() && ((curNanoStep + 1) == NANO_STEPS);
+    }
+
+    /**
+     * Reductions are accumulated while the cells are being updated,
+     * only the initial grid (whole ownRegion() at curStep) needs to
+     * be evaluated separately. This is skipped if the step has
+     * already been completed by a previous Stepper (i.e. prior to
+     * repartitioning).
+     */
+    inline void evaluateReductions()
+    {
+        if (!reductions || reductions->empty() || !reductions->needsStep(curStep)) {
+            return;
+        }
+
+        reductions->evaluate(*oldGrid, partitionManager->ownRegion(), curStep);
+        reductions->complete(curStep);
+    }
+
+    /**
+     * Of all cells updated by the kernel or the ghost zone update,
+     * only innerSet(ghostZoneWidth()) or rim(ghostZoneWidth())
+     * respectively will be retained. The fringes are the remainders
+     * which may be updated without accumulating them for the
+     * Reductions.
+     */
+    inline const Region<DIM>& remappedInnerSetFringe(unsigned offset) const
+    {
+        return remappedInnerSetFringes[offset];
+    }
+
+    inline const Region<DIM>& remappedRimFringe(unsigned offset) const
+    {
+        return remappedRimFringes[offset];
+    }
+
     inline CoordBox<DIM> initGridsCommon()
     {
         Coord<DIM> topoDim = initializer->gridDimensions();
@@ -304,6 +355,15 @@ protected:
             remappedInnerSets.push_back(grid.remapRegion(partitionManager->innerSet(i)));
             remappedRims.push_back(grid.remapRegion(partitionManager->rim(i)));
         }
+
+        if (!reductions || reductions->empty()) {
+            return;
+        }
+
+        for (unsigned i = 0; i <= ghostZoneWidth(); ++i) {
+            remappedInnerSetFringes.push_back(remappedInnerSets[i] - remappedInnerSets[ghostZoneWidth()]);
+            remappedRimFringes.push_back(remappedRims[i] - remappedRims[ghostZoneWidth()]);
+        }
     }
 };
 
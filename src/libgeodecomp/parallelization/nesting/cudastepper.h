@@ -8,6 +8,8 @@
 #include <libgeodecomp/storage/cudagrid.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 
+#include <stdexcept>
+
 namespace LibGeoDecomp {
 
 namespace CUDAStepperHelpers {
@@ -314,7 +316,8 @@ public:
         const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
         const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
         const PatchProviderVec& innerSetPatchProviders = PatchProviderVec(),
-        bool enableFineGrainedParallelism = false) :
+        bool enableFineGrainedParallelism = false,
+        typename CommonStepper<CELL_TYPE>::GlobalReductionsType *reductions = 0) :
         CommonStepper<CELL_TYPE>(
             partitionManager,
             initializer,
@@ -325,6 +328,10 @@ public:
             innerSetPatchProviders,
             enableFineGrainedParallelism)
     {
+        if (reductions && !reductions->empty()) {
+            throw std::logic_error("CUDAStepper doesn't support Reductions");
+        }
+
         initGrids();
     }
 
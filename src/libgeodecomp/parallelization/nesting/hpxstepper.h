@@ -56,7 +56,8 @@ public:
         const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
         const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
         const PatchProviderVec& innerSetPatchProviders = PatchProviderVec(),
-        bool enableFineGrainedParallelism = false) :
+        bool enableFineGrainedParallelism = false,
+        typename ParentType::GlobalReductionsType *reductions = 0) :
         ParentType(
             partitionManager,
             initializer,
@@ -65,7 +66,8 @@ public:
             ghostZonePatchProvidersPhase0,
             ghostZonePatchProvidersPhase1,
             innerSetPatchProviders,
-            enableFineGrainedParallelism)
+            enableFineGrainedParallelism,
+            reductions)
     {}
 
     inline hpx::future<void> notifyPatchAcceptersAsync(
@@ -0,0 +1,101 @@
+#ifndef LIBGEODECOMP_PARALLELIZATION_NESTING_MIGRATIONINITIALIZER_H
+#define LIBGEODECOMP_PARALLELIZATION_NESTING_MIGRATIONINITIALIZER_H
+
+#include <libgeodecomp/io/initializer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * The MigrationInitializer is used when a running simulation gets
+ * repartitioned: instead of setting up the grid from scratch, it
+ * fills in cells which have been migrated from other processes (or
+ * which were retained locally). All other queries (dimensions,
+ * adjacency, end of simulation) are forwarded to the original
+ * Initializer, only startStep() is overridden so that the new
+ * UpdateGroup resumes at the time step at which the migration took
+ * place.
+ */
+template<typename CELL>
+class MigrationInitializer : public Initializer<CELL>
+{
+public:
+    typedef typename Initializer<CELL>::Topology Topology;
+    typedef typename Initializer<CELL>::AdjacencyPtr AdjacencyPtr;
+    typedef typename SharedPtr<Initializer<CELL> >::Type InitPtr;
+    typedef typename SerializationBuffer<CELL>::BufferType BufferType;
+    static const int DIM = Topology::DIM;
+
+    MigrationInitializer(
+        InitPtr delegate,
+        unsigned resumeStep,
+        const CELL& edgeCell) :
+        delegate(delegate),
+        resumeStep(resumeStep),
+        edgeCell(edgeCell)
+    {}
+
+    /**
+     * Registers a patch which will be copied to the grid upon
+     * initialization. The buffer is expected to have been filled via
+     * GridBase::saveRegion() with the same Region.
+     */
+    void addPatch(const Region<DIM>& region, const BufferType& buffer)
+    {
+        regions << region;
+        buffers << buffer;
+    }
+
+    virtual void grid(GridBase<CELL, DIM> *target)
+    {
+        target->setEdge(edgeCell);
+
+        for (std::size_t i = 0; i < regions.size(); ++i) {
+            target->loadRegion(buffers[i], regions[i]);
+        }
+    }
+
+    virtual CoordBox<DIM> gridBox()
+    {
+        return delegate->gridBox();
+    }
+
+    virtual Coord<DIM> gridDimensions() const
+    {
+        return delegate->gridDimensions();
+    }
+
+    virtual unsigned startStep() const
+    {
+        return resumeStep;
+    }
+
+    virtual unsigned maxSteps() const
+    {
+        return delegate->maxSteps();
+    }
+
+    virtual AdjacencyPtr getAdjacency(const Region<DIM>& region) const
+    {
+        return delegate->getAdjacency(region);
+    }
+
+    virtual AdjacencyPtr getReverseAdjacency(const Region<DIM>& region) const
+    {
+        const AdjacencyManufacturer<DIM>& manufacturer = *delegate;
+        return manufacturer.getReverseAdjacency(region);
+    }
+
+private:
+    InitPtr delegate;
+    unsigned resumeStep;
+    CELL edgeCell;
+    std::vector<Region<DIM> > regions;
+    std::vector<BufferType> buffers;
+};
+
+}
+
+#endif
@@ -24,6 +24,7 @@ public:
     friend class UpdateGroupPrototypeTest;
     friend class UpdateGroupTest;
 
+    typedef typename UpdateGroup<CELL_TYPE, PatchLink>::GridType GridType;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchAccepterVec PatchAccepterVec;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchProviderVec PatchProviderVec;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchLinkAccepter PatchLinkAccepter;
@@ -32,6 +33,7 @@ public:
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PartitionPtr PartitionPtr;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchLinkAccepterPtr PatchLinkAccepterPtr;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchLinkProviderPtr PatchLinkProviderPtr;
+    typedef typename UpdateGroup<CELL_TYPE, PatchLink>::GlobalReductionsType GlobalReductionsType;
 
     using UpdateGroup<CELL_TYPE, PatchLink>::init;
     using UpdateGroup<CELL_TYPE, PatchLink>::rank;
@@ -50,7 +52,8 @@ public:
         PatchProviderVec patchProvidersGhost = PatchProviderVec(),
         PatchProviderVec patchProvidersInner = PatchProviderVec(),
         bool enableFineGrainedParallelism = false,
-        MPI_Comm communicator = MPI_COMM_WORLD) :
+        MPI_Comm communicator = MPI_COMM_WORLD,
+        GlobalReductionsType *reductions = 0) :
         UpdateGroup<CELL_TYPE, PatchLink>(ghostZoneWidth, initializer, MPILayer(communicator).rank()),
         mpiLayer(communicator)
     {
@@ -64,7 +67,8 @@ public:
             patchAcceptersInner,
             patchProvidersGhost,
             patchProvidersInner,
-            enableFineGrainedParallelism);
+            enableFineGrainedParallelism,
+            reductions);
     }
 
 private:
@@ -80,6 +84,15 @@ private:
         return boundingBoxes;
     }
 
+    /**
+     * Wider ghost zones get updated locally, which requires the
+     * cells' complete state.
+     */
+    bool haloMembersOnly() const
+    {
+        return this->ghostZoneWidth == 1;
+    }
+
     virtual PatchLinkAccepterPtr makePatchLinkAccepter(int target, const Region<DIM>& region)
     {
         return PatchLinkAccepterPtr(
@@ -88,7 +101,9 @@ private:
                 target,
                 MPILayer::PATCH_LINK,
                 SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
-                mpiLayer.communicator()));
+                mpiLayer.communicator(),
+                PatchLink<GridType>::DEFAULT_MAX_CHUNK_SIZE,
+                haloMembersOnly()));
 
     }
 
@@ -100,7 +115,9 @@ private:
                 source,
                 MPILayer::PATCH_LINK,
                 SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
-                mpiLayer.communicator()));
+                mpiLayer.communicator(),
+                PatchLink<GridType>::DEFAULT_MAX_CHUNK_SIZE,
+                haloMembersOnly()));
     }
 };
 
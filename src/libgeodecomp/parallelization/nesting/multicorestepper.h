@@ -4,50 +4,578 @@
 #include <libgeodecomp/config.h>
 #ifdef LIBGEODECOMP_WITH_THREADS
 
+#include <omp.h>
 #include <libgeodecomp/parallelization/nesting/commonstepper.h>
 #include <libgeodecomp/storage/patchbufferfixed.h>
+#include <libgeodecomp/storage/updatefunctor.h>
+
+#include <stdexcept>
 
 namespace LibGeoDecomp {
 
+namespace MultiCoreStepperHelpers {
+
+/**
+ * The number of nano steps completed on each slab is published via
+ * one of these counters. They're padded to a cache line to avoid
+ * false sharing among the spinning threads.
+ */
+class ProgressCounter
+{
+public:
+    inline ProgressCounter() :
+        value(0)
+    {}
+
+    std::size_t value;
+
+private:
+    char padding[64 - sizeof(std::size_t)];
+};
+
+}
+
 /**
  * MultiCoreStepper is an OpenMP-enabled implementation of the Stepper
- * concept.
+ * concept. It splits the node's subdomain into slabs along the
+ * outermost axis, one per thread. Each thread updates the inner set
+ * and rim fragments within its own slab. A single thread team lives
+ * throughout a call to update(): while updating the kernel a thread
+ * will only wait for its two adjacent slabs to finish the previous
+ * nano step (point-to-point synchronization via progress counters),
+ * so there is no team-wide barrier per nano step. Barriers are only
+ * required around the ghost zone update, during which the master
+ * thread handles all communication. That part of the rim which
+ * doesn't depend on the outer ghost zone is updated by the remaining
+ * threads while the master thread waits for incoming ghost zones.
+ *
+ * As with the other Steppers all PatchAccepters and PatchProviders
+ * are notified from the master thread only. GHOST_PHASE_0 providers
+ * are expected to write only to the outer ghost zone (as PatchLink
+ * providers do), otherwise they'd race with the overlapped rim update.
  *
  * fixme: how to handle threading if user code has a multithreaded
  *        update() itself? (e.g. n-body codes)
  *
  * fixme: cache blocking?
- *
- * fixme: mpi pacing?
  */
 template<typename CELL_TYPE>
 class MultiCoreStepper : public CommonStepper<CELL_TYPE>
 {
 public:
+    friend class MultiCoreStepperTest;
+    friend class MultiCoreStepperMPITest;
+
     typedef typename Stepper<CELL_TYPE>::Topology Topology;
-    typedef typename Stepper<CELL_TYPE>::InitPtr InitPtr;
-    typedef typename Stepper<CELL_TYPE>::PartitionManagerPtr PartitionManagerPtr;
-    typedef class Stepper<CELL_TYPE> ParentType;
+    const static int DIM = Topology::DIM;
+    const static unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL_TYPE>::VALUE;
+
+    typedef class CommonStepper<CELL_TYPE> ParentType;
     typedef typename ParentType::GridType GridType;
     typedef PartitionManager<Topology> PartitionManagerType;
     typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
     typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
+    typedef typename ParentType::PatchProviderVec PatchProviderVec;
+    typedef typename ParentType::InitPtr InitPtr;
+    typedef typename ParentType::PartitionManagerPtr PartitionManagerPtr;
+    typedef UpdateFunctorHelpers::ConcurrencyNoP ConcurrencySpec;
+    typedef std::vector<std::vector<Region<DIM> > > RegionMatrix;
 
-    const static int DIM = Topology::DIM;
-    const static unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL_TYPE>::VALUE;
+    using ParentType::initializer;
+    using ParentType::patchAccepters;
+    using ParentType::patchProviders;
+    using ParentType::partitionManager;
+    using ParentType::chronometer;
+
+    using ParentType::innerSet;
+    using ParentType::saveKernel;
+    using ParentType::restoreRim;
+    using ParentType::globalNanoStep;
+    using ParentType::rim;
+    using ParentType::resetValidGhostZoneWidth;
+    using ParentType::initGridsCommon;
+    using ParentType::saveRim;
+    using ParentType::restoreKernel;
 
+    using ParentType::curStep;
+    using ParentType::curNanoStep;
+    using ParentType::validGhostZoneWidth;
+    using ParentType::ghostZoneWidth;
+    using ParentType::oldGrid;
+    using ParentType::newGrid;
+
+    /**
+     * numThreads = 0 means that the team will be sized according to
+     * omp_get_max_threads(). The subdomain is always cut into
+     * numThreads slabs. Should the OpenMP runtime provide a smaller
+     * team (e.g. because update() is being called from within another
+     * parallel region), the slabs are dealt out round-robin to the
+     * threads available.
+     */
     inline MultiCoreStepper(
         PartitionManagerPtr partitionManager,
         InitPtr initializer,
         const PatchAccepterVec& ghostZonePatchAccepters = PatchAccepterVec(),
-        const PatchAccepterVec& innerSetPatchAccepters = PatchAccepterVec()) :
-        CommonStepper<CELL_TYPE>(
+        const PatchAccepterVec& innerSetPatchAccepters = PatchAccepterVec(),
+        const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
+        const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
+        const PatchProviderVec& innerSetPatchProviders = PatchProviderVec(),
+        bool enableFineGrainedParallelism = false,
+        typename ParentType::GlobalReductionsType *reductions = 0,
+        int numThreads = 0) :
+        ParentType(
             partitionManager,
             initializer,
             ghostZonePatchAccepters,
-            innerSetPatchAccepters)
-    {}
+            innerSetPatchAccepters,
+            ghostZonePatchProvidersPhase0,
+            ghostZonePatchProvidersPhase1,
+            innerSetPatchProviders,
+            enableFineGrainedParallelism),
+        numThreads(numThreads ? numThreads : omp_get_max_threads())
+    {
+        if (reductions && !reductions->empty()) {
+            throw std::logic_error("MultiCoreStepper doesn't support Reductions");
+        }
+
+        initGrids();
+    }
+
+    inline virtual void update(std::size_t nanoSteps)
+    {
+        TimeTotal t(&chronometer);
+        std::size_t remainingNanoSteps = nanoSteps;
+        std::size_t chunk = 0;
+
+#pragma omp parallel num_threads(numThreads)
+        {
+            int thread = omp_get_thread_num();
+            int teamSize = omp_get_num_threads();
+
+            while (remainingNanoSteps > 0) {
+#pragma omp master
+                {
+                    chunk = nextChunk(remainingNanoSteps);
+                    resetProgress();
+                    EventTrace::setNanoStep(globalNanoStep());
+                }
+#pragma omp barrier
+
+                if (thread == 0) {
+                    TimeComputeInner t(&chronometer);
+                    updateKernel(thread, teamSize, chunk);
+                } else {
+                    updateKernel(thread, teamSize, chunk);
+                }
+
+#pragma omp barrier
+#pragma omp master
+                {
+                    finishKernel(chunk);
+                    remainingNanoSteps -= chunk;
+                }
+#pragma omp barrier
+
+                if (validGhostZoneWidth == 0) {
+                    updateGhost(thread, teamSize);
+                }
+
+#pragma omp master
+                {
+                    if (validGhostZoneWidth == 0) {
+                        resetValidGhostZoneWidth();
+                    }
+
+                    unsigned index = ghostZoneWidth() - validGhostZoneWidth;
+                    this->notifyPatchProviders(innerSet(index), ParentType::INNER_SET, globalNanoStep());
+                }
+#pragma omp barrier
+            }
+        }
+    }
+
+    inline virtual void update1()
+    {
+        update(1);
+    }
+
+    inline int getNumThreads() const
+    {
+        return numThreads;
+    }
+
+private:
+    int numThreads;
+    RegionMatrix threadInnerSets;
+    RegionMatrix threadRimsInterior;
+    RegionMatrix threadRimsBoundary;
+    std::vector<MultiCoreStepperHelpers::ProgressCounter> progress;
+    bool overlapGhostZoneUpdate;
+
+    inline void initGrids()
+    {
+        initGridsCommon();
+        initThreadRegions();
+
+        this->notifyPatchAccepters(
+            rim(),
+            ParentType::GHOST_PHASE_0,
+            globalNanoStep());
+        this->notifyPatchAccepters(
+            innerSet(ghostZoneWidth()),
+            ParentType::INNER_SET,
+            globalNanoStep());
+
+        saveRim(globalNanoStep());
+
+#pragma omp parallel num_threads(numThreads)
+        {
+            updateGhost(omp_get_thread_num(), omp_get_num_threads());
+        }
+    }
+
+    /**
+     * Determines how many nano steps the team may run without
+     * intervention from the master thread: we need to stop at the
+     * next ghost zone update and whenever an inner set PatchAccepter
+     * or PatchProvider is due.
+     */
+    inline std::size_t nextChunk(std::size_t remainingNanoSteps)
+    {
+        std::size_t chunk = (std::min)(remainingNanoSteps, std::size_t(validGhostZoneWidth));
+        std::size_t now = globalNanoStep();
+
+        for (typename ParentType::PatchAccepterList::iterator i =
+                 patchAccepters[ParentType::INNER_SET].begin();
+             i != patchAccepters[ParentType::INNER_SET].end();
+             ++i) {
+            std::size_t next = (*i)->nextRequiredNanoStep();
+            if (next > now) {
+                chunk = (std::min)(chunk, next - now);
+            }
+        }
+
+        for (typename ParentType::PatchProviderList::iterator i =
+                 patchProviders[ParentType::INNER_SET].begin();
+             i != patchProviders[ParentType::INNER_SET].end();
+             ++i) {
+            std::size_t next = (*i)->nextAvailableNanoStep();
+            if (next > now) {
+                chunk = (std::min)(chunk, next - now);
+            }
+        }
+
+        return chunk;
+    }
+
+    /**
+     * Updates this thread's slabs of the kernel by chunk nano
+     * steps. Before it may start with a nano step, a slab needs to
+     * wait for its neighbors to complete the previous one: it'll
+     * read their results and overwrite the grid they've been reading
+     * from. A thread completes a nano step on all of its slabs
+     * before moving on to the next one, so a team smaller than
+     * numThreads can't deadlock.
+     */
+    inline void updateKernel(int thread, int teamSize, std::size_t chunk)
+    {
+        unsigned firstIndex = ghostZoneWidth() - validGhostZoneWidth + 1;
+
+        for (std::size_t i = 0; i < chunk; ++i) {
+            const GridType& sourceGrid = (i % 2) ? *newGrid : *oldGrid;
+            GridType *targetGrid = (i % 2) ? &*oldGrid : &*newGrid;
+
+            for (int slab = thread; slab < numThreads; slab += teamSize) {
+                waitForNeighbors(slab, i);
+
+                UpdateFunctor<CELL_TYPE, ConcurrencySpec>()(
+                    threadInnerSets[slab][firstIndex + i],
+                    Coord<DIM>(),
+                    Coord<DIM>(),
+                    sourceGrid,
+                    targetGrid,
+                    (curNanoStep + i) % NANO_STEPS,
+                    ConcurrencySpec());
+
+                signalProgress(slab, i + 1);
+            }
+        }
+    }
+
+    inline void finishKernel(std::size_t chunk)
+    {
+        using std::swap;
+
+        if (chunk % 2) {
+            swap(oldGrid, newGrid);
+        }
+
+        validGhostZoneWidth -= chunk;
+        curNanoStep += chunk;
+        curStep += curNanoStep / NANO_STEPS;
+        curNanoStep %= NANO_STEPS;
+
+        this->notifyPatchAccepters(innerSet(ghostZoneWidth()), ParentType::INNER_SET, globalNanoStep());
+    }
+
+    /**
+     * Same as VanillaStepper::updateGhost(), but needs to be called
+     * by all threads of the team. The master thread runs all
+     * communication while the other threads may already update the
+     * interior of the rim.
+     */
+    inline void updateGhost(int thread, int teamSize)
+    {
+        using std::swap;
+
+        std::size_t oldNanoStep = curNanoStep;
+        std::size_t oldStep = curStep;
+
+#pragma omp master
+        {
+            TimeComputeGhost t(&chronometer);
+            saveKernel();
+            restoreRim(false);
+        }
+#pragma omp barrier
+
+        for (std::size_t t = 0; t < ghostZoneWidth(); ++t) {
+#pragma omp master
+            {
+                overlapGhostZoneUpdate = !providersDue(ParentType::GHOST_PHASE_1, globalNanoStep());
+            }
+#pragma omp barrier
+
+            if (thread == 0) {
+                this->notifyPatchProviders(rim(t), ParentType::GHOST_PHASE_0, globalNanoStep());
+                this->notifyPatchProviders(rim(t), ParentType::GHOST_PHASE_1, globalNanoStep());
+            } else if (overlapGhostZoneUpdate) {
+                updateRims(threadRimsInterior, thread, teamSize, t + 1);
+            }
+#pragma omp barrier
+
+            if (thread == 0) {
+                TimeComputeGhost timer(&chronometer);
+                updateRims(threadRimsInterior, thread, teamSize, t + 1);
+                updateRims(threadRimsBoundary, thread, teamSize, t + 1);
+            } else {
+                if (!overlapGhostZoneUpdate) {
+                    updateRims(threadRimsInterior, thread, teamSize, t + 1);
+                }
+                updateRims(threadRimsBoundary, thread, teamSize, t + 1);
+            }
+#pragma omp barrier
+
+#pragma omp master
+            {
+                ++curNanoStep;
+                if (curNanoStep == NANO_STEPS) {
+                    curNanoStep = 0;
+                    curStep++;
+                }
+
+                swap(oldGrid, newGrid);
+
+                this->notifyPatchAccepters(rim(ghostZoneWidth()), ParentType::GHOST_PHASE_0, globalNanoStep());
+            }
+#pragma omp barrier
+        }
+
+#pragma omp master
+        {
+            TimeComputeGhost t(&chronometer);
+
+            saveRim(globalNanoStep());
+            if (ghostZoneWidth() % 2) {
+                swap(oldGrid, newGrid);
+            }
+
+            // restore grid for kernel update
+            curNanoStep = oldNanoStep;
+            curStep = oldStep;
+            restoreRim(true);
+            restoreKernel();
+        }
+#pragma omp barrier
+    }
+
+    /**
+     * Updates the given rim fragments of all slabs assigned to this
+     * thread.
+     */
+    inline void updateRims(const RegionMatrix& rims, int thread, int teamSize, std::size_t index)
+    {
+        for (int slab = thread; slab < numThreads; slab += teamSize) {
+            updateRim(rims[slab][index]);
+        }
+    }
+
+    inline void updateRim(const Region<DIM>& region)
+    {
+        UpdateFunctor<CELL_TYPE, ConcurrencySpec>()(
+            region,
+            Coord<DIM>(),
+            Coord<DIM>(),
+            *oldGrid,
+            &*newGrid,
+            curNanoStep,
+            ConcurrencySpec());
+    }
+
+    inline bool providersDue(const typename ParentType::PatchType& patchType, std::size_t nanoStep)
+    {
+        for (typename ParentType::PatchProviderList::iterator i =
+                 patchProviders[patchType].begin();
+             i != patchProviders[patchType].end();
+             ++i) {
+            if ((*i)->nextAvailableNanoStep() == nanoStep) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    inline void resetProgress()
+    {
+        for (std::size_t i = 0; i < progress.size(); ++i) {
+            progress[i].value = 0;
+        }
+    }
+
+    inline void waitForNeighbors(int slab, std::size_t nanoStepsCompleted)
+    {
+        if (numThreads == 1) {
+            return;
+        }
+
+        int neighbors[] = {
+            (slab + numThreads - 1) % numThreads,
+            (slab + 1) % numThreads
+        };
+
+        for (int i = 0; i < 2; ++i) {
+            for (;;) {
+                std::size_t neighborProgress;
+#pragma omp atomic read
+                neighborProgress = progress[neighbors[i]].value;
+
+                if (neighborProgress >= nanoStepsCompleted) {
+                    break;
+                }
+            }
+        }
+
+#pragma omp flush
+    }
+
+    inline void signalProgress(int slab, std::size_t nanoStepsCompleted)
+    {
+#pragma omp flush
+#pragma omp atomic write
+        progress[slab].value = nanoStepsCompleted;
+    }
+
+    /**
+     * Cuts the node's subdomain into slabs along the outermost axis,
+     * each of which holds roughly the same number of cells. Every
+     * slab is at least one cell thick, so a stencil update (which
+     * extends to at most one cell in each direction) will touch only
+     * the adjacent slabs. Slabs are arranged cyclically to account
+     * for periodic boundary conditions.
+     */
+    inline void initThreadRegions()
+    {
+        CoordBox<DIM> box = partitionManager->ownExpandedRegion().boundingBox();
+        int axisOrigin = box.origin[DIM - 1];
+        int axisLength = box.dimensions[DIM - 1];
+        numThreads = (std::max)(1, (std::min)(numThreads, maxThreads(axisLength, Topology())));
+
+        std::vector<std::size_t> histogram(axisLength, 0);
+        const Region<DIM>& ownRegion = partitionManager->ownRegion();
+        for (typename Region<DIM>::StreakIterator i = ownRegion.beginStreak();
+             i != ownRegion.endStreak();
+             ++i) {
+            if (DIM == 1) {
+                for (int x = i->origin.x(); x < i->endX; ++x) {
+                    ++histogram[x - axisOrigin];
+                }
+            } else {
+                histogram[i->origin[DIM - 1] - axisOrigin] += i->length();
+            }
+        }
+
+        std::vector<Region<DIM> > slabs;
+        std::size_t total = ownRegion.size();
+        std::size_t accumulated = 0;
+        int sliceStart = 0;
+        for (int i = 0; i < axisLength; ++i) {
+            accumulated += histogram[i];
+            int remainingSlices = axisLength - i - 1;
+            int remainingSlabs = numThreads - int(slabs.size()) - 1;
+
+            if ((remainingSlabs == 0) && (remainingSlices > 0)) {
+                continue;
+            }
+
+            if ((remainingSlices == remainingSlabs) ||
+                (accumulated * numThreads >= total * (slabs.size() + 1))) {
+                CoordBox<DIM> slabBox = box;
+                slabBox.origin[DIM - 1] = axisOrigin + sliceStart;
+                slabBox.dimensions[DIM - 1] = i + 1 - sliceStart;
+
+                Region<DIM> slab;
+                slab << slabBox;
+                slabs << slab;
+                sliceStart = i + 1;
+            }
+        }
+
+        threadInnerSets.clear();
+        threadRimsInterior.clear();
+        threadRimsBoundary.clear();
+        threadInnerSets.resize(numThreads);
+        threadRimsInterior.resize(numThreads);
+        threadRimsBoundary.resize(numThreads);
+        progress.resize(numThreads);
+
+        // cells in this region are directly affected by the ghost
+        // zone we receive from our neighbors:
+        const Region<DIM>& outerRim = partitionManager->getOuterRim();
+        Region<DIM> haloDependent = outerRim.expandWithTopology(
+            1,
+            partitionManager->getSimulationArea(),
+            Topology(),
+            *initializer->getAdjacency(outerRim));
+
+        for (int thread = 0; thread < numThreads; ++thread) {
+            for (unsigned i = 0; i <= ghostZoneWidth(); ++i) {
+                Region<DIM> innerSetFragment = innerSet(i) & slabs[thread];
+                Region<DIM> rimFragment = rim(i) & slabs[thread];
+                Region<DIM> boundaryFragment = rimFragment & haloDependent;
+
+                threadInnerSets[thread] << oldGrid->remapRegion(innerSetFragment);
+                threadRimsInterior[thread] << oldGrid->remapRegion(rimFragment - boundaryFragment);
+                threadRimsBoundary[thread] << oldGrid->remapRegion(boundaryFragment);
+            }
+        }
+    }
+
+    /**
+     * The slab decomposition relies on a regular grid, so we can't
+     * split unstructured grids this way.
+     */
+    inline int maxThreads(int /* unused: axisLength */, const Topologies::Unstructured::Topology& /* unused: topology */) const
+    {
+        return 1;
+    }
+
+    template<typename TOPOLOGY>
+    inline int maxThreads(int axisLength, const TOPOLOGY& /* unused: topology */) const
+    {
+        return axisLength;
+    }
 };
 
 }
@@ -48,6 +48,26 @@ public:
         writer->setRegion(region);
     }
 
+    /**
+     * Drops all pending requests and resumes with the first output
+     * step which lies strictly after nanoStep. Required if the
+     * adapter is handed over to a new Stepper (e.g. after the domain
+     * has been repartitioned) which will revisit time steps that
+     * the previous Stepper might already have reported on.
+     */
+    void reschedule(const std::size_t nanoStep)
+    {
+        requestedNanoSteps.clear();
+        if (nanoStep >= lastNanoStep) {
+            return;
+        }
+
+        std::size_t nextNanoStep = nanoStep + stride;
+        nextNanoStep -= (nextNanoStep % stride);
+        pushRequest((std::min)(nextNanoStep, lastNanoStep));
+        pushRequest(lastNanoStep);
+    }
+
     virtual void put(
         const GRID_TYPE& grid,
         const Region<GRID_TYPE::DIM>& validRegion,
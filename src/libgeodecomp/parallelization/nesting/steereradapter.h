@@ -50,6 +50,25 @@ public:
         steerer->setRegion(region);
     }
 
+    /**
+     * Discards all pending events and resumes with the first
+     * steering step which lies strictly after nanoStep. See
+     * ParallelWriterAdapter::reschedule() for the rationale.
+     */
+    void reschedule(const std::size_t nanoStep)
+    {
+        storedNanoSteps.clear();
+        if (nanoStep >= lastNanoStep) {
+            return;
+        }
+
+        std::size_t stride = NANO_STEPS * steerer->getPeriod();
+        std::size_t nextNanoStep = nanoStep + stride;
+        nextNanoStep -= (nextNanoStep % stride);
+        storedNanoSteps << (std::min)(nextNanoStep, lastNanoStep);
+        storedNanoSteps << lastNanoStep;
+    }
+
     virtual void get(
         GRID_TYPE *destinationGrid,
         const Region<DIM>& patchableRegion,
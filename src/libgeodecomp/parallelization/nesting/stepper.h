@@ -7,6 +7,7 @@
 #include <libgeodecomp/io/initializer.h>
 #include <libgeodecomp/misc/chronometer.h>
 #include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
 #include <libgeodecomp/parallelization/nesting/offsethelper.h>
 #include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/storage/patchaccepter.h>
@@ -41,6 +42,7 @@ public:
     typedef std::deque<PatchAccepterPtr> PatchAccepterList;
     typedef std::vector<PatchAccepterPtr> PatchAccepterVec;
     typedef std::vector<PatchProviderPtr> PatchProviderVec;
+    typedef GlobalReductions<CELL_TYPE, DIM> GlobalReductionsType;
 
     inline Stepper(
         PartitionManagerPtr partitionManager,
@@ -10,17 +10,19 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
-class MulticoreStepperTest : public CxxTest::TestSuite
+class MultiCoreStepperTest : public CxxTest::TestSuite
 {
 public:
     typedef APITraits::SelectTopology<TestCell<2> >::Value Topology;
     typedef DisplacedGrid<TestCell<2>, Topology, true> GridType;
 #ifdef LIBGEODECOMP_WITH_THREADS
     typedef MultiCoreStepper<TestCell<2> > StepperType;
+    typedef MultiCoreStepper<TestCell<3> > StepperType3D;
 #endif
 
     void setUp()
     {
+#ifdef LIBGEODECOMP_WITH_THREADS
         init.reset(new TestInitializer<TestCell<2> >(Coord<2>(17, 12)));
         CoordBox<2> rect = init->gridBox();
 
@@ -30,16 +32,160 @@ public:
         patchAccepter->pushRequest(13);
 
         partitionManager.reset(new PartitionManager<Topology>(rect));
-        // stepper.reset(
-        //     new StepperType(partitionManager, init));
+        stepper.reset(
+            new StepperType(
+                partitionManager,
+                init,
+                StepperType::PatchAccepterVec(),
+                StepperType::PatchAccepterVec(),
+                StepperType::PatchProviderVec(),
+                StepperType::PatchProviderVec(),
+                StepperType::PatchProviderVec(),
+                false,
+                0,
+                4));
 
-        // stepper->addPatchAccepter(patchAccepter, StepperType::GHOST);
+        stepper->addPatchAccepter(patchAccepter, StepperType::GHOST_PHASE_0);
+#endif
     }
 
-    void testFoo()
+    void testThreadRegions()
     {
 #ifdef LIBGEODECOMP_WITH_THREADS
-        std::cout << "fixme\n";
+        TS_ASSERT_EQUALS(4, stepper->getNumThreads());
+
+        Region<2> innerSet;
+        Region<2> rim;
+        for (int i = 0; i < stepper->getNumThreads(); ++i) {
+            TS_ASSERT(!stepper->threadInnerSets[i][1].empty());
+            TS_ASSERT((innerSet & stepper->threadInnerSets[i][1]).empty());
+            innerSet += stepper->threadInnerSets[i][1];
+
+            Region<2> threadRim =
+                stepper->threadRimsInterior[i][1] +
+                stepper->threadRimsBoundary[i][1];
+            TS_ASSERT((rim & threadRim).empty());
+            rim += threadRim;
+        }
+
+        TS_ASSERT_EQUALS(innerSet, partitionManager->innerSet(1));
+        TS_ASSERT_EQUALS(rim,      partitionManager->rim(1));
+#endif
+    }
+
+    void testUpdate1()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 0);
+        stepper->update1();
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 1);
+#endif
+    }
+
+    void testUpdateMultiple()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        stepper->update(8);
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 8);
+        stepper->update(30);
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 38);
+#endif
+    }
+
+    void testUpdateWithSmallerTeam()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        // with nested parallelism disabled, the stepper's parallel
+        // region gets a team of one thread which has to handle all
+        // four slabs:
+        int oldMaxActiveLevels = omp_get_max_active_levels();
+        omp_set_max_active_levels(1);
+
+#pragma omp parallel num_threads(2)
+        {
+#pragma omp master
+            {
+                stepper->update(8);
+            }
+        }
+
+        omp_set_max_active_levels(oldMaxActiveLevels);
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 8);
+
+        stepper->update(3);
+        TS_ASSERT_TEST_GRID(GridType, stepper->grid(), 11);
+#endif
+    }
+
+    void testPutPatch()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        stepper->update(9);
+        TS_ASSERT_EQUALS(std::size_t(2), patchAccepter->getOfferedNanoSteps().size());
+
+        stepper->update(4);
+        TS_ASSERT_EQUALS(std::size_t(3), patchAccepter->getOfferedNanoSteps().size());
+#endif
+    }
+
+    void testWideGhostZonesOnTorus()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef APITraits::SelectTopology<TestCell<3> >::Value Topology3D;
+        typedef StepperType3D::GridType GridType3D;
+        unsigned ghostZoneWidth = 3;
+
+        SharedPtr<TestInitializer<TestCell<3> > >::Type init3D(
+            new TestInitializer<TestCell<3> >(Coord<3>(13, 12, 11)));
+        CoordBox<3> box = init3D->gridBox();
+
+        std::vector<std::size_t> weights(1, box.dimensions.prod());
+        SharedPtr<Partition<3> >::Type partition(
+            new StripingPartition<3>(Coord<3>(), box.dimensions, 0, weights));
+        SharedPtr<PartitionManager<Topology3D> >::Type partitionManager3D(
+            new PartitionManager<Topology3D>());
+        partitionManager3D->resetRegions(
+            init3D,
+            box,
+            partition,
+            0,
+            ghostZoneWidth);
+        partitionManager3D->resetGhostZones(
+            std::vector<CoordBox<3> >(1),
+            std::vector<CoordBox<3> >(1));
+
+        SharedPtr<MockPatchAccepter<GridType3D> >::Type innerSetAccepter(
+            new MockPatchAccepter<GridType3D>());
+        innerSetAccepter->pushRequest(5);
+        innerSetAccepter->pushRequest(7);
+
+        StepperType3D stepper3D(
+            partitionManager3D,
+            init3D,
+            StepperType3D::PatchAccepterVec(),
+            StepperType3D::PatchAccepterVec(1, innerSetAccepter),
+            StepperType3D::PatchProviderVec(),
+            StepperType3D::PatchProviderVec(),
+            StepperType3D::PatchProviderVec(),
+            false,
+            0,
+            3);
+        TS_ASSERT_EQUALS(3, stepper3D.getNumThreads());
+
+        stepper3D.update(3);
+        TS_ASSERT_TEST_GRID(GridType3D, stepper3D.grid(), 3);
+        TS_ASSERT_EQUALS(std::size_t(0), innerSetAccepter->getOfferedNanoSteps().size());
+
+        stepper3D.update(5);
+        TS_ASSERT_TEST_GRID_REGION(
+            GridType3D,
+            stepper3D.grid(),
+            partitionManager3D->innerSet(2),
+            8);
+        TS_ASSERT_EQUALS(std::size_t(2), innerSetAccepter->getOfferedNanoSteps().size());
+
+        stepper3D.update(1);
+        TS_ASSERT_TEST_GRID(GridType3D, stepper3D.grid(), 9);
 #endif
     }
 
@@ -53,6 +53,7 @@ public:
     typedef typename StepperType::PatchType PatchType;
     typedef typename StepperType::PatchProviderPtr PatchProviderPtr;
     typedef typename StepperType::PatchAccepterPtr PatchAccepterPtr;
+    typedef typename StepperType::GlobalReductionsType GlobalReductionsType;
 
     UpdateGroup(
         unsigned ghostZoneWidth,
@@ -118,6 +119,16 @@ public:
         return partitionManager->getWeights();
     }
 
+    /**
+     * Exposes the current domain decomposition, e.g. so that a
+     * Simulator can determine which cells need to be migrated when
+     * repartitioning.
+     */
+    inline PartitionManagerType& getPartitionManager() const
+    {
+        return *partitionManager;
+    }
+
     inline double computeTimeInner() const
     {
         return stepper->computeTimeInner;
@@ -164,7 +175,8 @@ protected:
         PatchAccepterVec patchAcceptersInner,
         PatchProviderVec patchProvidersGhost,
         PatchProviderVec patchProvidersInner,
-        bool enableFineGrainedParallelism)
+        bool enableFineGrainedParallelism,
+        GlobalReductionsType *reductions = 0)
     {
         partitionManager->resetRegions(
             initializer,
@@ -251,7 +263,8 @@ protected:
                 patchLinkProviders,
                 patchProvidersGhost,
                 patchProvidersInner,
-                enableFineGrainedParallelism));
+                enableFineGrainedParallelism,
+                reductions));
     }
 
     virtual std::vector<CoordBox<DIM> > gatherBoundingBoxes(
@@ -4,6 +4,8 @@
 #include <libgeodecomp/parallelization/nesting/commonstepper.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 
+#include <stdexcept>
+
 namespace LibGeoDecomp {
 
 /**
@@ -35,6 +37,8 @@ public:
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
     typedef typename ParentType::InitPtr InitPtr;
     typedef typename ParentType::PartitionManagerPtr PartitionManagerPtr;
+    typedef typename ParentType::GlobalReductionsType GlobalReductionsType;
+    typedef ReductionAccumulator<CELL_TYPE, DIM, CONCURRENCY_SPEC> Accumulator;
 
     using ParentType::initializer;
     using ParentType::patchAccepters;
@@ -55,6 +59,10 @@ public:
     using ParentType::saveRim;
     using ParentType::getInnerRim;
     using ParentType::restoreKernel;
+    using ParentType::reducing;
+    using ParentType::evaluateReductions;
+    using ParentType::remappedInnerSetFringe;
+    using ParentType::remappedRimFringe;
 
     using ParentType::curStep;
     using ParentType::curNanoStep;
@@ -66,6 +74,7 @@ public:
     using ParentType::kernelBuffer;
     using ParentType::kernelFraction;
     using ParentType::enableFineGrainedParallelism;
+    using ParentType::reductions;
 
     inline VanillaStepper(
         PartitionManagerPtr partitionManager,
@@ -75,7 +84,8 @@ public:
         const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
         const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
         const PatchProviderVec& innerSetPatchProviders = PatchProviderVec(),
-        bool enableFineGrainedParallelism = false) :
+        bool enableFineGrainedParallelism = false,
+        GlobalReductionsType *reductions = 0) :
         ParentType(
             partitionManager,
             initializer,
@@ -84,8 +94,14 @@ public:
             ghostZonePatchProvidersPhase0,
             ghostZonePatchProvidersPhase1,
             innerSetPatchProviders,
-            enableFineGrainedParallelism)
+            enableFineGrainedParallelism,
+            reductions)
     {
+        if (reductions && !reductions->empty() &&
+            CONCURRENCY_SPEC(false, enableFineGrainedParallelism).enableHPX()) {
+            throw std::logic_error("Reductions can't be accumulated by HPX threads");
+        }
+
         initGrids();
     }
 
@@ -96,17 +112,26 @@ private:
         TimeTotal t(&chronometer);
         unsigned index = ghostZoneWidth() - --validGhostZoneWidth;
         const Region<DIM>& region = remappedInnerSet(index);
+        bool reduce = reducing();
         {
             TimeComputeInner t(&chronometer);
 
-            UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
-                region,
-                Coord<DIM>(),
-                Coord<DIM>(),
-                *oldGrid,
-                &*newGrid,
-                curNanoStep,
-                CONCURRENCY_SPEC(false, enableFineGrainedParallelism));
+            if (reduce) {
+                updateAndReduce(
+                    remappedInnerSet(ghostZoneWidth()),
+                    innerSet(ghostZoneWidth()),
+                    remappedInnerSetFringe(index),
+                    false);
+            } else {
+                UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
+                    region,
+                    Coord<DIM>(),
+                    Coord<DIM>(),
+                    *oldGrid,
+                    &*newGrid,
+                    curNanoStep,
+                    CONCURRENCY_SPEC(false, enableFineGrainedParallelism));
+            }
             swap(oldGrid, newGrid);
 
             ++curNanoStep;
@@ -116,6 +141,13 @@ private:
             }
         }
 
+        // The rim of this step has been accumulated before (it runs
+        // ahead of the kernel), so the step is complete now:
+        if (reduce) {
+            TimeCommunication t(&chronometer);
+            reductions->complete(curStep);
+        }
+
         this->notifyPatchAccepters(innerSet(ghostZoneWidth()), ParentType::INNER_SET, globalNanoStep());
 
         if (validGhostZoneWidth == 0) {
@@ -131,6 +163,7 @@ private:
     inline void initGrids()
     {
         initGridsCommon();
+        evaluateReductions();
 
         this->notifyPatchAccepters(
             rim(),
@@ -185,14 +218,22 @@ private:
                 TimeComputeGhost timer(&chronometer);
 
                 const Region<DIM>& region = remappedRim(t + 1);
-                UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
-                    region,
-                    Coord<DIM>(),
-                    Coord<DIM>(),
-                    *oldGrid,
-                    &*newGrid,
-                    curNanoStep,
-                    CONCURRENCY_SPEC(true, enableFineGrainedParallelism));
+                if (reducing()) {
+                    updateAndReduce(
+                        remappedRim(ghostZoneWidth()),
+                        rim(ghostZoneWidth()),
+                        remappedRimFringe(t + 1),
+                        true);
+                } else {
+                    UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
+                        region,
+                        Coord<DIM>(),
+                        Coord<DIM>(),
+                        *oldGrid,
+                        &*newGrid,
+                        curNanoStep,
+                        CONCURRENCY_SPEC(true, enableFineGrainedParallelism));
+                }
 
                 ++curNanoStep;
                 if (curNanoStep == NANO_STEPS) {
@@ -223,6 +264,41 @@ private:
             restoreKernel();
         }
     }
+
+    /**
+     * updates reducedRegion and fringe (both remapped) by one nano
+     * step, but only reducedRegion gets accumulated for the
+     * Reductions of the upcoming time step. logicalReducedRegion is
+     * the not remapped counterpart of reducedRegion.
+     */
+    inline void updateAndReduce(
+        const Region<DIM>& reducedRegion,
+        const Region<DIM>& logicalReducedRegion,
+        const Region<DIM>& fringe,
+        bool updatingGhost)
+    {
+        CONCURRENCY_SPEC concurrencySpec(updatingGhost, enableFineGrainedParallelism);
+
+        reductions->beginSweep();
+        UpdateFunctor<CELL_TYPE, Accumulator>()(
+            reducedRegion,
+            Coord<DIM>(),
+            Coord<DIM>(),
+            *oldGrid,
+            &*newGrid,
+            curNanoStep,
+            Accumulator(concurrencySpec, reductions, &logicalReducedRegion));
+        reductions->endSweep(curStep + 1);
+
+        UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
+            fringe,
+            Coord<DIM>(),
+            Coord<DIM>(),
+            *oldGrid,
+            &*newGrid,
+            curNanoStep,
+            concurrencySpec);
+    }
 };
 
 }
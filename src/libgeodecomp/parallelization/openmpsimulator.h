@@ -25,7 +25,7 @@ public:
     typedef typename MonolithicSimulator<CELL_TYPE>::Topology Topology;
     typedef typename MonolithicSimulator<CELL_TYPE>::WriterVector WriterVector;
     typedef typename APITraits::SelectSoA<CELL_TYPE>::Value SupportsSoA;
-    typedef typename GridTypeSelector<CELL_TYPE, Topology, false, SupportsSoA>::Value GridType;
+    typedef typename MonolithicGridTypeSelector<CELL_TYPE, Topology, SupportsSoA>::Value GridType;
     typedef typename Steerer<CELL_TYPE>::SteererFeedback SteererFeedback;
 
     static const int DIM = Topology::DIM;
@@ -60,12 +60,8 @@ protected:
         using std::swap;
         TimeCompute t(&chronometer);
 
-        UpdateFunctor<CELL_TYPE, UpdateFunctorHelpers::ConcurrencyEnableOpenMP>()(
-            simArea,
-            Coord<DIM>(),
-            Coord<DIM>(),
-            *curGrid,
-            newGrid,
+        PaddedTorusGridHelpers::RefreshGhostFrame<GridType>()(curGrid);
+        this->updateGrid(
             nanoStep,
             UpdateFunctorHelpers::ConcurrencyEnableOpenMP(true, enableFineGrainedParallelism));
         swap(curGrid, newGrid);
@@ -6,6 +6,7 @@
 
 #include <libgeodecomp/communication/hpxserializationwrapper.h>
 #include <libgeodecomp/io/writer.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
 #include <libgeodecomp/parallelization/monolithicsimulator.h>
 #include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/storage/updatefunctor.h>
@@ -28,7 +29,7 @@ public:
     typedef typename MonolithicSimulator<CELL_TYPE>::Topology Topology;
     typedef typename MonolithicSimulator<CELL_TYPE>::WriterVector WriterVector;
     typedef typename APITraits::SelectSoA<CELL_TYPE>::Value SupportsSoA;
-    typedef typename GridTypeSelector<CELL_TYPE, Topology, false, SupportsSoA>::Value GridType;
+    typedef typename MonolithicGridTypeSelector<CELL_TYPE, Topology, SupportsSoA>::Value GridType;
     typedef typename Steerer<CELL_TYPE>::SteererFeedback SteererFeedback;
 
     static const int DIM = Topology::DIM;
@@ -41,6 +42,7 @@ public:
     using MonolithicSimulator<CELL_TYPE>::writers;
     using MonolithicSimulator<CELL_TYPE>::getStep;
     using MonolithicSimulator<CELL_TYPE>::gridDim;
+    using MonolithicSimulator<CELL_TYPE>::reductions;
 
     /**
      * creates a SerialSimulator with the given initializer.
@@ -84,6 +86,7 @@ public:
         }
 
         ++stepNum;
+        reductions.complete(stepNum);
 
         WriterEvent event = WRITER_STEP_FINISHED;
         if (stepNum == initializer->maxSteps()) {
@@ -100,6 +103,7 @@ public:
         initializer->grid(curGrid);
         stepNum = initializer->startStep();
         setIORegions();
+        evaluateReductions();
 
         SteererFeedback feedback;
         handleInput(STEERER_INITIALIZED, &feedback);
@@ -116,6 +120,11 @@ public:
         handleInput(STEERER_ALL_DONE, &feedback);
     }
 
+    virtual void addReduction(Reduction<CELL_TYPE> *reduction)
+    {
+        reductions.add(reduction);
+    }
+
     /**
      * returns the current grid.
      */
@@ -134,10 +143,53 @@ protected:
         using std::swap;
         TimeCompute t(&chronometer);
 
-        UpdateFunctor<CELL_TYPE>()(simArea, Coord<DIM>(), Coord<DIM>(), *curGrid, newGrid, nanoStep);
+        PaddedTorusGridHelpers::RefreshGhostFrame<GridType>()(curGrid);
+        updateGrid(nanoStep, UpdateFunctorHelpers::ConcurrencyNoP());
         swap(curGrid, newGrid);
     }
 
+    /**
+     * updates all cells from curGrid to newGrid. The last nano step
+     * of each time step also accumulates the updated cells for all
+     * Reductions, so they don't need to be read again afterwards.
+     */
+    template<typename CONCURRENCY_SPEC>
+    void updateGrid(unsigned nanoStep, const CONCURRENCY_SPEC& concurrencySpec)
+    {
+        if (reductions.empty() || ((nanoStep + 1) < NANO_STEPS)) {
+            UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
+                simArea, Coord<DIM>(), Coord<DIM>(), *curGrid, newGrid, nanoStep, concurrencySpec);
+            return;
+        }
+
+        typedef ReductionAccumulator<CELL_TYPE, DIM, CONCURRENCY_SPEC> Accumulator;
+        reductions.beginSweep();
+        UpdateFunctor<CELL_TYPE, Accumulator>()(
+            simArea,
+            Coord<DIM>(),
+            Coord<DIM>(),
+            *curGrid,
+            newGrid,
+            nanoStep,
+            Accumulator(concurrencySpec, &reductions, &newGrid->boundingRegion()));
+        reductions.endSweep(stepNum + 1);
+    }
+
+    /**
+     * reductions are usually accumulated during the update, only the
+     * initial grid needs to be evaluated separately.
+     */
+    void evaluateReductions()
+    {
+        if (reductions.empty()) {
+            return;
+        }
+
+        TimeCompute t(&chronometer);
+        reductions.evaluate(*curGrid, curGrid->boundingRegion(), stepNum);
+        reductions.complete(stepNum);
+    }
+
     /**
      * notifies all registered Writers
      */
@@ -4,9 +4,12 @@
 #include <libgeodecomp/io/initializer.h>
 #include <libgeodecomp/io/steerer.h>
 #include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/reduction.h>
 #include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
 #include <libgeodecomp/storage/displacedgrid.h>
 #include <libgeodecomp/storage/soagrid.h>
+#include <stdexcept>
 #include <vector>
 
 namespace LibGeoDecomp {
@@ -90,6 +93,27 @@ public:
         steerers << SteererPtr(steerer);
     }
 
+    /**
+     * adds a Reduction which will be evaluated on the whole grid
+     * for each time step. Cells are accumulated while the last nano
+     * step of a time step is being computed. The Simulator takes
+     * ownership of the Reduction.
+     *
+     * Monolithic Simulators (SerialSimulator, OpenMPSimulator,
+     * CacheBlockingSimulator) publish results right after each step.
+     * Distributed Simulators (StripingSimulator, HiParSimulator)
+     * overlap the combination across nodes with the next step's
+     * computation, so Steerers will see results with a delay of one
+     * step. Results of the last step are available once run()
+     * returns. All other Simulators will throw, rather than silently
+     * leaving the Reduction untouched.
+     */
+    virtual void addReduction(Reduction<CELL_TYPE> *reduction)
+    {
+        delete reduction;
+        throw std::logic_error("this Simulator doesn't support Reductions");
+    }
+
     /**
      * Returns histograms which detail how much execution time was
      * spent on which part of the algorithm. Will return one element
@@ -102,6 +126,7 @@ protected:
     unsigned stepNum;
     InitPtr initializer;
     SteererVector steerers;
+    GlobalReductions<CELL_TYPE, DIM> reductions;
     Coord<DIM> gridDim;
 };
 
@@ -5,11 +5,16 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 #include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/loadbalancer/costprofilebalancer.h>
 #include <libgeodecomp/loadbalancer/loadbalancer.h>
+#include <libgeodecomp/misc/scopedtimer.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/misc/stringops.h>
 #include <libgeodecomp/parallelization/distributedsimulator.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
 #include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
@@ -20,6 +25,11 @@ namespace LibGeoDecomp {
  * This class aims at providing a very simple, but working parallel
  * simulation facility. It's not very modular, it's not fast, but it's
  * simple and it actually works.
+ *
+ * If the root's LoadBalancer is a CostProfileBalancer, each node
+ * will time the update of every row of its stripe individually and
+ * the stripe boundaries will be derived from that cost profile
+ * (instead of the nodes' overall compute/wall clock time ratios).
  */
 template<typename CELL_TYPE>
 class StripingSimulator : public DistributedSimulator<CELL_TYPE>
@@ -48,11 +58,13 @@ public:
     using DistributedSimulator<CELL_TYPE>::stepNum;
     using DistributedSimulator<CELL_TYPE>::writers;
     using DistributedSimulator<CELL_TYPE>::gridDim;
+    using DistributedSimulator<CELL_TYPE>::reductions;
 
     enum WaitTags {
         GENERAL,
         BALANCELOADS,
-        GHOSTREGION
+        GHOSTREGION,
+        REDUCTIONS
     };
 
     explicit StripingSimulator(
@@ -65,6 +77,7 @@ public:
         loadBalancingPeriod(loadBalancingPeriod)
     {
         validateConstructorParams();
+        initCostProfiling();
 
         initRegions(partitions);
         adaptBuffers();
@@ -72,6 +85,7 @@ public:
         curStripe = new GridType(regionWithOuterGhosts);
         newStripe = new GridType(regionWithOuterGhosts);
         initSimulation();
+        reductions.setMPILayer(&mpilayer, REDUCTIONS);
     }
 
     explicit StripingSimulator(
@@ -84,6 +98,7 @@ public:
         loadBalancingPeriod(loadBalancingPeriod)
     {
         validateConstructorParams();
+        initCostProfiling();
 
         initRegions(partitions);
         adaptBuffers();
@@ -91,10 +106,12 @@ public:
         curStripe = new GridType(regionWithOuterGhosts);
         newStripe = new GridType(regionWithOuterGhosts);
         initSimulation();
+        reductions.setMPILayer(&mpilayer, REDUCTIONS);
     }
 
     virtual ~StripingSimulator()
     {
+        reductions.finish();
         mpilayer.waitAll();
         delete curStripe;
         delete newStripe;
@@ -106,7 +123,6 @@ public:
     virtual void step()
     {
         balanceLoad();
-
         handleInput(STEERER_NEXT_STEP);
 
         for (unsigned i = 0; i < NANO_STEPS; i++) {
@@ -129,11 +145,20 @@ public:
     {
         initSimulation();
         setIORegions();
+        evaluateReductions();
         handleOutput(WRITER_INITIALIZED);
 
         while (stepNum < initializer->maxSteps()) {
             step();
         }
+
+        TimeCommunication t(&chronometer);
+        reductions.finish();
+    }
+
+    virtual void addReduction(Reduction<CELL_TYPE> *reduction)
+    {
+        reductions.add(reduction);
     }
 
     inline unsigned getLoadBalancingPeriod() const
@@ -177,6 +202,15 @@ private:
     WeightVec partitions;
     unsigned loadBalancingPeriod;
 
+    /**
+     * Per-row cost accounting is only active if the (root's)
+     * LoadBalancer can make use of it. rowCosts[i] accumulates the
+     * time spent on updating the i-th row of our stripe since the
+     * last load balancing.
+     */
+    bool costProfiling;
+    LoadVec rowCosts;
+
     /**
      * these Regions will only be used by the UpdateFunctor. They
      * need to be remapped because some grid implementations may
@@ -186,6 +220,10 @@ private:
     {
         remappedInnerRegion = curStripe->remapRegion(innerRegion);
         remappedInnerGhostRegion = curStripe->remapRegion(innerGhostRegion);
+
+        if (costProfiling) {
+            rowCosts.assign(partitions[mpilayer.rank() + 1] - partitions[mpilayer.rank()], 0);
+        }
     }
 
     /**
@@ -245,11 +283,18 @@ private:
         double myRatio = c.template ratio<TimeCompute, TimeTotal>();
         chronometer.reset();
         LoadVec loads = mpilayer.gather(myRatio, 0);
+        LoadVec costProfile = gatherRowCosts();
         WeightVec newPartitionsSendBuffer;
 
         if (mpilayer.rank() == 0) {
             WeightVec oldWorkloads = partitionsToWorkloads(partitions);
-            WeightVec newWorkloads = balancer->balance(oldWorkloads, loads);
+            WeightVec newWorkloads;
+            if (costProfiling) {
+                newWorkloads = static_cast<CostProfileBalancer&>(*balancer).balance(
+                    oldWorkloads, loads, costProfile);
+            } else {
+                newWorkloads = balancer->balance(oldWorkloads, loads);
+            }
             validateLoads(newWorkloads, oldWorkloads);
             newPartitionsSendBuffer = workloadsToPartitions(newWorkloads);
 
@@ -266,9 +311,39 @@ private:
         redistributeGrid(oldPartitions, newPartitions);
     }
 
+    /**
+     * collects the cost profile of all stripes on the root, ordered
+     * by row. Resets the local accounting.
+     */
+    LoadVec gatherRowCosts()
+    {
+        LoadVec ret;
+        if (!costProfiling) {
+            return ret;
+        }
+
+        std::vector<int> lengths;
+        WeightVec workloads = partitionsToWorkloads(partitions);
+        for (std::size_t i = 0; i < workloads.size(); ++i) {
+            lengths << int(workloads[i]);
+        }
+
+        if (mpilayer.rank() == 0) {
+            ret.resize(partitions.back());
+        }
+        mpilayer.gatherV(rowCosts, lengths, 0, ret);
+        std::fill(rowCosts.begin(), rowCosts.end(), 0);
+
+        return ret;
+    }
+
     void nanoStep(unsigned nanoStep)
     {
         TimeTotal t(&chronometer);
+        bool reduce = !reductions.empty() && ((nanoStep + 1) == NANO_STEPS);
+        if (reduce) {
+            reductions.beginSweep();
+        }
 
         // we wait for ghostregions "just in time" to overlap
         // communication with I/O (which occurs outside of
@@ -278,10 +353,13 @@ private:
 
         waitForGhostRegions(curStripe);
         recvOuterGhostRegion();
-        updateInnerGhostRegion(nanoStep);
+        updateInnerGhostRegion(nanoStep, reduce);
         sendInnerGhostRegion(newStripe);
 
-        updateInside(nanoStep);
+        updateInside(nanoStep, reduce);
+        if (reduce) {
+            completeReductions(stepNum + 1);
+        }
         swapGrids();
     }
 
@@ -301,6 +379,38 @@ private:
         }
     }
 
+    /**
+     * Reductions are accumulated while the last nano step of a time
+     * step is being computed, only the initial grid needs to be
+     * evaluated separately.
+     */
+    void evaluateReductions()
+    {
+        if (reductions.empty()) {
+            return;
+        }
+
+        {
+            TimeCompute t(&chronometer);
+            reductions.evaluate(*curStripe, region, stepNum);
+        }
+        TimeCommunication t(&chronometer);
+        reductions.complete(stepNum);
+    }
+
+    /**
+     * initiates the global combination of the given step's partials.
+     * The previous step's combination has been running concurrently
+     * to this step's computation and is waited for just now, so
+     * Steerers will see the results with a delay of one step.
+     */
+    void completeReductions(unsigned step)
+    {
+        TimeCommunication t(&chronometer);
+        reductions.endSweep(step);
+        reductions.complete(step);
+    }
+
     void setIORegions()
     {
         for(unsigned i = 0; i < writers.size(); i++) {
@@ -369,24 +479,199 @@ private:
         return CoordBox<DIM>(startCorner, dim);
     }
 
-    void updateRegion(const Region<DIM>& region, unsigned nanoStep)
-    {
-        UpdateFunctor<CELL_TYPE>()(
+    /**
+     * Charges the time spent on updating cells to their rows in
+     * rowCosts. Reading the timer per Streak would skew the costs on
+     * narrow grids, so updated rows are collected until a batch spans
+     * at least BATCH_SIZE cells. The batch's time is then split among
+     * its rows by cell count.
+     */
+    class RowCostAccount
+    {
+    public:
+        static const long BATCH_SIZE = 4096;
+
+        inline RowCostAccount(LoadVec *rowCosts, int startRow) :
+            rowCosts(rowCosts),
+            startRow(startRow),
+            pendingCells(0),
+            lastTime(ScopedTimer::time())
+        {}
+
+        /**
+         * Marks the Streak as updated and settles the current batch
+         * once it's large enough.
+         */
+        void add(const Streak<DIM>& streak)
+        {
+            collect(streak);
+            if (pendingCells >= BATCH_SIZE) {
+                flush();
+            }
+        }
+
+        /**
+         * Marks the Streak as updated, but leaves settling the batch
+         * to the caller.
+         */
+        void collect(const Streak<DIM>& streak)
+        {
+            if (DIM > 1) {
+                collect(streak.origin[DIM - 1], streak.length());
+                return;
+            }
+
+            // in 1D a Streak spans multiple rows:
+            for (int x = streak.origin.x(); x < streak.endX; ++x) {
+                collect(x, 1);
+            }
+        }
+
+        /**
+         * Charges the time since the last flush to all rows collected
+         * since.
+         */
+        void flush()
+        {
+            if (pendingCells == 0) {
+                return;
+            }
+
+            double now = ScopedTimer::time();
+            double timePerCell = (now - lastTime) / pendingCells;
+            for (std::size_t i = 0; i < pendingRows.size(); ++i) {
+                (*rowCosts)[pendingRows[i].first - startRow] += timePerCell * pendingRows[i].second;
+            }
+
+            pendingRows.clear();
+            pendingCells = 0;
+            lastTime = now;
+        }
+
+    private:
+        LoadVec *rowCosts;
+        int startRow;
+        std::vector<std::pair<int, long> > pendingRows;
+        long pendingCells;
+        double lastTime;
+
+        void collect(int row, long cells)
+        {
+            if (pendingRows.empty() || (pendingRows.back().first != row)) {
+                pendingRows.push_back(std::make_pair(row, 0l));
+            }
+
+            pendingRows.back().second += cells;
+            pendingCells += cells;
+        }
+    };
+
+    /**
+     * A CONCURRENCY_FUNCTOR which behaves just like the
+     * CONCURRENCY_SPEC it wraps, but also hands each updated Streak
+     * to a RowCostAccount. This way the whole Region can be passed to
+     * a single UpdateFunctor call, even if we're profiling. Grids
+     * which can't hand out updated Streaks get their time split among
+     * the rows by cell count.
+     */
+    template<typename CONCURRENCY_SPEC>
+    class RowCostProfiler : public CONCURRENCY_SPEC
+    {
+    public:
+        inline RowCostProfiler(
+            const CONCURRENCY_SPEC& spec,
+            RowCostAccount *account,
+            const Region<DIM> *logicalRegion) :
+            CONCURRENCY_SPEC(spec),
+            account(account),
+            logicalRegion(logicalRegion)
+        {}
+
+        template<typename GRID>
+        void streakUpdated(const Streak<DIM>& streak, const GRID& grid) const
+        {
+            CONCURRENCY_SPEC::streakUpdated(streak, grid);
+            account->add(streak);
+        }
+
+        template<typename GRID>
+        void regionUpdated(const GRID& grid) const
+        {
+            CONCURRENCY_SPEC::regionUpdated(grid);
+            for (typename Region<DIM>::StreakIterator i = logicalRegion->beginStreak();
+                 i != logicalRegion->endStreak();
+                 ++i) {
+                account->collect(*i);
+            }
+            account->flush();
+        }
+
+    private:
+        RowCostAccount *account;
+        const Region<DIM> *logicalRegion;
+    };
+
+    /**
+     * logicalRegion is the not remapped counterpart of region, which
+     * is required for accumulating the Reductions (if reduce is set)
+     * and for the cost profiling.
+     */
+    void updateRegion(
+        const Region<DIM>& region,
+        const Region<DIM>& logicalRegion,
+        unsigned nanoStep,
+        bool reduce)
+    {
+        typedef UpdateFunctorHelpers::ConcurrencyNoP ConcurrencyNoP;
+        typedef ReductionAccumulator<CELL_TYPE, DIM, ConcurrencyNoP> Accumulator;
+
+        if (reduce) {
+            updateRegion(region, logicalRegion, nanoStep,
+                         Accumulator(ConcurrencyNoP(), &reductions, &logicalRegion));
+        } else {
+            updateRegion(region, logicalRegion, nanoStep, ConcurrencyNoP());
+        }
+    }
+
+    template<typename CONCURRENCY_SPEC>
+    void updateRegion(
+        const Region<DIM>& region,
+        const Region<DIM>& logicalRegion,
+        unsigned nanoStep,
+        const CONCURRENCY_SPEC& concurrencySpec)
+    {
+        if (!costProfiling) {
+            UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
+                region,
+                Coord<DIM>(),
+                Coord<DIM>(),
+                *curStripe,
+                newStripe,
+                nanoStep,
+                concurrencySpec);
+            return;
+        }
+
+        typedef RowCostProfiler<CONCURRENCY_SPEC> Profiler;
+        RowCostAccount account(&rowCosts, partitions[mpilayer.rank()]);
+        UpdateFunctor<CELL_TYPE, Profiler>()(
             region,
             Coord<DIM>(),
             Coord<DIM>(),
             *curStripe,
             newStripe,
-            nanoStep);
+            nanoStep,
+            Profiler(concurrencySpec, &account, &logicalRegion));
+        account.flush();
     }
 
     /**
      * the methods below are just used to structurize the nanoStep() method.
      */
-    void updateInnerGhostRegion(unsigned nanoStep)
+    void updateInnerGhostRegion(unsigned nanoStep, bool reduce)
     {
         TimeComputeGhost t(&chronometer);
-        updateRegion(remappedInnerGhostRegion, nanoStep);
+        updateRegion(remappedInnerGhostRegion, innerGhostRegion, nanoStep, reduce);
     }
 
     void recvOuterGhostRegion()
@@ -423,10 +708,10 @@ private:
         }
     }
 
-    void updateInside(unsigned nanoStep)
+    void updateInside(unsigned nanoStep, bool reduce)
     {
         TimeComputeInner t(&chronometer);
-        updateRegion(remappedInnerRegion, nanoStep);
+        updateRegion(remappedInnerRegion, innerRegion, nanoStep, reduce);
     }
 
     Region<DIM> fillRegion(int startRow, int endRow)
@@ -628,6 +913,19 @@ private:
         return initializer->gridDimensions();
     }
 
+    /**
+     * all nodes need to agree on whether the cost profile is being
+     * recorded, but only the root knows its LoadBalancer.
+     */
+    void initCostProfiling()
+    {
+        int flag = 0;
+        if (mpilayer.rank() == 0) {
+            flag = (dynamic_cast<CostProfileBalancer*>(balancer.get()) != 0);
+        }
+        costProfiling = mpilayer.broadcast(flag, 0);
+    }
+
     void validateConstructorParams()
     {
         if (loadBalancingPeriod  < 1) {
@@ -142,6 +142,32 @@ public:
         }
     }
 
+    void testReductions()
+    {
+        Reduction<TestCell<2> > *sum =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_SUM);
+        Reduction<TestCell<2> > *min =
+            new MemberReduction<TestCell<2>, bool>(&TestCell<2>::isValid, REDUCTION_MIN);
+        s->addReduction(sum);
+        s->addReduction(min);
+        s->run();
+
+        unsigned nanoSteps = APITraits::SelectNanoSteps<TestCell<2> >::VALUE;
+        TS_ASSERT_EQUALS(maxSteps, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * maxSteps * nanoSteps, sum->result());
+        TS_ASSERT_EQUALS(maxSteps, min->resultStep());
+        TS_ASSERT_EQUALS(1, min->result());
+    }
+
+    void testReductionsAfterStartAreRejected()
+    {
+        s->step();
+        TS_ASSERT_THROWS(
+            s->addReduction(
+                new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_SUM)),
+            std::logic_error&);
+    }
+
     void testSteererCallback()
     {
         SharedPtr<MockSteererType::EventsStore>::Type events(new MockSteererType::EventsStore);
@@ -1,4 +1,5 @@
 #include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/io/collectingwriter.h>
 #include <libgeodecomp/io/mocksteerer.h>
 #include <libgeodecomp/io/mockwriter.h>
 #include <libgeodecomp/io/teststeerer.h>
@@ -10,6 +11,7 @@
 #include <libgeodecomp/loadbalancer/mockbalancer.h>
 #include <libgeodecomp/loadbalancer/noopbalancer.h>
 #include <libgeodecomp/misc/nonpodtestcell.h>
+#include <libgeodecomp/misc/stringops.h>
 #include <libgeodecomp/misc/testcell.h>
 #include <libgeodecomp/misc/testhelper.h>
 #include <libgeodecomp/parallelization/hiparsimulator.h>
@@ -163,15 +165,50 @@ public:
         TS_ASSERT_EQUALS(dim, grids[t].getDimensions());
 
         if (rank == 0) {
-            std::string expectedEvents;
-            for (int i = 0; i < 2; ++i) {
-                expectedEvents += "balance() [1415, 1415, 1415, 1416] [1, 1, 1, 1]\n";
+            // loads are measured at runtime, so we can only check the weights:
+            std::string expectedPrefix = "balance() [1415, 1415, 1415, 1416] [";
+            std::stringstream buf(MockBalancer::events);
+            std::string line;
+            int balancingEvents = 0;
+            while (std::getline(buf, line)) {
+                TS_ASSERT_EQUALS(expectedPrefix, line.substr(0, expectedPrefix.size()));
+                ++balancingEvents;
             }
 
-            TS_ASSERT_EQUALS(expectedEvents, MockBalancer::events);
+            TS_ASSERT_EQUALS(2, balancingEvents);
         }
     }
 
+    void testEventTrace()
+    {
+        sim->enableEventTrace();
+        sim->step();
+        sim->step();
+
+        std::string trace = sim->gatherEventTrace();
+        std::string report = sim->gatherCriticalPathReport();
+        if (rank != 0) {
+            TS_ASSERT_EQUALS("", trace);
+            TS_ASSERT_EQUALS("", report);
+            return;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            std::stringstream buf;
+            buf << "\"name\":\"rank " << i << "\"";
+            TS_ASSERT_DIFFERS(std::string::npos, trace.find(buf.str()));
+        }
+        TS_ASSERT_DIFFERS(std::string::npos, trace.find("\"name\":\"compute_time_inner\""));
+        TS_ASSERT_DIFFERS(std::string::npos, trace.find("\"direction\":\"recv\""));
+
+        // header, one line per nano step plus two lines of totals:
+        std::vector<std::string> lines = StringOps::tokenize(report, "\n");
+        TS_ASSERT_EQUALS(std::size_t(1 + 2 * NANO_STEPS + 2), lines.size());
+        std::stringstream buf;
+        buf << firstCycle;
+        TS_ASSERT_EQUALS(buf.str(), StringOps::tokenize(lines[1], " ")[0]);
+    }
+
     void testSteererCallback()
     {
         SharedPtr<MockSteererType::EventsStore>::Type events(new MockSteererType::EventsStore);
@@ -1321,6 +1358,20 @@ public:
         sim->run();
     }
 
+    void testLoadBalancingWithMigration2D()
+    {
+        for (int ghostZoneWidth = 1; ghostZoneWidth < 5; ++ghostZoneWidth) {
+            checkLoadBalancingWithMigration<TestCell<2> >(Coord<2>(30, 41), ghostZoneWidth);
+        }
+    }
+
+    void testLoadBalancingWithMigration3D()
+    {
+        for (int ghostZoneWidth = 1; ghostZoneWidth < 4; ++ghostZoneWidth) {
+            checkLoadBalancingWithMigration<TestCell<3> >(Coord<3>(15, 22, 13), ghostZoneWidth);
+        }
+    }
+
     void testUnstructured()
     {
 #ifdef LIBGEODECOMP_WITH_CPP14
@@ -1480,6 +1531,63 @@ public:
     }
 
 private:
+    /**
+     * Shifts a third of the first rank's work items to the last rank
+     * (and back, in alternating calls) to enforce cell migration.
+     */
+    class ShiftingBalancer : public LoadBalancer
+    {
+    public:
+        ShiftingBalancer() :
+            calls(0)
+        {}
+
+        virtual WeightVec balance(const WeightVec& weights, const LoadVec& /* unused: relativeLoads */)
+        {
+            WeightVec ret = weights;
+            std::size_t& source = (calls % 2) ? ret.back() : ret.front();
+            std::size_t& target = (calls % 2) ? ret.front() : ret.back();
+            std::size_t delta = source / 3;
+            source -= delta;
+            target += delta;
+            ++calls;
+
+            return ret;
+        }
+
+    private:
+        int calls;
+    };
+
+    template<typename CELL>
+    void checkLoadBalancingWithMigration(const Coord<CELL::DIMENSIONS>& dim, int ghostZoneWidth)
+    {
+        const int DIM = CELL::DIMENSIONS;
+        int startStep = 3;
+        int endStep = 41;
+        int loadBalancingPeriod = 5;
+
+        HiParSimulator<CELL, ZCurvePartition<DIM> > sim(
+            new TestInitializer<CELL>(dim, endStep, startStep),
+            rank? 0 : new ShiftingBalancer(),
+            loadBalancingPeriod,
+            ghostZoneWidth);
+
+        Writer<CELL> *writer = 0;
+        if (rank == 0) {
+            writer = new TestWriter<CELL>(2, startStep, endStep);
+        }
+        sim.addWriter(new CollectingWriter<CELL>(writer));
+
+        sim.run();
+
+        // domain must have changed, but not the total number of cells:
+        const std::vector<std::size_t>& weights = sim.updateGroup->getWeights();
+        TS_ASSERT(sim.lastRepartitioningNanoStep > startStep * APITraits::SelectNanoSteps<CELL>::VALUE);
+        TS_ASSERT_EQUALS(std::size_t(dim.prod()), sum(weights));
+        TS_ASSERT_EQUALS(weights[rank], sim.updateGroup->getPartitionManager().ownRegion().size());
+    }
+
     SharedPtr<SimulatorType>::Type sim;
     Coord<2> dim;
     unsigned maxSteps;
@@ -9,6 +9,7 @@
 #include <libgeodecomp/io/teststeerer.h>
 #include <libgeodecomp/io/testwriter.h>
 #include <libgeodecomp/io/unstructuredtestinitializer.h>
+#include <libgeodecomp/loadbalancer/costprofilebalancer.h>
 #include <libgeodecomp/loadbalancer/noopbalancer.h>
 #include <libgeodecomp/loadbalancer/randombalancer.h>
 #include <libgeodecomp/misc/nonpodtestcell.h>
@@ -38,6 +39,53 @@ public:
 };
 
 
+/**
+ * Checks that the global sum of all cycle counters of the previous
+ * step is available at the beginning of each step: the combination
+ * across nodes is overlapped with the current step's computation.
+ */
+class ReductionCheckSteerer : public Steerer<TestCell<2> >
+{
+public:
+    ReductionCheckSteerer(
+        const Reduction<TestCell<2> > *reduction,
+        unsigned firstStep,
+        unsigned *calls) :
+        Steerer<TestCell<2> >(1),
+        reduction(reduction),
+        firstStep(firstStep),
+        calls(calls)
+    {}
+
+    void nextStep(
+        GridType *grid,
+        const Region<2>& validRegion,
+        const CoordType& globalDimensions,
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        bool lastCall,
+        SteererFeedback *feedback)
+    {
+        ++*calls;
+        if (step == firstStep) {
+            TS_ASSERT(!reduction->hasResult());
+            return;
+        }
+
+        TS_ASSERT(reduction->hasResult());
+        TS_ASSERT_EQUALS(step - 1, reduction->resultStep());
+        TS_ASSERT_EQUALS(
+            globalDimensions.prod() * (step - 1) * APITraits::SelectNanoSteps<TestCell<2> >::VALUE,
+            reduction->result());
+    }
+
+private:
+    const Reduction<TestCell<2> > *reduction;
+    unsigned firstStep;
+    unsigned *calls;
+};
+
 class StripingSimulatorTest : public CxxTest::TestSuite
 {
 public:
@@ -324,11 +372,14 @@ public:
         }
     }
 
-    void checkLoadBalancingRealistically(unsigned balanceEveryN)
+    void checkLoadBalancingRealistically(unsigned balanceEveryN, bool costProfile = false)
     {
         SharedPtr<MockWriter<>::EventsStore>::Type expectedEvents(new MockWriter<>::EventsStore);
 
-        LoadBalancer *balancer = rank? 0 : new RandomBalancer;
+        LoadBalancer *balancer = 0;
+        if (rank == 0) {
+            balancer = costProfile ? static_cast<LoadBalancer*>(new CostProfileBalancer) : new RandomBalancer;
+        }
         StripingSimulator<TestCell<2> > localTestSim(
             new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
             balancer,
@@ -378,6 +429,105 @@ public:
         checkLoadBalancingRealistically(7);
     }
 
+    void testBalanceLoadCostProfile1()
+    {
+        checkLoadBalancingRealistically(1, true);
+    }
+
+    void testBalanceLoadCostProfile2()
+    {
+        checkLoadBalancingRealistically(3, true);
+    }
+
+    void testCostProfileMovesStripeBoundaries()
+    {
+        LoadBalancer *balancer = rank? 0 : new CostProfileBalancer;
+        StripingSimulator<TestCell<2> > localTestSim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            balancer);
+
+        TS_ASSERT(localTestSim.costProfiling);
+        TS_ASSERT_EQUALS(std::size_t(3), localTestSim.rowCosts.size());
+        TS_ASSERT(!testSim->costProfiling);
+
+        // row 6 (the first row of rank 2) is as expensive as 9 others:
+        localTestSim.rowCosts.assign(3, 1.0);
+        if (rank == 2) {
+            localTestSim.rowCosts[0] = 9;
+        }
+        localTestSim.balanceLoad();
+
+        StripingSimulator<TestCell<2> >::WeightVec expected;
+        expected << 0 << 5 << 6 << 7 << 12;
+        TS_ASSERT_EQUALS(expected, localTestSim.partitions);
+
+        unsigned expectedRows = expected[rank + 1] - expected[rank];
+        TS_ASSERT_EQUALS(std::size_t(expectedRows), localTestSim.rowCosts.size());
+        TS_ASSERT_EQUALS(LoadBalancer::LoadVec(expectedRows, 0), localTestSim.rowCosts);
+
+        localTestSim.run();
+        TS_ASSERT_TEST_GRID_REGION(
+            GridBaseType,
+            *localTestSim.curStripe,
+            localTestSim.region,
+            maxSteps * NANO_STEPS);
+    }
+
+    void testCostProfileChargesEveryRow()
+    {
+        LoadBalancer *balancer = rank? 0 : new CostProfileBalancer;
+        StripingSimulator<TestCell<2> > localTestSim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            balancer,
+            1000);
+
+        localTestSim.step();
+        localTestSim.step();
+
+        TS_ASSERT_EQUALS(std::size_t(3), localTestSim.rowCosts.size());
+        for (std::size_t i = 0; i < localTestSim.rowCosts.size(); ++i) {
+            TS_ASSERT_LESS_THAN(0, localTestSim.rowCosts[i]);
+        }
+        TS_ASSERT_TEST_GRID_REGION(
+            GridBaseType,
+            *localTestSim.curStripe,
+            localTestSim.region,
+            (firstStep + 2) * NANO_STEPS);
+    }
+
+    static double maxCombiner(double a, double b)
+    {
+        return (std::max)(a, b);
+    }
+
+    void testReductions()
+    {
+        Reduction<TestCell<2> > *sum =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_SUM);
+        Reduction<TestCell<2> > *min =
+            new MemberReduction<TestCell<2>, bool>(&TestCell<2>::isValid, REDUCTION_MIN);
+        Reduction<TestCell<2> > *max =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, &maxCombiner, 0);
+
+        LoadBalancer *balancer = rank? 0 : new RandomBalancer;
+        StripingSimulator<TestCell<2> > localTestSim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            balancer);
+        localTestSim.addReduction(sum);
+        localTestSim.addReduction(min);
+        localTestSim.addReduction(max);
+
+        unsigned calls = 0;
+        localTestSim.addSteerer(new ReductionCheckSteerer(sum, firstStep, &calls));
+        localTestSim.run();
+
+        TS_ASSERT_EQUALS(maxSteps - firstStep, calls);
+        TS_ASSERT_EQUALS(maxSteps, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * maxSteps * NANO_STEPS, sum->result());
+        TS_ASSERT_EQUALS(1, min->result());
+        TS_ASSERT_EQUALS(maxSteps * NANO_STEPS, max->result());
+    }
+
     void testLoadGathering()
     {
         LoadBalancer *balancer = rank? 0 : new CheckBalancer;
@@ -1,7 +1,6 @@
 #include <cxxtest/TestSuite.h>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <libgeodecomp/io/mockwriter.h>
+#include <libgeodecomp/io/mocksteerer.h>
 #include <libgeodecomp/io/testinitializer.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
@@ -16,110 +15,211 @@ namespace LibGeoDecomp {
 class CacheBlockingSimulatorTest : public CxxTest::TestSuite
 {
 public:
-    typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Cube<3>::Topology> TestCellType;
+    typedef TestCell<2, Stencils::Moore<2, 1>, Topologies::Cube<2>::Topology> TestCellCube2D;
+    typedef TestCell<2, Stencils::Moore<2, 1>, Topologies::Torus<2>::Topology> TestCellTorus2D;
+    typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Cube<3>::Topology> TestCellCube3D;
+    typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Torus<3>::Topology> TestCellTorus3D;
 
-    void setUp()
+    void testInvalidParameters()
     {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef CacheBlockingSimulator<TestCellCube3D> SimulatorType;
+
+        TS_ASSERT_THROWS(
+            SimulatorType(new TestInitializer<TestCellCube3D>(Coord<3>(10, 10, 10)), 0, Coord<2>(4, 4)),
+            std::invalid_argument&);
+        TS_ASSERT_THROWS(
+            SimulatorType(new TestInitializer<TestCellCube3D>(Coord<3>(10, 10, 10)), 2, Coord<2>(4, 0)),
+            std::invalid_argument&);
+#endif
     }
 
-    void tearDown()
+    void testColumns()
     {
-        // sim.reset();
+#ifdef LIBGEODECOMP_WITH_THREADS
+        CacheBlockingSimulator<TestCellCube3D> sim(
+            new TestInitializer<TestCellCube3D>(Coord<3>(10, 7, 5)), 3, Coord<2>(4, 3));
+
+        TS_ASSERT_EQUALS(std::size_t(9), sim.columns.size());
+
+        Region<3> columns;
+        for (std::size_t i = 0; i < sim.columns.size(); ++i) {
+            Region<3> column;
+            column << sim.columns[i];
+            TS_ASSERT((columns & column).empty());
+            columns += column;
+        }
+
+        Region<3> expected;
+        expected << sim.getGrid()->boundingBox();
+        TS_ASSERT_EQUALS(expected, columns);
+#endif
     }
 
-    void testPipelinedUpdate()
+    void testStepCube2D()
     {
-//         init(Coord<3>(40, 1, 20));
-
-//         sim->buffer.atEdge() = sim->curGrid->atEdge();
-//         sim->buffer.fill(sim->buffer.boundingBox(), sim->curGrid->getEdgeCell());
-//         sim->fixBufferOrigin(Coord<2>(0, 0));
-//         int i = 0;
-
-//         for (; i < 2 * pipelineLength - 2; ++i) {
-//             int lastStage = (i >> 1) + 1;
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, 0, lastStage);
-//         }
-//         for (; i < dim.z(); ++i) {
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, 0, pipelineLength);
-//         }
-//         for (; i < (dim.z() + 2 * pipelineLength - 2); ++i) {
-//             int firstStage = ((i - dim.z() + 1) >> 1);
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, firstStage, pipelineLength);
-//         }
-//     }
-
-//     void testUpdateWavefront()
-//     {
-//         init(Coord<3>(40, 30, 20));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 0);
-//         sim->updateWavefront(Coord<2>(0, 0));
-//         sim->updateWavefront(Coord<2>(1, 0));
-//         sim->updateWavefront(Coord<2>(2, 0));
-
-//         sim->updateWavefront(Coord<2>(0, 1));
-//         sim->updateWavefront(Coord<2>(1, 1));
-//         sim->updateWavefront(Coord<2>(2, 1));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->newGrid), pipelineLength);
-//     }
-
-//     void testHop1()
-//     {
-//         init(Coord<3>(40, 30, 20));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  5);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 10);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 15);
-//     }
-
-//     void testHop2()
-//     {
-//         init(Coord<3>(40, 30, 20), 7);
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  7);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 14);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 21);
-//     }
-
-//     void testHop3()
-//     {
-//         init(Coord<3>(40, 30, 20), 1);
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  1);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  2);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  3);
-//     }
-
-// private:
-//     int pipelineLength;
-//     Coord<3> dim;
-//     SharedPtr<CacheBlockingSimulator<TestCellType> >::Type sim;
-
-//     void init(const Coord<3>& gridDim, int newPipelineLength = 5, const Coord<2> wavefrontDim = Coord<2>(16, 16))
-//     {
-//         pipelineLength = newPipelineLength;
-//         dim = gridDim;
-//         sim.reset(new CacheBlockingSimulator<TestCellType>(
-//                       new TestInitializer<TestCellType>(
-//                           dim,
-//                           10000,
-//                           0),
-//                       pipelineLength,
-//                       wavefrontDim));
+        checkStep<TestCellCube2D>(Coord<2>(31, 20), 3, Coord<1>(7));
+    }
+
+    void testStepTorus2D()
+    {
+        checkStep<TestCellTorus2D>(Coord<2>(31, 20), 3, Coord<1>(7));
+    }
+
+    void testStepCube3D()
+    {
+        checkStep<TestCellCube3D>(Coord<3>(13, 11, 17), 4, Coord<2>(5, 4));
+    }
+
+    void testStepTorus3D()
+    {
+        checkStep<TestCellTorus3D>(Coord<3>(13, 11, 17), 4, Coord<2>(5, 4));
+    }
+
+    void testPipelineLongerThanStep()
+    {
+        // TestCell<3> needs 27 nano steps per step, so one hop may
+        // stop in the middle of a time step:
+        checkStep<TestCellTorus3D>(Coord<3>(9, 8, 7), 20, Coord<2>(3, 3));
+    }
+
+    void testBuffersHoldRingOfPlanes()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef GridBase<TestCellCube3D, 3> GridBaseType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<TestCellCube3D>::VALUE;
+
+        CacheBlockingSimulator<TestCellCube3D> sim(
+            new TestInitializer<TestCellCube3D>(Coord<3>(12, 10, 60)), 3, Coord<2>(6, 5));
+        sim.step();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), NANO_STEPS);
+
+        for (std::size_t i = 0; i < sim.buffers.size(); ++i) {
+            if (sim.buffers[i].getDimensions() != Coord<3>()) {
+                TS_ASSERT_EQUALS(8, sim.buffers[i].getDimensions().z());
+            }
+        }
+#endif
+    }
+
+    void testBuffersFollowTeamSize()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef GridBase<TestCellTorus2D, 2> GridBaseType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<TestCellTorus2D>::VALUE;
+
+        int oldNumThreads = omp_get_max_threads();
+        CacheBlockingSimulator<TestCellTorus2D> sim(
+            new TestInitializer<TestCellTorus2D>(Coord<2>(31, 20)), 3, Coord<1>(4));
+
+        omp_set_num_threads(oldNumThreads + 3);
+        sim.step();
+        omp_set_num_threads(oldNumThreads);
+
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), NANO_STEPS);
+        TS_ASSERT_LESS_THAN_EQUALS(std::size_t(2 * (oldNumThreads + 3)), sim.buffers.size());
+#endif
+    }
+
+    void testRunHonorsIOPeriods()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef TestCellTorus2D CellType;
+        typedef MockSteerer<CellType> MockSteererType;
+        typedef GridBase<CellType, 2> GridBaseType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CellType>::VALUE;
+
+        unsigned startStep = 5;
+        unsigned maxSteps = 23;
+        CacheBlockingSimulator<CellType> sim(
+            new TestInitializer<CellType>(Coord<2>(23, 17), maxSteps, startStep),
+            7,
+            Coord<1>(6));
+
+        SharedPtr<MockWriter<CellType>::EventsStore>::Type writerEvents(
+            new MockWriter<CellType>::EventsStore);
+        sim.addWriter(new MockWriter<CellType>(writerEvents, 4));
+
+        SharedPtr<MockSteererType::EventsStore>::Type steererEvents(
+            new MockSteererType::EventsStore);
+        sim.addSteerer(new MockSteererType(7, steererEvents));
+
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), maxSteps * NANO_STEPS);
+
+        MockWriter<CellType>::EventsStore expectedWriterEvents;
+        expectedWriterEvents << MockWriter<CellType>::Event(startStep, WRITER_INITIALIZED, 0, true);
+        for (unsigned t = startStep + 1; t < maxSteps; ++t) {
+            if ((t % 4) == 0) {
+                expectedWriterEvents << MockWriter<CellType>::Event(t, WRITER_STEP_FINISHED, 0, true);
+            }
+        }
+        expectedWriterEvents << MockWriter<CellType>::Event(maxSteps, WRITER_ALL_DONE, 0, true);
+        TS_ASSERT_EQUALS(expectedWriterEvents, *writerEvents);
+
+        MockSteererType::EventsStore expectedSteererEvents;
+        expectedSteererEvents << MockSteererType::Event(startStep, STEERER_INITIALIZED, 0, true);
+        for (unsigned t = startStep; t < maxSteps; ++t) {
+            if ((t % 7) == 0) {
+                expectedSteererEvents << MockSteererType::Event(t, STEERER_NEXT_STEP, 0, true);
+            }
+        }
+        expectedSteererEvents << MockSteererType::Event(maxSteps, STEERER_ALL_DONE, 0, true);
+        TS_ASSERT_EQUALS(expectedSteererEvents, *steererEvents);
+#endif
+    }
+
+    void testReductions()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef TestCellTorus2D CellType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CellType>::VALUE;
+
+        Coord<2> dim(23, 17);
+        unsigned startStep = 5;
+        unsigned maxSteps = 23;
+        CacheBlockingSimulator<CellType> sim(
+            new TestInitializer<CellType>(dim, maxSteps, startStep),
+            7,
+            Coord<1>(6));
+
+        Reduction<CellType> *max =
+            new MemberReduction<CellType, unsigned>(&CellType::cycleCounter, REDUCTION_MAX);
+        sim.addReduction(max);
+
+        sim.step();
+        TS_ASSERT_EQUALS(startStep + 1, max->resultStep());
+        TS_ASSERT_EQUALS((startStep + 1) * NANO_STEPS, max->result());
+
+        sim.run();
+        TS_ASSERT_EQUALS(maxSteps, max->resultStep());
+        TS_ASSERT_EQUALS(maxSteps * NANO_STEPS, max->result());
+#endif
+    }
+
+private:
+    template<typename CELL, int DIM>
+    void checkStep(const Coord<DIM>& dim, int pipelineLength, const Coord<DIM - 1>& wavefrontDim)
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef GridBase<CELL, DIM> GridBaseType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL>::VALUE;
+
+        CacheBlockingSimulator<CELL> sim(
+            new TestInitializer<CELL>(dim), pipelineLength, wavefrontDim);
+        TS_ASSERT_TEST_GRID2(GridBaseType, *sim.getGrid(), 0, typename);
+
+        sim.step();
+        TS_ASSERT_EQUALS(1, sim.getStep());
+        TS_ASSERT_TEST_GRID2(GridBaseType, *sim.getGrid(), NANO_STEPS, typename);
+
+        sim.step();
+        TS_ASSERT_EQUALS(2, sim.getStep());
+        TS_ASSERT_TEST_GRID2(GridBaseType, *sim.getGrid(), 2 * NANO_STEPS, typename);
+
+        sim.hop(1);
+        TS_ASSERT_TEST_GRID2(GridBaseType, *sim.getGrid(), 2 * NANO_STEPS + 1, typename);
+#endif
     }
 };
 
@@ -140,6 +140,21 @@ public:
         TS_ASSERT_EQUALS(grids1, grids2);
     }
 
+    void testReductions()
+    {
+        Reduction<TestCell<2> > *sum =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_SUM);
+        simulator->addReduction(sum);
+
+        simulator->step();
+        TS_ASSERT_EQUALS(startStep + 1, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * (startStep + 1) * NANO_STEPS_2D, sum->result());
+
+        simulator->run();
+        TS_ASSERT_EQUALS(maxSteps, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * maxSteps * NANO_STEPS_2D, sum->result());
+    }
+
     typedef APITraits::SelectTopology<TestCell<3> >::Value Topology;
     typedef Grid<TestCell<3>, Topology> Grid3D;
     typedef GridBase<TestCell<3>, 3> GridBase3D;
@@ -159,6 +174,17 @@ public:
         TS_ASSERT_TEST_GRID(GridBase3D, *sim.getGrid(), 21 * NANO_STEPS_3D);
     }
 
+    void testPaddedTorusGrid()
+    {
+        typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Torus<3>::Topology,
+                 APITraits::HasPaddedTorusGrid, TestCellHelpers::NoOutput> TestCellPadded;
+        typedef GridBase<TestCellPadded, 3> GridBaseType;
+
+        OpenMPSimulator<TestCellPadded> sim(new TestInitializer<TestCellPadded>(Coord<3>(13, 7, 5), 9, 2));
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 9 * NANO_STEPS_3D);
+    }
+
     void testSteererCallback()
     {
         SharedPtr<MockSteererType::EventsStore>::Type events(new MockSteererType::EventsStore);
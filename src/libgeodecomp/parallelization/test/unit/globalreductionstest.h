@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/reduction.h>
+#include <libgeodecomp/parallelization/globalreductions.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cmath>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ValueReduction : public Reduction<double>
+{
+public:
+    explicit ValueReduction(ReductionOperator op) :
+        Reduction<double>(op)
+    {}
+
+    ValueReduction(Combiner combiner, double identity) :
+        Reduction<double>(combiner, identity)
+    {}
+
+    double extract(const double& cell) const
+    {
+        return cell;
+    }
+};
+
+class GlobalReductionsTest : public CxxTest::TestSuite
+{
+public:
+    static double absMax(double a, double b)
+    {
+        return (std::max)(std::abs(a), std::abs(b));
+    }
+
+    void testEvaluate()
+    {
+        Coord<2> dim(200, 30);
+        Grid<double> grid(dim);
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                grid[Coord<2>(x, y)] = x - 100 + y * 0.5;
+            }
+        }
+
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(10, 10), Coord<2>(150, 10));
+
+        double expectedSum = 0;
+        for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+            expectedSum += grid[*i];
+        }
+
+        Reduction<double> *sum = new ValueReduction(REDUCTION_SUM);
+        Reduction<double> *min = new ValueReduction(REDUCTION_MIN);
+        Reduction<double> *max = new ValueReduction(REDUCTION_MAX);
+        Reduction<double> *custom = new ValueReduction(&absMax, 0);
+
+        GlobalReductions<double, 2> reductions;
+        TS_ASSERT(reductions.empty());
+        reductions.add(sum);
+        reductions.add(min);
+        reductions.add(custom);
+        reductions.add(max);
+        TS_ASSERT_EQUALS(std::size_t(4), reductions.size());
+
+        reductions.evaluate(grid, region, 47);
+        TS_ASSERT(reductions.isPending());
+        TS_ASSERT(!sum->hasResult());
+
+        reductions.complete(47);
+        TS_ASSERT(!reductions.isPending());
+
+        TS_ASSERT(sum->hasResult());
+        TS_ASSERT_EQUALS(unsigned(47), sum->resultStep());
+        TS_ASSERT_DELTA(expectedSum, sum->result(), 1e-9);
+        TS_ASSERT_EQUALS(-90 + 5.0, min->result());
+        TS_ASSERT_EQUALS( 59 + 9.5, max->result());
+        TS_ASSERT_EQUALS( 90 - 5.0, custom->result());
+    }
+
+    void testEmptyRegionYieldsIdentity()
+    {
+        Grid<double> grid(Coord<2>(10, 10), 1.0);
+        Reduction<double> *min = new ValueReduction(REDUCTION_MIN);
+
+        GlobalReductions<double, 2> reductions;
+        reductions.add(min);
+        reductions.evaluate(grid, Region<2>(), 11);
+        reductions.complete(11);
+
+        TS_ASSERT_EQUALS(min->identity(), min->result());
+        TS_ASSERT(min->result() > 1e300);
+    }
+
+    void testStreaksOfInterleavedSteps()
+    {
+        Coord<2> dim(20, 10);
+        Grid<double> grid(dim);
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                grid[Coord<2>(x, y)] = x + y * 100;
+            }
+        }
+
+        Reduction<double> *sum = new ValueReduction(REDUCTION_SUM);
+        GlobalReductions<double, 2> reductions;
+        reductions.add(sum);
+        TS_ASSERT(reductions.needsStep(0));
+
+        // step 5 is accumulated in two sweeps, with a sweep of step 6
+        // interleaved, just like a ghost zone update running ahead:
+        reductions.beginSweep();
+        reductions.accumulate(Streak<2>(Coord<2>(0, 0), 20), grid);
+        reductions.endSweep(5);
+
+        reductions.beginSweep();
+        reductions.accumulate(Streak<2>(Coord<2>(0, 9), 20), grid);
+        reductions.endSweep(6);
+
+        reductions.beginSweep();
+        reductions.accumulate(Streak<2>(Coord<2>(5, 1), 10), grid);
+        reductions.endSweep(5);
+
+        reductions.complete(5);
+        TS_ASSERT_EQUALS(unsigned(5), sum->resultStep());
+        TS_ASSERT_EQUALS(190.0 + 5 * 100 + 35, sum->result());
+        TS_ASSERT(!reductions.needsStep(5));
+        TS_ASSERT(reductions.needsStep(6));
+        TS_ASSERT(reductions.isPending());
+
+        reductions.discardAfter(5);
+        TS_ASSERT(!reductions.isPending());
+        reductions.complete(6);
+        TS_ASSERT_EQUALS(unsigned(5), sum->resultStep());
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(0, 9), 20);
+        reductions.evaluate(grid, region, 6);
+        reductions.complete(6);
+        TS_ASSERT_EQUALS(unsigned(6), sum->resultStep());
+        TS_ASSERT_EQUALS(190.0 + 20 * 900, sum->result());
+    }
+
+    void testInvalidOperators()
+    {
+        TS_ASSERT_THROWS(ValueReduction r(REDUCTION_CUSTOM), std::invalid_argument&);
+        TS_ASSERT_THROWS(ValueReduction(0, 0), std::invalid_argument&);
+    }
+};
+
+}
@@ -1,5 +1,6 @@
 #include <cxxtest/TestSuite.h>
 #include <sstream>
+#include <type_traits>
 #include <libgeodecomp/io/writer.h>
 #include <libgeodecomp/io/memorywriter.h>
 #include <libgeodecomp/io/mockinitializer.h>
@@ -19,6 +20,11 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+class PaddedTorusFixedAPI :
+        public APITraits::HasPaddedTorusGrid,
+        public APITraits::HasFixedCoordsOnlyUpdate
+{};
+
 class SerialSimulatorTest : public CxxTest::TestSuite
 {
 public:
@@ -186,6 +192,26 @@ public:
         TS_ASSERT_EQUALS(*events, expectedEvents);
     }
 
+    void testReductions()
+    {
+        Reduction<TestCell<2> > *sum =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_SUM);
+        Reduction<TestCell<2> > *max =
+            new MemberReduction<TestCell<2>, unsigned>(&TestCell<2>::cycleCounter, REDUCTION_MAX);
+        simulator->addReduction(sum);
+        simulator->addReduction(max);
+
+        simulator->step();
+        TS_ASSERT_EQUALS(startStep + 1, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * (startStep + 1) * NANO_STEPS_2D, sum->result());
+        TS_ASSERT_EQUALS((startStep + 1) * NANO_STEPS_2D, max->result());
+
+        simulator->run();
+        TS_ASSERT_EQUALS(maxSteps, sum->resultStep());
+        TS_ASSERT_EQUALS(dim.prod() * maxSteps * NANO_STEPS_2D, sum->result());
+        TS_ASSERT_EQUALS(maxSteps * NANO_STEPS_2D, max->result());
+    }
+
     void test1dTorus()
     {
         typedef TestCell<1, Stencils::Moore<1, 1>, Topologies::Torus<1>::Topology,
@@ -204,6 +230,30 @@ public:
         TS_ASSERT(writer->allEventsDone());
     }
 
+    void testPaddedTorusGrid()
+    {
+        typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Torus<3>::Topology,
+                 APITraits::HasPaddedTorusGrid, TestCellHelpers::NoOutput> TestCellPadded;
+        typedef GridBase<TestCellPadded, 3> GridBaseType;
+        TS_ASSERT((std::is_same<PaddedTorusGrid<TestCellPadded, Topologies::Torus<3>::Topology>,
+                   SerialSimulator<TestCellPadded>::GridType>::value));
+
+        SerialSimulator<TestCellPadded> sim(new TestInitializer<TestCellPadded>(Coord<3>(13, 7, 5), 9, 2));
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 9 * NANO_STEPS_3D);
+    }
+
+    void testPaddedTorusGridWithFixedNeighborhood()
+    {
+        typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Torus<3>::Topology,
+                 PaddedTorusFixedAPI, TestCellHelpers::NoOutput> TestCellPadded;
+        typedef GridBase<TestCellPadded, 3> GridBaseType;
+
+        SerialSimulator<TestCellPadded> sim(new TestInitializer<TestCellPadded>(Coord<3>(13, 7, 5), 9, 2));
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 9 * NANO_STEPS_3D);
+    }
+
     void testSteererCanTerminateSimulation()
     {
         unsigned eventStep = 15;
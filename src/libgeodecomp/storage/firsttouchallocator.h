@@ -0,0 +1,187 @@
+#ifndef LIBGEODECOMP_STORAGE_FIRSTTOUCHALLOCATOR_H
+#define LIBGEODECOMP_STORAGE_FIRSTTOUCHALLOCATOR_H
+
+#include <libgeodecomp/misc/numa.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <memory>
+#include <new>
+
+namespace LibGeoDecomp {
+
+/**
+ * Drop-in replacement for LibFlatArray::aligned_allocator. While
+ * NUMA::firstTouch() is enabled, larger blocks are mapped freshly
+ * from the OS (so none of their pages have been placed yet) and are
+ * then touched by all OpenMP threads, split up statically just like
+ * the planes of a grid during a threaded update. Later writes by a
+ * single thread (e.g. std::vector's constructor) don't move pages.
+ *
+ * With TOUCH = false, pages are left untouched and the caller is
+ * expected to initialize the memory in parallel (see SoAGrid).
+ */
+template<class T, std::size_t ALIGNMENT, bool TOUCH = true>
+class FirstTouchAllocator
+{
+public:
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    template<typename OTHER>
+    struct rebind
+    {
+        typedef FirstTouchAllocator<OTHER, ALIGNMENT, TOUCH> other;
+    };
+
+    inline FirstTouchAllocator()
+    {}
+
+    template<typename OTHER>
+    inline explicit FirstTouchAllocator(const FirstTouchAllocator<OTHER, ALIGNMENT, TOUCH>& /* other */)
+    {}
+
+    inline pointer address(reference x) const
+    {
+        return &x;
+    }
+
+    inline const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+
+    pointer allocate(std::size_t n, const void* = 0)
+    {
+        std::size_t bytes = n * sizeof(T);
+#ifndef _WIN32
+        if (NUMA::firstTouch() &&
+            (bytes >= NUMA::pageSize()) &&
+            (ALIGNMENT <= NUMA::pageSize())) {
+            return allocateMapped(bytes);
+        }
+#endif
+
+        return allocateHeap(bytes);
+    }
+
+    void deallocate(pointer p, std::size_t n)
+    {
+        if (p == 0) {
+            return;
+        }
+
+        Header *header = reinterpret_cast<Header*>(p) - 1;
+#ifndef _WIN32
+        if (header->mappedBytes) {
+            munmap(header->chunk, header->mappedBytes);
+            return;
+        }
+#endif
+
+        std::allocator<char>().deallocate(header->chunk, n * sizeof(T) + graceOffset());
+    }
+
+    std::size_t max_size() const throw()
+    {
+        return std::allocator<T>().max_size();
+    }
+
+    void construct(pointer p, const_reference val)
+    {
+        new (p) T(val);
+    }
+
+    void construct(pointer p)
+    {
+        new (p) T();
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    bool operator!=(const FirstTouchAllocator& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator==(const FirstTouchAllocator& /* other */) const
+    {
+        return true;
+    }
+
+private:
+    /**
+     * Sits in front of each block so deallocate() knows how the
+     * block was obtained. mappedBytes is 0 for heap blocks.
+     */
+    class Header
+    {
+    public:
+        char *chunk;
+        std::size_t mappedBytes;
+    };
+
+    static_assert(ALIGNMENT >= sizeof(Header), "alignment too small to accommodate the block header");
+
+    static std::size_t graceOffset()
+    {
+        return ALIGNMENT + sizeof(Header);
+    }
+
+    pointer allocateHeap(std::size_t bytes)
+    {
+        char *chunk = std::allocator<char>().allocate(bytes + graceOffset());
+
+        std::size_t offset = reinterpret_cast<std::size_t>(chunk) % ALIGNMENT;
+        std::size_t correction = ALIGNMENT - offset;
+        if (correction < sizeof(Header)) {
+            correction += ALIGNMENT;
+        }
+
+        return init(chunk + correction, chunk, 0);
+    }
+
+#ifndef _WIN32
+    pointer allocateMapped(std::size_t bytes)
+    {
+        // mappings are page aligned, so this keeps the block aligned:
+        std::size_t lead = (sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        std::size_t mappedBytes = lead + bytes;
+
+        void *chunk = mmap(0, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        char *ret = static_cast<char*>(chunk) + lead;
+        if (TOUCH) {
+            NUMA::touch(ret, bytes);
+        }
+
+        return init(ret, static_cast<char*>(chunk), mappedBytes);
+    }
+#endif
+
+    pointer init(char *block, char *chunk, std::size_t mappedBytes)
+    {
+        Header *header = reinterpret_cast<Header*>(block) - 1;
+        header->chunk = chunk;
+        header->mappedBytes = mappedBytes;
+
+        return reinterpret_cast<pointer>(block);
+    }
+};
+
+}
+
+#endif
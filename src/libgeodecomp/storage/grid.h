@@ -1,13 +1,13 @@
 #ifndef LIBGEODECOMP_STORAGE_GRID_H
 #define LIBGEODECOMP_STORAGE_GRID_H
 
-#include <libflatarray/aligned_allocator.hpp>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/storage/coordmap.h>
+#include <libgeodecomp/storage/firsttouchallocator.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <libgeodecomp/storage/selector.h>
 
@@ -54,8 +54,9 @@ public:
     using GridBase<CELL_TYPE, TOPOLOGY::DIM>::loadRegion;
     using GridBase<CELL_TYPE, TOPOLOGY::DIM>::saveRegion;
 
-    // always align on cache line boundaries
-    typedef typename std::vector<CELL_TYPE, LibFlatArray::aligned_allocator<CELL_TYPE, 64> > CellVector;
+    // always align on cache line boundaries, place pages according
+    // to NUMA::firstTouch()
+    typedef typename std::vector<CELL_TYPE, FirstTouchAllocator<CELL_TYPE, 64> > CellVector;
     typedef TOPOLOGY Topology;
     typedef CELL_TYPE Cell;
     typedef CoordMap<CELL_TYPE, Grid<CELL_TYPE, TOPOLOGY> > CoordMapType;
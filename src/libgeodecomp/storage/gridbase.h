@@ -5,8 +5,10 @@
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/streak.h>
+#include <libgeodecomp/misc/stringops.h>
 #include <libgeodecomp/storage/memorylocation.h>
 #include <libgeodecomp/storage/selector.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
 
 namespace LibGeoDecomp {
 
@@ -179,6 +181,52 @@ public:
         throw std::logic_error("loadRegion not implemented for buffers of type CELL, not an AoS grid?");
     }
 
+    /**
+     * Saves only the members given by selectors, e.g. those which
+     * neighboring cells read (see APITraits::HasHaloMembers). The
+     * members are stored one after another, each of them contiguously
+     * for all cells in region.
+     */
+    void saveRegion(
+        std::vector<char> *target,
+        const Region<DIM>& region,
+        const std::vector<Selector<CELL> >& selectors) const
+    {
+        target->resize(SerializationBuffer<CELL>::minimumStorageSize(region, selectors));
+        char *cursor = target->data();
+
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors.begin();
+             i != selectors.end();
+             ++i) {
+            saveMemberImplementation(cursor, MemoryLocation::HOST, *i, region);
+            cursor += i->sizeOfExternal() * region.size();
+        }
+    }
+
+    /**
+     * Counterpart to saveRegion() above.
+     */
+    void loadRegion(
+        const std::vector<char>& source,
+        const Region<DIM>& region,
+        const std::vector<Selector<CELL> >& selectors)
+    {
+        std::size_t expectedMinimumSize = SerializationBuffer<CELL>::minimumStorageSize(region, selectors);
+        if (source.size() < expectedMinimumSize) {
+            throw std::logic_error(
+                "source buffer too small (is " + StringOps::itoa(source.size()) +
+                ", expected at least: " + StringOps::itoa(expectedMinimumSize) + ")");
+        }
+        const char *cursor = source.data();
+
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors.begin();
+             i != selectors.end();
+             ++i) {
+            loadMemberImplementation(cursor, MemoryLocation::HOST, *i, region);
+            cursor += i->sizeOfExternal() * region.size();
+        }
+    }
+
     Coord<DIM> dimensions() const
     {
         return boundingBox().dimensions;
@@ -260,6 +308,19 @@ public:
         loadMemberImplementation(reinterpret_cast<const char*>(source), sourceLocation, selector, region);
     }
 
+    /**
+     * Counterpart to saveMemberUnchecked(): loads member data without
+     * checking the member's type against the Selector.
+     */
+    void loadMemberUnchecked(
+        const char *source,
+        MemoryLocation::Location sourceLocation,
+        const Selector<CELL>& selector,
+        const Region<DIM>& region)
+    {
+        loadMemberImplementation(source, sourceLocation, selector, region);
+    }
+
     /**
      * Through this function the weights of the edges on unstructured
      * grids can be set. Unavailable on regular grids.
@@ -4,6 +4,7 @@
 #include <libgeodecomp/config.h>
 
 #include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/paddedtorusgrid.h>
 #include <libgeodecomp/storage/reorderingunstructuredgrid.h>
 #include <libgeodecomp/storage/soagrid.h>
 #include <libgeodecomp/storage/unstructuredgrid.h>
@@ -41,6 +42,34 @@ public:
     typedef SoAGrid<CELL_TYPE, TOPOLOGY, TOPOLOGICALLY_CORRECT> Value;
 };
 
+/**
+ * Grid type selection for simulators which keep the whole simulation
+ * space in one grid (SerialSimulator, OpenMPSimulator). Other than
+ * GridTypeSelector this honors APITraits::HasPaddedTorusGrid, whose
+ * ghost frame would be wrong for grids which hold only a part of the
+ * simulation space.
+ */
+template<
+    typename CELL_TYPE,
+    typename TOPOLOGY,
+    typename SUPPORTS_SOA,
+    typename SUPPORTS_PADDED_TORUS_GRID = typename APITraits::SelectPaddedTorusGrid<CELL_TYPE>::Value>
+class MonolithicGridTypeSelector
+{
+public:
+    typedef typename GridTypeSelector<CELL_TYPE, TOPOLOGY, false, SUPPORTS_SOA>::Value Value;
+};
+
+/**
+ * see above.
+ */
+template<typename CELL_TYPE, typename TOPOLOGY>
+class MonolithicGridTypeSelector<CELL_TYPE, TOPOLOGY, APITraits::FalseType, APITraits::TrueType>
+{
+public:
+    typedef PaddedTorusGrid<CELL_TYPE, TOPOLOGY> Value;
+};
+
 #ifdef LIBGEODECOMP_WITH_CPP14
 /**
  * see above.
@@ -7,6 +7,7 @@
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/meshlesscelllist.h>
 
 namespace LibGeoDecomp {
 
@@ -30,6 +31,7 @@ public:
     typedef Grid<CoordList, TOPOLOGY> CoordListGrid;
     typedef std::vector<std::pair<FloatCoord<DIM>, int> > CoordVec;
     typedef std::vector<std::vector<int> > Graph;
+    typedef typename MeshlessCellList<TOPOLOGY>::PairVec PairVec;
 
     /**
      * creates an MeshlessAdapter which assumes that the coordinates
@@ -97,13 +99,66 @@ public:
         for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
             const CoordList& list = positions[*i];
             for (typename CoordList::const_iterator j = list.begin(); j != list.end(); ++j) {
-                ret.push_back(*i);
+                ret.push_back(*j);
             }
         }
 
         return ret;
     }
 
+    /**
+     * Bins all positions into a MeshlessCellList whose cutoff is the
+     * box size. The cell list enumerates vertices by their index in
+     * positions, not by their IDs.
+     */
+    MeshlessCellList<TOPOLOGY> cellList(const CoordVec& positions) const
+    {
+        std::vector<FloatCoord<DIM> > coords;
+        coords.reserve(positions.size());
+        for (typename CoordVec::const_iterator i = positions.begin(); i != positions.end(); ++i) {
+            coords.push_back(i->first);
+        }
+
+        MeshlessCellList<TOPOLOGY> ret(dimensions, boxSize);
+        ret.rebuild(coords);
+        return ret;
+    }
+
+    /**
+     * Returns all pairs of vertex IDs (i, j) with i < j whose
+     * vertices are closer to each other than the box size. Unlike
+     * repeated calls to search() this doesn't build a std::set per
+     * vertex, but bins all positions into a MeshlessCellList.
+     */
+    PairVec findAllPairs(const CoordVec& positions) const
+    {
+        PairVec ret = cellList(positions).findAllPairs();
+
+        for (typename PairVec::iterator i = ret.begin(); i != ret.end(); ++i) {
+            int a = positions[i->first].second;
+            int b = positions[i->second].second;
+            *i = std::make_pair((std::min)(a, b), (std::max)(a, b));
+        }
+
+        return ret;
+    }
+
+    /**
+     * Returns the adjacency lists of all vertices which are closer
+     * to each other than the box size. Like the Graph passed to
+     * findOptimumBoxSize(), lists are indexed by and refer to
+     * positions in the given vector.
+     */
+    inline Graph findAllNeighbors(const CoordVec& positions) const
+    {
+        return cellList(positions).neighborGraph();
+    }
+
+    inline PairVec findAllPairs(const CoordListGrid& positions) const
+    {
+        return findAllPairs(findAllPositions(positions));
+    }
+
     double findOptimumBoxSize(
         const CoordVec& positions,
         const Graph& graph)
@@ -202,24 +257,22 @@ public:
 
     std::map<std::string, double> reportFillLevels(const CoordVec& positions) const
     {
-        std::map<Coord<DIM>, int> cache;
+        std::vector<int> cache(discreteDim.prod(), 0);
         for (typename CoordVec::const_iterator i = positions.begin(); i != positions.end(); ++i) {
-            Coord<DIM> c = posToCoord(*i);
-            cache[c]++;
+            ++cache[posToCoord(i->first).toIndex(discreteDim)];
         }
 
         long sum = 0;
         long emptyCells = 0;
-        int lowestFill = cache[Coord<DIM>()];
-        int highestFill = cache[Coord<DIM>()];
-        CoordBox<DIM> box(Coord<DIM>(), discreteDim);
+        int lowestFill = cache[0];
+        int highestFill = cache[0];
 
-        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
-            lowestFill  = (std::min)(cache[*i], lowestFill);
-            highestFill = (std::max)(cache[*i], highestFill);
-            sum += cache[*i];
+        for (std::size_t i = 0; i < cache.size(); ++i) {
+            lowestFill  = (std::min)(cache[i], lowestFill);
+            highestFill = (std::max)(cache[i], highestFill);
+            sum += cache[i];
 
-            if (cache[*i] == 0) {
+            if (cache[i] == 0) {
                 ++emptyCells;
             }
         }
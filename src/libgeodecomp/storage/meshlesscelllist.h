@@ -0,0 +1,436 @@
+#ifndef LIBGEODECOMP_STORAGE_MESHLESSCELLLIST_H
+#define LIBGEODECOMP_STORAGE_MESHLESSCELLLIST_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/floatcoord.h>
+#include <libgeodecomp/geometry/topologies.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Cell list for neighbor searches on large sets of particles, as
+ * needed when porting meshless codes (see
+ * MeshlessAdapter::findAllPairs()).
+ * Particles are binned into boxes of at least (cutoff + skin) edge
+ * length via a counting sort, so all data lives in contiguous arrays:
+ * binOffsets() delimits each bin's range in particleIDs() (CSR
+ * format) and the particles' positions are stored per dimension in
+ * the same order.
+ *
+ * As long as no particle has moved further than skin/2 since the
+ * last binning, update() merely refreshes the positions and keeps
+ * the bins -- no pair within the cutoff can have escaped the
+ * neighboring bins yet.
+ */
+template<class TOPOLOGY=Topologies::Torus<2>::Topology>
+class MeshlessCellList
+{
+public:
+    static const int DIM = TOPOLOGY::DIM;
+
+    typedef std::vector<FloatCoord<DIM> > PositionVec;
+    typedef std::vector<std::vector<int> > Graph;
+    typedef std::vector<std::pair<int, int> > PairVec;
+
+    /**
+     * Particle coordinates are expected to be elementwise smaller
+     * than dimensions and non-negative. Particles farther outside are
+     * binned into the boundary bins.
+     */
+    inline MeshlessCellList(
+        const FloatCoord<DIM>& dimensions,
+        double cutoff,
+        double skin = 0) :
+        dimensions(dimensions),
+        cutoff2(cutoff * cutoff),
+        skin(skin)
+    {
+        if ((cutoff <= 0) || (skin < 0)) {
+            throw std::invalid_argument("cutoff must be positive and skin non-negative");
+        }
+
+        double binSize = cutoff + skin;
+        std::size_t numBins = 1;
+        for (int d = 0; d < DIM; ++d) {
+            binDim[d] = (std::max)(1, int(std::floor(dimensions[d] / binSize)));
+            scale[d] = binDim[d] / dimensions[d];
+            numBins *= binDim[d];
+        }
+
+        offsets.resize(numBins + 1, 0);
+        initNeighborBins();
+    }
+
+    /**
+     * Bins all particles from scratch.
+     */
+    void rebuild(const PositionVec& newPositions)
+    {
+        std::size_t numParticles = newPositions.size();
+        std::size_t numBins = binDim.prod();
+        std::vector<int> binOf(numParticles);
+
+        // per chunk histograms keep the sort stable and free of
+        // atomics, but aren't worth it if bins outnumber particles.
+        // The runtime may start fewer threads than requested, so
+        // chunks are dealt out to the actual team:
+        int numChunks = 1;
+#ifdef LIBGEODECOMP_WITH_THREADS
+        numChunks = int((std::min)(
+                            std::size_t(omp_get_max_threads()),
+                            (std::max)(std::size_t(1), numParticles / numBins)));
+#endif
+        std::vector<std::size_t> cursors(numChunks * numBins, 0);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel num_threads(numChunks)
+#endif
+        {
+            for (int chunk = threadID(); chunk < numChunks; chunk += teamSize()) {
+                std::size_t *histogram = &cursors[chunk * numBins];
+
+                for (std::size_t i = chunkStart(chunk, numChunks, numParticles);
+                     i < chunkStart(chunk + 1, numChunks, numParticles);
+                     ++i) {
+                    binOf[i] = binIndex(newPositions[i]);
+                    ++histogram[binOf[i]];
+                }
+            }
+        }
+
+        std::size_t sum = 0;
+        for (std::size_t bin = 0; bin < numBins; ++bin) {
+            offsets[bin] = sum;
+            for (int chunk = 0; chunk < numChunks; ++chunk) {
+                std::size_t count = cursors[chunk * numBins + bin];
+                cursors[chunk * numBins + bin] = sum;
+                sum += count;
+            }
+        }
+        offsets[numBins] = sum;
+
+        ids.resize(numParticles);
+        for (int d = 0; d < DIM; ++d) {
+            positions[d].resize(numParticles);
+        }
+        referencePositions = newPositions;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel num_threads(numChunks)
+#endif
+        {
+            for (int chunk = threadID(); chunk < numChunks; chunk += teamSize()) {
+                std::size_t *cursor = &cursors[chunk * numBins];
+
+                for (std::size_t i = chunkStart(chunk, numChunks, numParticles);
+                     i < chunkStart(chunk + 1, numChunks, numParticles);
+                     ++i) {
+                    std::size_t slot = cursor[binOf[i]]++;
+                    ids[slot] = int(i);
+                    for (int d = 0; d < DIM; ++d) {
+                        positions[d][slot] = newPositions[i][d];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Refreshes the positions. Returns true if the particles had to
+     * be re-binned, false if the bins could be kept.
+     */
+    bool update(const PositionVec& newPositions)
+    {
+        if ((newPositions.size() != referencePositions.size()) ||
+            (maxDisplacement2(newPositions) * 4 > skin * skin)) {
+            rebuild(newPositions);
+            return true;
+        }
+
+        long numParticles = long(ids.size());
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (long slot = 0; slot < numParticles; ++slot) {
+            for (int d = 0; d < DIM; ++d) {
+                positions[d][slot] = newPositions[ids[slot]][d];
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Returns all pairs (i, j) with i < j whose distance is smaller
+     * than the cutoff. Bins are processed in parallel, the output
+     * is deterministic nonetheless.
+     */
+    PairVec findAllPairs() const
+    {
+        std::size_t numBins = binDim.prod();
+        std::vector<PairVec> buffers(numBins);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (long bin = 0; bin < long(numBins); ++bin) {
+            PairVec& buffer = buffers[bin];
+            for (std::size_t n = neighborOffsets[bin]; n < neighborOffsets[bin + 1]; ++n) {
+                std::size_t other = neighborBins[n];
+                // visit each pair of bins only once:
+                if (other < std::size_t(bin)) {
+                    continue;
+                }
+
+                for (std::size_t i = offsets[bin]; i < offsets[bin + 1]; ++i) {
+                    std::size_t j = (other == std::size_t(bin)) ? (i + 1) : offsets[other];
+                    for (; j < offsets[other + 1]; ++j) {
+                        if (distance2(i, j) < cutoff2) {
+                            buffer.push_back(std::make_pair(
+                                                 (std::min)(ids[i], ids[j]),
+                                                 (std::max)(ids[i], ids[j])));
+                        }
+                    }
+                }
+            }
+        }
+
+        std::size_t numPairs = 0;
+        for (std::size_t bin = 0; bin < numBins; ++bin) {
+            numPairs += buffers[bin].size();
+        }
+
+        PairVec ret;
+        ret.reserve(numPairs);
+        for (std::size_t bin = 0; bin < numBins; ++bin) {
+            ret.insert(ret.end(), buffers[bin].begin(), buffers[bin].end());
+            PairVec().swap(buffers[bin]);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Builds the adjacency lists of all particles, indexed by their
+     * IDs and sorted. Every particle's list is written by exactly one
+     * thread.
+     */
+    Graph neighborGraph() const
+    {
+        std::size_t numBins = binDim.prod();
+        Graph ret(ids.size());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (long bin = 0; bin < long(numBins); ++bin) {
+            for (std::size_t i = offsets[bin]; i < offsets[bin + 1]; ++i) {
+                std::vector<int>& neighbors = ret[ids[i]];
+
+                for (std::size_t n = neighborOffsets[bin]; n < neighborOffsets[bin + 1]; ++n) {
+                    std::size_t other = neighborBins[n];
+                    for (std::size_t j = offsets[other]; j < offsets[other + 1]; ++j) {
+                        if ((i != j) && (distance2(i, j) < cutoff2)) {
+                            neighbors.push_back(ids[j]);
+                        }
+                    }
+                }
+
+                std::sort(neighbors.begin(), neighbors.end());
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Same statistics as MeshlessAdapter::reportFillLevels().
+     */
+    std::map<std::string, double> reportFillLevels() const
+    {
+        std::size_t numBins = binDim.prod();
+        std::size_t lowestFill = offsets[1] - offsets[0];
+        std::size_t highestFill = lowestFill;
+        std::size_t emptyCells = 0;
+
+        for (std::size_t bin = 0; bin < numBins; ++bin) {
+            std::size_t fill = offsets[bin + 1] - offsets[bin];
+            lowestFill  = (std::min)(lowestFill,  fill);
+            highestFill = (std::max)(highestFill, fill);
+            if (fill == 0) {
+                ++emptyCells;
+            }
+        }
+
+        std::map<std::string, double> ret;
+        ret["emptyCells"]  = emptyCells;
+        ret["averageFill"] = 1.0 * ids.size() / numBins;
+        ret["lowestFill"]  = lowestFill;
+        ret["highestFill"] = highestFill;
+        return ret;
+    }
+
+    inline const Coord<DIM>& getBinDim() const
+    {
+        return binDim;
+    }
+
+    /**
+     * Bin i holds the particles particleIDs()[binOffsets()[i]] up to
+     * (excluding) particleIDs()[binOffsets()[i + 1]].
+     */
+    inline const std::vector<std::size_t>& binOffsets() const
+    {
+        return offsets;
+    }
+
+    inline const std::vector<int>& particleIDs() const
+    {
+        return ids;
+    }
+
+    /**
+     * Component d of all particles' positions, in bin order.
+     */
+    inline const std::vector<double>& positionComponent(int d) const
+    {
+        return positions[d];
+    }
+
+    inline std::size_t binIndex(const FloatCoord<DIM>& pos) const
+    {
+        Coord<DIM> c;
+        for (int d = 0; d < DIM; ++d) {
+            c[d] = (std::max)(0, (std::min)(binDim[d] - 1, int(pos[d] * scale[d])));
+        }
+
+        return c.toIndex(binDim);
+    }
+
+private:
+    FloatCoord<DIM> dimensions;
+    Coord<DIM> binDim;
+    FloatCoord<DIM> scale;
+    double cutoff2;
+    double skin;
+
+    std::vector<std::size_t> offsets;
+    std::vector<int> ids;
+    std::vector<double> positions[DIM];
+    PositionVec referencePositions;
+
+    // CSR list of each bin's Moore neighborhood (including itself),
+    // wrapped and deduplicated according to the topology:
+    std::vector<std::size_t> neighborOffsets;
+    std::vector<std::size_t> neighborBins;
+
+    void initNeighborBins()
+    {
+        CoordBox<DIM> box(Coord<DIM>(), binDim);
+        CoordBox<DIM> stencil(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+        std::vector<std::size_t> buffer;
+
+        neighborOffsets.clear();
+        neighborBins.clear();
+
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            neighborOffsets.push_back(neighborBins.size());
+            buffer.clear();
+
+            for (typename CoordBox<DIM>::Iterator j = stencil.begin(); j != stencil.end(); ++j) {
+                Coord<DIM> neighbor = TOPOLOGY::normalize(*i + *j, binDim);
+                if (TOPOLOGY::isOutOfBounds(neighbor, binDim)) {
+                    continue;
+                }
+                buffer.push_back(neighbor.toIndex(binDim));
+            }
+
+            std::sort(buffer.begin(), buffer.end());
+            buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+            neighborBins.insert(neighborBins.end(), buffer.begin(), buffer.end());
+        }
+
+        neighborOffsets.push_back(neighborBins.size());
+    }
+
+    static inline int threadID()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    static inline int teamSize()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        return omp_get_num_threads();
+#else
+        return 1;
+#endif
+    }
+
+    static inline std::size_t chunkStart(int chunk, int numChunks, std::size_t size)
+    {
+        return size * chunk / numChunks;
+    }
+
+    /**
+     * Squared distance of the particles in slots i and j.
+     */
+    inline double distance2(std::size_t i, std::size_t j) const
+    {
+        double dist2 = 0;
+
+        for (int d = 0; d < DIM; ++d) {
+            double delta = std::abs(positions[d][i] - positions[d][j]);
+            if (TOPOLOGY::wrapsAxis(d)) {
+                delta = (std::min)(delta, dimensions[d] - delta);
+            }
+            dist2 += delta * delta;
+        }
+
+        return dist2;
+    }
+
+    double maxDisplacement2(const PositionVec& newPositions) const
+    {
+        double ret = 0;
+        long numParticles = long(newPositions.size());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static) reduction(max:ret)
+#endif
+        for (long i = 0; i < numParticles; ++i) {
+            double dist2 = 0;
+            for (int d = 0; d < DIM; ++d) {
+                double delta = std::abs(newPositions[i][d] - referencePositions[i][d]);
+                if (TOPOLOGY::wrapsAxis(d)) {
+                    delta = (std::min)(delta, dimensions[d] - delta);
+                }
+                dist2 += delta * delta;
+            }
+            ret = (std::max)(ret, dist2);
+        }
+
+        return ret;
+    }
+};
+
+}
+
+#endif
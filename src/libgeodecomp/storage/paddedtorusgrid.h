@@ -0,0 +1,385 @@
+#ifndef LIBGEODECOMP_STORAGE_PADDEDTORUSGRID_H
+#define LIBGEODECOMP_STORAGE_PADDEDTORUSGRID_H
+
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/topologies.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/coordmap.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/gridbase.h>
+#include <libgeodecomp/storage/selector.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace LibGeoDecomp {
+
+#ifdef _MSC_BUILD
+#pragma warning( push )
+#pragma warning( disable : 4820 )
+#endif
+
+/**
+ * A grid for models with periodic boundary conditions (e.g.
+ * Topologies::Torus) which surrounds the cells with a ghost frame as
+ * wide as the stencil's radius. refreshGhostFrame() copies the
+ * opposite sides of the grid into this frame (in bulk: whole planes
+ * and rows where possible), so that all reads in the vicinity of the
+ * grid work via plain pointer offsets instead of normalizing
+ * coordinates on every access. Axes which don't wrap get their frame
+ * filled with the edge cell.
+ *
+ * The frame has to be refreshed whenever the cells inside the grid
+ * have changed and before neighbors are read, i.e. typically once
+ * per nano step. Coordinates farther than the stencil's radius
+ * outside of the grid must not be accessed.
+ *
+ * This grid is meant for simulators which store the whole simulation
+ * space in one grid (SerialSimulator, OpenMPSimulator). Models
+ * request it via APITraits::HasPaddedTorusGrid.
+ */
+template<typename CELL_TYPE, typename TOPOLOGY=Topologies::Torus<2>::Topology>
+class PaddedTorusGrid : public GridBase<CELL_TYPE, TOPOLOGY::DIM>
+{
+public:
+    const static int DIM = TOPOLOGY::DIM;
+    const static int RADIUS = APITraits::SelectStencil<CELL_TYPE>::Value::RADIUS;
+
+    typedef CELL_TYPE Cell;
+    typedef TOPOLOGY Topology;
+    typedef typename Grid<CELL_TYPE, TOPOLOGY>::CellVector CellVector;
+    typedef CoordMap<CELL_TYPE, PaddedTorusGrid<CELL_TYPE, TOPOLOGY> > CoordMapType;
+
+    using GridBase<CELL_TYPE, TOPOLOGY::DIM>::loadRegion;
+    using GridBase<CELL_TYPE, TOPOLOGY::DIM>::saveRegion;
+
+    explicit PaddedTorusGrid(
+        const CoordBox<DIM>& box = CoordBox<DIM>(),
+        const CELL_TYPE& defaultCell = CELL_TYPE(),
+        const CELL_TYPE& edgeCell = CELL_TYPE(),
+        const Coord<DIM>& topologicalDimensions = Coord<DIM>()) :
+        GridBase<CELL_TYPE, TOPOLOGY::DIM>(topologicalDimensions),
+        edgeCell(edgeCell)
+    {
+        resize(box, defaultCell);
+    }
+
+    explicit PaddedTorusGrid(
+        const Region<DIM>& region,
+        const CELL_TYPE& defaultCell = CELL_TYPE(),
+        const CELL_TYPE& edgeCell = CELL_TYPE(),
+        const Coord<DIM>& topologicalDimensions = Coord<DIM>()) :
+        GridBase<CELL_TYPE, TOPOLOGY::DIM>(topologicalDimensions),
+        edgeCell(edgeCell)
+    {
+        resize(region.boundingBox(), defaultCell);
+    }
+
+    inline void resize(const CoordBox<DIM>& newBox)
+    {
+        resize(newBox, CELL_TYPE());
+    }
+
+    /**
+     * Copies the cells along the grid's boundaries to the opposite
+     * side of the ghost frame, one axis after another. Each axis'
+     * copies include the frame sections written by the preceding
+     * axes, so edges and corners are covered, too.
+     */
+    inline void refreshGhostFrame()
+    {
+        if (box.dimensions.prod() == 0) {
+            return;
+        }
+
+        for (int d = 0; d < DIM; ++d) {
+            refreshAxis(d);
+        }
+    }
+
+    /**
+     * Return a pointer to the underlying data storage (which starts
+     * with the ghost frame). Use with care!
+     */
+    inline
+    CELL_TYPE *data()
+    {
+        return cellVector.data();
+    }
+
+    /**
+     * Return a const pointer to the underlying data storage (which
+     * starts with the ghost frame). Use with care!
+     */
+    inline
+    const CELL_TYPE *data() const
+    {
+        return cellVector.data();
+    }
+
+    inline const Coord<DIM>& getPaddedDimensions() const
+    {
+        return paddedDimensions;
+    }
+
+    inline CELL_TYPE& getEdgeCell()
+    {
+        return edgeCell;
+    }
+
+    inline const CELL_TYPE& getEdgeCell() const
+    {
+        return edgeCell;
+    }
+
+    inline CELL_TYPE& operator[](const Coord<DIM>& absoluteCoord)
+    {
+        return cellVector[(absoluteCoord - frameOrigin).toIndex(paddedDimensions)];
+    }
+
+    inline const CELL_TYPE& operator[](const Coord<DIM>& absoluteCoord) const
+    {
+        return cellVector[(absoluteCoord - frameOrigin).toIndex(paddedDimensions)];
+    }
+
+    inline CoordMapType getNeighborhood(const Coord<DIM>& center) const
+    {
+        return CoordMapType(center, this);
+    }
+
+    virtual void set(const Coord<DIM>& coord, const CELL_TYPE& cell)
+    {
+        (*this)[coord] = cell;
+    }
+
+    virtual void set(const Streak<DIM>& streak, const CELL_TYPE *cells)
+    {
+        std::copy(cells, cells + streak.length(), &(*this)[streak.origin]);
+    }
+
+    virtual CELL_TYPE get(const Coord<DIM>& coord) const
+    {
+        return (*this)[coord];
+    }
+
+    virtual void get(const Streak<DIM>& streak, CELL_TYPE *cells) const
+    {
+        const CELL_TYPE *source = &(*this)[streak.origin];
+        std::copy(source, source + streak.length(), cells);
+    }
+
+    virtual void setEdge(const CELL_TYPE& cell)
+    {
+        edgeCell = cell;
+    }
+
+    virtual const CELL_TYPE& getEdge() const
+    {
+        return edgeCell;
+    }
+
+    inline const Coord<DIM>& getDimensions() const
+    {
+        return box.dimensions;
+    }
+
+    virtual CoordBox<DIM> boundingBox() const
+    {
+        return box;
+    }
+
+    void saveRegion(
+        std::vector<CELL_TYPE> *buffer,
+        const Region<DIM>& region,
+        const Coord<DIM>& offset = Coord<DIM>()) const
+    {
+        CELL_TYPE *target = buffer->data();
+
+        typename Region<DIM>::StreakIterator end = region.endStreak(offset);
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(offset); i != end; ++i) {
+            get(*i, target);
+            target += i->length();
+        }
+    }
+
+    void loadRegion(
+        const std::vector<CELL_TYPE>& buffer,
+        const Region<DIM>& region,
+        const Coord<DIM>& offset = Coord<DIM>())
+    {
+        const CELL_TYPE *source = buffer.data();
+
+        typename Region<DIM>::StreakIterator end = region.endStreak(offset);
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(offset); i != end; ++i) {
+            set(*i, source);
+            source += i->length();
+        }
+    }
+
+    inline std::string toString() const
+    {
+        std::ostringstream message;
+        message << "PaddedTorusGrid<" << DIM << ">(\n"
+                << "  boundingBox: " << box << "\n"
+                << "  paddedDimensions: " << paddedDimensions << "\n"
+                << ")";
+        return message.str();
+    }
+
+protected:
+    void saveMemberImplementation(
+        char *target,
+        MemoryLocation::Location targetLocation,
+        const Selector<CELL_TYPE>& selector,
+        const Region<DIM>& region) const
+    {
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            selector.copyMemberOut(
+                &(*this)[i->origin],
+                MemoryLocation::HOST,
+                target,
+                targetLocation,
+                std::size_t(i->length()));
+            target += selector.sizeOfExternal() * i->length();
+        }
+    }
+
+    void loadMemberImplementation(
+        const char *source,
+        MemoryLocation::Location sourceLocation,
+        const Selector<CELL_TYPE>& selector,
+        const Region<DIM>& region)
+    {
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            selector.copyMemberIn(
+                source,
+                sourceLocation,
+                &(*this)[i->origin],
+                MemoryLocation::HOST,
+                std::size_t(i->length()));
+            source += selector.sizeOfExternal() * i->length();
+        }
+    }
+
+private:
+    CoordBox<DIM> box;
+    Coord<DIM> frameOrigin;
+    Coord<DIM> paddedDimensions;
+    CellVector cellVector;
+    CELL_TYPE edgeCell;
+
+    inline void resize(const CoordBox<DIM>& newBox, const CELL_TYPE& defaultCell)
+    {
+        box = newBox;
+        frameOrigin = box.origin - Coord<DIM>::diagonal(RADIUS);
+        paddedDimensions = box.dimensions + Coord<DIM>::diagonal(2 * RADIUS);
+        cellVector.assign(std::size_t(paddedDimensions.prod()), defaultCell);
+    }
+
+    /**
+     * A slab is the set of cells sharing the same index along axis
+     * d. Within the rows/planes of the higher axes the cells of a
+     * slab are contiguous, so they can be copied en bloc.
+     */
+    inline void refreshAxis(int d)
+    {
+        std::size_t slabStride = 1;
+        for (int e = 0; e < d; ++e) {
+            slabStride *= std::size_t(paddedDimensions[e]);
+        }
+
+        std::size_t outerCount = 1;
+        for (int e = d + 1; e < DIM; ++e) {
+            outerCount *= std::size_t(box.dimensions[e]);
+        }
+
+        int length = box.dimensions[d];
+        bool wraps = Topology::wrapsAxis(d);
+
+        for (std::size_t outer = 0; outer < outerCount; ++outer) {
+            // higher axes only need to be refreshed within the grid,
+            // their frame will be filled when refreshing these axes:
+            std::size_t offset = 0;
+            std::size_t remainder = outer;
+            std::size_t stride = slabStride * std::size_t(paddedDimensions[d]);
+            for (int e = d + 1; e < DIM; ++e) {
+                std::size_t index = remainder % std::size_t(box.dimensions[e]);
+                remainder /= std::size_t(box.dimensions[e]);
+                offset += (index + RADIUS) * stride;
+                stride *= std::size_t(paddedDimensions[e]);
+            }
+
+            CELL_TYPE *slabs = &cellVector[offset];
+            for (int i = 0; i < RADIUS; ++i) {
+                CELL_TYPE *lower = slabs + std::size_t(i) * slabStride;
+                CELL_TYPE *upper = slabs + std::size_t(RADIUS + length + i) * slabStride;
+
+                if (!wraps) {
+                    std::fill(lower, lower + slabStride, edgeCell);
+                    std::fill(upper, upper + slabStride, edgeCell);
+                    continue;
+                }
+
+                const CELL_TYPE *lowerSource = slabs +
+                    std::size_t(RADIUS + modulo(i - RADIUS, length)) * slabStride;
+                const CELL_TYPE *upperSource = slabs +
+                    std::size_t(RADIUS + modulo(i, length)) * slabStride;
+                std::copy(lowerSource, lowerSource + slabStride, lower);
+                std::copy(upperSource, upperSource + slabStride, upper);
+            }
+        }
+    }
+
+    static inline int modulo(int value, int divisor)
+    {
+        return ((value % divisor) + divisor) % divisor;
+    }
+};
+
+#ifdef _MSC_BUILD
+#pragma warning( pop )
+#endif
+
+namespace PaddedTorusGridHelpers {
+
+/**
+ * Lets simulators refresh the ghost frame regardless of whether
+ * their grid type actually has one. This is the no-op for all other
+ * grids.
+ */
+template<typename GRID>
+class RefreshGhostFrame
+{
+public:
+    void operator()(GRID * /* grid */) const
+    {}
+};
+
+/**
+ * see above
+ */
+template<typename CELL_TYPE, typename TOPOLOGY>
+class RefreshGhostFrame<PaddedTorusGrid<CELL_TYPE, TOPOLOGY> >
+{
+public:
+    void operator()(PaddedTorusGrid<CELL_TYPE, TOPOLOGY> *grid) const
+    {
+        grid->refreshGhostFrame();
+    }
+};
+
+}
+
+}
+
+template<typename _CharT, typename _Traits, typename _CellT, typename _Topology>
+std::basic_ostream<_CharT, _Traits>&
+operator<<(std::basic_ostream<_CharT, _Traits>& __os,
+           const LibGeoDecomp::PaddedTorusGrid<_CellT, _Topology>& grid)
+{
+    __os << grid.toString();
+    return __os;
+}
+
+#endif
@@ -5,6 +5,8 @@
 #ifdef LIBGEODECOMP_WITH_CPP14
 
 #include <algorithm>
+#include <mutex>
+#include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
 #include <libgeodecomp/storage/sellcsigmasparsematrixcontainer.h>
 
@@ -16,80 +18,181 @@ namespace ReorderingUnstructuredGridHelpers {
 
 typedef std::pair<int, int> IntPair;
 
-inline
-std::vector<IntPair>::const_iterator mapLogicalToPhysicalID(int logicalID, const std::vector<IntPair>& logicalToPhysicalIDs)
-{
-    std::vector<IntPair>::const_iterator pos = std::lower_bound(
-        logicalToPhysicalIDs.begin(), logicalToPhysicalIDs.end(), logicalID,
-        [](const IntPair& a, const int logicalID) {
-            return a.first < logicalID;
-        });
-
-    if (pos->first != logicalID) {
-        return logicalToPhysicalIDs.end();
-    }
-
-    return pos;
-}
-
 /**
- * Helper class which converts logical coordinates to physical ones
- * (i.e. those that are actually used to address memory).
+ * Maps logical IDs to physical IDs in constant time. The table is
+ * split into blocks of BLOCK_SIZE consecutive logical IDs, and only
+ * blocks which contain at least one ID get allocated. This keeps
+ * memory consumption in check for node sets which are scattered
+ * (e.g. ghost zones of unstructured meshes).
  */
-template<int DIM>
-class ReorderingRegionIterator
+class IDMap
 {
 public:
-    inline
-    ReorderingRegionIterator(const Region<1>::Iterator& iter, const std::vector<IntPair>& logicalToPhysicalIDs) :
-        iter(iter),
-        logicalToPhysicalIDs(logicalToPhysicalIDs)
-    {
-        updateOrigin();
-    }
+    static const int BLOCK_BITS = 8;
+    static const int BLOCK_SIZE = 1 << BLOCK_BITS;
 
-    inline
-    int length() const
+    IDMap() :
+        minID(0)
+    {}
+
+    /**
+     * Expects logicalToPhysicalIDs to be sorted by logical ID.
+     */
+    explicit IDMap(const std::vector<IntPair>& logicalToPhysicalIDs) :
+        minID(0)
     {
-        return 1;
+        if (logicalToPhysicalIDs.empty()) {
+            return;
+        }
+
+        minID = logicalToPhysicalIDs.front().first;
+        int numBlocks = ((logicalToPhysicalIDs.back().first - minID) >> BLOCK_BITS) + 1;
+        blockOffsets.resize(numBlocks, -1);
+
+        for (std::vector<IntPair>::const_iterator i = logicalToPhysicalIDs.begin();
+             i != logicalToPhysicalIDs.end();
+             ++i) {
+            int relativeID = i->first - minID;
+            int& blockOffset = blockOffsets[relativeID >> BLOCK_BITS];
+            if (blockOffset == -1) {
+                blockOffset = physicalIDs.size();
+                physicalIDs.resize(physicalIDs.size() + BLOCK_SIZE, -1);
+            }
+
+            physicalIDs[blockOffset + (relativeID & (BLOCK_SIZE - 1))] = i->second;
+        }
     }
 
+    /**
+     * Returns the physical ID or -1 if logicalID is unknown.
+     */
     inline
-    void operator++()
+    int operator[](int logicalID) const
     {
-        ++iter;
-        updateOrigin();
+        int relativeID = logicalID - minID;
+        if (relativeID < 0) {
+            return -1;
+        }
+
+        std::size_t block = relativeID >> BLOCK_BITS;
+        if (block >= blockOffsets.size()) {
+            return -1;
+        }
+
+        int blockOffset = blockOffsets[block];
+        if (blockOffset == -1) {
+            return -1;
+        }
+
+        return physicalIDs[blockOffset + (relativeID & (BLOCK_SIZE - 1))];
     }
 
-    inline
-    const ReorderingRegionIterator *operator->() const
+private:
+    int minID;
+    std::vector<int> blockOffsets;
+    std::vector<int> physicalIDs;
+};
+
+/**
+ * Caches the physical streaks which correspond to a Region of
+ * logical IDs. Halo exchange and output touch the same Regions over
+ * and over again, so saveRegion()/loadRegion() can then copy whole
+ * streaks instead of looking up each ID individually. Streaks are
+ * stored in the order of the Region's IDs (which is the order of
+ * the buffer), physically consecutive IDs are merged.
+ *
+ * The cache is filled from const accessors which may run
+ * concurrently (e.g. a Writer saving a Region while a PatchLink
+ * packs a ghost zone), hence all accesses are serialized. Streaks
+ * are handed out via shared pointers so they remain valid even if
+ * their entry is evicted meanwhile. Copies of a cache start empty.
+ */
+template<typename STREAK>
+class PhysicalRegionCache
+{
+public:
+    typedef typename SharedPtr<const std::vector<STREAK> >::Type StreakVecPtr;
+
+    static const std::size_t MAX_ENTRIES = 16;
+
+    PhysicalRegionCache() :
+        nextVictim(0)
+    {}
+
+    PhysicalRegionCache(const PhysicalRegionCache& /* other */) :
+        nextVictim(0)
+    {}
+
+    PhysicalRegionCache& operator=(const PhysicalRegionCache& /* other */)
     {
-        return this;
+        clear();
+        return *this;
     }
 
-    inline
-    Streak<DIM> operator*() const
+    StreakVecPtr operator()(const Region<1>& region, const IDMap& idMap)
     {
-        return Streak<DIM>(origin, origin.x() + 1);
-    }
+        std::lock_guard<std::mutex> lock(mutex);
 
-    Coord<DIM> origin;
+        for (typename std::vector<Entry>::iterator i = entries.begin(); i != entries.end(); ++i) {
+            if (i->first == region) {
+                return i->second;
+            }
+        }
 
-    inline
-    bool operator!=(const ReorderingRegionIterator& other)
+        // translate first so a failed translation won't leave a
+        // bogus entry behind:
+        std::vector<STREAK> *streaks = new std::vector<STREAK>;
+        StreakVecPtr ret(streaks);
+        translate(region, idMap, streaks);
+
+        Entry *entry;
+        if (entries.size() < MAX_ENTRIES) {
+            entries.push_back(Entry());
+            entry = &entries.back();
+        } else {
+            entry = &entries[nextVictim];
+            nextVictim = (nextVictim + 1) % MAX_ENTRIES;
+        }
+
+        entry->first = region;
+        entry->second = ret;
+        return ret;
+    }
+
+    void clear()
     {
-        return iter != other.iter;
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        nextVictim = 0;
     }
 
 private:
-    Region<1>::Iterator iter;
-    const std::vector<IntPair>& logicalToPhysicalIDs;
+    typedef std::pair<Region<1>, StreakVecPtr> Entry;
 
-    void updateOrigin()
+    std::vector<Entry> entries;
+    std::size_t nextVictim;
+    std::mutex mutex;
+
+    static void translate(const Region<1>& region, const IDMap& idMap, std::vector<STREAK> *streaks)
     {
-        std::vector<IntPair>::const_iterator i = mapLogicalToPhysicalID(iter->x(), logicalToPhysicalIDs);
-        if (i != logicalToPhysicalIDs.end()) {
-            origin.x() = i->second;
+        streaks->clear();
+
+        for (Region<1>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            for (int logicalID = i->origin.x(); logicalID != i->endX; ++logicalID) {
+                int physicalID = idMap[logicalID];
+                if (physicalID == -1) {
+                    throw std::logic_error("cannot remap Coord from Region -- Region needs to be a subset of nodeSet");
+                }
+
+                if (!streaks->empty() && (streaks->back().endX == physicalID)) {
+                    ++streaks->back().endX;
+                } else {
+                    STREAK streak;
+                    streak.origin.x() = physicalID;
+                    streak.endX = physicalID + 1;
+                    *streaks << streak;
+                }
+            }
         }
     }
 };
@@ -107,7 +210,7 @@ template<>
 class Selector<APITraits::TrueType>
 {
 public:
-    typedef ReorderingRegionIterator<3> Value;
+    typedef Streak<3> Value;
 };
 
 /**
@@ -117,7 +220,7 @@ template<>
 class Selector<APITraits::FalseType>
 {
 public:
-    typedef ReorderingRegionIterator<1> Value;
+    typedef Streak<1> Value;
 };
 
 }
@@ -129,8 +232,9 @@ public:
  * and make the order yielded from the partial sortation in the
  * SELL-C-SIGMA format match the physical memory layout.
  *
- * This reordering slows down get()/set() and possibly
- * loadRegion()/saveRegion(). Cell updates should not be harmed as the
+ * IDs are translated via a lookup table, so get()/set() take
+ * constant time. loadRegion()/saveRegion() cache the physical streaks
+ * of recently used Regions. Cell updates should not be harmed as the
  * update functor needs to use reordered Regions anyway.
  *
  * One size fits both, SoA and AoS. SIGMA > 1 is only really relevant
@@ -155,7 +259,9 @@ public:
     typedef typename DELEGATE_GRID::WeightType WeightType;
     typedef typename APITraits::SelectSoA<CellType>::Value SoAFlag;
     typedef typename SerializationBuffer<CellType>::BufferType BufferType;
-    typedef typename ReorderingUnstructuredGridHelpers::Selector<SoAFlag>::Value ReorderingRegionIterator;
+    typedef typename ReorderingUnstructuredGridHelpers::Selector<SoAFlag>::Value PhysicalStreak;
+    typedef std::vector<PhysicalStreak> PhysicalStreakVec;
+    typedef typename ReorderingUnstructuredGridHelpers::PhysicalRegionCache<PhysicalStreak>::StreakVecPtr PhysicalStreakVecPtr;
 
     typedef std::pair<int, int> IntPair;
 
@@ -185,6 +291,7 @@ public:
                 ++physicalID;
             }
         }
+        idMap = ReorderingUnstructuredGridHelpers::IDMap(logicalToPhysicalIDs);
 
         CoordBox<1> delegateBox(Coord<1>(0), Coord<1>(nodeSet.size()));
         delegate = DELEGATE_GRID(delegateBox, defaultElement, edgeElement);
@@ -273,7 +380,6 @@ public:
 
         reorderDelegateGrid(std::move(newLogicalToPhysicalIDs), std::move(newPhysicalToLogicalIDs));
 
-        using ReorderingUnstructuredGridHelpers::mapLogicalToPhysicalID;
         SparseMatrix newMatrix;
 
         for (typename SparseMatrix::const_iterator i = matrix.begin(); i != matrix.end(); ++i) {
@@ -286,18 +392,15 @@ public:
                 continue;
             }
 
-            std::vector<std::pair<int, int> >::const_iterator iter;
-            iter = mapLogicalToPhysicalID(i->first.x(), logicalToPhysicalIDs);
-            if (iter == logicalToPhysicalIDs.end()) {
+            int id1 = idMap[i->first.x()];
+            if (id1 == -1) {
                 throw std::logic_error("unknown ID in matrix");
             }
-            int id1 = iter->second;
 
-            iter = mapLogicalToPhysicalID(i->first.y(), logicalToPhysicalIDs);
-            if (iter == logicalToPhysicalIDs.end()) {
+            int id2 = idMap[i->first.y()];
+            if (id2 == -1) {
                 throw std::logic_error("unknown neighbor ID in matrix");
             }
-            int id2 = iter->second;
 
             newMatrix << std::make_pair(Coord<2>(id1, id2), i->second);
         }
@@ -365,20 +468,14 @@ public:
 
     virtual void saveRegion(BufferType *buffer, const Region<DIM>& region, const Coord<DIM>& offset = Coord<DIM>()) const
     {
-        delegate.saveRegion(
-            buffer,
-            ReorderingRegionIterator(region.begin(), logicalToPhysicalIDs),
-            ReorderingRegionIterator(region.end(), logicalToPhysicalIDs),
-            region.size());
+        PhysicalStreakVecPtr streaks = physicalStreaks(region);
+        delegate.saveRegion(buffer, streaks->begin(), streaks->end(), region.size());
     }
 
     virtual void loadRegion(const BufferType& buffer, const Region<DIM>& region, const Coord<DIM>& offset = Coord<DIM>())
     {
-        delegate.loadRegion(
-            buffer,
-            ReorderingRegionIterator(region.begin(), logicalToPhysicalIDs),
-            ReorderingRegionIterator(region.end(), logicalToPhysicalIDs),
-            region.size());
+        PhysicalStreakVecPtr streaks = physicalStreaks(region);
+        delegate.loadRegion(buffer, streaks->begin(), streaks->end(), region.size());
     }
 
     /**
@@ -390,14 +487,13 @@ public:
         Region<1> ret;
 
         for (Region<1>::Iterator i = region.begin(); i != region.end(); ++i) {
-            using ReorderingUnstructuredGridHelpers::mapLogicalToPhysicalID;
-            std::vector<IntPair>::const_iterator iter = mapLogicalToPhysicalID(i->x(), logicalToPhysicalIDs);
+            int physicalID = idMap[i->x()];
 
-            if (iter == logicalToPhysicalIDs.end()) {
+            if (physicalID == -1) {
                 throw std::logic_error("cannot remap Coord from Region -- Region needs to be a subset of nodeSet");
             }
 
-            ret << Coord<1>(iter->second);
+            ret << Coord<1>(physicalID);
         }
 
         return ret;
@@ -452,6 +548,13 @@ private:
     Region<1> nodeSet;
     std::vector<IntPair> logicalToPhysicalIDs;
     std::vector<int> physicalToLogicalIDs;
+    ReorderingUnstructuredGridHelpers::IDMap idMap;
+    mutable ReorderingUnstructuredGridHelpers::PhysicalRegionCache<PhysicalStreak> regionCache;
+
+    PhysicalStreakVecPtr physicalStreaks(const Region<DIM>& region) const
+    {
+        return regionCache(region, idMap);
+    }
 
     /**
      * This operator is private as it gives access access to the
@@ -485,12 +588,13 @@ private:
         const Selector<CellType>& selector,
         const Region<DIM>& region) const
     {
+        PhysicalStreakVecPtr streaks = physicalStreaks(region);
         delegate.saveMemberImplementation(
             target,
             targetLocation,
             selector,
-            ReorderingRegionIterator(region.begin(), logicalToPhysicalIDs),
-            ReorderingRegionIterator(region.end(), logicalToPhysicalIDs));
+            streaks->begin(),
+            streaks->end());
     }
 
     virtual void loadMemberImplementation(
@@ -499,66 +603,62 @@ private:
         const Selector<CellType>& selector,
         const Region<DIM>& region)
     {
+        PhysicalStreakVecPtr streaks = physicalStreaks(region);
         delegate.loadMemberImplementation(
             source,
             sourceLocation,
             selector,
-            ReorderingRegionIterator(region.begin(), logicalToPhysicalIDs),
-            ReorderingRegionIterator(region.end(), logicalToPhysicalIDs));
+            streaks->begin(),
+            streaks->end());
     }
 
     void reorderDelegateGrid(std::vector<IntPair>&& newLogicalToPhysicalIDs, std::vector<int>&& newPhysicalToLogicalIDs)
     {
+        ReorderingUnstructuredGridHelpers::IDMap newIDMap(newLogicalToPhysicalIDs);
         CoordBox<1> box(Coord<1>(), nodeSet.boundingBox().dimensions);
         DELEGATE_GRID newDelegate(box);
         for (Region<1>::Iterator i = nodeSet.begin(); i != nodeSet.end(); ++i) {
-            using ReorderingUnstructuredGridHelpers::mapLogicalToPhysicalID;
-            std::vector<IntPair>::const_iterator iter;
-
-            iter = mapLogicalToPhysicalID(i->x(), newLogicalToPhysicalIDs);
-            if (iter == newLogicalToPhysicalIDs.end()) {
+            int newPhysicalID = newIDMap[i->x()];
+            if (newPhysicalID == -1) {
                 throw std::logic_error("ID not found in new ID map");
             }
-            Coord<1> newPhysicalID(iter->second);
 
-            iter = mapLogicalToPhysicalID(i->x(), logicalToPhysicalIDs);
-            if (iter == logicalToPhysicalIDs.end()) {
+            int oldPhysicalID = idMap[i->x()];
+            if (oldPhysicalID == -1) {
                 throw std::logic_error("ID not found in old ID map");
             }
-            Coord<1> oldPhysicalID(iter->second);
 
-            newDelegate.set(newPhysicalID, delegate.get(oldPhysicalID));
+            newDelegate.set(Coord<1>(newPhysicalID), delegate.get(Coord<1>(oldPhysicalID)));
         }
         delegate = std::move(newDelegate);
 
         logicalToPhysicalIDs = std::move(newLogicalToPhysicalIDs);
         physicalToLogicalIDs = std::move(newPhysicalToLogicalIDs);
+        idMap = std::move(newIDMap);
+        regionCache.clear();
     }
 
     inline
     CellType get(int logicalID) const
     {
-        using ReorderingUnstructuredGridHelpers::mapLogicalToPhysicalID;
-        std::vector<IntPair>::const_iterator pos = mapLogicalToPhysicalID(logicalID, logicalToPhysicalIDs);
-
-        if ((pos == logicalToPhysicalIDs.end() || (pos->first != logicalID))) {
+        int physicalID = idMap[logicalID];
+        if (physicalID == -1) {
             return delegate.getEdge();
         }
 
-        return delegate.get(Coord<1>(pos->second));
+        return delegate.get(Coord<1>(physicalID));
     }
 
     inline
     void set(int logicalID, const CellType& cell)
     {
-        using ReorderingUnstructuredGridHelpers::mapLogicalToPhysicalID;
-        std::vector<IntPair>::const_iterator pos = mapLogicalToPhysicalID(logicalID, logicalToPhysicalIDs);
-
-        if ((pos == logicalToPhysicalIDs.end() || (pos->first != logicalID))) {
+        int physicalID = idMap[logicalID];
+        if (physicalID == -1) {
             delegate.setEdge(cell);
+            return;
         }
 
-        delegate.set(Coord<1>(pos->second), cell);
+        delegate.set(Coord<1>(physicalID), cell);
     }
 };
 
@@ -41,9 +41,14 @@ public:
 };
 
 /**
- * Helper class to initialize the sell container from an adjacency matrix.
- * This is a class and not a method, because there are two different implementations,
- * one for SIGMA = 1 and one for SIGMA > 1.
+ * Helper class to initialize the sell container from an adjacency
+ * matrix, given either in coordinate format (COO, entries in any
+ * order) or in compressed sparse row format (CSR). Construction
+ * works in place on the input: row lengths are counted in one
+ * streaming pass, rows are sorted per sigma scope in parallel and
+ * the chunk offsets are derived via a prefix sum. Each entry is then
+ * written directly to its final position, using realRowToSorted as
+ * an index array.
  */
 template<typename VALUETYPE, int C, int SIGMA>
 class InitFromMatrix
@@ -54,14 +59,106 @@ public:
 
     void operator()(SellContainer *container, const Matrix& matrix) const
     {
-        std::vector<int> rowLengthCopy;
+        const long numberOfEntries = matrix.size();
+        std::vector<int> realRowLength(rowsPadded(container), 0);
 
-        // calculate size for arrays
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < numberOfEntries; ++i) {
+            const int row = matrix[i].first.x();
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp atomic
+#endif
+            ++realRowLength[row];
+        }
+
+        initLayout(container, realRowLength);
+
+        // entries of a row may be scattered all over the matrix,
+        // hence each row gets a cursor:
+        std::vector<int> cursor(realRowLength.size(), 0);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < numberOfEntries; ++i) {
+            const int row = matrix[i].first.x();
+            int index;
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp atomic capture
+#endif
+            index = cursor[row]++;
+
+            const int idx = entryIndex(container, container->realRowToSorted[row].second, index);
+            container->values[idx] = matrix[i].second;
+            container->column[idx] = matrix[i].first.y();
+        }
+
+        sortRows(container);
+    }
+
+    /**
+     * rowOffsets needs to hold dimension + 1 elements, the entries
+     * of row i are stored at indices [rowOffsets[i], rowOffsets[i + 1])
+     * of columns and values.
+     */
+    void operator()(
+        SellContainer *container,
+        const int *rowOffsets,
+        const int *columns,
+        const VALUETYPE *values) const
+    {
+        const long matrixRows = container->dimension;
+        std::vector<int> realRowLength(rowsPadded(container), 0);
+        for (long row = 0; row < matrixRows; ++row) {
+            realRowLength[row] = rowOffsets[row + 1] - rowOffsets[row];
+        }
+
+        initLayout(container, realRowLength);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long row = 0; row < matrixRows; ++row) {
+            const int sortedRow = container->realRowToSorted[row].second;
+            for (int i = rowOffsets[row]; i < rowOffsets[row + 1]; ++i) {
+                const int idx = entryIndex(container, sortedRow, i - rowOffsets[row]);
+                container->values[idx] = values[i];
+                container->column[idx] = columns[i];
+            }
+        }
+
+        sortRows(container);
+    }
+
+private:
+    static int rowsPadded(const SellContainer *container)
+    {
         const int matrixRows = container->dimension;
         const int numberOfChunks = (matrixRows - 1) / C + 1;
-        const int numberOfSigmas = (matrixRows - 1) / SIGMA + 1;
-        const int rowsPadded = numberOfChunks * C;
-        int numberOfValues = 0;
+        return numberOfChunks * C;
+    }
+
+    /**
+     * Position of the index-th entry of the given row (in sorted
+     * order) in values and column.
+     */
+    static int entryIndex(const SellContainer *container, int sortedRow, int index)
+    {
+        return container->chunkOffset[sortedRow / C] + index * C + sortedRow % C;
+    }
+
+    /**
+     * Sorts rows by length within each sigma scope, then sets up
+     * chunks and allocates storage. Padding rows are sorted just
+     * like real rows, but have length 0.
+     */
+    void initLayout(SellContainer *container, const std::vector<int>& realRowLength) const
+    {
+        const int numberOfRows = realRowLength.size();
+        const int numberOfChunks = numberOfRows / C;
+        const int numberOfSigmas = (numberOfRows - 1) / SIGMA + 1;
 
         // save references to sell data structures
         auto& chunkOffset     = container->chunkOffset;
@@ -69,94 +166,107 @@ public:
         auto& rowLength       = container->rowLength;
         auto& realRowToSorted = container->realRowToSorted;
         auto& chunkRowToReal  = container->chunkRowToReal;
-        auto& values          = container->values;
-        auto& column          = container->column;
 
-        // allocate memory
         chunkOffset.resize(numberOfChunks + 1);
         chunkLength.resize(numberOfChunks);
-        rowLength.resize(rowsPadded);
-        rowLengthCopy.resize(rowsPadded);
-        realRowToSorted.reserve(rowsPadded);
-        chunkRowToReal.resize(rowsPadded);
-
-        // get row lengths
-        std::fill(begin(rowLength), end(rowLength), 0);
-        for (const auto& pair: matrix) {
-            ++rowLength[pair.first.x()];
-        }
+        rowLength.resize(numberOfRows);
+        realRowToSorted.resize(numberOfRows);
+        chunkRowToReal.resize(numberOfRows);
 
-        // map sorting scope
-        for (int nSigma = 0; nSigma < numberOfSigmas; ++nSigma) {
-            const int numberOfRows = (std::min)(SIGMA, rowsPadded - nSigma * SIGMA);
-            std::vector<SortItem> lengths(numberOfRows);
-            for (int i = 0; i < numberOfRows; ++i) {
-                const int row = nSigma * SIGMA + i;
-                lengths[i] = SortItem(rowLength[row], row);
-            }
-            std::stable_sort(begin(lengths), end(lengths),
-                             [] (const SortItem& a, const SortItem& b) -> bool
-                             { return a.rowLength > b.rowLength; });
-            for (int i = 0; i < numberOfRows; ++i) {
-                int newID = nSigma * SIGMA + i;
-                chunkRowToReal[newID] = lengths[i].rowIndex;
-                realRowToSorted.push_back(std::make_pair(lengths[i].rowIndex, newID));
-                rowLengthCopy[newID] = lengths[i].rowLength;
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            std::vector<SortItem> lengths;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(static)
+#endif
+            for (int nSigma = 0; nSigma < numberOfSigmas; ++nSigma) {
+                const int offset = nSigma * SIGMA;
+                const int scopeRows = (std::min)(SIGMA, numberOfRows - offset);
+                lengths.resize(scopeRows);
+                for (int i = 0; i < scopeRows; ++i) {
+                    lengths[i] = SortItem(realRowLength[offset + i], offset + i);
+                }
+                std::stable_sort(begin(lengths), end(lengths),
+                                 [] (const SortItem& a, const SortItem& b) -> bool
+                                 { return a.rowLength > b.rowLength; });
+
+                for (int i = 0; i < scopeRows; ++i) {
+                    const int newID = offset + i;
+                    chunkRowToReal[newID] = lengths[i].rowIndex;
+                    realRowToSorted[lengths[i].rowIndex] = std::make_pair(lengths[i].rowIndex, newID);
+                    rowLength[newID] = lengths[i].rowLength;
+                }
             }
         }
 
-        std::stable_sort(realRowToSorted.begin(), realRowToSorted.end(),
-                         [] (const std::pair<int, int>& a, const std::pair<int, int>& b) -> bool
-                         { return a.first < b.first; });
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (int nChunk = 0; nChunk < numberOfChunks; ++nChunk) {
+            chunkLength[nChunk] = *std::max_element(
+                rowLength.begin() + nChunk * C,
+                rowLength.begin() + (nChunk + 1) * C);
+        }
 
-        // save chunk lengths and offsets
         chunkOffset[0] = 0;
         for (int nChunk = 0; nChunk < numberOfChunks; ++nChunk) {
-            std::vector<int> lengths(C);
-            for (auto i = 0u; i < lengths.size(); ++i) {
-                lengths[i] = rowLength[chunkRowToReal[nChunk * C + i]];
-            }
-            chunkLength[nChunk] = *std::max_element(begin(lengths), end(lengths));
-            if (nChunk > 0) {
-                chunkOffset[nChunk] = chunkOffset[nChunk - 1] + chunkLength[nChunk - 1] * C;
-            }
-            numberOfValues += chunkLength[nChunk] * C;
+            chunkOffset[nChunk + 1] = chunkOffset[nChunk] + chunkLength[nChunk] * C;
         }
-        chunkOffset[numberOfChunks] =
-            chunkOffset[numberOfChunks - 1] +
-            chunkLength[numberOfChunks - 1] * C;
-
-        // save values
-        rowLength = std::move(rowLengthCopy);
-        values.resize(numberOfValues);
-        column.resize(numberOfValues);
-        std::fill(begin(values), end(values), 0);
-        std::fill(begin(column), end(column), 0);
-        int currentRow = 0;
-        int index = 0;
-
-        for (const auto& pair: matrix) {
-            if (pair.first.x() != currentRow) {
-                currentRow = pair.first.x();
-                index = 0;
-            }
-            std::vector<std::pair<int, int> >::iterator iter = std::lower_bound(
-                realRowToSorted.begin(), realRowToSorted.end(), pair.first.x(),
-                [](const std::pair<int, int>& a, const int id) {
-                    return a.first < id;
-                });
-
-            if (iter == realRowToSorted.end()) {
-                throw std::logic_error("ID not found");
-            }
 
-            const int chunk = iter->second / C;
-            const int row   = iter->second % C;
-            const int start = chunkOffset[chunk];
-            const int idx   = start + index * C + row;
-            values[idx]     = pair.second;
-            column[idx]     = pair.first.y();
-            ++index;
+        container->values.clear();
+        container->column.clear();
+        container->values.resize(chunkOffset[numberOfChunks]);
+        container->column.resize(chunkOffset[numberOfChunks]);
+    }
+
+    /**
+     * Entries are expected in ascending column order within each
+     * row. Input which is already sorted (e.g. most CSR matrices)
+     * passes through at the cost of a single check per row.
+     */
+    void sortRows(SellContainer *container) const
+    {
+        const int numberOfRows = container->rowLength.size();
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            std::vector<std::pair<int, VALUETYPE> > row;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic, 1024)
+#endif
+            for (int sortedRow = 0; sortedRow < numberOfRows; ++sortedRow) {
+                const int length = container->rowLength[sortedRow];
+                const int start = entryIndex(container, sortedRow, 0);
+
+                bool sorted = true;
+                for (int i = 1; i < length; ++i) {
+                    if (container->column[start + i * C] < container->column[start + (i - 1) * C]) {
+                        sorted = false;
+                        break;
+                    }
+                }
+                if (sorted) {
+                    continue;
+                }
+
+                row.resize(length);
+                for (int i = 0; i < length; ++i) {
+                    row[i] = std::make_pair(container->column[start + i * C], container->values[start + i * C]);
+                }
+                std::stable_sort(begin(row), end(row),
+                                 [] (const std::pair<int, VALUETYPE>& a, const std::pair<int, VALUETYPE>& b) -> bool
+                                 { return a.first < b.first; });
+                for (int i = 0; i < length; ++i) {
+                    container->column[start + i * C] = row[i].first;
+                    container->values[start + i * C] = row[i].second;
+                }
+            }
         }
     }
 };
@@ -178,6 +288,7 @@ public:
     using AlignedIntVector   = std::vector<int, LibFlatArray::aligned_allocator<int, 64> >;
 
     friend SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>;
+    friend class SparseMatrixCache;
     friend class ReorderingUnstructuredGridTest;
 
     explicit
@@ -216,15 +327,44 @@ public:
     /**
      * This method can be used, if this container should be initialized from a
      * _complete_ matrix. Matrix is represented as map, key is Coord<2> which contains
-     * (row, column). value_type of map contains the actual value.
+     * (row, column). value_type of map contains the actual value. Entries may be
+     * given in any order.
      */
     void initFromMatrix(const SparseMatrix& matrix)
     {
-        SparseMatrix sortedMatrix = matrix;
-        std::sort(sortedMatrix.begin(), sortedMatrix.end(), [](const std::pair<Coord<2>, VALUETYPE>& a, const std::pair<Coord<2>, VALUETYPE>& b){
-                return a.first < b.first;
-            });
-        SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>()(this, sortedMatrix);
+        SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>()(this, matrix);
+    }
+
+    /**
+     * Same as above, but for a matrix in compressed sparse row
+     * format: the column indices and values of row i are stored at
+     * [rowOffsets[i], rowOffsets[i + 1]) in columns and values.
+     */
+    void initFromCSR(
+        const std::vector<int>& rowOffsets,
+        const std::vector<int>& columns,
+        const std::vector<VALUETYPE>& values)
+    {
+        if (rowOffsets.size() != (dimension + 1)) {
+            throw std::invalid_argument("rowOffsets needs to hold dimension + 1 elements");
+        }
+        if ((columns.size() != values.size()) ||
+            (rowOffsets.front() != 0) ||
+            (std::size_t(rowOffsets.back()) != values.size())) {
+            throw std::invalid_argument("CSR arrays don't match in size");
+        }
+
+        initFromCSR(rowOffsets.data(), columns.data(), values.data());
+    }
+
+    /**
+     * Variant for CSR data which isn't held in std::vectors, e.g.
+     * memory mapped files. rowOffsets has to hold dimension + 1
+     * elements, columns and values are indexed by these offsets.
+     */
+    void initFromCSR(const int *rowOffsets, const int *columns, const VALUETYPE *values)
+    {
+        SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>()(this, rowOffsets, columns, values);
     }
 
     inline bool operator==(const SellCSigmaSparseMatrixContainer& other) const
@@ -3,6 +3,8 @@
 
 #include <libflatarray/flat_array.hpp>
 #include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/selector.h>
+#include <vector>
 
 namespace LibGeoDecomp {
 
@@ -217,6 +219,24 @@ public:
         Implementation::resize(buffer, region);
     }
 
+    /**
+     * Returns the number of bytes required to store only the members
+     * given by selectors (see APITraits::HasHaloMembers) for all
+     * cells in region.
+     */
+    template<typename REGION>
+    static std::size_t minimumStorageSize(const REGION& region, const std::vector<Selector<CELL> >& selectors)
+    {
+        std::size_t ret = 0;
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors.begin();
+             i != selectors.end();
+             ++i) {
+            ret += i->sizeOfExternal() * region.size();
+        }
+
+        return ret;
+    }
+
     // static inline InsertIteratorType getInsertIterator(BufferType *buffer)
     // {
     //     Implementation::getInsertIterator(buffer);
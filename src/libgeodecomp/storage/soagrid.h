@@ -3,15 +3,38 @@
 
 #include <libflatarray/flat_array.hpp>
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/misc/numa.h>
 #include <libgeodecomp/misc/stringops.h>
+#include <libgeodecomp/storage/firsttouchallocator.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <libgeodecomp/storage/selector.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
 
+namespace LibFlatArray {
+
+/**
+ * FirstTouchAllocator<..., false> leaves its pages untouched, so
+ * soa_grid has to construct cells in parallel, or else the
+ * construction pass would place all pages on the allocating
+ * thread's node.
+ */
+template<typename T, std::size_t ALIGNMENT>
+class parallel_construction<LibGeoDecomp::FirstTouchAllocator<T, ALIGNMENT, false> >
+{
+public:
+    inline bool operator()() const
+    {
+        return LibGeoDecomp::NUMA::firstTouch();
+    }
+};
+
+}
+
 namespace LibGeoDecomp {
 
 namespace SoAGridHelpers {
@@ -56,54 +79,40 @@ public:
         innerCell(innerCell)
     {}
 
+    /**
+     * With NUMA::firstTouch() rows are written in parallel, split
+     * statically along the outermost dimension -- just like the
+     * UpdateFunctor distributes planes among threads. This way each
+     * page lands on the node of the thread which is going to update
+     * it.
+     */
     template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
     void operator()(LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX> accessor) const
     {
-        for (int z = 0; z < gridDim.z(); ++z) {
-            bool onEdge1 = false;
-            const CELL *cell1 = &innerCell;
-            if ((z < edgeRadii.z()) || (z >= (gridDim.z() - edgeRadii.z()))) {
-                cell1 = &edgeCell;
-                onEdge1 = true;
-            }
-
-            for (int y = 0; y < gridDim.y(); ++y) {
-                bool onEdge2 = onEdge1;
-                const CELL *cell2 = cell1;
-                if ((y < edgeRadii.y()) || (y >= (gridDim.y() - edgeRadii.y()))) {
-                    cell2 = &edgeCell;
-                    onEdge2 = true;
-                }
-
-                accessor.index() =
-                    z * DIM_X * DIM_Y +
-                    y * DIM_X;
-                int x = 0;
-
-                for (; x < edgeRadii.x(); ++x) {
-                    accessor << edgeCell;
-                    ++accessor.index();
-                }
+#ifdef LIBGEODECOMP_WITH_THREADS
+        if (NUMA::firstTouch()) {
+            const bool splitZ = (gridDim.z() > 1);
+            const long numPlanes = splitZ ? gridDim.z() : gridDim.y();
 
-                if (onEdge2 || INIT_INTERIOR) {
-                    for (; x < (gridDim.x() - edgeRadii.x()); ++x) {
-                        accessor << *cell2;
-                        ++accessor.index();
+#pragma omp parallel for schedule(static) firstprivate(accessor)
+            for (long plane = 0; plane < numPlanes; ++plane) {
+                if (splitZ) {
+                    for (int y = 0; y < gridDim.y(); ++y) {
+                        setRow(accessor, plane, y);
                     }
                 } else {
-                    // we need to advance index and x manually, otherwise
-                    // the following loop will erase the grid's interior:
-                    int delta = gridDim.x() - 2 * edgeRadii.x();
-                    x += delta;
-                    accessor.index() += delta;
-                }
-
-                for (; x < gridDim.x(); ++x) {
-                    accessor << edgeCell;
-                    ++accessor.index();
+                    setRow(accessor, 0, plane);
                 }
             }
 
+            return;
+        }
+#endif
+
+        for (int z = 0; z < gridDim.z(); ++z) {
+            for (int y = 0; y < gridDim.y(); ++y) {
+                setRow(accessor, z, y);
+            }
         }
     }
 
@@ -112,6 +121,46 @@ private:
     Coord<3> edgeRadii;
     CELL edgeCell;
     CELL innerCell;
+
+    template<typename ACCESSOR>
+    void setRow(ACCESSOR& accessor, int z, int y) const
+    {
+        bool onEdge = false;
+        const CELL *cell = &innerCell;
+        if ((z < edgeRadii.z()) || (z >= (gridDim.z() - edgeRadii.z())) ||
+            (y < edgeRadii.y()) || (y >= (gridDim.y() - edgeRadii.y()))) {
+            cell = &edgeCell;
+            onEdge = true;
+        }
+
+        accessor.index() =
+            z * ACCESSOR::DIM_X * ACCESSOR::DIM_Y +
+            y * ACCESSOR::DIM_X;
+        int x = 0;
+
+        for (; x < edgeRadii.x(); ++x) {
+            accessor << edgeCell;
+            ++accessor.index();
+        }
+
+        if (onEdge || INIT_INTERIOR) {
+            for (; x < (gridDim.x() - edgeRadii.x()); ++x) {
+                accessor << *cell;
+                ++accessor.index();
+            }
+        } else {
+            // we need to advance index and x manually, otherwise
+            // the following loop will erase the grid's interior:
+            int delta = gridDim.x() - 2 * edgeRadii.x();
+            x += delta;
+            accessor.index() += delta;
+        }
+
+        for (; x < gridDim.x(); ++x) {
+            accessor << edgeCell;
+            ++accessor.index();
+        }
+    }
 };
 
 /**
@@ -355,7 +404,9 @@ public:
 
     typedef CELL CellType;
     typedef TOPOLOGY Topology;
-    typedef LibFlatArray::soa_grid<CELL> Delegate;
+    // pages are placed by soa_grid's parallel construction pass and
+    // SetContent, see NUMA::firstTouch():
+    typedef LibFlatArray::soa_grid<CELL, FirstTouchAllocator<char, 4096, false> > Delegate;
     typedef typename APITraits::SelectStencil<CELL>::Value Stencil;
 
     explicit SoAGrid(
@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/misc/testhelper.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/updatefunctor.h>
+#include <libgeodecomp/storage/workdecomposition.h>
+
+#include <vector>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+
+/**
+ * Counts how often each cell has been visited.
+ */
+class VisitCounter
+{
+public:
+    explicit VisitCounter(Grid<int, Topologies::Cube<3>::Topology> *counts) :
+        counts(counts)
+    {}
+
+    void operator()(const Streak<3> *streak) const
+    {
+        for (Coord<3> c = streak->origin; c.x() < streak->endX; ++c.x()) {
+#pragma omp atomic
+            ++(*counts)[c];
+        }
+    }
+
+private:
+    Grid<int, Topologies::Cube<3>::Topology> *counts;
+};
+
+#endif
+
+class WorkDecompositionTest : public CxxTest::TestSuite
+{
+public:
+    void testChunks()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        Region<2> region;
+        region << Streak<2>(Coord<2>(0,  0), 100);
+        region << Streak<2>(Coord<2>(5,  1),  10);
+        region << Streak<2>(Coord<2>(0,  2),   3);
+        region << Streak<2>(Coord<2>(60, 3),  90);
+
+        WorkDecomposition<2> decomposition(region, 32, 2);
+
+        // 138 cells, 2 threads, 4 chunks each -> 17 cells per chunk.
+        // Streaks longer than 32 cells will be split:
+        TS_ASSERT_EQUALS(std::size_t(4), decomposition.numChunks());
+        TS_ASSERT_EQUALS(std::size_t(0), decomposition.queues[0].begin);
+        TS_ASSERT_EQUALS(std::size_t(2), decomposition.queues[0].end);
+        TS_ASSERT_EQUALS(std::size_t(2), decomposition.queues[1].begin);
+        TS_ASSERT_EQUALS(std::size_t(4), decomposition.queues[1].end);
+        TS_ASSERT_EQUALS(std::size_t(7), decomposition.streaks.size());
+
+        Region<2> actual;
+        for (std::size_t i = 0; i < decomposition.streaks.size(); ++i) {
+            TS_ASSERT(decomposition.streaks[i].length() <= 32);
+            actual << decomposition.streaks[i];
+        }
+        TS_ASSERT_EQUALS(region, actual);
+
+        TS_ASSERT_THROWS(WorkDecomposition<2>(region, 32, 0), std::invalid_argument&);
+        TS_ASSERT_THROWS(WorkDecomposition<2>(region, 0, 4), std::invalid_argument&);
+#endif
+    }
+
+    void testCache()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        WorkDecompositionCache<2> cache;
+        Region<2> region1;
+        region1 << CoordBox<2>(Coord<2>(0, 0), Coord<2>(20, 10));
+        Region<2> region2;
+        region2 << CoordBox<2>(Coord<2>(10, 10), Coord<2>(20, 10));
+
+        const WorkDecomposition<2> *a = &cache(region1, 16, 4);
+        const WorkDecomposition<2> *b = &cache(region2, 16, 4);
+        TS_ASSERT_DIFFERS(a, b);
+        TS_ASSERT_EQUALS(a, &cache(region1, 16, 4));
+        TS_ASSERT_EQUALS(b, &cache(region2, 16, 4));
+        TS_ASSERT_EQUALS(std::size_t(2), cache.entries.size());
+
+        cache(region1, 8, 4);
+        cache(region1, 16, 3);
+        TS_ASSERT_EQUALS(std::size_t(4), cache.entries.size());
+
+        for (int i = 0; i < 40; ++i) {
+            Region<2> region;
+            region << Streak<2>(Coord<2>(0, i), 10);
+            cache(region, 16, 4);
+        }
+        TS_ASSERT_EQUALS(WorkDecompositionCache<2>::MAX_ENTRIES, cache.entries.size());
+#endif
+    }
+
+    void testExecutorVisitsEachStreakOnce()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        Coord<3> dim(67, 31, 3);
+        Grid<int, Topologies::Cube<3>::Topology> counts(dim, 0);
+        Region<3> region;
+        region << CoordBox<3>(Coord<3>(1, 1, 0), Coord<3>(65, 29, 3));
+
+        WorkDecomposition<3> decomposition(region, 16, 4);
+        VisitCounter counter(&counts);
+        decomposition(counter);
+        decomposition(counter);
+
+        for (CoordBox<3>::Iterator i = counts.boundingBox().begin(); i != counts.boundingBox().end(); ++i) {
+            int expected = region.count(*i) ? 2 : 0;
+            TS_ASSERT_EQUALS(expected, counts[*i]);
+        }
+#endif
+    }
+
+    void testUpdateFunctorOnFlatGrid()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        // only 2 planes, so the UpdateFunctor should not parallelize
+        // by planes, but use the WorkDecomposition instead:
+        typedef TestCell<3> TestCellType;
+        typedef Grid<TestCellType, APITraits::SelectTopology<TestCellType>::Value> GridType;
+        static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<TestCellType>::VALUE;
+
+        Coord<3> dim(30, 20, 2);
+        CoordBox<3> box(Coord<3>(), dim);
+        Region<3> region;
+        region << box;
+
+        TestInitializer<TestCellType> init(dim);
+        GridType gridA(dim);
+        init.grid(&gridA);
+        GridType gridB = gridA;
+
+        GridType *gridOld = &gridA;
+        GridType *gridNew = &gridB;
+
+        for (unsigned s = 0; s < 2 * NANO_STEPS; ++s) {
+            UpdateFunctorHelpers::ConcurrencyEnableOpenMP concurrencySpec(s % 2, false);
+            UpdateFunctor<TestCellType, UpdateFunctorHelpers::ConcurrencyEnableOpenMP>()(
+                region, Coord<3>(), Coord<3>(), *gridOld, gridNew, s % NANO_STEPS, concurrencySpec);
+            std::swap(gridOld, gridNew);
+
+            TS_ASSERT_TEST_GRID(GridType, *gridOld, s + 1);
+        }
+#endif
+    }
+};
+
+}
@@ -0,0 +1,239 @@
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_HPX
+#include <hpx/config.hpp>
+#endif
+
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/firsttouchallocator.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/soagrid.h>
+
+#include <cxxtest/TestSuite.h>
+#include <vector>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Records which thread constructed it and on which NUMA node that
+ * thread was running at the time.
+ */
+class ConstructionSite
+{
+public:
+    ConstructionSite() :
+        thread(0),
+        node(-1)
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        thread = omp_get_thread_num();
+#endif
+#ifdef __linux__
+        unsigned cpu;
+        unsigned myNode;
+        if (syscall(SYS_getcpu, &cpu, &myNode, 0) == 0) {
+            node = myNode;
+        }
+#endif
+    }
+
+    int thread;
+    int node;
+};
+
+class FirstTouchTestCell
+{
+public:
+    ConstructionSite site;
+    double value;
+};
+
+}
+
+LIBFLATARRAY_REGISTER_SOA(
+    LibGeoDecomp::FirstTouchTestCell,
+    ((LibGeoDecomp::ConstructionSite)(site))
+    ((double)(value)))
+
+namespace LibGeoDecomp {
+
+/**
+ * Collects the address of the first cell's site in each z-plane.
+ */
+class PlaneStartCollector
+{
+public:
+    PlaneStartCollector(std::vector<const ConstructionSite*> *sites, int numPlanes) :
+        sites(sites),
+        numPlanes(numPlanes)
+    {}
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void operator()(LibFlatArray::soa_accessor<FirstTouchTestCell, DIM_X, DIM_Y, DIM_Z, INDEX>& accessor) const
+    {
+        for (int z = 0; z < numPlanes; ++z) {
+            accessor.index() = z * DIM_X * DIM_Y;
+            sites->push_back(&accessor.site());
+        }
+    }
+
+private:
+    std::vector<const ConstructionSite*> *sites;
+    int numPlanes;
+};
+
+class FirstTouchAllocatorTest : public CxxTest::TestSuite
+{
+public:
+    void tearDown()
+    {
+        NUMA::enableFirstTouch(false);
+    }
+
+    void testAlignment()
+    {
+        for (int mode = 0; mode < 2; ++mode) {
+            NUMA::enableFirstTouch(mode == 1);
+
+            for (std::size_t size = 1; size < (1 << 20); size = size * 3 + 1) {
+                std::vector<double, FirstTouchAllocator<double, 64> > vec(size, 2.5);
+                TS_ASSERT_EQUALS(std::size_t(0), reinterpret_cast<std::size_t>(vec.data()) % 64);
+                TS_ASSERT_EQUALS(2.5, vec.front());
+                TS_ASSERT_EQUALS(2.5, vec.back());
+
+                FirstTouchAllocator<char, 4096, false> allocator;
+                char *block = allocator.allocate(size);
+                TS_ASSERT_EQUALS(std::size_t(0), reinterpret_cast<std::size_t>(block) % 4096);
+                block[0] = 1;
+                block[size - 1] = 1;
+                allocator.deallocate(block, size);
+            }
+        }
+    }
+
+    void testBlocksOutliveModeSwitch()
+    {
+        NUMA::enableFirstTouch(true);
+        std::vector<int, FirstTouchAllocator<int, 64> > mapped(100000, 1);
+        NUMA::enableFirstTouch(false);
+        std::vector<int, FirstTouchAllocator<int, 64> > heap(100000, 2);
+
+        // deallocation needs to pick the matching method for each block:
+        mapped.swap(heap);
+        mapped.clear();
+        mapped.shrink_to_fit();
+        TS_ASSERT_EQUALS(1, heap[99999]);
+    }
+
+    void testGridsAreUnchanged()
+    {
+        typedef Topologies::Cube<3>::Topology Topology;
+        Coord<3> dim(17, 33, 21);
+        CoordBox<3> box(Coord<3>(), dim);
+        TestCell<3> cell(Coord<3>(1, 2, 3), dim, 4, 5.0);
+        TestCellSoA soaCell(Coord<3>(1, 2, 3), dim, 4, 5.0);
+        TestCellSoA soaEdge(Coord<3>(), dim, 0, -1.0);
+
+        Grid<TestCell<3>, Topology> grid1(dim, cell);
+        DisplacedGrid<TestCell<3>, Topology> displaced1(box, cell);
+        SoAGrid<TestCellSoA, Topology> soaGrid1(box, soaCell, soaEdge);
+
+        NUMA::enableFirstTouch(true);
+        Grid<TestCell<3>, Topology> grid2(dim, cell);
+        DisplacedGrid<TestCell<3>, Topology> displaced2(box, cell);
+        SoAGrid<TestCellSoA, Topology> soaGrid2(box, soaCell, soaEdge);
+
+        TS_ASSERT_EQUALS(grid1, grid2);
+        TS_ASSERT_EQUALS(displaced1, displaced2);
+        TS_ASSERT_EQUALS(soaEdge, soaGrid2.getEdge());
+        TS_ASSERT_EQUALS(soaEdge, soaGrid2.get(Coord<3>(-1, 5, 5)));
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TS_ASSERT_EQUALS(soaGrid1.get(*i), soaGrid2.get(*i));
+        }
+
+        // 2D grids are split along the y-axis:
+        CoordBox<2> box2D(Coord<2>(), Coord<2>(40, 50));
+        SoAGrid<TestCellSoA, Topologies::Cube<2>::Topology> soaGrid2D(box2D, soaCell, soaEdge);
+        TS_ASSERT_EQUALS(soaCell, soaGrid2D.get(Coord<2>(39, 49)));
+        TS_ASSERT_EQUALS(soaEdge, soaGrid2D.get(Coord<2>(40, 0)));
+    }
+
+    void testSoAConstructionFollowsThreadSplit()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef LibFlatArray::soa_grid<FirstTouchTestCell, FirstTouchAllocator<char, 4096, false> > GridType;
+        int oldNumThreads = omp_get_max_threads();
+        int numThreads = 4;
+        omp_set_num_threads(numThreads);
+
+        NUMA::enableFirstTouch(true);
+        GridType grid(64, 8, 13);
+        omp_set_num_threads(oldNumThreads);
+
+        // planes need to be constructed in contiguous blocks, one
+        // per thread, just like the static schedule of the updates:
+        int lastThread = 0;
+        for (int z = 0; z < 13; ++z) {
+            int thread = grid.get(0, 0, z).site.thread;
+            TS_ASSERT_LESS_THAN_EQUALS(lastThread, thread);
+            lastThread = thread;
+
+            for (int y = 0; y < 8; ++y) {
+                for (int x = 0; x < 64; ++x) {
+                    TS_ASSERT_EQUALS(thread, grid.get(x, y, z).site.thread);
+                }
+            }
+        }
+        TS_ASSERT_EQUALS(numThreads - 1, lastThread);
+
+        // single threaded construction without first touch:
+        NUMA::enableFirstTouch(false);
+        GridType grid2(64, 8, 13);
+        TS_ASSERT_EQUALS(0, grid2.get(63, 7, 12).site.thread);
+#endif
+    }
+
+    void testSoAPagePlacement()
+    {
+#ifdef __linux__
+        typedef LibFlatArray::soa_grid<FirstTouchTestCell, FirstTouchAllocator<char, 4096, false> > GridType;
+        NUMA::enableFirstTouch(true);
+        GridType grid(512, 16, 8);
+
+        std::vector<const ConstructionSite*> sites;
+        grid.callback(PlaneStartCollector(&sites, 8));
+
+        // each plane spans several pages, so the page holding a
+        // plane's first cell has been touched by that plane's thread
+        // first, and should reside on that thread's node:
+        std::size_t pageSize = NUMA::pageSize();
+        TS_ASSERT_EQUALS(std::size_t(8), sites.size());
+        for (std::size_t z = 0; z < sites.size(); ++z) {
+            TS_ASSERT_EQUALS(std::size_t(0), reinterpret_cast<std::size_t>(sites[z]) % pageSize);
+
+            int node = -1;
+            void *address = const_cast<ConstructionSite*>(sites[z]);
+            if (syscall(SYS_get_mempolicy, &node, 0, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+                // no NUMA support in this kernel (or not permitted)
+                return;
+            }
+
+            TS_ASSERT_EQUALS(sites[z]->node, node);
+        }
+#endif
+    }
+};
+
+}
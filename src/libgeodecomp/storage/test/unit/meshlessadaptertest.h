@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cxxtest/TestSuite.h>
 #include <libgeodecomp/misc/testhelper.h>
 #include <libgeodecomp/storage/meshlessadapter.h>
@@ -111,6 +112,65 @@ public:
 
     }
 
+    void testFindAllNeighbors()
+    {
+        typedef MeshlessAdapter<Topologies::Torus<2>::Topology> AdapterType;
+
+        FloatCoord<2> dim(6.5, 1);
+        double boxSize = 2;
+        AdapterType adapter(dim, boxSize);
+
+        // distances wrap around:
+        AdapterType::CoordVec positions;
+        for (int i = 0; i < 6; ++i) {
+            positions.push_back(std::make_pair(FloatCoord<2>(i + 0.5, 0.5), 10 + i));
+        }
+        positions.push_back(std::make_pair(FloatCoord<2>(2.1, 0.5), 16));
+
+        AdapterType::Graph graph = adapter.findAllNeighbors(positions);
+        TS_ASSERT_EQUALS(std::size_t(7), graph.size());
+        std::vector<int> expected;
+        expected << 1 << 3 << 6;
+        TS_ASSERT_EQUALS(expected, graph[2]);
+        expected.clear();
+        expected << 1 << 5 << 6;
+        TS_ASSERT_EQUALS(expected, graph[0]);
+        expected.clear();
+        expected << 0 << 1 << 2 << 3;
+        TS_ASSERT_EQUALS(expected, graph[6]);
+
+        // pairs are reported by vertex ID:
+        AdapterType::PairVec pairs = adapter.findAllPairs(positions);
+        TS_ASSERT_EQUALS(std::size_t(10), pairs.size());
+        TS_ASSERT(std::find(pairs.begin(), pairs.end(), std::make_pair(10, 15)) != pairs.end());
+
+        checkAgainstSearch(adapter, positions);
+    }
+
+    void testFindAllNeighborsCube()
+    {
+        typedef MeshlessAdapter<Topologies::Cube<2>::Topology> AdapterType;
+
+        FloatCoord<2> dim(6.5, 1);
+        double boxSize = 2;
+        AdapterType adapter(dim, boxSize);
+
+        // no wrap-around, so the outermost positions aren't neighbors:
+        AdapterType::CoordVec positions;
+        for (int i = 0; i < 6; ++i) {
+            positions.push_back(std::make_pair(FloatCoord<2>(i + 0.5, 0.5), i));
+        }
+        AdapterType::Graph graph = adapter.findAllNeighbors(positions);
+        std::vector<int> expected;
+        expected << 1;
+        TS_ASSERT_EQUALS(expected, graph[0]);
+        expected.clear();
+        expected << 4;
+        TS_ASSERT_EQUALS(expected, graph[5]);
+
+        checkAgainstSearch(adapter, positions);
+    }
+
     void testBoxSizeDetermination()
     {
         typedef MeshlessAdapter<Topologies::Torus<2>::Topology> AdapterType;
@@ -136,6 +196,45 @@ public:
         adapter.resetBoxSize(0.47);
         TS_ASSERT_EQUALS_DOUBLE(0.5, adapter.findOptimumBoxSize(positions, graph));
     }
+
+private:
+    /**
+     * findAllPairs() and findAllNeighbors() need to agree with the
+     * CoordListGrid-based search() for every vertex.
+     */
+    template<typename ADAPTER>
+    void checkAgainstSearch(const ADAPTER& adapter, const typename ADAPTER::CoordVec& positions)
+    {
+        typename ADAPTER::CoordListGrid grid = adapter.grid();
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            adapter.insert(&grid, positions[i].first, int(i));
+        }
+
+        typename ADAPTER::Graph graph = adapter.findAllNeighbors(positions);
+        typename ADAPTER::PairVec pairs = adapter.findAllPairs(positions);
+        std::size_t numPairs = 0;
+
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            std::set<int> found;
+            adapter.search(grid, positions[i].first, &found);
+            found.erase(int(i));
+
+            std::set<int> neighbors(graph[i].begin(), graph[i].end());
+            TS_ASSERT_EQUALS(found, neighbors);
+
+            for (std::set<int>::iterator j = found.begin(); j != found.end(); ++j) {
+                if (*j > int(i)) {
+                    ++numPairs;
+                    std::pair<int, int> pair(
+                        (std::min)(positions[i].second, positions[*j].second),
+                        (std::max)(positions[i].second, positions[*j].second));
+                    TS_ASSERT(std::find(pairs.begin(), pairs.end(), pair) != pairs.end());
+                }
+            }
+        }
+
+        TS_ASSERT_EQUALS(numPairs, pairs.size());
+    }
 };
 
 }
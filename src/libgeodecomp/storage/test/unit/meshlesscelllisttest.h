@@ -0,0 +1,262 @@
+#include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/meshlessadapter.h>
+#include <libgeodecomp/storage/meshlesscelllist.h>
+
+#include <cxxtest/TestSuite.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class MeshlessCellListTest : public CxxTest::TestSuite
+{
+public:
+    template<int DIM>
+    std::vector<FloatCoord<DIM> > randomPositions(const FloatCoord<DIM>& dim, int num)
+    {
+        std::vector<FloatCoord<DIM> > ret;
+        for (int i = 0; i < num; ++i) {
+            FloatCoord<DIM> pos;
+            for (int d = 0; d < DIM; ++d) {
+                pos[d] = Random::genDouble(dim[d]);
+            }
+            ret.push_back(pos);
+        }
+
+        return ret;
+    }
+
+    /**
+     * O(n^2) reference implementation.
+     */
+    template<class TOPOLOGY>
+    std::vector<std::pair<int, int> > bruteForcePairs(
+        const std::vector<FloatCoord<TOPOLOGY::DIM> >& positions,
+        const FloatCoord<TOPOLOGY::DIM>& dim,
+        double cutoff)
+    {
+        std::vector<std::pair<int, int> > ret;
+
+        for (int i = 0; i < int(positions.size()); ++i) {
+            for (int j = i + 1; j < int(positions.size()); ++j) {
+                double dist2 = 0;
+                for (int d = 0; d < TOPOLOGY::DIM; ++d) {
+                    double delta = std::abs(positions[i][d] - positions[j][d]);
+                    if (TOPOLOGY::wrapsAxis(d)) {
+                        delta = (std::min)(delta, dim[d] - delta);
+                    }
+                    dist2 += delta * delta;
+                }
+
+                if (dist2 < cutoff * cutoff) {
+                    ret.push_back(std::make_pair(i, j));
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    template<class TOPOLOGY>
+    void checkPairs(
+        const MeshlessCellList<TOPOLOGY>& cellList,
+        const std::vector<FloatCoord<TOPOLOGY::DIM> >& positions,
+        const FloatCoord<TOPOLOGY::DIM>& dim,
+        double cutoff)
+    {
+        std::vector<std::pair<int, int> > expected = bruteForcePairs<TOPOLOGY>(positions, dim, cutoff);
+        std::vector<std::pair<int, int> > actual = cellList.findAllPairs();
+        std::sort(actual.begin(), actual.end());
+        TS_ASSERT_EQUALS(expected.size(), actual.size());
+        TS_ASSERT(expected == actual);
+
+        typename MeshlessCellList<TOPOLOGY>::Graph graph = cellList.neighborGraph();
+        std::size_t numEdges = 0;
+        for (std::size_t i = 0; i < graph.size(); ++i) {
+            numEdges += graph[i].size();
+        }
+        TS_ASSERT_EQUALS(2 * expected.size(), numEdges);
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            const std::vector<int>& neighbors = graph[expected[i].first];
+            TS_ASSERT(std::binary_search(neighbors.begin(), neighbors.end(), expected[i].second));
+        }
+    }
+
+    void testTorus2D()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        FloatCoord<2> dim(100, 45);
+        double cutoff = 4;
+        std::vector<FloatCoord<2> > positions = randomPositions(dim, 2000);
+
+        MeshlessCellList<Topology> cellList(dim, cutoff);
+        cellList.rebuild(positions);
+        TS_ASSERT_EQUALS(Coord<2>(25, 11), cellList.getBinDim());
+        TS_ASSERT_EQUALS(positions.size(), cellList.binOffsets().back());
+        checkPairs(cellList, positions, dim, cutoff);
+
+        // particles need to be sorted by bins, bins in ascending order:
+        const std::vector<std::size_t>& offsets = cellList.binOffsets();
+        const std::vector<int>& ids = cellList.particleIDs();
+        for (std::size_t bin = 0; bin < offsets.size() - 1; ++bin) {
+            for (std::size_t i = offsets[bin]; i < offsets[bin + 1]; ++i) {
+                TS_ASSERT_EQUALS(bin, cellList.binIndex(positions[ids[i]]));
+                TS_ASSERT_EQUALS(positions[ids[i]][1], cellList.positionComponent(1)[i]);
+                if (i > offsets[bin]) {
+                    TS_ASSERT_LESS_THAN(ids[i - 1], ids[i]);
+                }
+            }
+        }
+    }
+
+    void testCube3D()
+    {
+        typedef Topologies::Cube<3>::Topology Topology;
+        FloatCoord<3> dim(20, 30, 10);
+        double cutoff = 2.5;
+        std::vector<FloatCoord<3> > positions = randomPositions(dim, 3000);
+
+        MeshlessCellList<Topology> cellList(dim, cutoff);
+        cellList.rebuild(positions);
+        TS_ASSERT_EQUALS(Coord<3>(8, 12, 4), cellList.getBinDim());
+        checkPairs(cellList, positions, dim, cutoff);
+    }
+
+    void testFewBins()
+    {
+        // wrapping must not cause neighboring bins to be visited twice:
+        typedef Topologies::Torus<2>::Topology Topology;
+        FloatCoord<2> dim(10, 5);
+        double cutoff = 4;
+        std::vector<FloatCoord<2> > positions = randomPositions(dim, 200);
+
+        MeshlessCellList<Topology> cellList(dim, cutoff);
+        cellList.rebuild(positions);
+        TS_ASSERT_EQUALS(Coord<2>(2, 1), cellList.getBinDim());
+        checkPairs(cellList, positions, dim, cutoff);
+    }
+
+    void testUpdate()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        FloatCoord<2> dim(50, 50);
+        double cutoff = 3;
+        double skin = 1;
+        std::vector<FloatCoord<2> > positions = randomPositions(dim, 1000);
+
+        MeshlessCellList<Topology> cellList(dim, cutoff, skin);
+        cellList.rebuild(positions);
+        std::vector<int> ids = cellList.particleIDs();
+
+        // moves of less than half the skin retain the bins...
+        for (int step = 0; step < 3; ++step) {
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                positions[i][0] += 0.1;
+                positions[i][1] -= 0.1;
+            }
+            TS_ASSERT(!cellList.update(positions));
+            TS_ASSERT_EQUALS(ids, cellList.particleIDs());
+            checkPairs(cellList, positions, dim, cutoff);
+        }
+
+        // ...while larger ones trigger a re-binning:
+        positions[17][0] += 0.2;
+        TS_ASSERT(cellList.update(positions));
+        checkPairs(cellList, positions, dim, cutoff);
+
+        positions.push_back(FloatCoord<2>(1, 2));
+        TS_ASSERT(cellList.update(positions));
+        checkPairs(cellList, positions, dim, cutoff);
+    }
+
+    void testRebuildWithSmallerTeam()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        typedef Topologies::Torus<2>::Topology Topology;
+        FloatCoord<2> dim(30, 20);
+        double cutoff = 5;
+        std::vector<FloatCoord<2> > positions = randomPositions(dim, 3000);
+        MeshlessCellList<Topology> cellList(dim, cutoff);
+
+        // rebuild() asks for 4 threads, but nested in another
+        // parallel region it only gets one:
+        int oldNumThreads = omp_get_max_threads();
+        int oldMaxActiveLevels = omp_get_max_active_levels();
+        omp_set_num_threads(4);
+        omp_set_max_active_levels(1);
+
+#pragma omp parallel num_threads(2)
+        {
+#pragma omp master
+            {
+                cellList.rebuild(positions);
+            }
+        }
+
+        omp_set_max_active_levels(oldMaxActiveLevels);
+        omp_set_num_threads(oldNumThreads);
+
+        TS_ASSERT_EQUALS(positions.size(), cellList.binOffsets().back());
+        checkPairs(cellList, positions, dim, cutoff);
+#endif
+    }
+
+    void testAdapterFindAllPairs()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        typedef MeshlessAdapter<Topology> AdapterType;
+        FloatCoord<2> dim(40, 30);
+        std::vector<FloatCoord<2> > positions = randomPositions(dim, 800);
+
+        AdapterType adapter(dim, 2.5);
+        AdapterType::CoordVec coordVec;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            coordVec.push_back(std::make_pair(positions[i], 1000 + int(i)));
+        }
+
+        // pairs are reported by vertex ID, not by index:
+        AdapterType::PairVec expected = bruteForcePairs<Topology>(positions, dim, 2.5);
+        for (AdapterType::PairVec::iterator i = expected.begin(); i != expected.end(); ++i) {
+            *i = std::make_pair(i->first + 1000, i->second + 1000);
+        }
+
+        AdapterType::PairVec actual = adapter.findAllPairs(coordVec);
+        std::sort(actual.begin(), actual.end());
+        TS_ASSERT(!expected.empty());
+        TS_ASSERT_EQUALS(expected.size(), actual.size());
+        TS_ASSERT(expected == actual);
+    }
+
+    void testReportFillLevels()
+    {
+        typedef Topologies::Cube<2>::Topology Topology;
+        FloatCoord<2> dim(4, 4);
+        std::vector<FloatCoord<2> > positions;
+        positions << FloatCoord<2>(0.5, 0.5)
+                  << FloatCoord<2>(1.5, 0.5)
+                  << FloatCoord<2>(1.5, 1.5)
+                  << FloatCoord<2>(3.5, 3.5);
+
+        MeshlessCellList<Topology> cellList(dim, 2);
+        cellList.rebuild(positions);
+        std::map<std::string, double> report = cellList.reportFillLevels();
+        TS_ASSERT_EQUALS(2, report["emptyCells"]);
+        TS_ASSERT_EQUALS(1, report["averageFill"]);
+        TS_ASSERT_EQUALS(0, report["lowestFill"]);
+        TS_ASSERT_EQUALS(3, report["highestFill"]);
+
+        MeshlessAdapter<Topology> adapter(dim, 2);
+        MeshlessAdapter<Topology>::CoordVec coordVec;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            coordVec.push_back(std::make_pair(positions[i], int(i)));
+        }
+        TS_ASSERT_EQUALS(report, adapter.reportFillLevels(coordVec));
+    }
+};
+
+}
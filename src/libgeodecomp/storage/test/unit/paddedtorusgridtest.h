@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/paddedtorusgrid.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Stores its own coordinate so we can check where cells in the ghost
+ * frame were copied from.
+ */
+template<int DIM, int RADIUS>
+class PaddedTorusGridTestCell
+{
+public:
+    class API :
+        public APITraits::HasStencil<Stencils::Moore<DIM, RADIUS> >
+    {};
+
+    explicit PaddedTorusGridTestCell(const Coord<DIM>& pos = Coord<DIM>()) :
+        pos(pos)
+    {}
+
+    Coord<DIM> pos;
+};
+
+class PaddedTorusGridTest : public CxxTest::TestSuite
+{
+public:
+    void testFrameWraps3D()
+    {
+        typedef Topologies::Torus<3>::Topology Topology;
+        typedef PaddedTorusGridTestCell<3, 2> Cell;
+
+        // a radius exceeding the grid's height needs to wrap repeatedly:
+        CoordBox<3> box(Coord<3>(5, 6, 7), Coord<3>(4, 1, 5));
+        PaddedTorusGrid<Cell, Topology> grid(box);
+        TS_ASSERT_EQUALS(box, grid.boundingBox());
+        TS_ASSERT_EQUALS(Coord<3>(8, 5, 9), grid.getPaddedDimensions());
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid.set(*i, Cell(*i));
+        }
+        grid.refreshGhostFrame();
+
+        CoordBox<3> frame(box.origin - Coord<3>::diagonal(2), grid.getPaddedDimensions());
+        for (CoordBox<3>::Iterator i = frame.begin(); i != frame.end(); ++i) {
+            Coord<3> expected;
+            for (int d = 0; d < 3; ++d) {
+                int length = box.dimensions[d];
+                expected[d] = box.origin[d] + ((*i)[d] - box.origin[d] + 2 * length) % length;
+            }
+            TS_ASSERT_EQUALS(expected, grid[*i].pos);
+        }
+    }
+
+    void testFrameHoldsEdgeCellOnNonWrappingAxes()
+    {
+        typedef Topologies::Cube<2>::Topology Topology;
+        typedef PaddedTorusGridTestCell<2, 1> Cell;
+
+        CoordBox<2> box(Coord<2>(), Coord<2>(6, 3));
+        Cell edgeCell(Coord<2>(-1, -1));
+        PaddedTorusGrid<Cell, Topology> grid(box, Cell(), edgeCell);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid.set(*i, Cell(*i));
+        }
+        grid.refreshGhostFrame();
+
+        CoordBox<2> frame(Coord<2>(-1, -1), grid.getPaddedDimensions());
+        for (CoordBox<2>::Iterator i = frame.begin(); i != frame.end(); ++i) {
+            Coord<2> expected = box.inBounds(*i) ? *i : edgeCell.pos;
+            TS_ASSERT_EQUALS(expected, grid[*i].pos);
+        }
+    }
+
+    void testStreaksAndRegions()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        typedef PaddedTorusGridTestCell<2, 1> Cell;
+
+        CoordBox<2> box(Coord<2>(10, 20), Coord<2>(8, 4));
+        PaddedTorusGrid<Cell, Topology> grid(box);
+
+        std::vector<Cell> cells;
+        for (int x = 12; x < 17; ++x) {
+            cells << Cell(Coord<2>(x, 22));
+        }
+        Streak<2> streak(Coord<2>(12, 22), 17);
+        grid.set(streak, cells.data());
+        TS_ASSERT_EQUALS(Coord<2>(14, 22), grid.get(Coord<2>(14, 22)).pos);
+
+        Region<2> region;
+        region << streak;
+        std::vector<Cell> buffer(region.size());
+        grid.saveRegion(&buffer, region);
+        for (std::size_t i = 0; i < buffer.size(); ++i) {
+            TS_ASSERT_EQUALS(cells[i].pos, buffer[i].pos);
+        }
+
+        grid.loadRegion(buffer, region, Coord<2>(-2, -2));
+        TS_ASSERT_EQUALS(Coord<2>(16, 22), grid.get(Coord<2>(14, 20)).pos);
+    }
+};
+
+}
@@ -13,6 +13,10 @@ class ReorderingUnstructuredGridTest : public CxxTest::TestSuite
 {
 public:
     typedef Topologies::Unstructured::Topology Topology;
+#ifdef LIBGEODECOMP_WITH_CPP14
+    typedef ReorderingUnstructuredGridHelpers::PhysicalRegionCache<Streak<1> > CacheType;
+#endif
+
     void testResize()
     {
 #ifdef LIBGEODECOMP_WITH_CPP14
@@ -785,6 +789,128 @@ public:
                  << Streak<1>(Coord<1>( 88), 120);
 
         TS_ASSERT_EQUALS(expected, actual);
+#endif
+    }
+
+    void testIDMap()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef ReorderingUnstructuredGridHelpers::IntPair IntPair;
+        typedef ReorderingUnstructuredGridHelpers::IDMap IDMap;
+
+        std::vector<IntPair> logicalToPhysicalIDs;
+        logicalToPhysicalIDs << std::make_pair(  -5, 4)
+                             << std::make_pair(   0, 3)
+                             << std::make_pair(   1, 0)
+                             << std::make_pair( 300, 2)
+                             << std::make_pair(5000, 1);
+        IDMap idMap(logicalToPhysicalIDs);
+
+        for (std::vector<IntPair>::iterator i = logicalToPhysicalIDs.begin();
+             i != logicalToPhysicalIDs.end();
+             ++i) {
+            TS_ASSERT_EQUALS(i->second, idMap[i->first]);
+        }
+
+        TS_ASSERT_EQUALS(-1, idMap[-6]);
+        TS_ASSERT_EQUALS(-1, idMap[-4]);
+        TS_ASSERT_EQUALS(-1, idMap[2]);
+        TS_ASSERT_EQUALS(-1, idMap[1000]);
+        TS_ASSERT_EQUALS(-1, idMap[4999]);
+        TS_ASSERT_EQUALS(-1, idMap[5001]);
+        TS_ASSERT_EQUALS(-1, IDMap()[0]);
+#endif
+    }
+
+    void testPhysicalRegionCache()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef ReorderingUnstructuredGridHelpers::IntPair IntPair;
+
+        // physical IDs: 10..14 map to 0..4, 20..22 to 7..5
+        std::vector<IntPair> logicalToPhysicalIDs;
+        for (int i = 0; i < 5; ++i) {
+            logicalToPhysicalIDs << std::make_pair(10 + i, i);
+        }
+        for (int i = 0; i < 3; ++i) {
+            logicalToPhysicalIDs << std::make_pair(20 + i, 7 - i);
+        }
+        ReorderingUnstructuredGridHelpers::IDMap idMap(logicalToPhysicalIDs);
+        CacheType cache;
+
+        Region<1> region;
+        region << Streak<1>(Coord<1>(11), 15)
+               << Streak<1>(Coord<1>(20), 23);
+
+        std::vector<Streak<1> > expected;
+        expected << Streak<1>(Coord<1>(1), 5)
+                 << Streak<1>(Coord<1>(7), 8)
+                 << Streak<1>(Coord<1>(6), 7)
+                 << Streak<1>(Coord<1>(5), 6);
+
+        CacheType::StreakVecPtr streaks = cache(region, idMap);
+        TS_ASSERT_EQUALS(expected, *streaks);
+        TS_ASSERT_EQUALS(streaks.get(), cache(region, idMap).get());
+
+        Region<1> invalidRegion;
+        invalidRegion << Coord<1>(16);
+        TS_ASSERT_THROWS(cache(invalidRegion, idMap), std::logic_error&);
+        TS_ASSERT_THROWS(cache(invalidRegion, idMap), std::logic_error&);
+
+        // evicted entries stay valid for whoever still holds them:
+        for (int mask = 1; mask <= 2 * int(CacheType::MAX_ENTRIES); ++mask) {
+            Region<1> other;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (mask & (1 << bit)) {
+                    other << Coord<1>((bit < 5) ? (10 + bit) : (15 + bit));
+                }
+            }
+            cache(other, idMap);
+        }
+        TS_ASSERT_EQUALS(expected, *streaks);
+        TS_ASSERT_DIFFERS(streaks.get(), cache(region, idMap).get());
+#endif
+    }
+
+    void testPhysicalRegionCacheConcurrentAccess()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef ReorderingUnstructuredGridHelpers::IntPair IntPair;
+
+        std::vector<IntPair> logicalToPhysicalIDs;
+        for (int i = 0; i < 1000; ++i) {
+            logicalToPhysicalIDs << std::make_pair(i, 999 - i);
+        }
+        ReorderingUnstructuredGridHelpers::IDMap idMap(logicalToPhysicalIDs);
+        CacheType cache;
+
+        // more Regions than entries, so threads evict each other's
+        // entries while they're still using them:
+        int numRegions = 4 * CacheType::MAX_ENTRIES;
+        int failures = 0;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic) num_threads(4) reduction(+:failures)
+#endif
+        for (int i = 0; i < 50 * numRegions; ++i) {
+            int start = 10 * (i % numRegions);
+            Region<1> region;
+            region << Streak<1>(Coord<1>(start), start + 10);
+
+            // IDs are mapped in reverse, so no streaks can be merged:
+            CacheType::StreakVecPtr streaks = cache(region, idMap);
+            if (streaks->size() != 10) {
+                ++failures;
+                continue;
+            }
+            for (int j = 0; j < 10; ++j) {
+                if ((*streaks)[j] != Streak<1>(Coord<1>(999 - start - j), 1000 - start - j)) {
+                    ++failures;
+                }
+            }
+        }
+
+        TS_ASSERT_EQUALS(0, failures);
 #endif
     }
 };
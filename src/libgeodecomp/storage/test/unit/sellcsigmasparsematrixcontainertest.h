@@ -883,6 +883,110 @@ public:
         TS_ASSERT(col[13] == 0);
 #endif
     }
+
+    void testInitFromShuffledMatrixAndCSR()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        const int DIM = 1000;
+        DMatrix matrix;
+        std::vector<int> rowOffsets(1, 0);
+        std::vector<int> columns;
+        std::vector<double> values;
+        for (int row = 0; row < DIM; ++row) {
+            // rows of varying length with columns in ascending order:
+            for (int i = 0; i < (row * 7) % 23; ++i) {
+                int column = (row + i * i) % DIM;
+                if (!columns.empty() && (rowOffsets.back() != int(columns.size())) &&
+                    (column <= columns.back())) {
+                    continue;
+                }
+                matrix << std::make_pair(Coord<2>(row, column), row + 0.001 * column);
+                columns << column;
+                values << row + 0.001 * column;
+            }
+            rowOffsets << int(columns.size());
+        }
+
+        SellCSigmaSparseMatrixContainer<double, 4, 16> reference(DIM);
+        reference.initFromMatrix(matrix);
+        for (int row = 0; row < DIM; ++row) {
+            const std::vector<std::pair<int, double> > expected = sortedRow(matrix, row);
+            TS_ASSERT_EQUALS(
+                expected,
+                reference.getRow(reference.realRowToSortedVec()[row].second));
+        }
+
+        SellCSigmaSparseMatrixContainer<double, 4, 16> fromCSR(DIM);
+        fromCSR.initFromCSR(rowOffsets, columns, values);
+        TS_ASSERT(reference == fromCSR);
+        TS_ASSERT_EQUALS(reference.chunkOffsetVec(),  fromCSR.chunkOffsetVec());
+        TS_ASSERT_EQUALS(reference.chunkRowToRealVec(), fromCSR.chunkRowToRealVec());
+
+        std::reverse(matrix.begin(), matrix.end());
+        std::swap(matrix[17], matrix[4711]);
+        SellCSigmaSparseMatrixContainer<double, 4, 16> fromShuffled(DIM);
+        fromShuffled.initFromMatrix(matrix);
+        TS_ASSERT(reference == fromShuffled);
+        TS_ASSERT_EQUALS(reference.realRowToSortedVec(), fromShuffled.realRowToSortedVec());
+
+        // padding rows are mapped onto themselves:
+        const std::vector<std::pair<int, int> >& realRowToSorted = reference.realRowToSortedVec();
+        TS_ASSERT_EQUALS(std::size_t(1000), realRowToSorted.size());
+        for (std::size_t i = 0; i < realRowToSorted.size(); ++i) {
+            TS_ASSERT_EQUALS(int(i), realRowToSorted[i].first);
+            TS_ASSERT_EQUALS(int(i), reference.chunkRowToRealVec()[realRowToSorted[i].second]);
+        }
+#endif
+    }
+
+    void testInitFromCSRWithPadding()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        // 0 1 0
+        // 2 0 3
+        // 0 0 4
+        std::vector<int> rowOffsets;
+        std::vector<int> columns;
+        std::vector<double> values;
+        rowOffsets << 0 << 1 << 3 << 4;
+        columns << 1 << 0 << 2 << 2;
+        values << 1 << 2 << 3 << 4;
+
+        SellCSigmaSparseMatrixContainer<double, 4, 1> a(3);
+        a.initFromCSR(rowOffsets, columns, values);
+
+        std::vector<int> expectedChunkRowToReal;
+        expectedChunkRowToReal << 0 << 1 << 2 << 3;
+        TS_ASSERT_EQUALS(expectedChunkRowToReal, a.chunkRowToRealVec());
+        TS_ASSERT_EQUALS(std::size_t(8), a.valuesVec().size());
+        TS_ASSERT_EQUALS(2, a.chunkLengthVec()[0]);
+
+        std::vector<std::pair<int, double> > row1;
+        row1 << std::make_pair(0, 2.0)
+             << std::make_pair(2, 3.0);
+        TS_ASSERT_EQUALS(row1, a.getRow(1));
+        TS_ASSERT_EQUALS(std::size_t(0), a.getRow(3).size());
+
+        rowOffsets.pop_back();
+        TS_ASSERT_THROWS(a.initFromCSR(rowOffsets, columns, values), std::invalid_argument&);
+#endif
+    }
+
+private:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    std::vector<std::pair<int, double> > sortedRow(const DMatrix& matrix, int row)
+    {
+        std::vector<std::pair<int, double> > ret;
+        for (std::size_t i = 0; i < matrix.size(); ++i) {
+            if (matrix[i].first.x() == row) {
+                ret << std::make_pair(matrix[i].first.y(), matrix[i].second);
+            }
+        }
+        std::sort(ret.begin(), ret.end());
+
+        return ret;
+    }
+#endif
 };
 
 }
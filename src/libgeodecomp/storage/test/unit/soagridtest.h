@@ -651,6 +651,47 @@ public:
         }
     }
 
+    void testLoadSaveRegionWithSelectors()
+    {
+        std::vector<Selector<MyDummyCell> > selectors;
+        selectors << Selector<MyDummyCell>(&MyDummyCell::z, "z")
+                  << Selector<MyDummyCell>(&MyDummyCell::y, "y");
+
+        CoordBox<2> box(Coord<2>(10, 20), Coord<2>(30, 20));
+        SoAGrid<MyDummyCell, Topology3> source(box, MyDummyCell(1, 2, 3));
+        SoAGrid<MyDummyCell, Topology3> target(box, MyDummyCell(-1, -2, -3));
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(10, 20), 25)
+               << Streak<2>(Coord<2>(30, 35), 40);
+        for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+            source.set(*i, MyDummyCell(i->x(), i->y() + 0.5, i->x() + i->y()));
+        }
+
+        std::vector<char> buffer;
+        source.saveRegion(&buffer, region, selectors);
+        TS_ASSERT_EQUALS(region.size() * (sizeof(char) + sizeof(double)), buffer.size());
+        TS_ASSERT_EQUALS(buffer.size(), SerializationBuffer<MyDummyCell>::minimumStorageSize(region, selectors));
+
+        target.loadRegion(buffer, region, selectors);
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            MyDummyCell cell = target.get(*i);
+            // members which weren't selected remain untouched:
+            TS_ASSERT_EQUALS(-1, cell.x);
+
+            if (region.count(*i)) {
+                TS_ASSERT_EQUALS(i->y() + 0.5, cell.y);
+                TS_ASSERT_EQUALS(char(i->x() + i->y()), cell.z);
+            } else {
+                TS_ASSERT_EQUALS(-2, cell.y);
+                TS_ASSERT_EQUALS(-3, cell.z);
+            }
+        }
+
+        buffer.resize(buffer.size() - 1);
+        TS_ASSERT_THROWS(target.loadRegion(buffer, region, selectors), std::logic_error&);
+    }
+
     void testLoadSaveMember3D()
     {
         // basic setup:
@@ -0,0 +1,212 @@
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/updatefunctor.h>
+#include <libgeodecomp/storage/verletboxcell.h>
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Particles which repel each other with a soft, linear force.
+ */
+class VerletTestParticle
+{
+public:
+    class API : public APITraits::HasCubeTopology<3>
+    {};
+
+    static inline double cutoff()
+    {
+        return 1.0;
+    }
+
+    static inline double deltaT()
+    {
+        return 0.02;
+    }
+
+    explicit VerletTestParticle(
+        const FloatCoord<3>& pos = FloatCoord<3>(),
+        const FloatCoord<3>& vel = FloatCoord<3>(),
+        const int id = 0) :
+        pos(pos),
+        vel(vel),
+        id(id)
+    {}
+
+    inline FloatCoord<3> getPos() const
+    {
+        return pos;
+    }
+
+    template<typename DOUBLE>
+    static inline DOUBLE forceFactor(const DOUBLE& distance2)
+    {
+        return DOUBLE(0.5) * (DOUBLE(cutoff() * cutoff()) - distance2);
+    }
+
+    inline void update(const FloatCoord<3>& force, const int nanoStep)
+    {
+        vel += force * deltaT();
+        pos += vel * deltaT();
+    }
+
+    FloatCoord<3> pos;
+    FloatCoord<3> vel;
+    int id;
+};
+
+class VerletBoxCellTest : public CxxTest::TestSuite
+{
+public:
+    typedef VerletBoxCell<VerletTestParticle> CellType;
+    typedef APITraits::SelectTopology<CellType>::Value Topology;
+    typedef Grid<CellType, Topology> GridType;
+
+    void setUp()
+    {
+        gridDim = Coord<3>(4, 4, 4);
+        cellDim = FloatCoord<3>(2.0, 2.0, 2.0);
+
+        particles.clear();
+        for (int i = 0; i < 500; ++i) {
+            // keep particles clear of the simulation space's boundary:
+            FloatCoord<3> pos(
+                1.5 + Random::genDouble(5.0),
+                1.5 + Random::genDouble(5.0),
+                1.5 + Random::genDouble(5.0));
+            FloatCoord<3> vel(
+                Random::genDouble(0.5) - 0.25,
+                Random::genDouble(0.5) - 0.25,
+                Random::genDouble(0.5) - 0.25);
+            particles << VerletTestParticle(pos, vel, i);
+        }
+    }
+
+    void testMatchesBruteForce()
+    {
+        std::size_t rebuilds = simulateAndCompare(0.4, 40);
+        std::size_t rebuildsWithoutSkin = simulateAndCompare(0.0, 40);
+
+        // lists are reused most of the time:
+        TS_ASSERT_LESS_THAN(rebuilds * 3, rebuildsWithoutSkin);
+    }
+
+    void testInsert()
+    {
+        CellType cell(FloatCoord<3>(2, 2, 2), cellDim, 1.0, 0.4);
+        cell << particles[0]
+             << particles[1];
+        TS_ASSERT_EQUALS(std::size_t(2), cell.size());
+        TS_ASSERT_EQUALS(std::size_t(0), cell.numRebuilds());
+        TS_ASSERT_EQUALS(particles[1].pos, cell[1].getPos());
+    }
+
+private:
+    Coord<3> gridDim;
+    FloatCoord<3> cellDim;
+    std::vector<VerletTestParticle> particles;
+
+    GridType initGrid(double skin)
+    {
+        GridType grid(gridDim);
+        CoordBox<3> box = grid.boundingBox();
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid[*i] = CellType(cellDim.scale(*i), cellDim, VerletTestParticle::cutoff(), skin);
+        }
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            Coord<3> c;
+            for (int d = 0; d < 3; ++d) {
+                c[d] = int(particles[i].pos[d] / cellDim[d]);
+            }
+            CellType cell = grid[c];
+            cell << particles[i];
+            grid[c] = cell;
+        }
+
+        return grid;
+    }
+
+    std::size_t countParticles(const GridType& grid)
+    {
+        std::size_t ret = 0;
+        CoordBox<3> box = grid.boundingBox();
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            ret += grid[*i].size();
+        }
+
+        return ret;
+    }
+
+    void bruteForceStep(std::vector<VerletTestParticle> *reference)
+    {
+        double cutoff2 = VerletTestParticle::cutoff() * VerletTestParticle::cutoff();
+        std::vector<FloatCoord<3> > forces(reference->size());
+
+        for (std::size_t i = 0; i < reference->size(); ++i) {
+            for (std::size_t j = 0; j < reference->size(); ++j) {
+                FloatCoord<3> delta = (*reference)[i].pos - (*reference)[j].pos;
+                double distance2 = delta * delta;
+                if ((i != j) && (distance2 < cutoff2)) {
+                    forces[i] += delta * VerletTestParticle::forceFactor(distance2);
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < reference->size(); ++i) {
+            (*reference)[i].update(forces[i], 0);
+        }
+    }
+
+    std::size_t simulateAndCompare(double skin, int steps)
+    {
+        GridType grid1 = initGrid(skin);
+        GridType grid2 = grid1;
+        GridType *oldGrid = &grid1;
+        GridType *newGrid = &grid2;
+        Region<3> region;
+        region << grid1.boundingBox();
+        std::vector<VerletTestParticle> reference = particles;
+
+        for (int t = 0; t < steps; ++t) {
+            UpdateFunctor<CellType>()(
+                region,
+                Coord<3>(),
+                Coord<3>(),
+                *oldGrid,
+                newGrid,
+                0);
+            std::swap(oldGrid, newGrid);
+            bruteForceStep(&reference);
+        }
+
+        TS_ASSERT_EQUALS(reference.size(), countParticles(*oldGrid));
+        std::size_t rebuilds = 0;
+        CoordBox<3> box = oldGrid->boundingBox();
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const CellType& cell = (*oldGrid)[*i];
+            rebuilds += cell.numRebuilds();
+            // particles may only linger up to skin/2 outside their
+            // box, plus whatever distance they moved in the last step:
+            FloatCoord<3> margin = FloatCoord<3>::diagonal(skin * 0.5 + 0.1);
+            FloatCoord<3> lower = cellDim.scale(*i) - margin;
+            FloatCoord<3> upper = cellDim.scale(*i) + cellDim + margin;
+
+            for (CellType::const_iterator j = cell.begin(); j != cell.end(); ++j) {
+                TS_ASSERT(lower.dominates(j->getPos()));
+                TS_ASSERT(j->getPos().strictlyDominates(upper));
+                const VerletTestParticle& expected = reference[j->id];
+                TS_ASSERT_LESS_THAN((j->pos - expected.pos).length(), 1e-9);
+                TS_ASSERT_LESS_THAN((j->vel - expected.vel).length(), 1e-9);
+            }
+        }
+
+        return rebuilds;
+    }
+};
+
+}
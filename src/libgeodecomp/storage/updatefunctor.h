@@ -136,6 +136,7 @@ public:
                 nanoStep,
                 &concurrencySpec,
                 &modelThreadingSpec));
+        concurrencySpec.regionUpdated(*gridNew);
     }
 
     template<typename GRID1, typename GRID2, typename CONCURRENCY_FUNCTOR, typename ANY_API, typename ANY_TOPOLOGY, typename ANY_THREADED_UPDATE>
@@ -168,6 +169,10 @@ public:
         LinePointerUpdateFunctor<CELL>()(                               \
             streak, gridOld.boundingBox(), pointers,                    \
             &(*gridNew)[realTargetCoord], nanoStep);                    \
+        concurrencySpec.streakUpdated(                                  \
+            Streak<DIM>(realTargetCoord,                                \
+                        realTargetCoord.x() + i->length()),             \
+            *gridNew);                                                  \
         /**/
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_1
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_2
@@ -206,6 +211,9 @@ public:
         Coord<DIM> targetOrigin = i->origin + targetOffset;             \
         VanillaUpdateFunctor<CELL>()(                                   \
             sourceStreak, targetOrigin, gridOld, gridNew, nanoStep);    \
+        concurrencySpec.streakUpdated(                                  \
+            Streak<DIM>(targetOrigin, targetOrigin.x() + i->length()),  \
+            *gridNew);                                                  \
         /**/
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_1
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_2
@@ -244,6 +252,9 @@ public:
         Coord<DIM> targetOrigin = i->origin + targetOffset;             \
         VanillaUpdateFunctor<CELL>()(                                   \
             sourceStreak, targetOrigin, gridOld, gridNew, nanoStep);    \
+        concurrencySpec.streakUpdated(                                  \
+            Streak<DIM>(targetOrigin, targetOrigin.x() + i->length()),  \
+            *gridNew);                                                  \
         /**/
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_1
         LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_2
@@ -278,6 +289,7 @@ public:
         ANY_THREADED_UPDATE modelThreadingSpec)
     {
         UnstructuredUpdateFunctor<CELL>()(region, gridOld, gridNew, nanoStep, concurrencySpec, modelThreadingSpec);
+        concurrencySpec.regionUpdated(*gridNew);
     }
 #endif
 };
@@ -285,6 +297,13 @@ public:
 /**
  * The default CONCURRENCY_FUNCTOR for UpdateFunctor: won't request
  * threading and won't execute any sideband actions.
+ *
+ * Sideband actions hook into the update via streakUpdated(), which
+ * is called (from within the updating thread) for each Streak right
+ * after it has been written to the new grid, and regionUpdated(),
+ * which is called once after the whole Region has been updated by
+ * implementations which don't work on Streaks of cells (SoA and
+ * unstructured grids).
  */
 class ConcurrencyNoP
 {
@@ -312,6 +331,14 @@ public:
     {
         return false;
     }
+
+    template<int DIM, typename GRID>
+    void streakUpdated(const Streak<DIM>& /* unused: streak */, const GRID& /* unused: grid */) const
+    {}
+
+    template<typename GRID>
+    void regionUpdated(const GRID& /* unused: grid */) const
+    {}
 };
 
 /**
@@ -348,6 +375,14 @@ public:
         return enableFineGrainedParallelism;
     }
 
+    template<int DIM, typename GRID>
+    void streakUpdated(const Streak<DIM>& /* unused: streak */, const GRID& /* unused: grid */) const
+    {}
+
+    template<typename GRID>
+    void regionUpdated(const GRID& /* unused: grid */) const
+    {}
+
 private:
     bool updatingGhost;
     bool enableFineGrainedParallelism;
@@ -384,6 +419,14 @@ public:
         return enableFineGrainedParallelism;
     }
 
+    template<int DIM, typename GRID>
+    void streakUpdated(const Streak<DIM>& /* unused: streak */, const GRID& /* unused: grid */) const
+    {}
+
+    template<typename GRID>
+    void regionUpdated(const GRID& /* unused: grid */) const
+    {}
+
 private:
     bool enableFineGrainedParallelism;
 };
@@ -2,6 +2,7 @@
 #define LIBGEODECOMP_STORAGE_UPDATEFUNCTORMACROS_H
 
 #include <libgeodecomp/storage/updatefunctormacrosmsvc.h>
+#include <libgeodecomp/storage/workdecomposition.h>
 
 #ifndef _MSC_BUILD
 
@@ -9,7 +10,9 @@
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_1                         \
     if (concurrencySpec.enableOpenMP() &&                               \
         !modelThreadingSpec.hasOpenMP()) {                              \
-        if (concurrencySpec.preferStaticScheduling()) {                 \
+        std::size_t numThreads = omp_get_max_threads();                 \
+        if (concurrencySpec.preferStaticScheduling() &&                 \
+            (region.numPlanes() >= numThreads)) {                       \
             _Pragma("omp parallel for schedule(static)")                \
             for (std::size_t c = 0; c < region.numPlanes(); ++c) {      \
                 typename Region<DIM>::StreakIterator e =                \
@@ -24,7 +27,8 @@
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_2                         \
         } else {                                                        \
-            if (!concurrencySpec.preferFineGrainedParallelism()) {      \
+            if (!concurrencySpec.preferFineGrainedParallelism() &&      \
+                (region.numPlanes() >= numThreads)) {                   \
                 _Pragma("omp parallel for schedule(dynamic)")           \
                 for (std::size_t c = 0; c < region.numPlanes(); ++c) {  \
                     typename Region<DIM>::StreakIterator e =            \
@@ -39,28 +43,13 @@
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_3                         \
             } else {                                                    \
-                typedef typename Region<DIM>::StreakIterator Iter;      \
-                std::vector<Streak<DIM> > streaks;                      \
-                streaks.reserve(region.numStreaks());                   \
-                for (Iter i = region.beginStreak();                     \
-                     i != region.endStreak();                           \
-                     ++i) {                                             \
-                    Streak<DIM> s = *i;                                 \
-                    auto granularity = modelThreadingSpec.granularity(); \
-                    while (s.length() > granularity) {                  \
-                        Streak<DIM> tranche = s;                        \
-                        tranche.endX = s.origin.x() + granularity -     \
-                            (s.origin.x() % granularity);               \
-                        streaks.push_back(tranche);                     \
-                        s.origin.x() = tranche.endX;                    \
-                    }                                                   \
-                    streaks.push_back(s);                               \
-                }                                                       \
-                _Pragma("omp parallel for schedule(dynamic)")           \
-                    for (std::size_t j = 0; j < streaks.size(); ++j) {  \
-                        Streak<DIM> *i = &streaks[j];                   \
-                        LGD_UPDATE_FUNCTOR_BODY;                        \
-                    }                                                   \
+                WorkDecompositionCache<DIM>::instance()(                \
+                    region,                                             \
+                    modelThreadingSpec.granularity(),                   \
+                    numThreads)(                                        \
+                        [&](const Streak<DIM> *i) {                     \
+                            LGD_UPDATE_FUNCTOR_BODY;                    \
+                        });                                             \
             }                                                           \
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_4                         \
@@ -11,7 +11,9 @@
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_1                         \
     if (concurrencySpec.enableOpenMP() &&                               \
         !modelThreadingSpec.hasOpenMP()) {                              \
-        if (concurrencySpec.preferStaticScheduling()) {                 \
+        std::size_t numThreads = omp_get_max_threads();                 \
+        if (concurrencySpec.preferStaticScheduling() &&                 \
+            (region.numPlanes() >= numThreads)) {                       \
             __pragma(omp parallel for schedule(static))                 \
             for (int c = 0; c < int(region.numPlanes()); ++c) {         \
                 typename Region<DIM>::StreakIterator e =                \
@@ -26,7 +28,8 @@
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_2                         \
         } else {                                                        \
-            if (!concurrencySpec.preferFineGrainedParallelism()) {      \
+            if (!concurrencySpec.preferFineGrainedParallelism() &&      \
+                (region.numPlanes() >= numThreads)) {                   \
                 __pragma(omp parallel for schedule(dynamic))            \
                 for (int c = 0; c < int(region.numPlanes()); ++c) {     \
                     typename Region<DIM>::StreakIterator e =            \
@@ -41,28 +44,13 @@
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_3                         \
             } else {                                                    \
-                typedef typename Region<DIM>::StreakIterator Iter;      \
-                std::vector<Streak<DIM> > streaks;                      \
-                streaks.reserve(region.numStreaks());                   \
-                for (Iter i = region.beginStreak();                     \
-                     i != region.endStreak();                           \
-                     ++i) {                                             \
-                    Streak<DIM> s = *i;                                 \
-                    auto granularity = modelThreadingSpec.granularity(); \
-                    while (s.length() > granularity) {                  \
-                        Streak<DIM> tranche = s;                        \
-                        tranche.endX = s.origin.x() + granularity -     \
-                            (s.origin.x() % granularity);               \
-                        streaks.push_back(tranche);                     \
-                        s.origin.x() = tranche.endX;                    \
-                    }                                                   \
-                    streaks.push_back(s);                               \
-                }                                                       \
-                __pragma(omp parallel for schedule(dynamic))            \
-                for (int j = 0; j < int(streaks.size()); ++j) {         \
-                    Streak<DIM> *i = &streaks[std::size_t(j)];          \
-                    LGD_UPDATE_FUNCTOR_BODY;                            \
-                }                                                       \
+                WorkDecompositionCache<DIM>::instance()(                \
+                    region,                                             \
+                    modelThreadingSpec.granularity(),                   \
+                    numThreads)(                                        \
+                        [&](const Streak<DIM> *i) {                     \
+                            LGD_UPDATE_FUNCTOR_BODY;                    \
+                        });                                             \
             }                                                           \
     /**/
 #define LGD_UPDATE_FUNCTOR_THREADING_SELECTOR_4                         \
@@ -0,0 +1,417 @@
+#ifndef LIBGEODECOMP_STORAGE_VERLETBOXCELL_H
+#define LIBGEODECOMP_STORAGE_VERLETBOXCELL_H
+
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/floatcoord.h>
+#include <libgeodecomp/geometry/stencils.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <libflatarray/aligned_allocator.hpp>
+#include <libflatarray/short_vec.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Alternative to BoxCell for n-body codes with short-range, central
+ * forces. BoxCell hands each particle all particles of the
+ * surrounding boxes in every step, so the pair search dominates the
+ * run time. VerletBoxCell instead keeps the positions of the
+ * surrounding boxes in SoA format and caches Verlet neighbor lists
+ * for its particles: all particles within (cutoff + skin), stored as
+ * offsets into the concatenated positions of the neighborhood. The
+ * lists are only rebuilt once a particle in the neighborhood has
+ * moved further than skin/2 or the neighborhood's composition
+ * changed. Forces are evaluated with LibFlatArray's short_vec.
+ *
+ * To keep the composition stable, a particle only migrates to
+ * another box once it is more than skin/2 outside of its current
+ * box. Hence the edges of the boxes need to be at least as long as
+ * (cutoff + 2 * skin).
+ *
+ * PARTICLE needs to provide:
+ *
+ * - FloatCoord<DIM> getPos() const
+ *
+ * - template<typename DOUBLE> static DOUBLE forceFactor(const DOUBLE& distance2),
+ *   which is instantiated with short_vec<double, ARITY>. The force a
+ *   particle at distance delta exerts is delta * forceFactor(delta * delta),
+ *   pairs beyond the cutoff are masked out by VerletBoxCell.
+ *
+ * - void update(const FloatCoord<DIM>& force, int nanoStep)
+ */
+template<typename PARTICLE>
+class VerletBoxCell
+{
+public:
+    friend class VerletBoxCellTest;
+
+    typedef std::vector<PARTICLE> Container;
+    typedef typename Container::value_type Cargo;
+    typedef typename Container::value_type value_type;
+    typedef typename Container::const_iterator const_iterator;
+    typedef typename Container::iterator iterator;
+    typedef typename APITraits::SelectTopology<Cargo>::Value Topology;
+
+    class API :
+        public APITraits::SelectAPI<Cargo>::Value,
+        public APITraits::HasStencil<Stencils::Moore<Topology::DIM, 1> >
+    {};
+
+    const static int DIM = Topology::DIM;
+    const static int ARITY = 4;
+
+    typedef LibFlatArray::short_vec<double, ARITY> ShortVec;
+    typedef std::vector<double, LibFlatArray::aligned_allocator<double, 64> > DoubleVec;
+
+    inline explicit VerletBoxCell(
+        const FloatCoord<DIM>& origin = Coord<DIM>(),
+        const FloatCoord<DIM>& dimension = Coord<DIM>(),
+        const double cutoff = 0,
+        const double skin = 0) :
+        origin(origin),
+        dimension(dimension),
+        cutoff(cutoff),
+        skin(skin),
+        generation(0),
+        rebuilds(0)
+    {}
+
+    inline const_iterator begin() const
+    {
+        return particles.begin();
+    }
+
+    inline iterator begin()
+    {
+        return particles.begin();
+    }
+
+    inline const_iterator end() const
+    {
+        return particles.end();
+    }
+
+    inline iterator end()
+    {
+        return particles.end();
+    }
+
+    inline void insert(const Cargo& particle)
+    {
+        particles << particle;
+        for (int d = 0; d < DIM; ++d) {
+            positions[d] << particle.getPos()[d];
+        }
+        ++generation;
+    }
+
+    inline std::size_t size() const
+    {
+        return particles.size();
+    }
+
+    inline
+    const Cargo& operator[](const std::size_t i) const
+    {
+        return particles[i];
+    }
+
+    inline
+    VerletBoxCell& operator<<(const Cargo& cargo)
+    {
+        insert(cargo);
+        return *this;
+    }
+
+    /**
+     * Number of times this box had to rebuild its neighbor lists.
+     */
+    inline std::size_t numRebuilds() const
+    {
+        return rebuilds;
+    }
+
+    template<class HOOD>
+    inline void update(const HOOD& hood, const int nanoStep)
+    {
+        const VerletBoxCell& oldSelf = hood[Coord<DIM>()];
+        origin     = oldSelf.origin;
+        dimension  = oldSelf.dimension;
+        cutoff     = oldSelf.cutoff;
+        skin       = oldSelf.skin;
+        generation = oldSelf.generation;
+        rebuilds   = oldSelf.rebuilds;
+
+        gatherNeighborhood(hood);
+        bool migrated = collectParticles(hood);
+        if (migrated) {
+            ++generation;
+        }
+
+        bool valid = !migrated && (oldSelf.listGenerations == haloGenerations);
+        if (valid) {
+            neighborOffsets = oldSelf.neighborOffsets;
+            neighborIndices = oldSelf.neighborIndices;
+            listGenerations = oldSelf.listGenerations;
+            for (int d = 0; d < DIM; ++d) {
+                reference[d] = oldSelf.reference[d];
+            }
+            valid = (maxDisplacement2() * 4) <= (skin * skin);
+        }
+        if (!valid) {
+            rebuildLists();
+        }
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            particles[i].update(force(i), nanoStep);
+            FloatCoord<DIM> pos = particles[i].getPos();
+            for (int d = 0; d < DIM; ++d) {
+                positions[d][i] = pos[d];
+            }
+        }
+    }
+
+private:
+    // padding slots in the halo are parked here, far beyond any cutoff:
+    static inline double farAway()
+    {
+        return 1e100;
+    }
+
+    FloatCoord<DIM> origin;
+    FloatCoord<DIM> dimension;
+    double cutoff;
+    double skin;
+    // incremented whenever particles enter or leave this box:
+    std::size_t generation;
+    std::size_t rebuilds;
+
+    Container particles;
+    DoubleVec positions[DIM];
+
+    // positions of all particles in the neighborhood, concatenated
+    // in stencil order and padded to a multiple of ARITY:
+    DoubleVec halo[DIM];
+    std::vector<std::size_t> haloOffsets;
+    std::vector<std::size_t> haloGenerations;
+    // slot of each of our particles within the halo:
+    std::vector<int> haloSelf;
+
+    // Verlet lists (CSR format) and the state they were built from:
+    std::vector<std::size_t> neighborOffsets;
+    std::vector<int> neighborIndices;
+    std::vector<std::size_t> listGenerations;
+    DoubleVec reference[DIM];
+
+    static inline CoordBox<DIM> stencil()
+    {
+        return CoordBox<DIM>(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+    }
+
+    template<class HOOD>
+    void gatherNeighborhood(const HOOD& hood)
+    {
+        haloOffsets.clear();
+        haloGenerations.clear();
+        std::size_t haloSize = 0;
+
+        CoordBox<DIM> box = stencil();
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const VerletBoxCell& cell = hood[*i];
+            haloOffsets << haloSize;
+            haloGenerations << cell.generation;
+            haloSize += cell.particles.size();
+        }
+        haloOffsets << haloSize;
+
+        // one extra slot so padded lists always have a target:
+        std::size_t paddedSize = (haloSize / ARITY + 1) * ARITY;
+        for (int d = 0; d < DIM; ++d) {
+            halo[d].resize(paddedSize);
+            std::fill(halo[d].begin() + haloSize, halo[d].end(), farAway());
+        }
+
+        std::size_t index = 0;
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i, ++index) {
+            const VerletBoxCell& cell = hood[*i];
+            for (int d = 0; d < DIM; ++d) {
+                std::copy(cell.positions[d].begin(), cell.positions[d].end(), halo[d].begin() + haloOffsets[index]);
+            }
+        }
+    }
+
+    /**
+     * Particles stay with their box as long as they are less than
+     * skin/2 outside of it. Returns true if any particle entered or
+     * left this box.
+     */
+    template<class HOOD>
+    bool collectParticles(const HOOD& hood)
+    {
+        FloatCoord<DIM> margin = FloatCoord<DIM>::diagonal(skin * 0.5);
+        FloatCoord<DIM> oppositeCorner = origin + dimension;
+        bool migrated = false;
+
+        particles.clear();
+        for (int d = 0; d < DIM; ++d) {
+            positions[d].clear();
+        }
+        haloSelf.clear();
+
+        CoordBox<DIM> box = stencil();
+        std::size_t index = 0;
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i, ++index) {
+            const VerletBoxCell& cell = hood[*i];
+            bool isSelf = (*i == Coord<DIM>());
+            FloatCoord<DIM> lower = cell.origin - margin;
+            FloatCoord<DIM> upper = cell.origin + cell.dimension + margin;
+
+            for (std::size_t j = 0; j < cell.particles.size(); ++j) {
+                const Cargo& particle = cell.particles[j];
+                bool staysWithOwner = APITraits::SelectPositionChecker<Cargo>::value(particle, lower, upper);
+
+                if (isSelf) {
+                    if (!staysWithOwner) {
+                        migrated = true;
+                        continue;
+                    }
+                } else {
+                    if (staysWithOwner ||
+                        !APITraits::SelectPositionChecker<Cargo>::value(particle, origin, oppositeCorner)) {
+                        continue;
+                    }
+                    migrated = true;
+                }
+
+                particles << particle;
+                for (int d = 0; d < DIM; ++d) {
+                    positions[d] << cell.positions[d][j];
+                }
+                haloSelf << int(haloOffsets[index] + j);
+            }
+        }
+
+        return migrated;
+    }
+
+    double maxDisplacement2() const
+    {
+        double ret = 0;
+        std::size_t haloSize = haloOffsets.back();
+
+        for (std::size_t i = 0; i < haloSize; ++i) {
+            double dist2 = 0;
+            for (int d = 0; d < DIM; ++d) {
+                double delta = halo[d][i] - reference[d][i];
+                dist2 += delta * delta;
+            }
+            ret = (std::max)(ret, dist2);
+        }
+
+        return ret;
+    }
+
+    void rebuildLists()
+    {
+        double range = cutoff + skin;
+        ShortVec range2 = range * range;
+        std::size_t haloSize = haloOffsets.back();
+        std::size_t paddedSize = halo[0].size();
+        // the first padding slot is guaranteed to exist:
+        int padding = int(haloSize);
+        double buffer[ARITY];
+
+        neighborOffsets.clear();
+        neighborIndices.clear();
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            neighborOffsets << neighborIndices.size();
+            int self = haloSelf[i];
+            ShortVec pos[DIM];
+            for (int d = 0; d < DIM; ++d) {
+                pos[d] = halo[d][self];
+            }
+
+            for (std::size_t j = 0; j < paddedSize; j += ARITY) {
+                ShortVec dist2 = 0.0;
+                for (int d = 0; d < DIM; ++d) {
+                    ShortVec delta = pos[d] - ShortVec(&halo[d][j]);
+                    dist2 += delta * delta;
+                }
+
+                if (!(dist2 < range2).any()) {
+                    continue;
+                }
+                dist2.store(buffer);
+
+                for (int k = 0; k < ARITY; ++k) {
+                    int candidate = int(j) + k;
+                    if ((buffer[k] < range * range) && (candidate != self) && (candidate < padding)) {
+                        neighborIndices << candidate;
+                    }
+                }
+            }
+
+            while ((neighborIndices.size() % ARITY) != 0) {
+                neighborIndices << padding;
+            }
+        }
+        neighborOffsets << neighborIndices.size();
+
+        listGenerations = haloGenerations;
+        for (int d = 0; d < DIM; ++d) {
+            reference[d] = halo[d];
+        }
+        ++rebuilds;
+    }
+
+    FloatCoord<DIM> force(std::size_t i) const
+    {
+        ShortVec cutoff2 = cutoff * cutoff;
+        ShortVec zero = 0.0;
+        ShortVec pos[DIM];
+        ShortVec accu[DIM];
+        int self = haloSelf[i];
+        for (int d = 0; d < DIM; ++d) {
+            pos[d] = halo[d][self];
+            accu[d] = 0.0;
+        }
+
+        for (std::size_t j = neighborOffsets[i]; j < neighborOffsets[i + 1]; j += ARITY) {
+            ShortVec delta[DIM];
+            ShortVec dist2 = 0.0;
+            for (int d = 0; d < DIM; ++d) {
+                ShortVec other;
+                other.gather(&halo[d][0], &neighborIndices[j]);
+                delta[d] = pos[d] - other;
+                dist2 += delta[d] * delta[d];
+            }
+
+            ShortVec factor = PARTICLE::forceFactor(dist2);
+            factor.blend(cutoff2 <= dist2, zero);
+            for (int d = 0; d < DIM; ++d) {
+                accu[d] += delta[d] * factor;
+            }
+        }
+
+        FloatCoord<DIM> ret;
+        double buffer[ARITY];
+        for (int d = 0; d < DIM; ++d) {
+            accu[d].store(buffer);
+            for (int k = 0; k < ARITY; ++k) {
+                ret[d] += buffer[k];
+            }
+        }
+
+        return ret;
+    }
+};
+
+}
+
+#endif
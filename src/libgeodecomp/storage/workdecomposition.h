@@ -0,0 +1,246 @@
+#ifndef LIBGEODECOMP_STORAGE_WORKDECOMPOSITION_H
+#define LIBGEODECOMP_STORAGE_WORKDECOMPOSITION_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_THREADS
+
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/streak.h>
+
+#include <atomic>
+#include <omp.h>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace WorkDecompositionHelpers {
+
+/**
+ * A range of chunks initially assigned to one thread. Other threads
+ * may claim chunks from it once they've run out of work. Queues are
+ * padded to a cache line so that threads don't step on each other's
+ * toes when incrementing their counters.
+ */
+class Queue
+{
+public:
+    inline Queue() :
+        next(0),
+        begin(0),
+        end(0)
+    {}
+
+    inline Queue(const Queue& other) :
+        next(other.next.load()),
+        begin(other.begin),
+        end(other.end)
+    {}
+
+    inline Queue& operator=(const Queue& other)
+    {
+        next.store(other.next.load());
+        begin = other.begin;
+        end = other.end;
+        return *this;
+    }
+
+    std::atomic<std::size_t> next;
+    std::size_t begin;
+    std::size_t end;
+
+private:
+    char padding[64 - sizeof(std::atomic<std::size_t>) - 2 * sizeof(std::size_t)];
+};
+
+}
+
+/**
+ * Splits a Region into balanced chunks of Streaks for threaded
+ * updates and runs them via work stealing: each thread starts with
+ * its own contiguous range of chunks and will steal chunks from the
+ * other threads' ranges once it's done with its own.
+ *
+ * Streaks are first cut into tranches at multiples of granularity
+ * (as some update functors depend on this alignment). Consecutive
+ * tranches are then grouped into chunks of roughly equal cell count,
+ * so that many short Streaks (e.g. on grids with few planes) make
+ * up a chunk while long Streaks are still being split up.
+ *
+ * Construction allocates, execution doesn't. Hence
+ * decompositions should be reused via WorkDecompositionCache.
+ */
+template<int DIM>
+class WorkDecomposition
+{
+public:
+    friend class WorkDecompositionTest;
+
+    /**
+     * We aim for a couple of chunks per thread to leave some slack
+     * for stealing.
+     */
+    static const std::size_t CHUNKS_PER_THREAD = 4;
+
+    WorkDecomposition(const Region<DIM>& region, int granularity, std::size_t numThreads) :
+        region(region),
+        granularity(granularity),
+        queues(numThreads)
+    {
+        if (numThreads == 0) {
+            throw std::invalid_argument("WorkDecomposition needs at least one thread");
+        }
+        if (granularity <= 0) {
+            throw std::invalid_argument("granularity needs to be positive");
+        }
+
+        std::size_t chunkSize = region.size() / (numThreads * CHUNKS_PER_THREAD);
+        chunkSize = (std::max)(chunkSize, std::size_t(1));
+
+        std::size_t currentChunkSize = 0;
+        chunkOffsets.push_back(0);
+
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            Streak<DIM> s = *i;
+
+            while (s.origin.x() < s.endX) {
+                Streak<DIM> tranche = s;
+                if (s.length() > granularity) {
+                    tranche.endX = s.origin.x() + granularity - (s.origin.x() % granularity);
+                }
+
+                streaks.push_back(tranche);
+                currentChunkSize += tranche.length();
+                s.origin.x() = tranche.endX;
+
+                if (currentChunkSize >= chunkSize) {
+                    chunkOffsets.push_back(streaks.size());
+                    currentChunkSize = 0;
+                }
+            }
+        }
+
+        if (currentChunkSize > 0) {
+            chunkOffsets.push_back(streaks.size());
+        }
+
+        std::size_t chunks = numChunks();
+        for (std::size_t t = 0; t < numThreads; ++t) {
+            queues[t].begin = chunks * (t + 0) / numThreads;
+            queues[t].end   = chunks * (t + 1) / numThreads;
+        }
+    }
+
+    inline bool matches(const Region<DIM>& otherRegion, int otherGranularity, std::size_t numThreads) const
+    {
+        return
+            (granularity == otherGranularity) &&
+            (queues.size() == numThreads) &&
+            (region == otherRegion);
+    }
+
+    inline std::size_t numChunks() const
+    {
+        return chunkOffsets.size() - 1;
+    }
+
+    /**
+     * Calls functor with a pointer to each Streak of the Region.
+     * Concurrent calls on the same object are not allowed.
+     */
+    template<typename FUNCTOR>
+    void operator()(const FUNCTOR& functor) const
+    {
+        for (std::size_t i = 0; i < queues.size(); ++i) {
+            queues[i].next.store(queues[i].begin, std::memory_order_relaxed);
+        }
+
+#pragma omp parallel
+        {
+            std::size_t numQueues = queues.size();
+            std::size_t thread = omp_get_thread_num() % numQueues;
+
+            for (std::size_t offset = 0; offset < numQueues; ++offset) {
+                WorkDecompositionHelpers::Queue& queue = queues[(thread + offset) % numQueues];
+
+                for (;;) {
+                    std::size_t chunk = queue.next.fetch_add(1, std::memory_order_relaxed);
+                    if (chunk >= queue.end) {
+                        break;
+                    }
+
+                    for (std::size_t j = chunkOffsets[chunk]; j < chunkOffsets[chunk + 1]; ++j) {
+                        functor(&streaks[j]);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    Region<DIM> region;
+    int granularity;
+    std::vector<Streak<DIM> > streaks;
+    std::vector<std::size_t> chunkOffsets;
+    mutable std::vector<WorkDecompositionHelpers::Queue> queues;
+};
+
+/**
+ * Regions being updated are mostly the same from one nano step to
+ * the next (inner set, rims, ghost zones), so we keep the most
+ * recently used WorkDecompositions around. Each thread has its own
+ * cache (see instance()), hence no locking is required.
+ */
+template<int DIM>
+class WorkDecompositionCache
+{
+public:
+    friend class WorkDecompositionTest;
+
+    static const std::size_t MAX_ENTRIES = 16;
+
+    inline WorkDecompositionCache() :
+        nextVictim(0)
+    {
+        // references handed out remain valid until their entry gets evicted:
+        entries.reserve(MAX_ENTRIES);
+    }
+
+    const WorkDecomposition<DIM>& operator()(
+        const Region<DIM>& region,
+        int granularity,
+        std::size_t numThreads)
+    {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].matches(region, granularity, numThreads)) {
+                return entries[i];
+            }
+        }
+
+        if (entries.size() < MAX_ENTRIES) {
+            entries.push_back(WorkDecomposition<DIM>(region, granularity, numThreads));
+            return entries.back();
+        }
+
+        std::size_t index = nextVictim;
+        nextVictim = (nextVictim + 1) % MAX_ENTRIES;
+        entries[index] = WorkDecomposition<DIM>(region, granularity, numThreads);
+        return entries[index];
+    }
+
+    static WorkDecompositionCache& instance()
+    {
+        static thread_local WorkDecompositionCache cache;
+        return cache;
+    }
+
+private:
+    std::vector<WorkDecomposition<DIM> > entries;
+    std::size_t nextVictim;
+};
+
+}
+
+#endif
+
+#endif
@@ -2,15 +2,18 @@
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/io/simpleinitializer.h>
 #include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/numa.h>
 #include <libgeodecomp/geometry/convexpolytope.h>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regionbuilder.h>
 #include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/geometry/partitions/hindexingpartition.h>
 #include <libgeodecomp/geometry/partitions/hilbertpartition.h>
 #include <libgeodecomp/geometry/partitions/stripingpartition.h>
 #include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/loadbalancer/oozebalancer.h>
 #include <libgeodecomp/storage/grid.h>
 #include <libgeodecomp/storage/linepointerassembly.h>
 #include <libgeodecomp/storage/linepointerupdatefunctor.h>
@@ -132,6 +135,123 @@ public:
     }
 };
 
+class RegionInsertBuilder : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionInsert";
+    }
+
+    std::string species()
+    {
+        return "builder";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            RegionBuilder<3> builder;
+            for (int z = 0; z < dim.z(); ++z) {
+                for (int y = 0; y < dim.y(); ++y) {
+                    builder << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+            Region<3> r = builder.build();
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
+/**
+ * Inserts Streaks back to front, which forces Region to shift its
+ * indices on every insert.
+ */
+class RegionInsertReverse : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionInsertReverse";
+    }
+
+    std::string species()
+    {
+        return "gold";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            Region<3> r;
+            for (int z = dim.z() - 1; z >= 0; --z) {
+                for (int y = dim.y() - 1; y >= 0; --y) {
+                    r << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
+class RegionInsertReverseBuilder : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionInsertReverse";
+    }
+
+    std::string species()
+    {
+        return "builder";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            RegionBuilder<3> builder;
+            for (int z = dim.z() - 1; z >= 0; --z) {
+                for (int y = dim.y() - 1; y >= 0; --y) {
+                    builder << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+            Region<3> r = builder.build();
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
 class RegionIntersect : public CPUBenchmark
 {
 public:
@@ -179,6 +299,53 @@ public:
     }
 };
 
+class RegionIntersectParallel : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionIntersect";
+    }
+
+    std::string species()
+    {
+        return "parallel";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            Region<3> r1;
+            Region<3> r2;
+
+            for (int z = 0; z < dim.z(); ++z) {
+                for (int y = 0; y < dim.y(); ++y) {
+                    r1 << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+
+            for (int z = 1; z < (dim.z() - 1); ++z) {
+                for (int y = 1; y < (dim.y() - 1); ++y) {
+                    r2 << Streak<3>(Coord<3>(1, y, z), dim.x() - 1);
+                }
+            }
+
+            Region<3> r3 = RegionBuilder<3>::parallelIntersection(r1, r2);
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
 class RegionSubtract : public CPUBenchmark
 {
 public:
@@ -226,6 +393,53 @@ public:
     }
 };
 
+class RegionSubtractParallel : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionSubtract";
+    }
+
+    std::string species()
+    {
+        return "parallel";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            Region<3> r1;
+            Region<3> r2;
+
+            for (int z = 0; z < dim.z(); ++z) {
+                for (int y = 0; y < dim.y(); ++y) {
+                    r1 << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+
+            for (int z = 1; z < (dim.z() - 1); ++z) {
+                for (int y = 1; y < (dim.y() - 1); ++y) {
+                    r2 << Streak<3>(Coord<3>(1, y, z), dim.x() - 1);
+                }
+            }
+
+            Region<3> r3 = RegionBuilder<3>::parallelDifference(r1, r2);
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
 class RegionUnion : public CPUBenchmark
 {
 public:
@@ -273,6 +487,53 @@ public:
     }
 };
 
+class RegionUnionParallel : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "RegionUnion";
+    }
+
+    std::string species()
+    {
+        return "parallel";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            Region<3> r1;
+            Region<3> r2;
+
+            for (int z = 0; z < dim.z(); ++z) {
+                for (int y = 0; y < dim.y(); ++y) {
+                    r1 << Streak<3>(Coord<3>(0, y, z), dim.x());
+                }
+            }
+
+            for (int z = 1; z < (dim.z() - 1); ++z) {
+                for (int y = 1; y < (dim.y() - 1); ++y) {
+                    r2 << Streak<3>(Coord<3>(1, y, z), dim.x() - 1);
+                }
+            }
+
+            Region<3> r3 = RegionBuilder<3>::parallelSum(r1, r2);
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
 class RegionAppend : public CPUBenchmark
 {
 public:
@@ -2125,6 +2386,121 @@ private:
     std::string name;
 };
 
+/**
+ * Measures how long it takes to set up the Regions of all nodes,
+ * which is what PartitionManager ultimately needs.
+ */
+template<class PARTITION>
+class PartitionRegionsBenchmark : public CPUBenchmark
+{
+public:
+    explicit PartitionRegionsBenchmark(const std::string& name, std::size_t numNodes = 1024) :
+        name(name),
+        numNodes(numNodes)
+    {}
+
+    std::string species()
+    {
+        return "gold";
+    }
+
+    std::string family()
+    {
+        return name;
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double duration = 0;
+        Coord<2> realDim(dim.x(), dim.y());
+        std::size_t totalSize = std::size_t(dim.x()) * dim.y();
+        std::size_t sum = 0;
+
+        {
+            ScopedTimer t(&duration);
+
+            std::vector<std::size_t> weights(numNodes, totalSize / numNodes);
+            weights.back() += totalSize % numNodes;
+            PARTITION h(Coord<2>(100, 200), realDim, 0, weights);
+            std::vector<Region<2> > regions = h.getRegions();
+
+            for (std::size_t i = 0; i < regions.size(); ++i) {
+                sum += regions[i].size();
+            }
+        }
+
+        if (sum != totalSize) {
+            throw std::runtime_error("oops, partition regions went bad!");
+        }
+
+        return duration;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+
+private:
+    std::string name;
+    std::size_t numNodes;
+};
+
+/**
+ * Runs a couple of balancing rounds for a domain of 4*10^10 cells
+ * whose computational cost varies between ranks.
+ */
+class OozeBalancerBenchmark : public CPUBenchmark
+{
+public:
+    std::string species()
+    {
+        return "gold";
+    }
+
+    std::string family()
+    {
+        return "OozeBalancer";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        std::size_t ranks = rawDim[0];
+        std::size_t cells = 40000000000ULL;
+        int rounds = 10;
+
+        LoadBalancer::WeightVec weights(ranks, cells / ranks);
+        weights.back() += cells % ranks;
+        LoadBalancer::LoadVec relativeLoads(ranks);
+        OozeBalancer balancer;
+
+        double duration = 0;
+        {
+            ScopedTimer t(&duration);
+
+            for (int round = 0; round < rounds; ++round) {
+                for (std::size_t i = 0; i < ranks; ++i) {
+                    relativeLoads[i] = weights[i] * (1.0 + 0.1 * (i % 7)) * 1e-10;
+                }
+
+                weights = balancer.balance(weights, relativeLoads);
+            }
+        }
+
+        if (sum(weights) != cells) {
+            throw std::runtime_error("oops, OozeBalancer lost some cells!");
+        }
+
+        return duration;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+};
+
 #ifdef LIBGEODECOMP_WITH_CPP14
 typedef double ValueType;
 const std::size_t MATRICES = 1;
@@ -2915,6 +3291,210 @@ private:
     }
 };
 
+/**
+ * Bandwidth-bound 3D Jacobi with the statically scheduled OpenMP
+ * UpdateFunctor. Threads are pinned for both species, so the only
+ * difference is where the grids' pages end up: on the node of the
+ * initializing thread (vanilla) or next to the threads which update
+ * them (gold).
+ */
+class NUMAFirstTouchBase : public CPUBenchmark
+{
+public:
+    typedef UpdateFunctorHelpers::ConcurrencyEnableOpenMP MyConcurrencySpec;
+    typedef UpdateFunctor<JacobiCellFixedHood, MyConcurrencySpec> MyUpdateFunctor;
+    typedef Grid<JacobiCellFixedHood, Topologies::Cube<3>::Topology> GridType;
+
+    std::string family()
+    {
+        return "NUMAFirstTouch";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        int steps = 20;
+
+        NUMA::pinThreads(NUMA::PIN_COMPACT);
+        NUMA::enableFirstTouch(firstTouch());
+        GridType *gridOld = new GridType(dim, JacobiCellFixedHood(1.0));
+        GridType *gridNew = new GridType(dim, JacobiCellFixedHood(0.0));
+        NUMA::enableFirstTouch(false);
+
+        Region<3> region;
+        region << CoordBox<3>(Coord<3>::diagonal(1), dim - Coord<3>::diagonal(2));
+
+        using std::swap;
+
+        double seconds = 0;
+        {
+            ScopedTimer timer(&seconds);
+
+            for (int i = 0; i < steps; ++i) {
+                MyUpdateFunctor()(region, Coord<3>(), Coord<3>(), *gridOld, gridNew, 0, MyConcurrencySpec(false, false));
+                swap(gridOld, gridNew);
+            }
+        }
+
+        if (gridNew->get(Coord<3>(1, 1, 1)).temp == 4711) {
+            std::cout << "this statement just serves to prevent the compiler from"
+                      << "optimizing away the loops above\n";
+        }
+
+        delete gridOld;
+        delete gridNew;
+
+        const double updates = 1.0 * region.size() * steps;
+        return 1e-9 * updates / seconds;
+    }
+
+    std::string unit()
+    {
+        return "GLUPS";
+    }
+
+private:
+    virtual bool firstTouch() = 0;
+};
+
+class NUMAFirstTouchVanilla : public NUMAFirstTouchBase
+{
+public:
+    std::string species()
+    {
+        return "vanilla";
+    }
+
+private:
+    bool firstTouch()
+    {
+        return false;
+    }
+};
+
+class NUMAFirstTouchGold : public NUMAFirstTouchBase
+{
+public:
+    std::string species()
+    {
+        return "gold";
+    }
+
+private:
+    bool firstTouch()
+    {
+        return true;
+    }
+};
+
+/**
+ * 3D Jacobi on a torus with the classic API, so every neighbor
+ * access goes through the grid's operator[].
+ */
+class JacobiCellTorus
+{
+public:
+    class API :
+        public APITraits::HasStencil<Stencils::VonNeumann<3, 1> >,
+        public APITraits::HasTorusTopology<3>
+    {};
+
+    explicit JacobiCellTorus(double t = 0) :
+        temp(t)
+    {}
+
+    template<typename NEIGHBORHOOD>
+    void update(const NEIGHBORHOOD& hood, int /* nanoStep */)
+    {
+        temp = (hood[Coord<3>( 0,  0, -1)].temp +
+                hood[Coord<3>( 0, -1,  0)].temp +
+                hood[Coord<3>(-1,  0,  0)].temp +
+                hood[Coord<3>( 0,  0,  0)].temp +
+                hood[Coord<3>( 1,  0,  0)].temp +
+                hood[Coord<3>( 0,  1,  0)].temp +
+                hood[Coord<3>( 0,  0,  1)].temp) * (1.0 / 7.0);
+    }
+
+    double temp;
+};
+
+class JacobiCellPaddedTorus : public JacobiCellTorus
+{
+public:
+    class API :
+        public JacobiCellTorus::API,
+        public APITraits::HasPaddedTorusGrid
+    {};
+
+    explicit JacobiCellPaddedTorus(double t = 0) :
+        JacobiCellTorus(t)
+    {}
+};
+
+/**
+ * Compares periodic boundary handling in the SerialSimulator: the
+ * default DisplacedGrid normalizes coordinates on each access
+ * (vanilla) while the PaddedTorusGrid refreshes its ghost frame once
+ * per nano step (gold).
+ */
+template<typename CELL>
+class PaddedTorusGridBenchmark : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "PaddedTorusGrid";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        int maxT = 5;
+        SerialSimulator<CELL> sim(
+            new NoOpInitializer<CELL>(dim, maxT));
+
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            sim.run();
+        }
+
+        if (sim.getGrid()->get(Coord<3>(1, 1, 1)).temp == 4711) {
+            std::cout << "this statement just serves to prevent the compiler from"
+                      << "optimizing away the loops above\n";
+        }
+
+        double updates = 1.0 * maxT * dim.prod();
+        double gLUPS = 1e-9 * updates / seconds;
+
+        return gLUPS;
+    }
+
+    std::string unit()
+    {
+        return "GLUPS";
+    }
+};
+
+class PaddedTorusGridVanilla : public PaddedTorusGridBenchmark<JacobiCellTorus>
+{
+public:
+    std::string species()
+    {
+        return "vanilla";
+    }
+};
+
+class PaddedTorusGridGold : public PaddedTorusGridBenchmark<JacobiCellPaddedTorus>
+{
+public:
+    std::string species()
+    {
+        return "gold";
+    }
+};
+
 #ifdef LIBGEODECOMP_WITH_CUDA
 void cudaTests(std::string name, std::string revision, int cudaDevice);
 #endif
@@ -2986,18 +3566,42 @@ int main(int argc, char **argv)
     eval(RegionInsert(), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionInsert(), toVector(Coord<3>(2048, 2048, 2048)));
 
+    eval(RegionInsertBuilder(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionInsertBuilder(), toVector(Coord<3>( 512,  512,  512)));
+    eval(RegionInsertBuilder(), toVector(Coord<3>(2048, 2048, 2048)));
+
+    eval(RegionInsertReverse(), toVector(Coord<3>(  64,   64,   64)));
+    eval(RegionInsertReverse(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionInsertReverse(), toVector(Coord<3>( 256,  256,  256)));
+
+    eval(RegionInsertReverseBuilder(), toVector(Coord<3>(  64,   64,   64)));
+    eval(RegionInsertReverseBuilder(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionInsertReverseBuilder(), toVector(Coord<3>( 256,  256,  256)));
+
     eval(RegionIntersect(), toVector(Coord<3>( 128,  128,  128)));
     eval(RegionIntersect(), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionIntersect(), toVector(Coord<3>(2048, 2048, 2048)));
 
+    eval(RegionIntersectParallel(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionIntersectParallel(), toVector(Coord<3>( 512,  512,  512)));
+    eval(RegionIntersectParallel(), toVector(Coord<3>(2048, 2048, 2048)));
+
     eval(RegionSubtract(), toVector(Coord<3>( 128,  128,  128)));
     eval(RegionSubtract(), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionSubtract(), toVector(Coord<3>(2048, 2048, 2048)));
 
+    eval(RegionSubtractParallel(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionSubtractParallel(), toVector(Coord<3>( 512,  512,  512)));
+    eval(RegionSubtractParallel(), toVector(Coord<3>(2048, 2048, 2048)));
+
     eval(RegionUnion(), toVector(Coord<3>( 128,  128,  128)));
     eval(RegionUnion(), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionUnion(), toVector(Coord<3>(2048, 2048, 2048)));
 
+    eval(RegionUnionParallel(), toVector(Coord<3>( 128,  128,  128)));
+    eval(RegionUnionParallel(), toVector(Coord<3>( 512,  512,  512)));
+    eval(RegionUnionParallel(), toVector(Coord<3>(2048, 2048, 2048)));
+
     eval(RegionAppend(), toVector(Coord<3>( 128,  128,  128)));
     eval(RegionAppend(), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionAppend(), toVector(Coord<3>(2048, 2048, 2048)));
@@ -3110,6 +3714,14 @@ int main(int argc, char **argv)
     eval(PartitionBenchmark<HilbertPartition     >("PartitionHilbert"),   dim);
     eval(PartitionBenchmark<ZCurvePartition<2>   >("PartitionZCurve"),    dim);
 
+    eval(PartitionRegionsBenchmark<StripingPartition<2> >("PartitionRegionsStriping"), dim);
+    eval(PartitionRegionsBenchmark<HilbertPartition     >("PartitionRegionsHilbert"),  dim);
+    eval(PartitionRegionsBenchmark<ZCurvePartition<2>   >("PartitionRegionsZCurve"),   dim);
+
+    eval(OozeBalancerBenchmark(), toVector(Coord<3>(  1000, 1, 1)));
+    eval(OozeBalancerBenchmark(), toVector(Coord<3>( 10000, 1, 1)));
+    eval(OozeBalancerBenchmark(), toVector(Coord<3>(100000, 1, 1)));
+
     dim = toVector(Coord<3>(10000, 2000, 0));
     eval(UpdateFunctorThreadingSilver(), dim);
     eval(UpdateFunctorThreadingGold(), dim);
@@ -3117,6 +3729,24 @@ int main(int argc, char **argv)
     eval(GridLoadSaveRegionAoS(), toVector(Coord<3>(256, 0, 32)));
     eval(GridLoadSaveRegionSoA(), toVector(Coord<3>(256, 0, 32)));
 
+    sizes.clear();
+    sizes << Coord<3>(64, 64, 64)
+          << Coord<3>(128, 128, 128)
+          << Coord<3>(256, 256, 256);
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        eval(PaddedTorusGridVanilla(), toVector(sizes[i]));
+        eval(PaddedTorusGridGold(), toVector(sizes[i]));
+    }
+
+    // pins all OpenMP threads, so keep this last:
+    sizes.clear();
+    sizes << Coord<3>(256, 256, 256)
+          << Coord<3>(512, 512, 256);
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        eval(NUMAFirstTouchVanilla(), toVector(sizes[i]));
+        eval(NUMAFirstTouchGold(), toVector(sizes[i]));
+    }
+
 #ifdef LIBGEODECOMP_WITH_CUDA
     cudaTests(name, revision, cudaDevice);
 #endif
@@ -7,13 +7,14 @@
  *
  * Use the accompanying fetch_matrices.sh to download/extract these.
  *
- * We're using the Matrix Market IO library for matrix parsing:
- * http://math.nist.gov/MatrixMarket/mmio-c.html
+ * Matrices are parsed once by SparseMatrixCache and stored in a
+ * binary CSR file (<matrix>.mtx.csr) which later runs map directly.
  *
  */
 #include <libgeodecomp/config.h>
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/io/simpleinitializer.h>
+#include <libgeodecomp/io/sparsematrixcache.h>
 #include <libgeodecomp/misc/chronometer.h>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/region.h>
@@ -34,16 +35,17 @@
 #include <immintrin.h>
 #endif
 
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <stdio.h>
+#include <sys/stat.h>
 #include <cstdlib>
 #include <sstream>
 #include <vector>
 #include <map>
 
 #include "../performancetests/cpubenchmark.h"
-#include "mmio.h"
 
 using namespace LibGeoDecomp;
 using namespace LibFlatArray;
@@ -171,6 +173,115 @@ LIBFLATARRAY_REGISTER_SOA(SPMVMSoACell<262144>, ((double)(sum))((double)(value))
         eval(METHOD<SPMVMSoACell<262144>, MATRIX, NZ, 262144>(), toVector(Coord<3>(DIM, 1, 1))); \
     } while (0)
 
+/**
+ * Reads dimensions and number of stored entries from the size line
+ * of a MatrixMarket file, without parsing the body. Symmetric
+ * matrices store only one triangle, hence the flag.
+ */
+inline bool matrixMarketSize(
+    const std::string& fileName,
+    long *rows,
+    long *columns,
+    long *entries,
+    bool *symmetric)
+{
+    std::ifstream file(fileName.c_str());
+    std::string banner;
+    std::getline(file, banner);
+    *symmetric = (banner.find("symmetric") != std::string::npos);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || (line[0] == '%')) {
+            continue;
+        }
+
+        std::stringstream buf(line);
+        buf >> *rows >> *columns >> *entries;
+        return bool(buf);
+    }
+
+    return false;
+}
+
+/**
+ * A cache file is stale if it's older than the matrix it was
+ * converted from, or if it doesn't match that matrix (e.g. because
+ * the download was replaced or a conversion got interrupted).
+ */
+template<typename VALUE_TYPE>
+bool csrCacheIsValid(const std::string& fileName, const std::string& cacheFile)
+{
+    struct stat matrixStatus;
+    struct stat cacheStatus;
+    if (stat(cacheFile.c_str(), &cacheStatus) != 0) {
+        return false;
+    }
+    if (stat(fileName.c_str(), &matrixStatus) != 0) {
+        // nothing to rebuild the cache from, so it'll have to do:
+        return true;
+    }
+    if (cacheStatus.st_mtime < matrixStatus.st_mtime) {
+        return false;
+    }
+
+    long rows;
+    long columns;
+    long entries;
+    bool symmetric;
+    if (!matrixMarketSize(fileName, &rows, &columns, &entries, &symmetric)) {
+        return false;
+    }
+
+    SparseMatrixCache::Header header;
+    try {
+        header = SparseMatrixCache::readHeader(cacheFile);
+    } catch (const IOException&) {
+        return false;
+    }
+
+    // symmetric matrices get their off-diagonal entries mirrored:
+    std::size_t minEntries = entries;
+    std::size_t maxEntries = symmetric ? 2 * entries : entries;
+    // sections: header, row offsets, columns, values:
+    std::size_t expectedSize = SparseMatrixCache::Header::align(
+        SparseMatrixCache::Header::align(
+            sizeof(SparseMatrixCache::Header) + (header.dimension + 1) * sizeof(std::int64_t)) +
+        header.nonZeros * sizeof(int)) +
+        header.nonZeros * sizeof(VALUE_TYPE);
+
+    return
+        (header.valueSize == sizeof(VALUE_TYPE)) &&
+        (header.c == 0) &&
+        (header.dimension == std::size_t(rows)) &&
+        (header.numberOfColumns == std::size_t(columns)) &&
+        (header.nonZeros >= minEntries) &&
+        (header.nonZeros <= maxEntries) &&
+        (std::size_t(cacheStatus.st_size) >= expectedSize);
+}
+
+/**
+ * Parsing MatrixMarket files takes much longer than the benchmarks
+ * themselves, so we convert each matrix once into a binary CSR file
+ * next to it and map that on subsequent runs. Stale caches are
+ * rebuilt. Conversion goes to a temporary file first so that an
+ * interrupted run can't leave a truncated cache behind.
+ */
+template<typename VALUE_TYPE>
+std::string csrCacheFile(const std::string& fileName)
+{
+    std::string cacheFile = fileName + ".csr";
+    if (!csrCacheIsValid<VALUE_TYPE>(fileName, cacheFile)) {
+        std::string tempFile = cacheFile + ".tmp";
+        SparseMatrixCache::convertMatrixMarket<VALUE_TYPE>(fileName, tempFile);
+        if (std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+            throw FileWriteException(cacheFile);
+        }
+    }
+
+    return cacheFile;
+}
+
 /**
  * For reference performance of SELL, we also measure the performance of
  * compressed row storage. This class initializes the datastructures needed
@@ -185,32 +296,6 @@ private:
     std::vector<int>        column;
     std::vector<int>        rowLen;
 
-    void initFromMatrix(const std::vector<std::pair<Coord<2>, VALUE_TYPE> >& matrix)
-    {
-        const int nonZero = matrix.size();
-        if (!nonZero) {
-            throw std::logic_error("Matrix should at least have one non-zero entry");
-        }
-
-        values.resize(nonZero);
-        column.resize(nonZero);
-        rowLen.resize(dimension + 1);
-
-        int currentRow = 0;
-        int cnt = 0;
-        rowLen[0] = 0;
-        for (const auto& pair : matrix) {
-            if (currentRow != pair.first.x()) {
-                currentRow = pair.first.x();
-                rowLen[currentRow] = cnt;
-            }
-            values[cnt] = pair.second;
-            column[cnt] = pair.first.y();
-            ++cnt;
-        }
-        rowLen[dimension] = cnt;
-    }
-
 public:
     inline
     explicit CRSInitializer(int dim) :
@@ -237,48 +322,20 @@ public:
 
     void init(const std::string& fileName)
     {
-        std::vector<std::pair<Coord<2>, VALUE_TYPE> > adjacency;
+        SparseMatrixCache::loadCSR(csrCacheFile<VALUE_TYPE>(fileName), &rowLen, &column, &values);
 
-        // read matrix into adjacency (this may take some time ...)
-        // using this C API provided by matrix market
-        MM_typecode matcode;
-        int M, N, nz;
-        FILE *f = fopen(fileName.c_str(), "r");
-        if (!f) {
-            LOG(FATAL, "CRSInitializer failed to open file " << fileName);
-            throw std::logic_error("fopen() failed");
-        }
-
-        if (mm_read_banner(f, &matcode) != 0) {
-            throw std::logic_error("Could not process Matrix Market banner");
-        }
-
-        if (mm_read_mtx_crd_size(f, &M, &N, &nz) != 0) {
-            throw std::logic_error("Could not dimensions of matrix");
-        }
-
-        if (dimension != M || dimension != N) {
+        if (int(rowLen.size()) != (dimension + 1)) {
             throw std::logic_error("Size mismatch");
         }
-
-        for (int i = 0; i < nz; ++i) {
-            int m, n;
-            double tmp;
-            if (fscanf(f, "%d %d %lg\n", &m, &n, &tmp) != 3) {
-                throw std::logic_error("Failed to parse mtx format");
-            }
-            adjacency << std::make_pair(Coord<2>(m - 1, n - 1), tmp);
+        if (values.empty()) {
+            throw std::logic_error("Matrix should at least have one non-zero entry");
         }
-
-        fclose(f);
-
-        initFromMatrix(adjacency);
     }
 };
 
 /**
  * Initializer class, which reads in matrices in matrix market format
- * using mmc.h, mmc.c. See http://math.nist.gov/MatrixMarket/mmio-c.html.
+ * via their binary CSR cache, see csrCacheFile().
  */
 template<typename CELL, typename GRID>
 class SparseMatrixInitializerMM : public SimpleInitializer<CELL>
@@ -300,44 +357,32 @@ public:
 
     virtual void grid(GridBase<CELL, 1> *grid)
     {
-        // setup sparse matrix
-        std::vector<std::pair<Coord<2>, double> > weights;
-
-        // read matrix into weights (this may take some time ...)
-        // using this C API provided by matrix market
-        MM_typecode matcode;
-        int M, N, nz;
-        FILE *f = fopen(fileName.c_str(), "r");
-        if (!f) {
-            LOG(FATAL, "SparseMatrixInitializerMM failed to open file " << fileName);
-            throw std::logic_error("fopen() failed");
-        }
-
-        if (mm_read_banner(f, &matcode) != 0) {
-            throw std::logic_error("Could not process Matrix Market banner");
-        }
-
-        if (mm_read_mtx_crd_size(f, &M, &N, &nz) != 0) {
-            throw std::logic_error("Could not dimensions of matrix");
-        }
-
-        if (size != M || size != N) {
+        std::string cacheFile = csrCacheFile<double>(fileName);
+        if (SparseMatrixCache::readHeader(cacheFile).dimension != std::size_t(size)) {
             throw std::logic_error("Size mismatch");
         }
 
-        for (int i = 0; i < nz; ++i) {
-            int m, n;
-            double tmp;
-            if (fscanf(f, "%d %d %lg\n", &m, &n, &tmp) != 3) {
-                throw std::logic_error("Failed to parse mtx format");
+        // fill the SELL container straight from the mapped cache if
+        // possible, saving the detour via a coordinate list:
+        GRID *soaGrid = dynamic_cast<GRID*>(grid);
+        if (soaGrid) {
+            SparseMatrixCache::loadCSR(cacheFile, &soaGrid->getWeights(0));
+        } else {
+            std::vector<int> rowOffsets;
+            std::vector<int> columns;
+            std::vector<double> values;
+            SparseMatrixCache::loadCSR(cacheFile, &rowOffsets, &columns, &values);
+
+            std::vector<std::pair<Coord<2>, double> > weights;
+            weights.reserve(values.size());
+            for (int row = 0; row < size; ++row) {
+                for (int i = rowOffsets[row]; i < rowOffsets[row + 1]; ++i) {
+                    weights << std::make_pair(Coord<2>(row, columns[i]), values[i]);
+                }
             }
-            weights << std::make_pair(Coord<2>(m - 1, n - 1), tmp);
+            grid->setWeights(0, weights);
         }
 
-        fclose(f);
-
-        grid->setWeights(0, weights);
-
         // setup rhs: not needed, since the grid is intialized with default cells
         // default value of SPMVMCell is 8.0
     }
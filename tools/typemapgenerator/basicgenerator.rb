@@ -50,7 +50,9 @@ void serialize(ARCHIVE& archive, #{klass}#{params2}& object, const unsigned vers
 EOF
   end
 
-  def generate_serialize_function(klass, members, parents, template_parameters)
+  # custom_serializer names the codec of classes which encode
+  # themselves (see MPIParser#custom_serializer).
+  def generate_serialize_function(klass, members, parents, template_parameters, custom_serializer=nil)
     params1 = render_template_params1(template_parameters)
     params2 = render_template_params2(template_parameters)
     params1 = ", #{params1}" if params1.size > 0
@@ -62,6 +64,14 @@ EOF
     {
 EOF
 
+    if custom_serializer
+      ret += <<EOF
+        #{custom_serializer}::serialize(archive, object);
+    }
+EOF
+      return ret
+    end
+
     parents.sort.each do |parent_type|
       ret += <<EOF
         archive & #{base_object_name}<#{parent_type} >(object);
@@ -96,11 +106,13 @@ EOF
     ret.gsub!(/SERIALIZATION_CLASS_NAME/, @serialization_class_name)
     ret.gsub!(/SERIALIZATION_NAMESPACE/, @serialization_namespace)
 
+    custom_serializers = options.custom_serializers || {}
     serializations = options.topological_class_sortation.map do |klass|
       generate_serialize_function(klass,
                                   options.members[klass],
                                   options.resolved_parents[klass],
-                                  options.template_params[klass])
+                                  options.template_params[klass],
+                                  custom_serializers[klass])
     end
     ret.sub!(/.*SERIALIZATIION_DEFINITIONS/, serializations.join("\n"))
 
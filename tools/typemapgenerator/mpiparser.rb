@@ -159,6 +159,7 @@ class MPIParser
     res.template_params = {}
     res.is_abstract = {}
     res.wants_polymorphic_serialization = {}
+    res.custom_serializers = {}
 
     classes.each do |klass|
       res.members[klass] = get_members(klass)
@@ -166,10 +167,16 @@ class MPIParser
       res.template_params[klass] = template_parameters(klass)
       res.is_abstract[klass] = is_abstract?(klass)
       res.wants_polymorphic_serialization[klass] = wants_polymorphic_serialization?(klass)
+      res.custom_serializers[klass] = custom_serializer(klass)
     end
 
     @log.info "  shallow resolution successful, mapping headers"
-    res.headers = classes.map { |klass| find_header(klass, @include_prefix) }
+    res.headers = []
+    classes.each do |klass|
+      res.headers.push find_header(klass, @include_prefix)
+      codec = res.custom_serializers[klass]
+      res.headers.push find_codec_header(klass, codec, @include_prefix) if codec
+    end
     return res
   end
 
@@ -781,6 +788,48 @@ class MPIParser
     return false
   end
 
+  # Classes may take over their Boost/HPX serialization (e.g. to use
+  # a compact encoding) by befriending CustomSerialization and a codec
+  # named after them, e.g. Region and RegionCodec. The generated
+  # serialize() then forwards to CODEC::serialize(archive, object).
+  # Returns the codec's name or nil.
+  def custom_serializer(klass)
+    filename = class_to_filename(klass)
+    doc = get_xml(filename)
+    friends = []
+
+    doc.elements.each("doxygen/compounddef/sectiondef/memberdef") do |member|
+      if member.attributes["kind"] == "friend"
+        friends.push member.elements["name"].text
+      end
+    end
+
+    return nil if !friends.include?("CustomSerialization")
+
+    codec = template_basename(klass).split("::").last + "Codec"
+    if !friends.include?(codec)
+      raise "#{klass} requests custom serialization, but doesn't befriend #{codec}"
+    end
+
+    return codec
+  end
+
+  # Codecs aren't serialization candidates themselves, so their XML
+  # file isn't cached yet. They're expected to share the namespace of
+  # the class they serialize.
+  def find_codec_header(klass, codec, prefix="")
+    namespace = template_basename(klass).split("::")[0..-2]
+    full_name = (namespace + [codec]).join("::")
+
+    if @filename_cache[full_name].nil?
+      filename = `grep -l "<compoundname>#{full_name}</compoundname>" #{@path}/class*.xml`.split("\n").first
+      raise "no XML file found for codec #{full_name}" if filename.nil?
+      @filename_cache[full_name] = filename
+    end
+
+    return find_header(full_name, prefix)
+  end
+
   def is_class_declaration(filename)
     (filename =~ /\/class/)
   end
@@ -28,4 +28,18 @@ class TestBoostGenerator < Test::Unit::TestCase
 
     assert_equal(expected_def, actual_def)
   end
+
+  def test_generate_custom_serialize_function
+    actual_def = @generator.generate_serialize_function("Car", {}, [], [], "CarCodec")
+    expected_def = <<EOF
+    template<typename ARCHIVE>
+    inline
+    static void serialize(ARCHIVE& archive, Car& object, const unsigned /*version*/)
+    {
+        CarCodec::serialize(archive, object);
+    }
+EOF
+
+    assert_equal(expected_def, actual_def)
+  end
 end